@@ -0,0 +1,136 @@
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include "utils.h"
+#include "holdings.h"
+#include "matching_engine.h"
+#include <memory>
+#include <unordered_map>
+
+class Backtest;
+
+// One execution of a backtested order
+struct BacktestTrade
+{
+    size_t candleIndex;
+    uint64_t orderId; // 0 for market orders
+    Side side;
+    double quantity;
+    double price;
+    double brokerFee;
+    double realizedPnL; // Sells only
+};
+
+// A trading strategy driven by stored candles. Callbacks run on the backtest
+// thread and may place or cancel orders through the Backtest they are given.
+class Strategy
+{
+public:
+    virtual ~Strategy() = default;
+    virtual std::string name() const = 0;
+    virtual void onCandle(Backtest &backtest, const Candle &candle, size_t index) = 0;
+    virtual void onFill(Backtest &backtest, const BacktestTrade &trade) {}
+};
+
+struct BacktestConfig
+{
+    double startingCash = 100000.0;
+    size_t equityStride = 1;  // Record equity every N candles; 0 records none
+    bool recordTrades = true;
+};
+
+struct BacktestResult
+{
+    std::string strategy;
+    size_t candles = 0;
+    double startingCash = 0.0;
+    double finalEquity = 0.0;
+    double totalReturn = 0.0; // Percent
+    double maxDrawdown = 0.0; // Percent of the running peak
+    double sharpe = 0.0;      // Mean over standard deviation of per-candle returns
+    double fees = 0.0;
+    double realizedPnL = 0.0;
+    size_t fills = 0;
+    size_t closingTrades = 0; // Sells that reduced a position
+    size_t winningTrades = 0;
+    std::vector<BacktestTrade> trades;
+    std::vector<double> equity; // One point every equityStride candles
+};
+
+// Replays one symbol's candles through a strategy. Orders use the live fill
+// rules: market orders fill at the latest close, and everything else goes
+// into a real OrderBook that each candle drives with its open, nearer
+// extreme, further extreme and close as reference prices. Fees come from
+// calculateBrokerFee and the position from HoldingsMap, as in live trading.
+class Backtest
+{
+public:
+    explicit Backtest(const BacktestConfig &config = BacktestConfig());
+    Backtest(const Backtest &) = delete; // The book's event sink points back here
+    Backtest &operator=(const Backtest &) = delete;
+
+    BacktestResult run(const Candle *candles, size_t count, Strategy &strategy);
+
+    // Order entry from strategy callbacks. Market orders return false and
+    // other orders 0 when the cash or shares are not available.
+    bool buy(double quantity);
+    bool sell(double quantity);
+    uint64_t limitBuy(double quantity, double limitPrice);
+    uint64_t limitSell(double quantity, double limitPrice);
+    uint64_t stopBuy(double quantity, double stopPrice);
+    uint64_t stopSell(double quantity, double stopPrice);
+    uint64_t placeOrder(Side side, BookOrderType type, double quantity, double limitPrice, double stopPrice = 0.0, double trailAmount = 0.0);
+    bool cancel(uint64_t orderId);
+
+    double price() const { return lastPrice; }
+    double cash() const { return cashBalance; }
+    double position() const { return shares; }
+    double equity() const { return cashBalance + shares * lastPrice; }
+    double availableCash() const { return cashBalance - reservedCash; }
+    double availableShares() const { return shares - reservedShares; }
+    size_t openOrders() const { return holds.size(); }
+
+private:
+    struct Hold
+    {
+        double cash;
+        double shares;
+    };
+
+    void reset();
+    void drive(const Candle &candle);
+    void applyBookEvents();
+    void reportFills(Strategy &strategy);
+    void execute(Side side, uint64_t orderId, double quantity, double price);
+    void release(uint64_t orderId, double fraction = 1.0);
+
+    BacktestConfig config;
+    OrderBook book;
+    std::vector<BookEvent> events;           // Collected by the book's sink, applied after each book call
+    std::vector<BacktestTrade> pendingFills; // Reported to onFill once the current callback returns
+    std::vector<BacktestTrade> reporting;
+    std::unordered_map<uint64_t, Hold> holds; // Open order ID -> reservation
+    HoldingsMap holdings;
+    BacktestResult result;
+
+    double cashBalance = 0.0;
+    double shares = 0.0;
+    double reservedCash = 0.0;
+    double reservedShares = 0.0;
+    double lastPrice = 0.0;
+    size_t currentIndex = 0;
+    uint64_t nextOrderId = 1;
+};
+
+// Built-in strategies, looked up by name for the command line
+struct StrategyParams
+{
+    int period = 5;          // SMA, RSI or Bollinger period (MACD is fixed at 12/26/9)
+    double lowerBand = 30.0; // RSI: buy at or below
+    double upperBand = 70.0; // RSI: sell at or above
+};
+
+std::unique_ptr<Strategy> makeStrategy(const std::string &name, const StrategyParams &params);
+std::string strategyNames(); // For usage messages, e.g. "sma_cross|rsi|macd_cross|bollinger"
+
+#endif // BACKTEST_H
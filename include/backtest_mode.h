@@ -0,0 +1,34 @@
+#ifndef BACKTEST_MODE_H
+#define BACKTEST_MODE_H
+
+#include "utils.h"
+#include "backtest.h"
+#include "parameter_sweep.h"
+
+// Options for replaying stored candles through a strategy
+struct BacktestOptions
+{
+    std::string strategy;  // A name from strategyNames()
+    std::string symbol;    // Empty for every symbol with stored candles
+    StrategyParams params;
+    double startingCash = 100000.0;
+    std::string outputDir = "data/backtests"; // Trade lists and equity curves
+};
+
+// Options for running a parameter grid over every symbol
+struct SweepOptions
+{
+    std::string symbol; // Empty for every symbol with stored candles
+    SweepGrid grid;
+    unsigned threads = 0; // 0 = the shared pool, one worker per hardware thread
+    double startingCash = 100000.0;
+    size_t top = 20; // Rows shown; 0 shows all
+};
+
+// Function declarations
+bool parseBacktestOptions(int argc, char *argv[], BacktestOptions &options);
+int runBacktestMode(const BacktestOptions &options);
+bool parseSweepOptions(int argc, char *argv[], SweepOptions &options);
+int runSweepMode(const SweepOptions &options);
+
+#endif // BACKTEST_MODE_H
@@ -0,0 +1,10 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "utils.h"
+
+// Function declarations
+int runBenchmark(const std::string &name);
+std::string benchmarkNames(); // For usage messages, e.g. "matching|..."
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,67 @@
+#ifndef CANDLE_HISTORY_H
+#define CANDLE_HISTORY_H
+
+#include "utils.h"
+
+// Candles [first, first + count) of a history
+struct CandleRange
+{
+    const Candle *candles = nullptr;
+    size_t first = 0; // History index of candles[0]
+    size_t count = 0;
+};
+
+// Read-only, memory-mapped view of a stored candle file. The candles are
+// used in place: nothing is copied or parsed, so a view is cheap to open and
+// can be shared by any number of reader threads.
+class CandleHistory
+{
+public:
+    CandleHistory() = default;
+    ~CandleHistory();
+    CandleHistory(CandleHistory &&other) noexcept;
+    CandleHistory &operator=(CandleHistory &&other) noexcept;
+    CandleHistory(const CandleHistory &) = delete;
+    CandleHistory &operator=(const CandleHistory &) = delete;
+
+    // Map a file of packed Candles that follow headerBytes of header;
+    // a trailing partial candle is ignored
+    bool open(const std::string &path, size_t headerBytes = 0);
+
+    // Map a symbol's history: data/stock_data/<symbol>/candles_history.dat,
+    // or the <symbol>_candles.dat snapshot if no history has been recorded
+    bool openSymbol(const std::string &symbol);
+    void close();
+
+    // Remap if candles have been appended to the file since it was mapped.
+    // Returns true if the candles changed; pointers into the old view are
+    // then no longer valid.
+    bool refresh();
+
+    const Candle *data() const { return candles; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Candle &operator[](size_t i) const { return candles[i]; }
+    const Candle *begin() const { return candles; }
+    const Candle *end() const { return candles + count; }
+    const std::string &path() const { return filePath; }
+
+    // The candles in [first, first + count), clamped to the history
+    CandleRange range(size_t first, size_t count) const;
+
+    static std::string historyPath(const std::string &symbol);
+    static std::string snapshotPath(const std::string &symbol);
+
+    // Every symbol with a history or a snapshot on disk, sorted
+    static std::vector<std::string> storedSymbols();
+
+private:
+    void *mapping = nullptr;
+    size_t mappedBytes = 0;
+    const Candle *candles = nullptr;
+    size_t count = 0;
+    size_t headerBytes = 0;
+    std::string filePath;
+};
+
+#endif // CANDLE_HISTORY_H
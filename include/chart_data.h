@@ -0,0 +1,59 @@
+#ifndef CHART_DATA_H
+#define CHART_DATA_H
+
+#include "utils.h"
+#include "symbol_registry.h"
+
+// Candles shown by the chart; older ones are off the left edge
+const size_t CHART_VISIBLE_CANDLES = 50;
+
+// The visible part of one symbol's chart, copied out under the symbol's
+// seriesLock so the plot can be built without holding it. Every series is aligned with
+// candles; warm-up values (0 before an average is ready) are kept and
+// skipped when written. A long range is downsampled so that each entry is a
+// bucket of `stride` history candles (see chart_downsample.h).
+struct ChartWindow
+{
+    size_t first = 0;  // History index of candles[0]
+    size_t stride = 1; // History candles per entry
+    std::vector<Candle> candles;
+    std::vector<double> movingAverage;
+    std::vector<double> bollingerUpper;
+    std::vector<double> bollingerLower;
+    std::vector<double> rsi;
+    double currentPrice = 0.0; // Latest tick, 0 if none yet
+};
+
+// Function declarations
+// Sync the symbol's indicators and copy its last visible candles into window,
+// reusing window's storage. Returns false if the symbol has no candles yet.
+// Callers hold the symbol's seriesLock (market_data.h); the work is
+// O(visible), whatever the history length.
+bool captureChartWindow(const std::string &symbol, size_t visible, ChartWindow &window);
+
+// Bring the symbol's chart indicators up to date with its candles, so the
+// next capture or scan has nothing to catch up on. Takes the symbol's
+// seriesLock; does nothing for a symbol without indicators.
+void syncChartIndicators(SymbolId symbolId);
+
+// Latest tick of symbol, 0 if none yet; read without a lock
+double chartCurrentPrice(const std::string &symbol);
+
+// Candles fed to the indicators ahead of a window taken from stored history.
+// SMA and Bollinger only look back 20 candles; Wilder's RSI keeps under 1e-8
+// of anything older than this.
+const size_t CHART_WARMUP_CANDLES = 250;
+
+// Append the window to buffer as gnuplot inline datablocks $candles (history
+// index open high low close), $ma, $bands (index upper lower) and $rsi
+void appendChartDatablocks(const ChartWindow &window, std::string &buffer);
+
+// First window row holding history index `ready` or later, e.g. where a
+// series' warm-up ends
+size_t firstReadyRow(const ChartWindow &window, size_t ready);
+
+// Append value in plain decimal with the given number of decimals, using std::to_chars
+void appendNumber(std::string &buffer, double value, int decimals);
+void appendNumber(std::string &buffer, size_t value);
+
+#endif // CHART_DATA_H
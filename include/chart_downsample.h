@@ -0,0 +1,77 @@
+#ifndef CHART_DOWNSAMPLE_H
+#define CHART_DOWNSAMPLE_H
+
+#include "utils.h"
+#include "chart_data.h"
+#include "candle_history.h"
+
+// A range the chart can be zoomed out to, at 10 seconds per candle
+struct ChartZoomLevel
+{
+    size_t candles;
+    const char *label;
+};
+
+// The first level is the live in-memory window; the others are read from the
+// recorded history
+const ChartZoomLevel CHART_ZOOM_LEVELS[] = {
+    {CHART_VISIBLE_CANDLES, "50 candles"},
+    {360, "1 hour"},
+    {2160, "6 hours"},
+    {8640, "1 day"},
+    {60480, "1 week"},
+    {259200, "30 days"},
+};
+const size_t CHART_ZOOM_LEVEL_COUNT = sizeof(CHART_ZOOM_LEVELS) / sizeof(CHART_ZOOM_LEVELS[0]);
+
+// Entries in a gnuplot frame: the width of its default 640x480 window. A
+// candle narrower than a pixel is never seen, so longer ranges are reduced.
+const size_t GNUPLOT_CHART_PIXELS = 640;
+
+// Reads chart windows of any range from a symbol's recorded history through
+// a memory-mapped range query, so zooming out over months of candles never
+// touches candlesMap. Indicators are computed over the range at full
+// resolution with the batch kernels, then everything is downsampled to the
+// width being drawn. Buffers are reused from window to window.
+class ChartHistoryReader
+{
+public:
+    explicit ChartHistoryReader(const std::string &symbol) : symbol(symbol) {}
+
+    // Map the history, or remap it once candles have been recorded; returns
+    // true if the candles changed
+    bool refresh();
+    size_t size() const { return history.size(); }
+
+    // The newest `range` candles as at most `width` entries. Buckets start at
+    // multiples of the stride in the history, so as candles arrive only the
+    // newest bucket changes. Returns false if nothing has been recorded.
+    bool window(size_t range, size_t width, ChartWindow &window);
+
+private:
+    std::string symbol;
+    CandleHistory history;
+    std::vector<double> closes;
+    std::vector<double> movingAverage;
+    std::vector<double> bollingerMiddle;
+    std::vector<double> bollingerUpper;
+    std::vector<double> bollingerLower;
+    std::vector<double> rsi;
+};
+
+// Function declarations
+// OHLC-preserving buckets of `stride` candles: the first open, highest high,
+// lowest low and last close; the last bucket may be partial
+void bucketCandles(const Candle *candles, size_t count, size_t stride, std::vector<Candle> &out);
+
+// Largest-Triangle-Three-Buckets over the same buckets: the value of each
+// bucket's point that forms the largest triangle with the point kept for the
+// bucket before and the average of the bucket after, which keeps a line's
+// peaks and troughs. The first and last points are always kept. Values
+// before `from` are warm-up; their buckets are 0 and they are never picked.
+void lttbBuckets(const double *values, size_t count, size_t stride, size_t from, std::vector<double> &out);
+
+// Zoom level after stepping in (towards the live window) or out
+size_t zoomChart(size_t level, bool zoomOut);
+
+#endif // CHART_DOWNSAMPLE_H
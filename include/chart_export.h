@@ -0,0 +1,54 @@
+#ifndef CHART_EXPORT_H
+#define CHART_EXPORT_H
+
+#include "utils.h"
+#include "chart_data.h"
+#include "work_stealing_pool.h"
+
+// Image formats a chart can be exported in, as bits
+enum ChartImageFormat : unsigned
+{
+    CHART_SVG = 1u << 0,
+    CHART_PNG = 1u << 1,
+};
+
+struct ChartImageSize
+{
+    int width = 1200;
+    int height = 720;
+};
+
+// What an export draws and where it writes it
+struct ChartExportSettings
+{
+    unsigned formats = CHART_SVG;
+    ChartImageSize size;
+    size_t candles = 120; // Newest candles per chart, downsampled to the plot's pixel width
+    std::string outputDirectory = "data/charts";
+};
+
+struct ChartExportSummary
+{
+    size_t charts = 0; // Symbols drawn
+    size_t files = 0;
+    size_t bytes = 0;
+    std::vector<std::string> failed; // No stored candles, or a file could not be written
+};
+
+// Function declarations
+// The chart as an SVG document: candlesticks, moving average and Bollinger
+// Bands over an RSI pane, laid out like the gnuplot chart
+void appendSvgChart(const ChartWindow &window, const std::string &symbol, const ChartImageSize &size, std::string &svg);
+
+// The same chart rasterised into pixels (reused from chart to chart) and
+// encoded as a PNG, with no image library or gnuplot
+void appendPngChart(const ChartWindow &window, const std::string &symbol, const ChartImageSize &size,
+                    std::vector<uint8_t> &pixels, std::string &png);
+
+// Draw every symbol's stored history to <outputDirectory>/<symbol>.svg/.png,
+// spread over the pool. Each symbol's candles are memory-mapped and only the
+// drawn range and its indicator warm-up are read.
+ChartExportSummary exportCharts(const std::vector<std::string> &symbols, const ChartExportSettings &settings,
+                                WorkStealingPool &pool, TaskPriority priority = TaskPriority::Bulk);
+
+#endif // CHART_EXPORT_H
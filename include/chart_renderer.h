@@ -0,0 +1,65 @@
+#ifndef CHART_RENDERER_H
+#define CHART_RENDERER_H
+
+#include "utils.h"
+#include "chart_data.h"
+#include "event_loop.h"
+
+// What a chart frame shows that can change between frames: the number of
+// closed candles and the current price label, to the paisa. Frames are only
+// rendered when this changes.
+struct ChartStamp
+{
+    size_t candles = 0;
+    long long pricePaise = -1;
+
+    bool operator==(const ChartStamp &other) const { return candles == other.candles && pricePaise == other.pricePaise; }
+    bool operator!=(const ChartStamp &other) const { return !(*this == other); }
+};
+
+// Owns the gnuplot pipe for one symbol's chart and writes frames to it from
+// an event loop. The pipe does not block: post() writes what the pipe takes
+// and the loop writes the rest whenever it is writable. A frame posted while
+// an earlier one is still going out waits in a one-slot mailbox, and a newer
+// post replaces it, so a slow gnuplot drops frames rather than stalling the
+// loop. post() is called on the loop's thread.
+class ChartRenderer
+{
+public:
+    ChartRenderer(const std::string &symbol, const char *command, EventLoop &loop);
+    ~ChartRenderer(); // Writes out any frame still waiting, then closes the pipe
+    ChartRenderer(const ChartRenderer &) = delete;
+    ChartRenderer &operator=(const ChartRenderer &) = delete;
+
+    bool isOpen() const { return pipe != nullptr; } // False once gnuplot has gone
+
+    // Swaps window into the mailbox; window comes back holding old storage to reuse
+    void post(ChartWindow &window);
+
+    size_t framesRendered() const { return rendered; }
+    size_t framesDropped() const { return dropped; }
+
+private:
+    void startFrame(); // Format the mailbox's frame into the write buffer
+    void writeSome();  // Write until the pipe is full or nothing is left
+
+    std::string symbol;
+    FILE *pipe = nullptr;
+    EventLoop &loop;
+    ChartWindow pending;
+    bool hasPending = false;
+    std::string buffer; // Frame going out, from `written` on
+    size_t written = 0;
+    bool waitingForPipe = false; // Watching the pipe for writable
+    size_t rendered = 0;
+    size_t dropped = 0;
+};
+
+// Function declarations
+// Current stamp for symbol; callers hold the symbol's seriesLock
+ChartStamp currentChartStamp(const std::string &symbol);
+
+// Append one full frame for window: its datablocks, then the multiplot commands
+void appendGnuplotFrame(const ChartWindow &window, const std::string &symbol, std::string &buffer);
+
+#endif // CHART_RENDERER_H
@@ -0,0 +1,33 @@
+#ifndef CLIENT_MODE_H
+#define CLIENT_MODE_H
+
+#include "utils.h"
+
+// Options for the command-line client and the load generator
+struct ClientOptions
+{
+    std::string socketPath;
+    uint16_t port = 0;
+    std::vector<std::string> symbols; // Subscribed to; empty for every symbol
+    std::string ordersPath;           // Order script (script mode's format) to send, or "-" for stdin
+    size_t batch = 64;                // Orders per message
+};
+
+struct LoadOptions
+{
+    std::string socketPath;
+    uint16_t port = 0;
+    size_t subscribers = 1000;
+    double seconds = 10.0;
+    double orderRate = 0.0; // Orders per second over one extra connection; 0 for none
+    size_t batch = 64;      // Orders per message
+    std::string symbol = "TECHSOL";
+};
+
+// Function declarations
+bool parseClientOptions(int argc, char *argv[], ClientOptions &options);
+bool parseLoadOptions(int argc, char *argv[], LoadOptions &options);
+int runClientMode(const ClientOptions &options);
+int runLoadGenerator(const LoadOptions &options);
+
+#endif // CLIENT_MODE_H
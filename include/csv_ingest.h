@@ -0,0 +1,59 @@
+#ifndef CSV_INGEST_H
+#define CSV_INGEST_H
+
+#include "utils.h"
+#include "work_stealing_pool.h"
+
+// Which rows of a CSV become candles, and under which names they are stored
+struct CsvIngestSettings
+{
+    std::string series = "EQ";                    // Bhavcopy series to keep; empty keeps every series
+    std::string symbol;                           // For files with no symbol column
+    std::vector<std::string> symbols;             // Source symbols to keep; empty keeps all
+    std::map<std::string, std::string> renames;   // Source symbol -> stored symbol, e.g. RELIANCE -> RELYCORP
+    bool writeHistory = false;                    // Also replace <SYMBOL>/candles_history.dat
+};
+
+// One symbol's candles, oldest first
+struct IngestedSeries
+{
+    std::string symbol; // As stored
+    std::vector<Candle> candles;
+    int firstDate = 0; // YYYYMMDD, or 0 for files without dates
+    int lastDate = 0;
+};
+
+struct CsvIngestSummary
+{
+    size_t files = 0;
+    size_t bytes = 0;
+    size_t rows = 0;       // Data rows read
+    size_t candles = 0;    // Rows stored
+    size_t skipped = 0;    // Malformed rows
+    size_t filtered = 0;   // Rows of another series or an unselected symbol
+    size_t duplicates = 0; // Rows for a date a later row replaced
+    double parseSeconds = 0.0;
+    double writeSeconds = 0.0;
+    std::vector<IngestedSeries> series; // Sorted by symbol
+    std::vector<std::string> errors;    // Files that could not be read, series that could not be written
+};
+
+// Function declarations
+// Parse CSV text into candles per symbol. Columns are found by header name,
+// so NSE bhavcopies (SYMBOL, SERIES, OPEN, HIGH, LOW, CLOSE, TIMESTAMP), the
+// newer UDiFF bhavcopies (TckrSymb, SctySrs, OpnPric, ... TradDt) and
+// one-symbol Date,Open,High,Low,Close exports all load. The text is split at
+// line boundaries into chunks parsed in parallel on the pool; each symbol's
+// rows are then ordered by date, keeping the last row for a repeated date.
+// Returns false, with error set, if the header has no usable columns.
+bool parseCsvCandles(const char *data, size_t size, const CsvIngestSettings &settings, WorkStealingPool &pool,
+                     CsvIngestSummary &summary, std::string &error, TaskPriority priority = TaskPriority::Bulk);
+
+// Memory-map and parse each file (every *.csv in a directory), then write
+// each symbol's candles as data/stock_data/<SYMBOL>_candles.dat and
+// _closePrices.dat, the snapshot format loadStockData reads, one pool task
+// per symbol. Existing files for those symbols are replaced.
+CsvIngestSummary ingestCsvFiles(const std::vector<std::string> &paths, const CsvIngestSettings &settings,
+                                WorkStealingPool &pool, TaskPriority priority = TaskPriority::Bulk);
+
+#endif // CSV_INGEST_H
@@ -2,6 +2,8 @@
 #define DATA_MANAGEMENT_H
 
 #include "utils.h"
+#include "order_store.h"
+#include "holdings.h"
 
 
 struct User
@@ -13,24 +15,13 @@ struct User
     double initialDemoMoney;
     std::vector<std::tuple<std::string, double, double, std::string, double>> transactions; // symbol, amount, price, type, brokerFee
 
-    // Structure to represent a holding
-    struct Holding
-    {
-        std::string symbol;
-        double amount;
-        double averagePrice;
-    };
-    std::vector<Holding> holdings; // Track holdings
+    // Track holdings, keyed by symbol ID
+    using Holding = ::Holding;
+    HoldingsMap holdings;
 
-    // Structure for pending limit orders
-    struct Order
-    {
-        std::string symbol;
-        std::string type; // "Limit_Buy" or "Limit_Sell"
-        double amount;
-        double limitPrice;
-    };
-    std::vector<Order> pendingOrders; // Pending limit orders
+    // Pending limit orders, indexed by order ID
+    using Order = ::Order;
+    OrderStore pendingOrders;
 
     void saveUserData();
     bool loadUserData();
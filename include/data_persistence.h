@@ -4,9 +4,10 @@
 #include "utils.h"
 
 // Declaration of external variables
+// Keys are all added before the simulations start; each symbol's entries
+// are guarded by its seriesLock (market_data.h)
 extern std::map<std::string, std::vector<double>> closePricesMap;
 extern std::map<std::string, std::vector<Candle>> candlesMap;
-extern std::map<std::string, std::atomic<bool>> stopFlags;
 
 // Function declarations
 void saveStockData(const std::map<std::string, std::vector<double>> &closePricesMap, const std::map<std::string, std::vector<Candle>> &candlesMap);
@@ -0,0 +1,85 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "utils.h"
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+
+// Single-threaded event loop: file descriptors, periodic timers and tasks
+// posted from other threads, all handled on the thread that calls run().
+// On Linux everything is one epoll set: timers are timerfds, which the
+// kernel re-arms a whole period after the last deadline, so ticks never
+// drift however long a handler runs; post() and stop() wake the loop
+// through an eventfd, so stopping takes effect at once rather than at the
+// next tick. Elsewhere timers and tasks are kept on a condition variable
+// and file descriptors cannot be watched.
+class EventLoop
+{
+public:
+    using Handler = std::function<void()>;
+    using TimerHandler = std::function<void(uint64_t ticks)>; // Periods elapsed since the last call; above 1 if late
+
+    EventLoop();
+    ~EventLoop(); // Tasks still queued are dropped
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+#ifndef _WIN32
+    // Call handler whenever fd is readable, at end of file, or has failed
+    void watchReadable(int fd, Handler handler);
+    // Call handler whenever fd can take more data; unwatch it once nothing is left to write
+    void watchWritable(int fd, Handler handler);
+    void unwatch(int fd);
+#endif
+
+    // Call handler every period, the first time one period from now; returns the timer's ID
+    int addTimer(std::chrono::nanoseconds period, TimerHandler handler);
+    void removeTimer(int id);
+
+    // Run task on the loop's thread; safe from any thread
+    void post(Handler task);
+
+    // Handle events until stop(). Safe to call again after it returns.
+    void run();
+    // End the current run(), or the next one if none is running; safe from
+    // any thread and from handlers
+    void stop();
+
+private:
+    void runTasks();
+
+#ifndef _WIN32
+    struct Watch
+    {
+        Handler readable;
+        Handler writable;
+    };
+
+    void updateWatch(int fd, const Watch &watch, bool added);
+    void dispatch(int fd, uint32_t events);
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::unordered_map<int, Watch> watches;
+    std::unordered_map<int, TimerHandler> timers; // By timerfd, which is also the timer's ID
+#else
+    struct Timer
+    {
+        std::chrono::steady_clock::duration period;
+        std::chrono::steady_clock::time_point deadline;
+        TimerHandler handler;
+    };
+
+    std::condition_variable woken;
+    std::unordered_map<int, Timer> timers;
+    int nextTimerId = 1;
+#endif
+
+    std::mutex taskLock;
+    std::vector<Handler> tasks;
+    std::vector<Handler> running; // Tasks being run, swapped out of `tasks`
+    std::atomic<bool> stopping{false};
+};
+
+#endif // EVENT_LOOP_H
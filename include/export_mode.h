@@ -0,0 +1,19 @@
+#ifndef EXPORT_MODE_H
+#define EXPORT_MODE_H
+
+#include "utils.h"
+#include "chart_export.h"
+
+// Options for drawing chart images from stored candles
+struct ExportOptions
+{
+    std::vector<std::string> symbols; // Empty for every symbol with stored candles
+    ChartExportSettings settings;
+    unsigned threads = 0; // 0 = the shared pool, one worker per hardware thread
+};
+
+// Function declarations
+bool parseExportOptions(int argc, char *argv[], ExportOptions &options);
+int runExportMode(const ExportOptions &options);
+
+#endif // EXPORT_MODE_H
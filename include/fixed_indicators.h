@@ -0,0 +1,185 @@
+#ifndef FIXED_INDICATORS_H
+#define FIXED_INDICATORS_H
+
+#include "utils.h"
+#include "indicators.h"
+#include <array>
+#include <type_traits>
+
+// Indicators with the period as a template argument. The window is a
+// std::array sized at compile time and every period-dependent constant folds,
+// so wrap-around and re-sum loops can be unrolled. Same interface as the
+// runtime-period versions in indicators.h; SMA and EMA do the same arithmetic
+// and match them exactly.
+
+template <int Period>
+class FixedSma
+{
+    static_assert(Period > 0, "period must be positive");
+
+public:
+    double update(double value)
+    {
+        sum += value - window[next];
+        window[next] = value;
+        if (++next == Period)
+        {
+            next = 0;
+            sum = 0.0;
+            for (double v : window)
+                sum += v;
+        }
+        if (count < Period)
+            ++count;
+        return this->value();
+    }
+    bool ready() const { return count == Period; }
+    double value() const { return ready() ? sum / Period : 0.0; }
+    static constexpr int period() { return Period; }
+    void reset() { *this = FixedSma(); }
+
+private:
+    std::array<double, Period> window{};
+    size_t next = 0;
+    size_t count = 0;
+    double sum = 0.0;
+};
+
+template <int Period>
+class FixedEma
+{
+    static_assert(Period > 0, "period must be positive");
+
+public:
+    double update(double value)
+    {
+        ++count;
+        if (count < Period)
+            average += value;
+        else if (count == Period)
+            average = (average + value) / Period;
+        else
+            average += ALPHA * (value - average);
+        return this->value();
+    }
+    bool ready() const { return count >= Period; }
+    double value() const { return ready() ? average : 0.0; }
+    static constexpr int period() { return Period; }
+    void reset() { *this = FixedEma(); }
+
+private:
+    static constexpr double ALPHA = 2.0 / (Period + 1);
+    size_t count = 0;
+    double average = 0.0;
+};
+
+// Wilder's smoothing multiplies by the constants (Period - 1) / Period and
+// 1 / Period instead of dividing by Period, which takes the division off the
+// chain from one candle to the next. Values differ from StreamingRsi only in
+// the last bits.
+template <int Period>
+class FixedRsi
+{
+    static_assert(Period > 0, "period must be positive");
+
+public:
+    double update(double close)
+    {
+        if (changes > 0)
+        {
+            double change = close - previousClose;
+            // Branch-free split; a branch on the sign mispredicts on half the candles
+            double magnitude = std::fabs(change);
+            double gain = 0.5 * (magnitude + change);
+            double loss = 0.5 * (magnitude - change);
+            if (changes <= Period)
+            {
+                averageGain += gain * WEIGHT;
+                averageLoss += loss * WEIGHT;
+            }
+            else
+            {
+                averageGain = averageGain * DECAY + gain * WEIGHT;
+                averageLoss = averageLoss * DECAY + loss * WEIGHT;
+            }
+        }
+        previousClose = close;
+        ++changes;
+        return value();
+    }
+    bool ready() const { return changes > Period; }
+    double value() const
+    {
+        if (!ready() || averageGain + averageLoss <= 0.0)
+            return 50.0;
+        return 100.0 * averageGain / (averageGain + averageLoss);
+    }
+    static constexpr int period() { return Period; }
+    void reset() { *this = FixedRsi(); }
+
+private:
+    static constexpr double WEIGHT = 1.0 / Period;
+    static constexpr double DECAY = (Period - 1.0) / Period;
+    size_t changes = 0;
+    double previousClose = 0.0;
+    double averageGain = 0.0;
+    double averageLoss = 0.0;
+};
+
+// Periods instantiated ahead of time; others fall back to the runtime-period indicators
+constexpr int FIXED_PERIODS[] = {5, 9, 14, 20, 50, 200};
+
+// Calls kernel(std::integral_constant<int, P>()) when period is one of
+// FIXED_PERIODS and returns true; returns false for any other period
+template <typename Kernel>
+bool dispatchFixedPeriod(int period, Kernel &&kernel)
+{
+    switch (period)
+    {
+    case 5:
+        kernel(std::integral_constant<int, 5>());
+        return true;
+    case 9:
+        kernel(std::integral_constant<int, 9>());
+        return true;
+    case 14:
+        kernel(std::integral_constant<int, 14>());
+        return true;
+    case 20:
+        kernel(std::integral_constant<int, 20>());
+        return true;
+    case 50:
+        kernel(std::integral_constant<int, 50>());
+        return true;
+    case 200:
+        kernel(std::integral_constant<int, 200>());
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Feeds every close through indicator; works with fixed and runtime-period
+// indicators alike. The loop runs on a local copy so the state can stay in
+// registers instead of being stored and reloaded through the reference.
+template <typename Indicator>
+void closeSeries(Indicator &indicator, const Candle *candles, size_t count, double *out)
+{
+    Indicator local = indicator;
+    for (size_t i = 0; i < count; ++i)
+        out[i] = local.update(candles[i].close);
+    indicator = std::move(local);
+}
+
+// Function declarations
+// Whole-history series over closes, specialised for FIXED_PERIODS
+void smaSeries(const Candle *candles, size_t count, int period, double *out);
+void emaSeries(const Candle *candles, size_t count, int period, double *out);
+void rsiSeries(const Candle *candles, size_t count, int period, double *out);
+
+// The same series with the runtime-period indicators, whatever the period
+void genericSmaSeries(const Candle *candles, size_t count, int period, double *out);
+void genericEmaSeries(const Candle *candles, size_t count, int period, double *out);
+void genericRsiSeries(const Candle *candles, size_t count, int period, double *out);
+
+#endif // FIXED_INDICATORS_H
@@ -0,0 +1,88 @@
+#ifndef HOLDINGS_H
+#define HOLDINGS_H
+
+#include "utils.h"
+#include "symbol_registry.h"
+
+// Structure to represent a holding
+struct Holding
+{
+    SymbolId symbolId;
+    std::string symbol;
+    double amount;
+    double averagePrice;
+    double markPrice; // Latest price the holding was valued at
+};
+
+// Open-addressing (linear probing) map of holdings keyed by symbol ID.
+// Portfolio aggregates are maintained incrementally on every fill and price
+// mark, so totals are O(1) to query instead of a scan over all holdings.
+class HoldingsMap
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const HoldingsMap *map, size_t slot) : map(map), slot(slot) { skipEmpty(); }
+        const Holding &operator*() const { return map->slots[slot]; }
+        const Holding *operator->() const { return &map->slots[slot]; }
+        const_iterator &operator++()
+        {
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return slot == other.slot; }
+        bool operator!=(const const_iterator &other) const { return slot != other.slot; }
+
+    private:
+        void skipEmpty()
+        {
+            while (slot < map->slots.size() && map->slots[slot].symbolId == INVALID_SYMBOL_ID)
+                ++slot;
+        }
+        const HoldingsMap *map;
+        size_t slot;
+    };
+
+    const Holding *find(SymbolId id) const;
+
+    // Add to a position at the given price, updating the average price
+    void buy(SymbolId id, double amount, double price);
+
+    // Reduce a position at the given price; returns the realized profit/loss.
+    // The holding is removed once its amount reaches zero.
+    double sell(SymbolId id, double amount, double price);
+
+    // Re-value a holding at the latest market price (no-op if not held)
+    void markPrice(SymbolId id, double price);
+
+    // Insert a holding as loaded from disk
+    void restore(SymbolId id, double amount, double averagePrice);
+    void clear();
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    double totalInvestment() const { return costBasis; }
+    double currentValue() const { return marketValue; }
+    double unrealizedPnL() const { return marketValue - costBasis; }
+    double realizedPnL() const { return realized; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots.size()); }
+
+private:
+    size_t slotFor(SymbolId id) const;   // Slot holding id, or the empty slot where it would go
+    Holding &insert(SymbolId id);        // Insert an empty position for id
+    void erase(size_t slot);             // Backward-shift deletion, no tombstones
+    void grow();
+
+    std::vector<Holding> slots;
+    size_t count = 0;
+    double costBasis = 0.0;   // Sum of amount * averagePrice
+    double marketValue = 0.0; // Sum of amount * markPrice
+    double realized = 0.0;    // Realized profit/loss since login
+};
+
+#endif // HOLDINGS_H
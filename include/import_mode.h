@@ -0,0 +1,19 @@
+#ifndef IMPORT_MODE_H
+#define IMPORT_MODE_H
+
+#include "utils.h"
+#include "csv_ingest.h"
+
+// Options for loading historical OHLC CSVs into the candle store
+struct ImportOptions
+{
+    std::vector<std::string> paths; // Files, or directories of *.csv files
+    CsvIngestSettings settings;
+    unsigned threads = 0; // 0 = the shared pool, one worker per hardware thread
+};
+
+// Function declarations
+bool parseImportOptions(int argc, char *argv[], ImportOptions &options);
+int runImportMode(const ImportOptions &options);
+
+#endif // IMPORT_MODE_H
@@ -0,0 +1,46 @@
+#ifndef INDICATOR_BATCH_H
+#define INDICATOR_BATCH_H
+
+#include "utils.h"
+
+// Structure-of-arrays copy of a candle history, so batch kernels stream
+// through one field at a time in contiguous, vector-friendly memory
+struct CandleColumns
+{
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> volume; // Empty: candles do not carry volume yet
+
+    CandleColumns() = default;
+    CandleColumns(const Candle *candles, size_t count);
+    size_t size() const { return close.size(); }
+};
+
+// Batch kernels use AVX2 when the CPU has it (detected at run time, GCC and
+// Clang on x86 only) and scalar loops otherwise. Turning SIMD off is for
+// comparing the two.
+bool batchSimdAvailable();
+bool batchSimdEnabled();
+void setBatchSimdEnabled(bool enabled);
+
+// Whole-history indicators over columns. Every output holds count values and
+// follows the streaming indicators in indicators.h: 0 before an average is
+// ready, 50 before an oscillator is. Windowed sums come from short runs of
+// prefix sums, each shifted by its first value, which keeps their magnitude
+// (and rounding) small; recurrences (EMA, Wilder smoothing) stay scalar, with
+// the per-value work around them vectorised.
+void smaBatch(const double *values, size_t count, int period, double *out);
+void emaBatch(const double *values, size_t count, int period, double *out);
+void rsiBatch(const double *close, size_t count, int period, double *out);
+void macdBatch(const double *close, size_t count, int fastPeriod, int slowPeriod, int signalPeriod,
+               double *macd, double *signal, double *histogram);
+void bollingerBatch(const double *close, size_t count, int period, double width,
+                    double *middle, double *upper, double *lower);
+void atrBatch(const double *high, const double *low, const double *close, size_t count, int period, double *out);
+void stochasticBatch(const double *high, const double *low, const double *close, size_t count,
+                     int kPeriod, int dPeriod, double *k, double *d);
+void vwapBatch(const double *high, const double *low, const double *close, const double *volume, size_t count, double *out);
+
+#endif // INDICATOR_BATCH_H
@@ -0,0 +1,240 @@
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include "utils.h"
+#include <deque>
+
+// Simple moving average over a fixed window, updated in O(1) per value.
+// The running sum is re-added from the window once per pass over it, so
+// rounding error cannot build up over a long history.
+class StreamingSma
+{
+public:
+    explicit StreamingSma(int period);
+
+    double update(double value); // Returns the new average (0 until the window is full)
+    bool ready() const { return count == window.size(); }
+    double value() const { return ready() ? sum / window.size() : 0.0; }
+    int period() const { return static_cast<int>(window.size()); }
+    void reset();
+
+private:
+    std::vector<double> window;
+    size_t next = 0;
+    size_t count = 0;
+    double sum = 0.0;
+};
+
+// Relative Strength Index with Wilder's smoothing: the first average gain
+// and loss are plain means over period changes, after which each new change
+// is blended in with weight 1/period. O(1) per value.
+class StreamingRsi
+{
+public:
+    explicit StreamingRsi(int period);
+
+    double update(double close); // Returns the new RSI (50 until period changes are seen)
+    bool ready() const { return changes > static_cast<size_t>(rsiPeriod); }
+    double value() const;
+    int period() const { return rsiPeriod; }
+    void reset();
+
+private:
+    int rsiPeriod;
+    size_t changes = 0; // Closes seen, counting the first one that has no change
+    double previousClose = 0.0;
+    double averageGain = 0.0;
+    double averageLoss = 0.0;
+};
+
+// Exponential moving average, seeded with the simple average of the first
+// period values; alpha = 2 / (period + 1)
+class StreamingEma
+{
+public:
+    explicit StreamingEma(int period);
+
+    double update(double value); // Returns the new average (0 until period values are seen)
+    bool ready() const { return count >= static_cast<size_t>(emaPeriod); }
+    double value() const { return ready() ? average : 0.0; }
+    int period() const { return emaPeriod; }
+    void reset();
+
+private:
+    int emaPeriod;
+    double alpha;
+    size_t count = 0;
+    double average = 0.0; // Running sum until ready
+};
+
+// MACD: fast EMA minus slow EMA, its signal-line EMA, and the histogram between them
+class StreamingMacd
+{
+public:
+    StreamingMacd(int fastPeriod = 12, int slowPeriod = 26, int signalPeriod = 9);
+
+    void update(double close);
+    bool ready() const { return signalEma.ready(); }
+    double macd() const { return macdValue; }
+    double signal() const { return signalEma.value(); }
+    double histogram() const { return ready() ? macdValue - signalEma.value() : 0.0; }
+    void reset();
+
+private:
+    StreamingEma fastEma;
+    StreamingEma slowEma;
+    StreamingEma signalEma;
+    double macdValue = 0.0;
+};
+
+// Bollinger Bands: the simple average of the window and width standard
+// deviations (population) either side of it
+class StreamingBollinger
+{
+public:
+    explicit StreamingBollinger(int period = 20, double width = 2.0);
+
+    void update(double close);
+    bool ready() const { return count == window.size(); }
+    double middle() const { return ready() ? mean : 0.0; }
+    double upper() const { return ready() ? mean + width * deviation : 0.0; }
+    double lower() const { return ready() ? mean - width * deviation : 0.0; }
+    double standardDeviation() const { return deviation; }
+    int period() const { return static_cast<int>(window.size()); }
+    void reset();
+
+private:
+    std::vector<double> window;
+    double width;
+    size_t next = 0;
+    size_t count = 0;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    double mean = 0.0;
+    double deviation = 0.0;
+};
+
+// Average True Range with Wilder's smoothing
+class StreamingAtr
+{
+public:
+    explicit StreamingAtr(int period = 14);
+
+    double update(const Candle &candle); // Returns the new ATR (0 until period ranges are seen)
+    bool ready() const { return count >= static_cast<size_t>(atrPeriod); }
+    double value() const { return ready() ? average : 0.0; }
+    void reset();
+
+private:
+    int atrPeriod;
+    size_t count = 0;
+    double previousClose = 0.0;
+    double average = 0.0;
+};
+
+// Stochastic oscillator: %K places the close within the high-low range of
+// the last kPeriod candles, %D is the simple average of the last dPeriod %K.
+// Monotonic queues keep the window's high and low in amortised O(1).
+class StreamingStochastic
+{
+public:
+    explicit StreamingStochastic(int kPeriod = 14, int dPeriod = 3);
+
+    void update(const Candle &candle);
+    bool ready() const { return seen >= static_cast<size_t>(kPeriod); }
+    double k() const { return ready() ? kValue : 50.0; }
+    double d() const { return dSma.ready() ? dSma.value() : 50.0; }
+    void reset();
+
+private:
+    int kPeriod;
+    size_t seen = 0;
+    std::deque<std::pair<size_t, double>> highs; // Decreasing: front is the window high
+    std::deque<std::pair<size_t, double>> lows;  // Increasing: front is the window low
+    double kValue = 50.0;
+    StreamingSma dSma;
+};
+
+// Volume-weighted average price since the last reset, on the typical price
+// (high + low + close) / 3. Candles carry no volume yet, so it is passed in.
+class StreamingVwap
+{
+public:
+    double update(const Candle &candle, double volume);
+    bool ready() const { return totalVolume > 0.0; }
+    double value() const { return ready() ? priceVolume / totalVolume : 0.0; }
+    void reset();
+
+private:
+    double priceVolume = 0.0;
+    double totalVolume = 0.0;
+};
+
+// Latest value of every indicator for one symbol
+struct IndicatorSnapshot
+{
+    double close = 0.0;
+    double previousClose = 0.0;
+    double movingAverage = 0.0;
+    double previousMovingAverage = 0.0;
+    double rsi = 50.0;
+    double ema = 0.0;
+    double macd = 0.0;
+    double macdSignal = 0.0;
+    double bollingerUpper = 0.0;
+    double bollingerLower = 0.0;
+    double atr = 0.0;
+    double stochasticK = 50.0;
+    double stochasticD = 50.0;
+};
+
+// Indicator series for one symbol's candles, extended as candles close.
+// sync() only feeds candles added since the last call, so keeping the chart
+// indicators current costs O(1) per closed candle instead of a full re-scan.
+class SymbolIndicators
+{
+public:
+    SymbolIndicators(int maPeriod, int rsiPeriod);
+
+    // Catch up with candles; starts over if the history was replaced by a shorter one
+    void sync(const std::vector<Candle> &candles);
+
+    // Chart series, one value per candle
+    const std::vector<double> &movingAverage() const { return maValues; }
+    const std::vector<double> &rsi() const { return rsiValues; }
+    const std::vector<double> &bollingerUpper() const { return upperValues; }
+    const std::vector<double> &bollingerLower() const { return lowerValues; }
+
+    const IndicatorSnapshot &latest() const { return snapshot; }
+    size_t size() const { return processed; }
+
+private:
+    StreamingSma sma;
+    StreamingRsi rsiState;
+    StreamingEma ema;
+    StreamingMacd macd;
+    StreamingBollinger bollinger;
+    StreamingAtr atr;
+    StreamingStochastic stochastic;
+    std::vector<double> maValues;
+    std::vector<double> rsiValues;
+    std::vector<double> upperValues;
+    std::vector<double> lowerValues;
+    IndicatorSnapshot snapshot;
+    size_t processed = 0;
+};
+
+// Whole-history series for backfill, with the fixed-period kernels where they exist
+std::vector<double> movingAverageSeries(const std::vector<Candle> &candles, int period);
+std::vector<double> rsiSeries(const std::vector<Candle> &candles, int period);
+
+// Chart indicator periods
+const int CHART_MA_PERIOD = 5;
+const int CHART_RSI_PERIOD = 14;
+const int CHART_EMA_PERIOD = 20;
+const int CHART_BOLLINGER_PERIOD = 20;
+
+// Per-symbol chart indicators; each entry is guarded by its symbol's seriesLock like candlesMap
+extern std::map<std::string, SymbolIndicators> indicatorsMap;
+
+#endif // INDICATORS_H
@@ -0,0 +1,47 @@
+#ifndef LINE_EDITOR_H
+#define LINE_EDITOR_H
+
+#include "utils.h"
+
+// Terminal input for an event loop. The terminal is put in raw mode for the
+// editor's lifetime: keys arrive as they are pressed, without blocking, and
+// are echoed here after the current prompt. Backspace, Ctrl-U (erase line)
+// and Ctrl-W (erase word) edit the line; other escape sequences, like the
+// arrow keys, are ignored. A finished line is split into whitespace-separated
+// tokens, as std::cin >> would read them. Piped input is read the same way,
+// without raw mode or echo.
+class LineEditor
+{
+public:
+    LineEditor();
+    ~LineEditor(); // Restores the terminal
+    LineEditor(const LineEditor &) = delete;
+    LineEditor &operator=(const LineEditor &) = delete;
+
+#ifndef _WIN32
+    int fd() const { return STDIN_FILENO; } // Watch this for readable
+#endif
+
+    // Show text at (column, row), then the line typed so far, with the cursor after it
+    void prompt(int column, int row, const std::string &text);
+    // Show the prompt and the line typed so far again, e.g. once a message has been written
+    void redraw();
+
+    // Take whatever has been typed, without blocking; tokens of finished
+    // lines are appended to tokens. Returns false at end of input.
+    bool read(std::vector<std::string> &tokens);
+
+private:
+    void key(char c, std::vector<std::string> &tokens);
+    void erase(size_t count); // The last count characters of the line
+    void echo(const std::string &text);
+
+    std::string line;
+    int promptColumn = 1;
+    int promptRow = 1;
+    std::string promptText;
+    bool raw = false;
+    int escape = 0; // 1 after ESC, 2 inside a control sequence
+};
+
+#endif // LINE_EDITOR_H
@@ -0,0 +1,212 @@
+#ifndef MARKET_BUS_H
+#define MARKET_BUS_H
+
+#include "utils.h"
+#include "ring_buffer.h"
+#include "symbol_registry.h"
+#include <functional>
+#include <memory>
+
+// A price tick or a closed candle of one symbol
+struct MarketEvent
+{
+    enum Type : uint32_t
+    {
+        Tick,
+        CandleClose
+    };
+
+    Type type = Tick;
+    SymbolId symbolId = INVALID_SYMBOL_ID;
+    double price = 0.0; // The tick, or the candle's close
+    Candle candle{};    // CandleClose only
+};
+
+// Single-producer, multi-consumer broadcast ring of market events
+// (Disruptor-style). The producer writes events into slots and commits a
+// batch by moving one cursor; every consumer keeps its own cursor and reads
+// at its own pace, with no lock on either side. The producer never waits
+// for consumers: a consumer that falls a whole ring behind finds its slots
+// overwritten, counts what it missed and carries on from newer events.
+// Each slot carries the sequence of the event in it, checked before and
+// after a read, so an event overwritten mid-read is never handed out.
+class MarketBus
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit MarketBus(size_t requestedCapacity);
+    MarketBus(const MarketBus &) = delete;
+    MarketBus &operator=(const MarketBus &) = delete;
+
+    // Producer: write an event; consumers see it once it is committed
+    void publish(const MarketEvent &event)
+    {
+        Slot &slot = slots[next & mask];
+        slot.stamp.store(0, std::memory_order_relaxed); // Stamps are sequence + 1, so 0 is "being written"
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.header.store((static_cast<uint64_t>(event.type) << 32) | event.symbolId, std::memory_order_relaxed);
+        if (event.type == MarketEvent::Tick)
+        {
+            slot.values[0].store(event.price, std::memory_order_relaxed);
+        }
+        else
+        {
+            slot.values[0].store(event.candle.open, std::memory_order_relaxed);
+            slot.values[1].store(event.candle.high, std::memory_order_relaxed);
+            slot.values[2].store(event.candle.low, std::memory_order_relaxed);
+            slot.values[3].store(event.candle.close, std::memory_order_relaxed);
+        }
+        slot.stamp.store(next + 1, std::memory_order_release);
+        ++next;
+    }
+
+    // Producer: make every event published so far visible, and wake consumers waiting for them
+    void commit();
+
+    // Events committed so far
+    uint64_t cursor() const { return committed.load(std::memory_order_acquire); }
+    size_t capacity() const { return mask + 1; }
+
+    // Copy out event `sequence`; false if it has been overwritten
+    bool read(uint64_t sequence, MarketEvent &event) const
+    {
+        const Slot &slot = slots[sequence & mask];
+        uint64_t stamp = slot.stamp.load(std::memory_order_acquire);
+        if (stamp != sequence + 1)
+            return false;
+        uint64_t header = slot.header.load(std::memory_order_relaxed);
+        double values[4];
+        for (int i = 0; i < 4; ++i)
+            values[i] = slot.values[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.stamp.load(std::memory_order_relaxed) != stamp)
+            return false;
+
+        event.type = static_cast<MarketEvent::Type>(header >> 32);
+        event.symbolId = static_cast<SymbolId>(header);
+        if (event.type == MarketEvent::Tick)
+        {
+            event.price = values[0];
+        }
+        else
+        {
+            event.candle = Candle{values[0], values[1], values[2], values[3]};
+            event.price = values[3];
+        }
+        return true;
+    }
+
+private:
+    friend class MarketBusReader;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> stamp{0};
+        std::atomic<uint64_t> header{0}; // Type in the high half, symbol in the low half
+        std::atomic<double> values[4];   // The tick's price, or the candle's OHLC
+    };
+
+    // Consumers that may sleep register a wakeup here. The wakeups belong to
+    // the bus, so the producer can always notify one, even as its reader goes.
+    static const size_t MAX_READERS = 64;
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<bool> used{false};
+        ConsumerWakeup wakeup;
+    };
+
+    int attach(); // -1 if every reader slot is taken
+    void detach(int reader);
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) uint64_t next = 0; // Producer's
+    alignas(64) std::atomic<uint64_t> committed{0};
+    std::atomic<size_t> readerSlotsSeen{0}; // Highest reader slot ever used, plus one
+    ReaderSlot readers[MAX_READERS];
+};
+
+// One consumer's cursor on a bus, starting at the events committed after it
+// is made. Only the owning thread may use it. Throws std::runtime_error if
+// every reader slot of the bus is taken.
+class MarketBusReader
+{
+public:
+    explicit MarketBusReader(MarketBus &bus);
+    ~MarketBusReader();
+    MarketBusReader(const MarketBusReader &) = delete;
+    MarketBusReader &operator=(const MarketBusReader &) = delete;
+
+    // Hand up to maxEvents committed events to handler(const MarketEvent &), in
+    // order; returns how many it handled
+    template <typename Handler>
+    size_t poll(Handler &&handler, size_t maxEvents = 1024)
+    {
+        uint64_t available = bus.cursor();
+        if (available - next > bus.capacity())
+            skipAhead(available);
+        uint64_t end = std::min<uint64_t>(available, next + maxEvents);
+        size_t handled = 0;
+        MarketEvent event;
+        while (next < end)
+        {
+            if (!bus.read(next, event))
+            {
+                skipAhead(bus.cursor()); // Lapped while reading
+                break;
+            }
+            ++next;
+            ++handled;
+            handler(event);
+        }
+        return handled;
+    }
+
+    bool pending() const { return bus.cursor() != next; }
+    uint64_t position() const { return next; } // Sequence of the next event; in a handler, of the event plus one
+    uint64_t missed() const { return missedEvents; } // Overwritten before this reader got to them
+
+    // Woken by every commit; also usable for work that arrives by other queues
+    ConsumerWakeup &wakeup() { return bus.readers[slot].wakeup; }
+
+private:
+    void skipAhead(uint64_t available);
+
+    MarketBus &bus;
+    int slot;
+    uint64_t next;
+    uint64_t missedEvents = 0;
+};
+
+// A thread that hands every event on a bus to handler, in batches, sleeping
+// while there is none. Stopping handles whatever is already committed first.
+// If the consumer is lapped, gapHandler is told how many events it missed,
+// on the same thread, so it can resync from the state the events came from.
+class MarketBusConsumer
+{
+public:
+    using Handler = std::function<void(const MarketEvent &)>;
+    using GapHandler = std::function<void(uint64_t missed)>;
+
+    MarketBusConsumer(MarketBus &bus, Handler handler, GapHandler gapHandler = nullptr);
+    ~MarketBusConsumer(); // Stops
+    MarketBusConsumer(const MarketBusConsumer &) = delete;
+    MarketBusConsumer &operator=(const MarketBusConsumer &) = delete;
+
+    void stop();
+
+private:
+    void run();
+
+    MarketBusReader reader;
+    Handler handler;
+    GapHandler gapHandler;
+    uint64_t missedReported = 0;
+    std::atomic<bool> running{true};
+    std::thread worker;
+};
+
+// Ticks and candles of the simulated market, published by the simulation thread
+extern MarketBus marketBus;
+
+#endif // MARKET_BUS_H
@@ -0,0 +1,69 @@
+#ifndef MARKET_DATA_H
+#define MARKET_DATA_H
+
+#include "utils.h"
+#include "symbol_registry.h"
+
+// A symbol's latest price and how many ticks it has had; sequence 0 means
+// no tick yet
+struct Tick
+{
+    double price = 0.0;
+    uint64_t sequence = 0;
+};
+
+// The latest tick of one symbol, published with a seqlock: the version is
+// odd while the price is being written, and a reader retries if it saw an
+// odd version or the version moved under it. Readers never take a lock and
+// never hold up the writer. One thread publishes each symbol.
+class LatestTick
+{
+public:
+    void publish(double price)
+    {
+        uint64_t current = version.load(std::memory_order_relaxed);
+        version.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        latestPrice.store(price, std::memory_order_relaxed);
+        version.store(current + 2, std::memory_order_release);
+    }
+
+    Tick read() const
+    {
+        while (true)
+        {
+            uint64_t before = version.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield(); // The writer is between its two stores
+                continue;
+            }
+            double price = latestPrice.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == before)
+                return Tick{price, before / 2};
+        }
+    }
+
+private:
+    std::atomic<uint64_t> version{0}; // Twice the ticks published, plus one during a write
+    std::atomic<double> latestPrice{0.0};
+};
+
+// One symbol's shard of the market data. seriesLock guards the symbol's
+// entries in closePricesMap, candlesMap and indicatorsMap; the maps' keys
+// are all added before the simulations start, so finding an entry needs no
+// lock. Shards sit on cache lines of their own, so symbols ticking on
+// different threads do not slow each other down.
+struct alignas(64) SymbolMarket
+{
+    std::mutex seriesLock;
+    LatestTick latest;
+};
+
+// Function declarations
+// The shard of a symbol; the reference stays valid for the program lifetime
+// and looking it up takes no lock once the symbol has been seen
+SymbolMarket &symbolMarket(SymbolId id);
+
+#endif // MARKET_DATA_H
@@ -0,0 +1,115 @@
+#ifndef MARKET_SERVER_H
+#define MARKET_SERVER_H
+
+#include "utils.h"
+#include "event_loop.h"
+#include "market_bus.h"
+#include "trading_engine.h"
+#include "wire_protocol.h"
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+// Serves the market bus and order entry to local clients over the binary
+// protocol of wire_protocol.h, on a Unix domain socket and/or localhost TCP.
+// Everything runs on one event loop. Each batch of bus events is encoded
+// once, into one shared block for every-symbol subscribers and one per
+// symbol for the rest; subscribers' send queues hold references to those
+// blocks and write them with scatter-gather sends, so the frames are never
+// copied per subscriber. A subscriber whose queue grows past a limit is
+// disconnected rather than holding memory for everyone. Orders arrive in
+// batches and are queued for one trading engine (one account), whose
+// results are routed back to the connection that sent each order.
+class MarketServer
+{
+public:
+    struct Stats
+    {
+        size_t connections = 0;
+        size_t subscribers = 0;
+        uint64_t eventsFannedOut = 0;  // Bus events encoded
+        uint64_t eventsMissed = 0;     // Bus events overwritten before the server read them
+        uint64_t framesQueued = 0;     // Frames queued to subscribers, counting each subscriber
+        uint64_t ordersReceived = 0;
+        uint64_t slowDisconnects = 0;
+        uint64_t refusedConnections = 0; // Accepted and closed at once: out of descriptors
+    };
+
+    // engine may be null, for market data only; otherwise the server becomes
+    // its result listener, so it must be made before engine->start() and
+    // destroyed after engine->stop(). The server is only used on the loop's
+    // thread, and destroyed while the loop is not running.
+    MarketServer(EventLoop &loop, MarketBus &bus, TradingEngine *engine);
+    ~MarketServer(); // Closes every socket
+    MarketServer(const MarketServer &) = delete;
+    MarketServer &operator=(const MarketServer &) = delete;
+
+    bool listenUnix(const std::string &path); // Replaces a stale socket file
+    bool listenTcp(uint16_t port);            // 127.0.0.1 only
+
+    Stats stats() const;
+
+private:
+    // A reference into a block of frames shared between connections
+    struct Chunk
+    {
+        std::shared_ptr<const std::string> data;
+        size_t offset;
+    };
+
+    struct Connection
+    {
+        int fd = -1;
+        FrameReader in;
+        std::deque<Chunk> out;
+        size_t queuedBytes = 0;
+        bool waitingToWrite = false;
+        bool allSymbols = false;
+        std::vector<bool> symbols; // By SymbolId, when not allSymbols
+        bool subscribed = false;
+        bool trading = false; // Has sent orders, so also gets the account's executions
+    };
+
+    void acceptFrom(int listenFd);
+    void receive(uint64_t id);
+    bool handleFrame(uint64_t id, Connection &connection, const char *body, size_t size);
+    void handleSubscription(Connection &connection, WireReader &reader, bool subscribe);
+    bool handleOrders(uint64_t id, Connection &connection, WireReader &reader);
+    void fanOut();
+    void deliverResults();
+    void enqueue(Connection &connection, std::shared_ptr<const std::string> block);
+    bool flush(uint64_t id); // False if the connection was closed
+    void closeConnection(uint64_t id);
+    void watchBus();
+
+    EventLoop &loop;
+    MarketBus &bus;
+    MarketBusReader events; // Only used on the loop's thread
+    TradingEngine *engine;
+    std::vector<bool> tradable; // By SymbolId
+
+    std::vector<int> listeners;
+    std::string unixPath;
+    int spareFd = -1; // Given up to accept and close a connection when out of descriptors
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t nextConnection = 1;
+
+    // Orders with the engine: engine request ID -> connection and the client's tag
+    std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>> inFlight;
+    uint64_t nextRequest = 1;
+
+    // Results from the engine thread, handed to the loop in batches
+    std::mutex resultLock;
+    std::vector<TradeResult> results;
+    bool resultsPosted = false;
+
+    // Wakes the loop when the bus moves; the bus wakes consumers through a
+    // condition variable rather than a descriptor epoll could watch
+    std::thread busWatcher;
+    std::atomic<bool> watching{true};
+    std::atomic<bool> fanOutPosted{false};
+
+    Stats counters;
+};
+
+#endif // MARKET_SERVER_H
@@ -0,0 +1,234 @@
+#ifndef MATCHING_ENGINE_H
+#define MATCHING_ENGINE_H
+
+#include "utils.h"
+#include "symbol_registry.h"
+#include "ring_buffer.h"
+#include "trigger_index.h"
+#include "market_bus.h"
+#include <functional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+using AccountId = uint32_t;
+const AccountId LIQUIDITY_PROVIDER = 0; // The synthetic price process
+
+enum class Side
+{
+    Buy,
+    Sell
+};
+
+// Prices are matched in integer ticks of 0.01 INR so levels compare exactly
+inline int64_t priceToTicks(double price) { return static_cast<int64_t>(std::llround(price * 100.0)); }
+inline double ticksToPrice(int64_t ticks) { return ticks / 100.0; }
+
+// How an added order enters the book
+enum class BookOrderType
+{
+    Limit,       // Matches now, rests the remainder
+    StopMarket,  // Armed; trades at the reference price once it reaches stopPrice
+    StopLimit,   // Armed; enters as a limit order once the reference price reaches stopPrice
+    TrailingStop // Armed; trades once the reference price moves trailAmount against its best
+};
+
+// Request to a symbol's book
+struct BookCommand
+{
+    enum Kind
+    {
+        Add,
+        Cancel,
+        Amend,
+        ReferencePrice
+    };
+    Kind kind;
+    SymbolId symbolId;
+    AccountId account;
+    uint64_t orderId;   // Account-local order ID
+    uint64_t requestId; // Echoed back in the acknowledgement
+    Side side;
+    double quantity; // Add: order size, Amend: new remaining size
+    double price;    // Limit price, or the reference price
+    BookOrderType orderType = BookOrderType::Limit;
+    double stopPrice = 0.0;
+    double trailAmount = 0.0;
+    uint64_t linkedOrderId = 0; // One-cancels-other sibling, or 0
+};
+
+// Something that happened to an account's order
+struct BookEvent
+{
+    enum Kind
+    {
+        Fill,
+        Canceled,
+        CancelRejected,
+        Amended,
+        AmendRejected,
+        Triggered,  // A stop fired at price; a fill or a resting limit order follows
+        OcoCanceled, // Canceled because its one-cancels-other sibling traded or triggered
+        StopMoved    // A trailing stop's trigger is now price
+    };
+    Kind kind;
+    SymbolId symbolId;
+    AccountId account;
+    uint64_t orderId;
+    uint64_t requestId;
+    Side side;
+    double quantity;  // Fill: executed size
+    double price;     // Fill: execution price, Amended: new limit price
+    double remaining; // Size still resting after this event
+    AccountId counterparty;
+};
+
+// Price-time priority limit order book for one symbol. Orders are pooled and
+// linked FIFO within each price level; an ID index makes cancel/amend O(1)
+// apart from the level lookup. Stop orders wait in a TriggerIndex until a
+// reference price fires them. Not thread-safe: a shard owns each book.
+class OrderBook
+{
+public:
+    using EventSink = std::function<void(const BookEvent &)>;
+
+    OrderBook(SymbolId symbolId, EventSink sink);
+
+    // Match an incoming limit order against the opposite side and rest the
+    // remainder, or arm a stop order
+    void add(const BookCommand &command);
+    void cancel(AccountId account, uint64_t orderId, uint64_t requestId);
+
+    // Shrinking at the same price keeps time priority; any other change re-queues the order
+    void amend(AccountId account, uint64_t orderId, uint64_t requestId, double quantity, double price);
+
+    // Report the trailing stops the reference price moves, fire the stops it
+    // reaches, then let the liquidity provider trade every resting order it
+    // crosses, at that price
+    void onReferencePrice(double price);
+
+    size_t size() const { return index.size(); }
+    size_t armedStops() const { return stopIndex.size(); }
+    double bestBid() const { return bids.empty() ? 0.0 : ticksToPrice(bids.begin()->first); }
+    double bestAsk() const { return asks.empty() ? 0.0 : ticksToPrice(asks.begin()->first); }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Resting
+    {
+        AccountId account;
+        uint64_t orderId;
+        Side side;
+        int64_t priceTicks;
+        double remaining;
+        uint32_t prev;
+        uint32_t next;
+        uint64_t linkedOrderId;
+    };
+
+    struct Stop
+    {
+        AccountId account;
+        uint64_t orderId;
+        Side side;
+        BookOrderType type;
+        double quantity;
+        double limitPrice; // StopLimit only
+        uint64_t linkedOrderId;
+        bool live;
+    };
+
+    struct Level
+    {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+    };
+
+    template <typename Levels>
+    void matchAgainst(Levels &levels, AccountId account, uint64_t orderId, Side side, double &quantity, int64_t limitTicks, uint64_t &linkedOrderId);
+    template <typename Levels>
+    void sweepAgainstReference(Levels &levels, int64_t referenceTicks, double price);
+
+    void addLimit(AccountId account, uint64_t orderId, Side side, double quantity, double price, uint64_t linkedOrderId);
+    void armStop(const BookCommand &command);
+    void triggerStop(uint32_t stopSlot, double price);
+    void releaseStop(uint32_t stopSlot);
+    void reportStopMoved(uint32_t stopSlot);
+    void cancelSibling(AccountId account, uint64_t siblingId, uint64_t orderId);
+    void forgetSibling(AccountId account, uint64_t siblingId);
+    void rest(AccountId account, uint64_t orderId, Side side, double quantity, int64_t priceTicks, uint64_t linkedOrderId);
+    void unlink(uint32_t slot);
+    void fill(uint32_t slot, double quantity, double price, AccountId counterparty);
+
+    static uint64_t key(AccountId account, uint64_t orderId) { return (static_cast<uint64_t>(account) << 40) | orderId; }
+
+    SymbolId symbolId;
+    EventSink sink;
+    std::map<int64_t, Level, std::greater<int64_t>> bids; // Best (highest) first
+    std::map<int64_t, Level> asks;                        // Best (lowest) first
+    std::vector<Resting> pool;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<uint64_t, uint32_t> index; // (account, orderId) -> slot
+
+    std::vector<Stop> stops;
+    std::vector<uint32_t> freeStops;
+    std::unordered_map<uint64_t, uint32_t> stopIndex; // (account, orderId) -> stop slot
+    TriggerIndex triggers;
+    std::vector<TriggerIndex::Handle> fired;
+    std::vector<TriggerIndex::Handle> moved;
+    std::unordered_set<uint64_t> canceledBeforeArrival; // OCO legs whose sibling traded first
+};
+
+// Shared per-symbol books, sharded across threads by symbol. Each shard owns
+// its books outright and applies commands from a lock-free queue in order,
+// and takes its symbols' reference prices from the market bus as it goes.
+class MatchingEngine
+{
+public:
+    using AccountListener = std::function<void(const BookEvent &)>;
+
+    // Start shardCount worker threads (0 = one per hardware thread, at most
+    // one per symbol). Each takes a market bus reader slot. Start before,
+    // and stop after, every thread that submits commands.
+    void start(unsigned shardCount = 0);
+    void stop(); // Applies whatever is already queued, then joins the shards
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Register before submitting orders; the listener runs on shard threads.
+    // Unregistering waits for any callback already in progress.
+    AccountId registerAccount(AccountListener listener);
+    void unregisterAccount(AccountId account);
+
+    // Safe from any thread; return false (dropping the command) if the engine is not running
+    bool submit(const BookCommand &command);
+
+    // Like submit(), but also returns false instead of waiting when the shard queue is full
+    bool trySubmit(const BookCommand &command);
+
+private:
+    struct Shard
+    {
+        Shard(size_t capacity, size_t index) : commands(capacity), prices(marketBus), wakeup(prices.wakeup()), index(index) {}
+        MpscRingBuffer<BookCommand> commands;
+        MarketBusReader prices;
+        ConsumerWakeup &wakeup; // Woken by commands and by market bus commits alike
+        size_t index;
+        std::unordered_map<SymbolId, std::unique_ptr<OrderBook>> books;
+        std::thread worker;
+    };
+
+    void runShard(Shard &shard);
+    void deliver(const BookEvent &event);
+    OrderBook &bookFor(Shard &shard, SymbolId symbolId);
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<bool> running{false};
+    std::shared_mutex accountsMutex;
+    std::vector<AccountListener> accounts; // Indexed by AccountId
+};
+
+// Process-wide matching engine shared by every account
+extern MatchingEngine matchingEngine;
+
+#endif // MATCHING_ENGINE_H
@@ -0,0 +1,101 @@
+#ifndef ORDER_STORE_H
+#define ORDER_STORE_H
+
+#include "utils.h"
+#include <cstdint>
+#include <unordered_map>
+
+// Structure for pending orders
+struct Order
+{
+    uint64_t id; // Assigned by OrderStore, monotonically increasing
+    std::string symbol;
+    std::string type; // "Limit_Buy", "Stop_Sell", "Trailing_Stop_Buy", "Bracket_Sell", ...
+    double amount;    // Still to be executed
+    double limitPrice;
+    double stopPrice = 0.0;   // Stop trigger; a trailing buy's initial trigger; a bracket's stop-loss
+    double trailAmount = 0.0; // Trailing stops
+    double takeProfit = 0.0;  // Brackets
+    uint64_t linkedId = 0;    // One-cancels-other sibling
+    double filled = 0.0;      // Brackets: executed so far, sized into the exit orders
+};
+
+// Order type helpers
+inline bool isBuyOrder(const Order &order) { return order.type.size() > 4 && order.type.compare(order.type.size() - 4, 4, "_Buy") == 0; }
+inline bool isStopLimitOrder(const Order &order) { return order.type.compare(0, 11, "Stop_Limit_") == 0; }
+inline bool isTrailingOrder(const Order &order) { return order.type.compare(0, 9, "Trailing_") == 0; }
+inline bool isStopOrder(const Order &order) { return order.type.compare(0, 5, "Stop_") == 0 || isTrailingOrder(order); }
+inline bool isBracketOrder(const Order &order) { return order.type.compare(0, 8, "Bracket_") == 0; }
+
+// Pooled store for pending orders.
+// Orders live in reusable slots linked in time priority (oldest first); an
+// ID -> slot hash index makes lookup, cancel and amend O(1) without moving
+// any other order.
+class OrderStore
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const OrderStore *store, uint32_t slot) : store(store), slot(slot) {}
+        const Order &operator*() const { return store->slots[slot].order; }
+        const Order *operator->() const { return &store->slots[slot].order; }
+        const_iterator &operator++()
+        {
+            slot = store->slots[slot].next;
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return slot == other.slot; }
+        bool operator!=(const const_iterator &other) const { return slot != other.slot; }
+
+    private:
+        const OrderStore *store;
+        uint32_t slot;
+    };
+
+    // Add an order at the back of the time priority and return its new ID
+    uint64_t add(Order order);
+
+    // Re-insert a previously issued order keeping its ID (used when loading)
+    void restore(const Order &order);
+
+    // Remove an order; returns false if the ID is unknown
+    bool cancel(uint64_t id);
+
+    // Change amount and limit price in place, keeping the order's position
+    bool amend(uint64_t id, double amount, double limitPrice);
+
+    Order *find(uint64_t id);
+    const Order *find(uint64_t id) const;
+
+    size_t size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+    void clear();
+
+    uint64_t peekNextId() const { return nextId; }
+
+    const_iterator begin() const { return const_iterator(this, head); }
+    const_iterator end() const { return const_iterator(this, NIL); }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Slot
+    {
+        Order order;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    uint32_t acquireSlot(const Order &order);
+    void releaseSlot(uint32_t slot);
+
+    std::vector<Slot> slots;                      // Pool of order slots
+    std::vector<uint32_t> freeSlots;              // Recycled slot numbers
+    std::unordered_map<uint64_t, uint32_t> index; // Order ID -> slot
+    uint32_t head = NIL;
+    uint32_t tail = NIL;
+    uint64_t nextId = 1;
+};
+
+#endif // ORDER_STORE_H
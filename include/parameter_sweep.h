@@ -0,0 +1,45 @@
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include "utils.h"
+#include "backtest.h"
+#include "candle_history.h"
+#include "work_stealing_pool.h"
+
+// Parameter grid: every SMA period for sma_cross, and every RSI period
+// with every band pair for rsi
+struct SweepGrid
+{
+    std::vector<int> smaPeriods{5, 10, 20, 50, 100, 200};
+    std::vector<int> rsiPeriods{7, 14, 21, 28};
+    std::vector<std::pair<double, double>> rsiBands{{20.0, 80.0}, {25.0, 75.0}, {30.0, 70.0}};
+};
+
+// One parameter combination run on every symbol
+struct SweepRow
+{
+    std::string strategy; // e.g. "rsi(14, 20/80)"
+    std::string strategyName;
+    StrategyParams params;
+    size_t symbols = 0;
+    size_t profitableSymbols = 0;
+    double meanReturn = 0.0;    // Percent, averaged over symbols
+    double worstDrawdown = 0.0; // Percent, the largest over symbols
+    double meanSharpe = 0.0;
+    size_t fills = 0;
+};
+
+// A symbol's mapped history; the mapping is read-only, so every worker shares it
+struct SweepSymbol
+{
+    std::string symbol;
+    CandleHistory history;
+};
+
+// Run every combination of the grid on every symbol, one pool task per
+// (combination, symbol) pair, and return the rows best mean return first
+std::vector<SweepRow> runParameterSweep(const std::vector<SweepSymbol> &symbols, const SweepGrid &grid,
+                                        const BacktestConfig &config, WorkStealingPool &pool,
+                                        TaskPriority priority = TaskPriority::Bulk);
+
+#endif // PARAMETER_SWEEP_H
@@ -0,0 +1,17 @@
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include "utils.h"
+#include <array>
+
+// RGB palette entry
+using PaletteColour = std::array<uint8_t, 3>;
+
+// Function declarations
+// Append an 8-bit palette PNG of width x height pixels, one palette index per
+// pixel, row by row. Compressed with a small built-in deflate (fixed Huffman
+// codes, matches only against the previous pixel and the pixel above), which
+// suits charts: long runs of background and repeated rows.
+void appendPng(const uint8_t *pixels, int width, int height, const std::vector<PaletteColour> &palette, std::string &png);
+
+#endif // PNG_WRITER_H
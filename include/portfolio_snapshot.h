@@ -0,0 +1,64 @@
+#ifndef PORTFOLIO_SNAPSHOT_H
+#define PORTFOLIO_SNAPSHOT_H
+
+#include "utils.h"
+#include "data_management.h"
+
+// Copy of everything the portfolio panel shows, as the account stood when
+// it was published
+struct PortfolioSnapshot
+{
+    std::string username;
+    std::vector<Holding> holdings; // Valued at the prices they were last marked at
+    std::vector<Order> pendingOrders;
+    double totalInvestment = 0.0;
+    double currentValue = 0.0;
+    double realizedPnL = 0.0;
+    double demoMoney = 0.0;
+    double reservedCash = 0.0; // Held back for resting buys
+    double lastOrderPrice = 0.0;
+};
+
+// Single-writer, single-reader publication of portfolio snapshots through
+// three slots (a triple buffer). The writer fills its back slot and swaps
+// it into the middle with one atomic exchange; the reader swaps the middle
+// out whenever it is fresh. Neither side ever waits for the other, and
+// slots are reused, so steady-state publishing does not allocate.
+class PortfolioSnapshots
+{
+public:
+    PortfolioSnapshots() = default;
+    PortfolioSnapshots(const PortfolioSnapshots &) = delete;
+    PortfolioSnapshots &operator=(const PortfolioSnapshots &) = delete;
+
+    // Writer: fill this in, then publish() it
+    PortfolioSnapshot &back() { return slots[backSlot]; }
+    void publish()
+    {
+        backSlot = middle.exchange(backSlot | FRESH, std::memory_order_acq_rel) & SLOT_MASK;
+    }
+
+    // Reader: the newest published snapshot; it does not change until the next call
+    const PortfolioSnapshot &latest()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH)
+            frontSlot = middle.exchange(frontSlot, std::memory_order_acq_rel) & SLOT_MASK;
+        return slots[frontSlot];
+    }
+
+private:
+    static const unsigned SLOT_MASK = 3;
+    static const unsigned FRESH = 4; // Set on the middle slot until the reader takes it
+
+    PortfolioSnapshot slots[3];
+    unsigned backSlot = 0; // Writer's
+    std::atomic<unsigned> middle{1};
+    unsigned frontSlot = 2; // Reader's
+};
+
+// Function declarations
+// Copy the account into snapshot, reusing its buffers. The caller is the
+// account's writer or holds its lock.
+void capturePortfolio(const User &user, double reservedCash, double lastOrderPrice, PortfolioSnapshot &snapshot);
+
+#endif // PORTFOLIO_SNAPSHOT_H
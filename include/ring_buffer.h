@@ -0,0 +1,140 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+// Each cell carries a sequence number that tells producers and the consumer
+// whether it is free or filled for the current lap (Vyukov's bounded queue),
+// so pushes and pops are a handful of atomic operations and never block.
+template <typename T>
+class MpscRingBuffer
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscRingBuffer(size_t requestedCapacity)
+    {
+        capacity = 1;
+        while (capacity < requestedCapacity)
+            capacity <<= 1;
+        mask = capacity - 1;
+        cells.reset(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRingBuffer(const MpscRingBuffer &) = delete;
+    MpscRingBuffer &operator=(const MpscRingBuffer &) = delete;
+
+    // Safe to call from any number of threads; returns false when full
+    bool tryPush(const T &value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Full
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Only the single consumer thread may call this; returns false when empty
+    bool tryPop(T &value)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell &cell = cells[pos & mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+            return false; // Empty
+
+        value = std::move(cell.value);
+        cell.sequence.store(pos + capacity, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return enqueuePos.load(std::memory_order_relaxed) - dequeuePos.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t capacity;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+// Lets a ring buffer consumer sleep while its queues are empty.
+// Producers call notify() after pushing; it only takes the mutex when the
+// consumer has announced it is going to sleep, so the fast path stays lock-free.
+class ConsumerWakeup
+{
+public:
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in waitUntil()
+        if (sleeping.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            signal.notify_one();
+        }
+    }
+
+    // Sleep until the deadline or a notify(), unless hasWork() turns true first
+    template <typename Clock, typename Duration, typename Predicate>
+    void waitUntil(const std::chrono::time_point<Clock, Duration> &deadline, Predicate hasWork)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Re-checking after publishing 'sleeping' closes the lost-wakeup window
+        if (!hasWork())
+            signal.wait_until(lock, deadline);
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // Unconditional wake-up, e.g. for shutdown
+    void wakeAlways()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        signal.notify_one();
+    }
+
+private:
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex;
+    std::condition_variable signal;
+};
+
+#endif // RING_BUFFER_H
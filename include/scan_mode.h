@@ -0,0 +1,19 @@
+#ifndef SCAN_MODE_H
+#define SCAN_MODE_H
+
+#include "utils.h"
+#include "screener.h"
+
+// Options for screening the stored candles of every symbol
+struct ScanOptions
+{
+    ScreenCriteria criteria;
+    unsigned threads = 0; // 0 = the shared pool, one worker per hardware thread
+    size_t top = 20;      // Rows shown; 0 shows all
+};
+
+// Function declarations
+bool parseScanOptions(int argc, char *argv[], ScanOptions &options);
+int runScanMode(const ScanOptions &options);
+
+#endif // SCAN_MODE_H
@@ -0,0 +1,70 @@
+#ifndef SCREEN_BUFFER_H
+#define SCREEN_BUFFER_H
+
+#include "utils.h"
+
+// A rectangle of the terminal, 1-based like moveCursor
+struct TerminalArea
+{
+    int column = 1;
+    int row = 1;
+    int width = 0;
+    int height = 0;
+
+    bool operator==(const TerminalArea &other) const
+    {
+        return column == other.column && row == other.row && width == other.width && height == other.height;
+    }
+    bool operator!=(const TerminalArea &other) const { return !(*this == other); }
+};
+
+// Screen model of an area of the terminal: a grid of character cells with a
+// front buffer (what the terminal shows) and a back buffer (the next frame).
+// A frame is drawn into the back buffer without touching the terminal;
+// present() then diffs the two and appends only the changed spans of each
+// row, as escapes for one write. Unchanged text, like a panel's static
+// lines, costs nothing after the first frame.
+class ScreenBuffer
+{
+public:
+    // Move or resize the area. The next present redraws it in full and
+    // clears the rows of the old area it no longer covers.
+    void setArea(const TerminalArea &area);
+    const TerminalArea &area() const { return current; }
+
+    // Start a frame: the back buffer is blanked
+    void clear();
+
+    // Text at (column, row) of the area, 0-based, cut off at its right edge
+    void print(int column, int row, const std::string &text);
+
+    // Redraw everything on the next present, e.g. when the terminal has been cleared
+    void invalidate() { redrawAll = true; }
+
+    // Append what turns the shown frame into the new one, cursor saved and
+    // restored around it, then make the new one the shown one. Appends
+    // nothing if no cell has changed. Callers hold consoleMutex, so the
+    // front buffer stays what the terminal shows.
+    void present(std::string &out);
+
+private:
+    void presentRow(int row, std::string &out);
+
+    TerminalArea current;
+    TerminalArea shown; // Area of the front buffer
+    std::vector<char> front;
+    std::vector<char> back;
+    bool redrawAll = true;
+    unsigned shownClears = 0; // clearScreen() calls up to the last present
+};
+
+// Function declarations
+// Clear the whole terminal through std::cout; every ScreenBuffer redraws in
+// full on its next present. Callers hold consoleMutex.
+void clearScreen();
+
+// Write buffer to the terminal in one call, after anything still queued on
+// std::cout; callers hold consoleMutex
+void writeTerminal(const std::string &buffer);
+
+#endif // SCREEN_BUFFER_H
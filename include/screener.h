@@ -0,0 +1,54 @@
+#ifndef SCREENER_H
+#define SCREENER_H
+
+#include "utils.h"
+#include "indicators.h"
+#include "work_stealing_pool.h"
+
+// Conditions a scan looks for, as bits so a hit can carry all it matched
+enum ScreenCondition : unsigned
+{
+    SCREEN_RSI_OVERSOLD = 1u << 0,        // RSI under ScreenCriteria::rsiBelow
+    SCREEN_RSI_OVERBOUGHT = 1u << 1,      // RSI over ScreenCriteria::rsiAbove
+    SCREEN_SMA_CROSS_UP = 1u << 2,        // Close crossed above its SMA on the last candle
+    SCREEN_SMA_CROSS_DOWN = 1u << 3,      // Close crossed below its SMA on the last candle
+    SCREEN_BOLLINGER_BREAKOUT = 1u << 4,  // Close above the upper Bollinger Band
+    SCREEN_BOLLINGER_BREAKDOWN = 1u << 5, // Close below the lower Bollinger Band
+    SCREEN_ALL = (1u << 6) - 1,
+};
+
+struct ScreenCriteria
+{
+    unsigned conditions = SCREEN_ALL;
+    double rsiBelow = 20.0;
+    double rsiAbove = 80.0;
+};
+
+// A symbol that met at least one condition
+struct ScreenHit
+{
+    std::string symbol;
+    unsigned matched = 0; // ScreenCondition bits
+    double score = 0.0;   // How far past each trigger it is, summed: RSI points and percent of price
+    IndicatorSnapshot snapshot;
+};
+
+// Function declarations
+// Conditions snapshot meets, with their combined score
+unsigned evaluateScreen(const IndicatorSnapshot &snapshot, const ScreenCriteria &criteria, double &score);
+
+// Bring every symbol's indicators up to date in parallel and rank the
+// symbols that match, most conditions first, then by score. The indicators
+// are the chart's streaming ones, so each symbol only processes candles
+// closed since it was last charted or scanned. Each symbol's seriesLock is
+// held only while its own indicators are brought up to date.
+std::vector<ScreenHit> scanSymbols(const std::map<std::string, std::vector<Candle>> &candles,
+                                   std::map<std::string, SymbolIndicators> &indicators,
+                                   const ScreenCriteria &criteria, WorkStealingPool &pool,
+                                   TaskPriority priority = TaskPriority::Bulk);
+
+std::string screenConditionNames(unsigned matched, const ScreenCriteria &criteria); // e.g. "RSI<20, SMA cross up"
+bool parseScreenConditions(const std::string &text, unsigned &conditions);         // e.g. "oversold,cross_up"
+void printScanTable(const std::vector<ScreenHit> &hits, const ScreenCriteria &criteria, size_t top);
+
+#endif // SCREENER_H
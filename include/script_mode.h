@@ -0,0 +1,22 @@
+#ifndef SCRIPT_MODE_H
+#define SCRIPT_MODE_H
+
+#include "utils.h"
+#include "trading_engine.h"
+
+// Options for non-interactive order entry
+struct ScriptOptions
+{
+    std::string scriptPath; // File of order commands, or "-" for stdin
+    std::string account;    // Existing username to trade as
+    double rate = 0.0;      // Commands per second; 0 means as fast as possible
+    bool save = false;      // Persist the account afterwards (off for load tests)
+};
+
+// Function declarations
+bool parseScriptOptions(int argc, char *argv[], ScriptOptions &options);
+int runOrderScript(const ScriptOptions &options);
+// One line of a script; false for blank lines, and for invalid ones with error set
+bool parseScriptLine(const std::string &line, TradeCommand &command, std::string &error);
+
+#endif // SCRIPT_MODE_H
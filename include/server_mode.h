@@ -0,0 +1,19 @@
+#ifndef SERVER_MODE_H
+#define SERVER_MODE_H
+
+#include "utils.h"
+
+// Options for serving the simulated market to local clients
+struct ServeOptions
+{
+    std::string socketPath; // Unix domain socket; the default one if neither this nor a port is given
+    uint16_t port = 0;      // Localhost TCP port; 0 for none
+    std::string account;    // Existing username that orders trade as; empty for market data only
+    bool save = false;      // Persist the account and prices on shutdown
+};
+
+// Function declarations
+bool parseServeOptions(int argc, char *argv[], ServeOptions &options);
+int runServeMode(const ServeOptions &options);
+
+#endif // SERVER_MODE_H
@@ -4,6 +4,7 @@
 #include "utils.h"
 
 // Function declarations
-void simulateSymbolPrice(const std::string &symbol, std::vector<double> &closePrices, std::vector<Candle> &candles, std::atomic<bool> &stopFlag);
+void startSimulations();
+void stopSimulations();
 
 #endif // SIMULATIONS_H
\ No newline at end of file
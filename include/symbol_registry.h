@@ -0,0 +1,17 @@
+#ifndef SYMBOL_REGISTRY_H
+#define SYMBOL_REGISTRY_H
+
+#include "utils.h"
+#include <cstdint>
+
+// Compact integer ID for a ticker symbol, used as a key in hot data structures
+using SymbolId = uint32_t;
+const SymbolId INVALID_SYMBOL_ID = 0xFFFFFFFFu;
+
+// Function declarations
+SymbolId internSymbol(const std::string &symbol);  // Returns the existing ID or assigns the next one
+SymbolId findSymbolId(const std::string &symbol);  // INVALID_SYMBOL_ID if never interned
+const std::string &symbolName(SymbolId id);        // Reference stays valid for the program lifetime
+size_t symbolCount();
+
+#endif // SYMBOL_REGISTRY_H
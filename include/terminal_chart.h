@@ -0,0 +1,65 @@
+#ifndef TERMINAL_CHART_H
+#define TERMINAL_CHART_H
+
+#include "utils.h"
+#include "chart_data.h"
+#include "screen_buffer.h"
+
+// Where the trading view's chart goes
+enum class ChartOutput
+{
+    Gnuplot,  // A gnuplot window, fed by ChartRenderer
+    Terminal, // Drawn in the terminal by TerminalChart
+};
+
+// First line of the trading view's terminal chart, below its menu, messages and help (lines 2-17)
+const int TERMINAL_CHART_TOP_LINE = 18;
+
+// Smallest area a frame is drawn in: a title row, the axis and a few rows per pane
+const int TERMINAL_CHART_MIN_WIDTH = 40;
+const int TERMINAL_CHART_MIN_HEIGHT = 8;
+
+// Columns right of the plot, for the price and RSI labels; the rest of the width holds one candle per column at most
+const int TERMINAL_CHART_AXIS_WIDTH = 10;
+
+// Draws a chart window as text: candlesticks from block characters, the
+// moving average, Bollinger Bands and RSI as braille dots (2x4 per cell), in
+// ANSI colours. A frame is composed on a cell canvas and appended to a buffer
+// as one run of escapes and UTF-8, so it can go out in a single write. The
+// canvas is kept between frames.
+class TerminalChart
+{
+public:
+    // Append a frame of window drawn over area; false if area is too small
+    bool appendFrame(const ChartWindow &window, const std::string &symbol, const TerminalArea &area, std::string &buffer);
+
+private:
+    struct Cell
+    {
+        const char *glyph = nullptr; // Candle part or rule; wins over dots
+        char text = 0;               // Label character; wins over everything
+        uint8_t dots = 0;            // Braille dot bits
+        uint8_t glyphColour = 0;
+        uint8_t dotColour = 0;
+    };
+
+    Cell &at(int x, int y) { return cells[static_cast<size_t>(y) * width + x]; }
+    void setDot(int dotX, int dotY, uint8_t colour);
+    void drawSegment(int x0, int y0, int x1, int y1, uint8_t colour);
+    void drawSeries(const std::vector<double> &series, size_t skip, size_t from, int top, int rows,
+                    double low, double high, uint8_t colour);
+    void drawText(int x, int y, const std::string &text, uint8_t colour);
+
+    std::vector<Cell> cells;
+    std::vector<int> candleColumns; // Canvas column of each candle drawn
+    int width = 0;
+    int height = 0;
+    int clipTop = 0; // Dot rows the pane being drawn covers, [clipTop, clipBottom)
+    int clipBottom = 0;
+};
+
+// Function declarations
+ChartOutput defaultChartOutput(); // Gnuplot on Windows or with a display, the terminal otherwise
+bool parseChartOutput(const std::string &text, ChartOutput &output);
+
+#endif // TERMINAL_CHART_H
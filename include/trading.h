@@ -4,11 +4,76 @@
 #include "utils.h"
 #include "data_management.h"
 #include "data_persistence.h"
+#include "trading_engine.h"
+#include "line_editor.h"
+
+// Prices an order-entry action asks for after the amount
+enum class PriceField
+{
+    Limit,
+    Stop,
+    Trail,
+    TakeProfit
+};
+
+// Order entry for the trading view, fed by the event loop one token at a
+// time: an action, then the amount, prices or order ID it needs, each after
+// its own prompt. Finished commands are queued for the trading engine, whose
+// results come back through showResult() on the same thread.
+class OrderEntry
+{
+public:
+    OrderEntry(TradingEngine *engine, const std::string &symbol, std::atomic<size_t> &chartZoom, LineEditor &editor);
+
+    void start(); // Show the command prompt
+
+    // Returns false once the user has chosen to leave the trading view
+    bool onToken(std::string token);
+
+    // Show an engine result under the prompt, then put the prompt back
+    void showResult(const TradeResult &result);
+
+private:
+    // What the next token is
+    enum class Step
+    {
+        Action,
+        Amount,
+        Price,
+        OrderId,
+        NewAmount,
+        NewLimitPrice
+    };
+
+    bool onAction(const std::string &action);
+    void onPrice(const std::string &token);
+    void ask(Step next, int line, const std::string &prompt);
+    void showMessage(int line, const std::string &message); // Then back to the command prompt
+    void showHelp();
+    void promptAction();
+    void submitCommand();
+
+    TradingEngine *engine;
+    SymbolId symbolId;
+    std::atomic<size_t> &chartZoom;
+    LineEditor &editor;
+
+    Step step = Step::Action;
+    int line = 0; // Row of the current prompt
+    TradeCommand command{};
+    std::vector<PriceField> priceFields;
+    size_t nextField = 0;
+    bool amending = false;
+    std::string newAmount;
+};
 
 // Function declarations
 double calculateBrokerFee(double transactionValue);
 bool hasSufficientFunds(User *user, double totalCost);
+bool hasSufficientHoldings(User *user, SymbolId symbolId, double amount);
 bool hasSufficientHoldings(User *user, const std::string &symbol, double amount);
-void userInputThread(User *user, std::map<std::string, std::vector<double>> &closePricesMap, std::string &symbol, double &lastOrderPrice);
+bool lookupOrderAction(const std::string &action, CommandType &type, std::vector<PriceField> &fields);
+const char *priceFieldName(PriceField field);
+void setPriceField(TradeCommand &command, PriceField field, double value);
 
 #endif // TRADING_H
@@ -0,0 +1,147 @@
+#ifndef TRADING_ENGINE_H
+#define TRADING_ENGINE_H
+
+#include "utils.h"
+#include "data_management.h"
+#include "ring_buffer.h"
+#include "matching_engine.h"
+#include "portfolio_snapshot.h"
+#include <deque>
+#include <functional>
+#include <unordered_map>
+
+enum class CommandType
+{
+    MarketBuy,
+    MarketSell,
+    LimitBuy,
+    LimitSell,
+    StopBuy,
+    StopSell,
+    StopLimitBuy,
+    StopLimitSell,
+    TrailingStopBuy,
+    TrailingStopSell,
+    OcoBuy,  // Limit buy below the market + stop buy above it
+    OcoSell, // Limit sell above the market + stop sell below it
+    BracketBuy,
+    BracketSell,
+    CancelOrder,
+    AmendOrder
+};
+
+// A parsed order-entry command, queued from the input side to the engine
+struct TradeCommand
+{
+    CommandType type;
+    SymbolId symbolId;
+    double amount;
+    double limitPrice;
+    uint64_t orderId;   // Target of CancelOrder / AmendOrder
+    uint64_t requestId; // Caller's tag, echoed back in the result
+    std::chrono::steady_clock::time_point submitted;
+    double stopPrice = 0.0;   // Stop orders and OCO stop legs; a bracket's stop-loss
+    double trailAmount = 0.0; // Trailing stops
+    double takeProfit = 0.0;  // Brackets
+};
+
+// Outcome of a command, or an unsolicited limit-order execution (requestId 0)
+struct TradeResult
+{
+    uint64_t requestId;
+    CommandType type;
+    bool accepted;
+    bool filled;
+    uint64_t orderId;
+    std::string message;
+    std::string detail;
+    std::chrono::steady_clock::time_point submitted;
+    std::chrono::steady_clock::time_point completed;
+};
+
+// Owns all mutable account state. Order entry threads only parse input and
+// push TradeCommands onto a lock-free queue; the engine thread applies them
+// in sequence, so the account has one writer. Limit orders rest in the shared
+// matchingEngine book and their fills come back on a second queue.
+class TradingEngine
+{
+public:
+    using ResultListener = std::function<void(const TradeResult &)>;
+
+    explicit TradingEngine(User *user, size_t queueCapacity = 4096);
+    ~TradingEngine();
+
+    // Registers the account with matchingEngine and re-submits its pending orders
+    void start();
+    void stop(); // Drains queued commands, then pulls the account's orders from the book
+
+    // Queue a command; spins only while the queue is full
+    void submit(const TradeCommand &command);
+    bool trySubmit(const TradeCommand &command);
+
+    // Called on the engine thread after every command and execution; set before start()
+    void setResultListener(ResultListener listener);
+
+    // Readers lock this to see a consistent account; only the engine writes
+    std::mutex &accountMutex() { return accountLock; }
+    User *account() { return user; }
+    double lastOrderPrice() const { return lastPrice.load(std::memory_order_relaxed); }
+    double reservedFunds() const { return reservedCash; } // Hold accountMutex()
+
+    // The account as of the engine's last change, without taking any lock.
+    // One reader only (the portfolio panel); valid until its next call.
+    const PortfolioSnapshot &portfolio() { return snapshots.latest(); }
+
+private:
+    // A book request whose acknowledgement is still outstanding
+    struct PendingRequest
+    {
+        TradeCommand command;
+        bool withdrawal;   // Pulled from the book at shutdown; keep the order for saving
+        double heldCash;   // Extra reservation held while an amend is in flight
+        double heldShares;
+    };
+
+    void run();
+    void apply(const TradeCommand &command, std::vector<TradeResult> &results);
+    void applyBookEvent(const BookEvent &event, std::vector<TradeResult> &results);
+    bool drainBookEvents(std::vector<TradeResult> &results);
+    void publish(std::vector<TradeResult> &results);
+    bool submitToBook(const BookCommand &command);
+    void resubmitPendingOrders();
+    void withdrawFromBook();
+    void markHoldings();
+    void publishPortfolio();
+    double latestPrice(SymbolId symbolId);
+    void reserve(const User::Order &order, double sign);
+    bool carriesReservation(const User::Order &order);
+    double sharesOnOffer(SymbolId symbolId);
+    bool canReserve(const User::Order &order, const User::Order *sibling, std::string &error);
+    uint64_t placeOrder(const User::Order &order, const User::Order *sibling);
+    void removeOrder(uint64_t orderId);
+    void activateBracket(const User::Order &entry, std::vector<TradeResult> &results);
+
+    User *user;
+    MpscRingBuffer<TradeCommand> commands;
+    MpscRingBuffer<BookEvent> bookEvents;
+    ConsumerWakeup wakeup;
+    ResultListener listener;
+    std::mutex accountLock;
+    std::atomic<double> lastPrice{0.0};
+    PortfolioSnapshots snapshots;
+
+    // Engine-thread state for the shared order book
+    AccountId bookAccount = LIQUIDITY_PROVIDER;
+    std::atomic<bool> acceptingEvents{false};
+    std::deque<BookEvent> deferredEvents; // Popped while waiting on a full shard queue
+    uint64_t nextBookRequest = 1;
+    std::unordered_map<uint64_t, PendingRequest> pendingRequests; // Book request ID -> request
+    size_t withdrawalsOutstanding = 0;
+    double reservedCash = 0.0;                           // Held back for resting buys
+    std::unordered_map<SymbolId, double> reservedShares; // Held back for resting sells
+
+    std::thread engineThread;
+    std::atomic<bool> running{false};
+};
+
+#endif // TRADING_ENGINE_H
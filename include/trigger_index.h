@@ -0,0 +1,119 @@
+#ifndef TRIGGER_INDEX_H
+#define TRIGGER_INDEX_H
+
+#include "utils.h"
+#include <cstdint>
+#include <deque>
+#include <set>
+
+// Armed stop triggers for one symbol, ordered by trigger price so a new
+// price only touches the triggers it fires.
+//
+// Sell-side stops fire when the price falls to their trigger, buy-side stops
+// when it rises to it; the rising side is stored with negated prices so both
+// share one "fires on a fall" ladder.
+//
+// Fixed triggers sit in FIFO price levels. Trailing triggers follow the best
+// price seen since they were armed; triggers that have seen the same best
+// price form a cohort that moves as one, so a new high re-keys cohorts rather
+// than individual stops. Cohorts merge smaller-into-larger when the price
+// passes their peaks, so each trigger is moved O(log n) times over its life.
+class TriggerIndex
+{
+public:
+    using Handle = uint32_t; // Caller's slot number for the order behind a trigger
+
+    enum Direction
+    {
+        FiresOnFall, // Sell stops
+        FiresOnRise  // Buy stops
+    };
+
+    // Fire once the price reaches triggerTicks in the given direction
+    void arm(Handle handle, Direction direction, int64_t triggerTicks);
+
+    // Fire once the price moves distanceTicks against the best price since arming
+    // (armed at the next price if none has been seen yet)
+    void armTrailing(Handle handle, Direction direction, int64_t distanceTicks);
+
+    // Returns false if the handle is not armed
+    bool disarm(Handle handle);
+
+    // Apply a new price: ratchet trailing triggers, then append fired handles
+    // (each disarmed) to fired, fixed triggers before trailing ones. If moved
+    // is given, the trailing triggers the price moved (or first armed) are
+    // appended to it; that costs a visit to each of them.
+    void onPrice(int64_t priceTicks, std::vector<Handle> &fired, std::vector<Handle> *moved = nullptr);
+
+    // Current trigger price of an armed, non-waiting handle
+    int64_t trigger(Handle handle) const;
+
+    bool hasPrice() const { return priceSeen; }
+    int64_t lastPrice() const { return lastTicks; }
+    size_t size() const { return armedCount; }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+    using DistanceMap = std::multimap<int64_t, Handle>; // Smallest distance (highest trigger) first
+
+    struct Level
+    {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+    };
+
+    struct Cohort
+    {
+        int64_t peak;
+        DistanceMap byDistance;
+    };
+
+    // All triggers of one direction, in "fires on a fall" coordinates
+    struct Ladder
+    {
+        std::map<int64_t, Level, std::greater<int64_t>> fixedLevels; // Highest trigger first
+        std::map<int64_t, uint32_t> cohortsByPeak;                   // Lowest peak first
+        std::set<std::pair<int64_t, uint32_t>, std::greater<std::pair<int64_t, uint32_t>>> cohortsByTrigger;
+    };
+
+    struct Entry
+    {
+        enum State : uint8_t
+        {
+            Disarmed,
+            Fixed,
+            Trailing,
+            Waiting // Trailing, armed at the first price
+        };
+        State state = Disarmed;
+        uint8_t ladder = 0;
+        int64_t value = 0; // Fixed: trigger, Trailing/Waiting: distance
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t cohort = NIL;
+        DistanceMap::iterator position;
+    };
+
+    Entry &entry(Handle handle);
+    void armFixed(Handle handle, uint8_t ladder, int64_t trigger);
+    void armInCohort(Handle handle, uint8_t ladder, int64_t distance, int64_t peak);
+    void unlinkFixed(Handle handle);
+    void removeFromCohort(Handle handle);
+    void releaseCohort(Ladder &ladder, uint32_t cohort);
+    void ratchet(uint8_t ladder, int64_t price, std::vector<Handle> *moved);
+    void fire(uint8_t ladder, int64_t price, std::vector<Handle> &fired);
+
+    static int64_t toLadder(uint8_t ladder, int64_t ticks) { return ladder == 0 ? ticks : -ticks; }
+    int64_t cohortTrigger(uint32_t cohort) const { return cohorts[cohort].peak - cohorts[cohort].byDistance.begin()->first; }
+
+    Ladder ladders[2]; // FiresOnFall, FiresOnRise
+    std::vector<Entry> entries; // Indexed by handle
+    std::deque<Cohort> cohorts; // Stable addresses: entries hold iterators into the maps
+    std::vector<uint32_t> freeCohorts;
+    std::vector<Handle> waiting;
+    size_t armedCount = 0;
+    bool priceSeen = false;
+    int64_t lastTicks = 0;
+};
+
+#endif // TRIGGER_INDEX_H
@@ -3,13 +3,21 @@
 
 #include "utils.h"
 #include "authentication.h"
+#include "trading_engine.h"
+#include "screen_buffer.h"
 
 // Function declarations
-void displayPortfolio(User *user, std::map<std::string, std::vector<double>> &closePricesMap,
-                      double lastOrderPrice, int screenWidth, int screenHeight, int &lastLineUsed,
-                      int &maximumHoldingsCount, int &maximumPendingOrdersCount);
+// Lines the portfolio takes, and the line it starts on at the bottom of the screen
+int portfolioLinesNeeded(int maximumHoldingsCount, int maximumPendingOrdersCount);
+int portfolioTopLine(int screenHeight, int maximumHoldingsCount, int maximumPendingOrdersCount);
 
-void displayTransactions(const User &user);
-void displayInputPrompt();
+// Draw the portfolio panel into screen's back buffer, moving its area to
+// where the panel now starts. It reads only the snapshot, so no lock is
+// held; present the screen under consoleMutex to show the lines that changed.
+void composePortfolio(const PortfolioSnapshot &portfolio, int screenWidth, int screenHeight, int &lastLineUsed,
+                      int &maximumHoldingsCount, int &maximumPendingOrdersCount, ScreenBuffer &screen);
+
+void displayTransactions(TradingEngine &engine);
+void displayScan();
 
 #endif // UI_H
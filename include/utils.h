@@ -43,7 +43,6 @@
 namespace fs = std::filesystem;
 
 // Mutexes for synchronization
-extern std::mutex dataMutex;             // Mutex for data synchronization
 extern std::mutex consoleMutex;          // Mutex for console output synchronization
 extern std::atomic<bool> stopSimulation; // To stop the simulation
 extern std::atomic<bool> changeStock;    // To change the stock
@@ -84,6 +83,16 @@ inline void moveCursor(int x, int y)
     std::cout << "\033[" << y << ";" << x << "H";
 }
 
+// Same as moveCursor, appended to a frame buffer instead of written to std::cout
+inline void appendMoveCursor(std::string &buffer, int x, int y)
+{
+    buffer += "\033[";
+    buffer += std::to_string(y);
+    buffer += ';';
+    buffer += std::to_string(x);
+    buffer += 'H';
+}
+
 // Function to get console size
 inline void GetConsoleSize(int &width, int &height)
 {
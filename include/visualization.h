@@ -6,6 +6,7 @@
 
 // Function declarations
 void plotData(const std::string &symbol, const std::vector<Candle> &candles);
+// Per-index recomputation over the window; the chart uses the streaming indicators in indicators.h
 double calculateMovingAverage(const std::vector<Candle> &candles, int period, int currentIndex);
 double calculateRSI(const std::vector<Candle> &candles, int period, int currentIndex);
 
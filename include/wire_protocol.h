@@ -0,0 +1,143 @@
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+#include "utils.h"
+#include "symbol_registry.h"
+#include "trading_engine.h"
+#include <cstring>
+
+// Binary protocol between the market server and its clients. Every message
+// is a frame: a 4-byte body length, then the body, whose first byte is the
+// message type. Integers and doubles are in the host's byte order, as both
+// ends are on the same machine.
+//
+// Client to server:
+//   Subscribe / Unsubscribe  u32 count, count x u32 symbolId (count 0 = every symbol)
+//   OrderBatch               u32 count, count x WireOrder
+// Server to client:
+//   SymbolTable              u32 count, count x {u32 symbolId, f64 latest price, u8 length, name}
+//   Tick                     u32 symbolId, u64 bus sequence, i64 sent (steady clock ns), f64 price
+//   CandleClose              u32 symbolId, u64 bus sequence, i64 sent, f64 open, high, low, close
+//                            (the market bus's own sequence, across every symbol: a client
+//                            sees gaps for symbols it is not subscribed to, and for events
+//                            the server was lapped on)
+//   OrderAck                 u64 tag, u8 command, u8 flags, u64 orderId, u16 length, message
+//                            (tag 0: a resting order of the account executed)
+enum class WireType : uint8_t
+{
+    Subscribe = 1,
+    Unsubscribe = 2,
+    OrderBatch = 3,
+    SymbolTable = 16,
+    Tick = 17,
+    CandleClose = 18,
+    OrderAck = 19,
+};
+
+const size_t WIRE_LENGTH_BYTES = 4;
+const size_t WIRE_MAX_BODY = 1 << 20;  // Larger frames are a protocol error
+const size_t WIRE_ORDER_BYTES = 61;    // One WireOrder on the wire
+
+// Where the server listens, and clients connect, unless told otherwise
+const char *const DEFAULT_SERVER_SOCKET = "data/market.sock";
+
+const uint8_t WIRE_ACCEPTED = 1;
+const uint8_t WIRE_FILLED = 2;
+
+// One order of an OrderBatch; the fields a command does not use are 0
+struct WireOrder
+{
+    uint64_t tag = 0; // The client's, echoed in the acknowledgement; must not be 0
+    CommandType type = CommandType::MarketBuy;
+    SymbolId symbolId = INVALID_SYMBOL_ID;
+    double amount = 0.0;
+    double limitPrice = 0.0;
+    double stopPrice = 0.0;
+    double trailAmount = 0.0;
+    double takeProfit = 0.0;
+    uint64_t orderId = 0; // Cancels and amends
+};
+
+struct WireAck
+{
+    uint64_t tag = 0;
+    CommandType type = CommandType::MarketBuy;
+    uint8_t flags = 0;
+    uint64_t orderId = 0;
+    std::string message;
+};
+
+// Reads the fields of a frame body in order; any read past the end fails
+// and leaves the reader failed
+class WireReader
+{
+public:
+    WireReader(const char *data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    bool read(T &value)
+    {
+        if (failed || size - offset < sizeof(T))
+        {
+            failed = true;
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool readString(size_t length, std::string &value);
+    bool ok() const { return !failed; }
+
+private:
+    const char *data;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false;
+};
+
+// Splits a byte stream into frame bodies. Bytes are appended as they arrive;
+// next() hands out each complete body once.
+class FrameReader
+{
+public:
+    // Room for up to `bytes` more; returns where to write them
+    char *prepare(size_t bytes);
+    void commit(size_t bytes) { end += bytes; }
+
+    // The next complete body, valid until the next call; false if there is
+    // none yet or the stream is broken (see broken())
+    bool next(const char *&body, size_t &size);
+    bool broken() const { return tooLarge; }
+
+private:
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool tooLarge = false;
+};
+
+// Function declarations
+// Each appends one whole frame to out
+void appendSubscribe(std::string &out, WireType type, const std::vector<SymbolId> &symbols);
+void appendOrderBatch(std::string &out, const WireOrder *orders, size_t count);
+void appendSymbolTable(std::string &out, const std::vector<std::pair<SymbolId, double>> &symbols);
+void appendTick(std::string &out, SymbolId symbolId, uint64_t sequence, int64_t sentNanos, double price);
+void appendCandle(std::string &out, SymbolId symbolId, uint64_t sequence, int64_t sentNanos, const Candle &candle);
+void appendAck(std::string &out, const WireAck &ack);
+
+// Read one order or acknowledgement, as written by the functions above
+bool readWireOrder(WireReader &reader, WireOrder &order);
+bool readWireAck(WireReader &reader, WireAck &ack);
+
+// Steady-clock time in nanoseconds, comparable between processes on the same machine
+int64_t wireClockNanos();
+
+// A blocking connection to the server's Unix socket, or to localhost TCP if port is not 0; -1 on failure
+int connectToServer(const std::string &socketPath, uint16_t port);
+
+// Lift the open-file limit to the hard limit, for thousands of sockets; returns the new limit
+size_t raiseDescriptorLimit();
+
+#endif // WIRE_PROTOCOL_H
@@ -0,0 +1,110 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include "utils.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+
+// Which tasks a worker takes first. A worker always picks the most urgent
+// task queued anywhere in the pool, so interactive work waits at most for
+// the tasks already running, however much bulk work is queued behind it.
+enum class TaskPriority
+{
+    Interactive, // Someone is waiting on the screen for it
+    Normal,      // Simulation and persistence
+    Bulk,        // Analytics: sweeps, scans and exports run in batch
+};
+
+// Tasks submitted together and waited for together. Waiting on a group only
+// waits for its own tasks, so callers can share one pool.
+class TaskGroup
+{
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+private:
+    friend class WorkStealingPool;
+    std::atomic<size_t> unfinished{0};
+};
+
+// Fixed set of worker threads, each with its own task deque per priority.
+// A worker runs its own tasks newest first (they are likely still in cache)
+// and, when it runs dry, steals the oldest task from another worker's deque,
+// so uneven task sizes even out without a shared queue that every worker
+// contends on. More urgent tasks are taken, local or stolen, before less
+// urgent ones.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // What one worker has done since the pool started
+    struct WorkerStats
+    {
+        uint64_t tasks = 0;        // Tasks run
+        uint64_t stolen = 0;       // Of those, taken from another worker's deque
+        double busySeconds = 0.0;  // Spent running tasks
+        double utilisation = 0.0;  // Busy share of the pool's lifetime
+    };
+
+    explicit WorkStealingPool(unsigned workerCount = 0); // 0 = one per hardware thread
+    ~WorkStealingPool();                                 // Finishes queued tasks, then joins
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // Safe from any thread. From a worker the task goes on that worker's own
+    // deque; from outside, deques are filled round-robin.
+    void submit(TaskGroup &group, Task task, TaskPriority priority = TaskPriority::Normal);
+
+    // Block until every task submitted to group so far (and any they submitted
+    // to it) has run. A worker waiting on a group runs queued tasks meanwhile.
+    void wait(TaskGroup &group);
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+    std::vector<WorkerStats> stats() const;
+
+private:
+    static const size_t PRIORITY_LEVELS = 3;
+
+    struct Job
+    {
+        Task task;
+        TaskGroup *group;
+    };
+
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<Job> jobs[PRIORITY_LEVELS];
+        std::thread thread;
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> busyNanoseconds{0};
+    };
+
+    void run(unsigned self);
+    bool take(unsigned self, Job &job); // The most urgent job, local or stolen
+    bool popLocal(unsigned self, size_t level, Job &job);
+    bool steal(unsigned self, size_t level, Job &job);
+    void execute(unsigned self, Job &job);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::chrono::steady_clock::time_point started;
+    std::atomic<size_t> queued[PRIORITY_LEVELS]; // Submitted, not yet taken by a worker
+    std::atomic<size_t> unfinished{0};           // Submitted, not yet finished, in any group
+    std::atomic<unsigned> nextWorker{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepLock;
+    std::condition_variable workAvailable;
+    std::condition_variable groupDone;
+};
+
+// Function declarations
+// The process-wide pool, one worker per hardware thread, started on first use
+WorkStealingPool &sharedPool();
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,461 @@
+// src/backtest.cpp
+
+#include "utils.h"
+#include "backtest.h"
+#include "trading.h"
+#include "indicators.h"
+#include "fixed_indicators.h"
+
+namespace
+{
+    const AccountId STRATEGY_ACCOUNT = 1; // The book's only account besides the liquidity provider
+    const SymbolId BACKTEST_SYMBOL = 0;
+
+    // Cash a pending buy holds back, as for live orders: its value plus the fee on it
+    double cashReservation(double quantity, double price)
+    {
+        double transactionCost = quantity * price;
+        return transactionCost + calculateBrokerFee(transactionCost);
+    }
+
+    // Whole shares the available cash buys at the latest price, fee included
+    double affordableShares(const Backtest &backtest)
+    {
+        double cash = backtest.availableCash();
+        if (cash <= 0.0 || backtest.price() <= 0.0)
+            return 0.0;
+        return std::floor((cash - calculateBrokerFee(cash)) / backtest.price());
+    }
+
+    void buyAll(Backtest &backtest)
+    {
+        double quantity = affordableShares(backtest);
+        if (quantity >= 1.0)
+            backtest.buy(quantity);
+    }
+
+    void sellAll(Backtest &backtest)
+    {
+        double quantity = backtest.availableShares();
+        if (quantity > 0.0)
+            backtest.sell(quantity);
+    }
+
+    // All in when the close crosses above its simple moving average, all out when it crosses below.
+    // Sma is StreamingSma, or FixedSma for the periods that have a compile-time kernel.
+    template <typename Sma>
+    class SmaCrossStrategy : public Strategy
+    {
+    public:
+        explicit SmaCrossStrategy(const Sma &sma = Sma()) : sma(sma) {}
+
+        std::string name() const override { return "sma_cross(" + std::to_string(sma.period()) + ")"; }
+
+        void onCandle(Backtest &backtest, const Candle &candle, size_t index) override
+        {
+            double average = sma.update(candle.close);
+            if (!sma.ready())
+                return;
+
+            bool above = candle.close > average;
+            if (above && trend < 0)
+                buyAll(backtest);
+            else if (!above && trend > 0)
+                sellAll(backtest);
+            trend = above ? 1 : -1;
+        }
+
+    private:
+        Sma sma;
+        int trend = 0; // Side of the average on the previous candle; 0 before the first
+    };
+
+    // Buys when the (Wilder) RSI falls to the lower band and sells when it reaches the upper one.
+    // Rsi is StreamingRsi or FixedRsi, as for SmaCrossStrategy.
+    template <typename Rsi>
+    class RsiStrategy : public Strategy
+    {
+    public:
+        RsiStrategy(const Rsi &rsi, double lowerBand, double upperBand)
+            : rsi(rsi), lowerBand(lowerBand), upperBand(upperBand) {}
+
+        std::string name() const override
+        {
+            std::ostringstream oss;
+            oss << "rsi(" << rsi.period() << ", " << lowerBand << "/" << upperBand << ")";
+            return oss.str();
+        }
+
+        void onCandle(Backtest &backtest, const Candle &candle, size_t index) override
+        {
+            double value = rsi.update(candle.close);
+            if (!rsi.ready())
+                return;
+
+            if (value <= lowerBand)
+                buyAll(backtest);
+            else if (value >= upperBand)
+                sellAll(backtest);
+        }
+
+    private:
+        Rsi rsi;
+        double lowerBand;
+        double upperBand;
+    };
+
+    // All in when the MACD line crosses above its signal line, all out when it crosses below
+    class MacdCrossStrategy : public Strategy
+    {
+    public:
+        std::string name() const override { return "macd_cross(12, 26, 9)"; }
+
+        void onCandle(Backtest &backtest, const Candle &candle, size_t index) override
+        {
+            macd.update(candle.close);
+            if (!macd.ready())
+                return;
+
+            bool above = macd.histogram() > 0.0;
+            if (above && trend < 0)
+                buyAll(backtest);
+            else if (!above && trend > 0)
+                sellAll(backtest);
+            trend = above ? 1 : -1;
+        }
+
+    private:
+        StreamingMacd macd;
+        int trend = 0;
+    };
+
+    // Mean reversion: buys a close at or under the lower Bollinger Band and
+    // sells once the close is back to the middle one
+    class BollingerStrategy : public Strategy
+    {
+    public:
+        explicit BollingerStrategy(int period) : bands(period) {}
+
+        std::string name() const override { return "bollinger(" + std::to_string(bands.period()) + ", 2)"; }
+
+        void onCandle(Backtest &backtest, const Candle &candle, size_t index) override
+        {
+            bands.update(candle.close);
+            if (!bands.ready())
+                return;
+
+            if (candle.close <= bands.lower())
+                buyAll(backtest);
+            else if (candle.close >= bands.middle())
+                sellAll(backtest);
+        }
+
+    private:
+        StreamingBollinger bands;
+    };
+}
+
+Backtest::Backtest(const BacktestConfig &config)
+    : config(config), book(BACKTEST_SYMBOL, [this](const BookEvent &event)
+                           { events.push_back(event); })
+{
+}
+
+void Backtest::reset()
+{
+    book = OrderBook(BACKTEST_SYMBOL, [this](const BookEvent &event)
+                     { events.push_back(event); });
+    events.clear();
+    pendingFills.clear();
+    holds.clear();
+    holdings.clear();
+    result = BacktestResult();
+    cashBalance = config.startingCash;
+    shares = 0.0;
+    reservedCash = 0.0;
+    reservedShares = 0.0;
+    lastPrice = 0.0;
+    currentIndex = 0;
+    nextOrderId = 1;
+}
+
+BacktestResult Backtest::run(const Candle *candles, size_t count, Strategy &strategy)
+{
+    reset();
+    result.strategy = strategy.name();
+    result.candles = count;
+    result.startingCash = config.startingCash;
+    if (config.equityStride > 0)
+        result.equity.reserve(count / config.equityStride + 1);
+
+    double peak = cashBalance;
+    double previousEquity = cashBalance;
+    double meanReturn = 0.0; // Welford's running mean and variance of per-candle returns
+    double returnM2 = 0.0;
+    size_t returnCount = 0;
+    size_t untilSample = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Candle &candle = candles[i];
+        currentIndex = i;
+
+        // An empty book has nothing for the candle to fill or trigger
+        if (book.size() != 0 || book.armedStops() != 0)
+        {
+            drive(candle);
+            reportFills(strategy);
+        }
+
+        lastPrice = candle.close;
+        strategy.onCandle(*this, candle, i);
+        if (!pendingFills.empty())
+            reportFills(strategy);
+
+        double value = cashBalance + shares * lastPrice;
+        if (value > peak)
+            peak = value;
+        else if (peak > 0.0 && (peak - value) / peak > result.maxDrawdown)
+            result.maxDrawdown = (peak - value) / peak;
+
+        if (previousEquity > 0.0)
+        {
+            double change = value / previousEquity - 1.0;
+            ++returnCount;
+            double delta = change - meanReturn;
+            meanReturn += delta / returnCount;
+            returnM2 += delta * (change - meanReturn);
+        }
+        previousEquity = value;
+
+        if (config.equityStride > 0 && untilSample-- == 0)
+        {
+            result.equity.push_back(value);
+            untilSample = config.equityStride - 1;
+        }
+    }
+
+    result.finalEquity = equity();
+    result.totalReturn = (config.startingCash > 0.0) ? (result.finalEquity / config.startingCash - 1.0) * 100.0 : 0.0;
+    result.maxDrawdown *= 100.0;
+    if (returnCount > 1 && returnM2 > 0.0)
+        result.sharpe = meanReturn / std::sqrt(returnM2 / (returnCount - 1));
+    return std::move(result);
+}
+
+void Backtest::drive(const Candle &candle)
+{
+    // The candle's path: open, the nearer extreme, the further one, then close
+    bool highFirst = candle.high - candle.open < candle.open - candle.low;
+    book.onReferencePrice(candle.open);
+    book.onReferencePrice(highFirst ? candle.high : candle.low);
+    book.onReferencePrice(highFirst ? candle.low : candle.high);
+    book.onReferencePrice(candle.close);
+    applyBookEvents();
+}
+
+void Backtest::applyBookEvents()
+{
+    for (const BookEvent &event : events)
+    {
+        switch (event.kind)
+        {
+        case BookEvent::Fill:
+        {
+            execute(event.side, event.orderId, event.quantity, event.price);
+            double before = event.quantity + event.remaining;
+            release(event.orderId, (before > 0.0) ? event.quantity / before : 1.0);
+            break;
+        }
+        case BookEvent::Canceled:
+        case BookEvent::OcoCanceled:
+            release(event.orderId);
+            break;
+        case BookEvent::Triggered:
+        case BookEvent::StopMoved:
+        case BookEvent::CancelRejected:
+        case BookEvent::Amended:
+        case BookEvent::AmendRejected:
+            break;
+        }
+    }
+    events.clear();
+}
+
+void Backtest::reportFills(Strategy &strategy)
+{
+    // onFill may trade again; keep reporting until nothing new has filled
+    while (!pendingFills.empty())
+    {
+        reporting.swap(pendingFills);
+        for (const BacktestTrade &trade : reporting)
+        {
+            strategy.onFill(*this, trade);
+        }
+        reporting.clear();
+    }
+}
+
+void Backtest::execute(Side side, uint64_t orderId, double quantity, double price)
+{
+    double transactionValue = quantity * price;
+    double brokerFee = calculateBrokerFee(transactionValue);
+    BacktestTrade trade{currentIndex, orderId, side, quantity, price, brokerFee, 0.0};
+
+    if (side == Side::Buy)
+    {
+        cashBalance -= transactionValue + brokerFee;
+        holdings.buy(BACKTEST_SYMBOL, quantity, price);
+        shares += quantity;
+    }
+    else
+    {
+        cashBalance += transactionValue - brokerFee;
+        trade.realizedPnL = holdings.sell(BACKTEST_SYMBOL, quantity, price);
+        shares -= quantity;
+        ++result.closingTrades;
+        if (trade.realizedPnL > 0.0)
+            ++result.winningTrades;
+    }
+
+    ++result.fills;
+    result.fees += brokerFee;
+    result.realizedPnL += trade.realizedPnL;
+    if (config.recordTrades)
+        result.trades.push_back(trade);
+    pendingFills.push_back(trade);
+}
+
+void Backtest::release(uint64_t orderId, double fraction)
+{
+    auto it = holds.find(orderId);
+    if (it == holds.end())
+        return;
+
+    double cash = it->second.cash * fraction;
+    double heldShares = it->second.shares * fraction;
+    reservedCash -= cash;
+    reservedShares -= heldShares;
+    if (fraction >= 1.0)
+    {
+        holds.erase(it);
+        return;
+    }
+    it->second.cash -= cash;
+    it->second.shares -= heldShares;
+}
+
+bool Backtest::buy(double quantity)
+{
+    if (quantity <= 0.0 || lastPrice <= 0.0 || cashReservation(quantity, lastPrice) > availableCash())
+        return false;
+    execute(Side::Buy, 0, quantity, lastPrice);
+    return true;
+}
+
+bool Backtest::sell(double quantity)
+{
+    if (quantity <= 0.0 || lastPrice <= 0.0 || quantity > availableShares())
+        return false;
+    execute(Side::Sell, 0, quantity, lastPrice);
+    return true;
+}
+
+uint64_t Backtest::limitBuy(double quantity, double limitPrice)
+{
+    return placeOrder(Side::Buy, BookOrderType::Limit, quantity, limitPrice);
+}
+
+uint64_t Backtest::limitSell(double quantity, double limitPrice)
+{
+    return placeOrder(Side::Sell, BookOrderType::Limit, quantity, limitPrice);
+}
+
+uint64_t Backtest::stopBuy(double quantity, double stopPrice)
+{
+    return placeOrder(Side::Buy, BookOrderType::StopMarket, quantity, 0.0, stopPrice);
+}
+
+uint64_t Backtest::stopSell(double quantity, double stopPrice)
+{
+    return placeOrder(Side::Sell, BookOrderType::StopMarket, quantity, 0.0, stopPrice);
+}
+
+uint64_t Backtest::placeOrder(Side side, BookOrderType type, double quantity, double limitPrice, double stopPrice, double trailAmount)
+{
+    bool needsLimit = (type == BookOrderType::Limit || type == BookOrderType::StopLimit);
+    bool needsStop = (type == BookOrderType::StopMarket || type == BookOrderType::StopLimit);
+    if (quantity <= 0.0 || lastPrice <= 0.0 || (needsLimit && limitPrice <= 0.0) || (needsStop && stopPrice <= 0.0) ||
+        (type == BookOrderType::TrailingStop && trailAmount <= 0.0))
+        return 0;
+
+    // Reserve as live orders do: buys at their limit, or at the stop for stop-market and trailing buys
+    Hold hold{0.0, 0.0};
+    if (side == Side::Buy)
+    {
+        double holdPrice = needsLimit ? limitPrice : (type == BookOrderType::StopMarket ? stopPrice : lastPrice + trailAmount);
+        hold.cash = cashReservation(quantity, holdPrice);
+        if (hold.cash > availableCash())
+            return 0;
+    }
+    else
+    {
+        hold.shares = quantity;
+        if (hold.shares > availableShares())
+            return 0;
+    }
+
+    uint64_t orderId = nextOrderId++;
+    holds.emplace(orderId, hold);
+    reservedCash += hold.cash;
+    reservedShares += hold.shares;
+
+    // An idle book has not seen recent candles; bring its price up to date so
+    // stops compare against, and trailing stops start from, the latest close
+    if (book.size() == 0 && book.armedStops() == 0)
+        book.onReferencePrice(lastPrice);
+
+    book.add(BookCommand{BookCommand::Add, BACKTEST_SYMBOL, STRATEGY_ACCOUNT, orderId, 0, side, quantity, limitPrice, type, stopPrice, trailAmount});
+    applyBookEvents();
+    return orderId;
+}
+
+bool Backtest::cancel(uint64_t orderId)
+{
+    if (holds.find(orderId) == holds.end())
+        return false;
+    book.cancel(STRATEGY_ACCOUNT, orderId, 0);
+    applyBookEvents();
+    return true;
+}
+
+std::unique_ptr<Strategy> makeStrategy(const std::string &name, const StrategyParams &params)
+{
+    // Common periods get the compile-time indicator kernels
+    std::unique_ptr<Strategy> strategy;
+    if (name == "sma_cross")
+    {
+        if (!dispatchFixedPeriod(params.period, [&](auto constant)
+                                 { strategy = std::make_unique<SmaCrossStrategy<FixedSma<decltype(constant)::value>>>(); }))
+            strategy = std::make_unique<SmaCrossStrategy<StreamingSma>>(StreamingSma(params.period));
+        return strategy;
+    }
+    if (name == "rsi")
+    {
+        if (!dispatchFixedPeriod(params.period, [&](auto constant)
+                                 { using Rsi = FixedRsi<decltype(constant)::value>;
+                                   strategy = std::make_unique<RsiStrategy<Rsi>>(Rsi(), params.lowerBand, params.upperBand); }))
+            strategy = std::make_unique<RsiStrategy<StreamingRsi>>(StreamingRsi(params.period), params.lowerBand, params.upperBand);
+        return strategy;
+    }
+    if (name == "macd_cross")
+        return std::make_unique<MacdCrossStrategy>();
+    if (name == "bollinger")
+        return std::make_unique<BollingerStrategy>(params.period);
+    return nullptr;
+}
+
+std::string strategyNames()
+{
+    return "sma_cross|rsi|macd_cross|bollinger";
+}
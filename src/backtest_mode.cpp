@@ -0,0 +1,263 @@
+// src/backtest_mode.cpp
+
+#include "utils.h"
+#include "backtest_mode.h"
+#include "candle_history.h"
+
+bool parseBacktestOptions(int argc, char *argv[], BacktestOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--backtest" && hasValue)
+                options.strategy = argv[++i];
+            else if (arg == "--symbol" && hasValue)
+            {
+                options.symbol = argv[++i];
+                std::transform(options.symbol.begin(), options.symbol.end(), options.symbol.begin(), ::toupper);
+            }
+            else if (arg == "--period" && hasValue)
+                options.params.period = std::stoi(argv[++i]);
+            else if (arg == "--lower" && hasValue)
+                options.params.lowerBand = std::stod(argv[++i]);
+            else if (arg == "--upper" && hasValue)
+                options.params.upperBand = std::stod(argv[++i]);
+            else if (arg == "--cash" && hasValue)
+                options.startingCash = std::stod(argv[++i]);
+            else if (arg == "--out" && hasValue)
+                options.outputDir = argv[++i];
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    return !options.strategy.empty() && options.params.period > 0 && options.startingCash > 0.0 &&
+           options.params.lowerBand < options.params.upperBand;
+}
+
+// Function to parse "5,10,20" into a list of periods
+static bool parsePeriodList(const std::string &text, std::vector<int> &periods)
+{
+    periods.clear();
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        int period = std::stoi(item);
+        if (period <= 0)
+            return false;
+        periods.push_back(period);
+    }
+    return !periods.empty();
+}
+
+// Function to parse "20/80,30/70" into RSI band pairs
+static bool parseBandList(const std::string &text, std::vector<std::pair<double, double>> &bands)
+{
+    bands.clear();
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        size_t slash = item.find('/');
+        if (slash == std::string::npos)
+            return false;
+        double lower = std::stod(item.substr(0, slash));
+        double upper = std::stod(item.substr(slash + 1));
+        if (lower >= upper)
+            return false;
+        bands.emplace_back(lower, upper);
+    }
+    return !bands.empty();
+}
+
+bool parseSweepOptions(int argc, char *argv[], SweepOptions &options)
+{
+    bool sweep = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--sweep")
+                sweep = true;
+            else if (arg == "--symbol" && hasValue)
+            {
+                options.symbol = argv[++i];
+                std::transform(options.symbol.begin(), options.symbol.end(), options.symbol.begin(), ::toupper);
+            }
+            else if (arg == "--threads" && hasValue)
+                options.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if (arg == "--sma" && hasValue)
+            {
+                if (!parsePeriodList(argv[++i], options.grid.smaPeriods))
+                    return false;
+            }
+            else if (arg == "--rsi" && hasValue)
+            {
+                if (!parsePeriodList(argv[++i], options.grid.rsiPeriods))
+                    return false;
+            }
+            else if (arg == "--bands" && hasValue)
+            {
+                if (!parseBandList(argv[++i], options.grid.rsiBands))
+                    return false;
+            }
+            else if (arg == "--cash" && hasValue)
+                options.startingCash = std::stod(argv[++i]);
+            else if (arg == "--top" && hasValue)
+                options.top = std::stoul(argv[++i]);
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    return sweep && options.startingCash > 0.0;
+}
+
+// Function to write a backtest's trade list and equity curve as CSV
+static void writeBacktestOutput(const std::string &path, const BacktestResult &result)
+{
+    std::ofstream tradesFile(path + "_trades.csv");
+    tradesFile << "candle,order_id,side,quantity,price,broker_fee,realized_pnl\n";
+    for (const BacktestTrade &trade : result.trades)
+    {
+        tradesFile << trade.candleIndex << ',' << trade.orderId << ',' << (trade.side == Side::Buy ? "Buy" : "Sell") << ','
+                   << trade.quantity << ',' << trade.price << ',' << trade.brokerFee << ',' << trade.realizedPnL << '\n';
+    }
+
+    std::ofstream equityFile(path + "_equity.csv");
+    equityFile << "candle,equity\n";
+    for (size_t i = 0; i < result.equity.size(); ++i)
+    {
+        equityFile << i << ',' << result.equity[i] << '\n';
+    }
+}
+
+int runBacktestMode(const BacktestOptions &options)
+{
+    std::vector<std::string> symbols;
+    if (!options.symbol.empty())
+        symbols.push_back(options.symbol);
+    else
+    {
+        for (const auto &pair : assetData)
+            symbols.push_back(pair.first);
+    }
+
+    std::unique_ptr<Strategy> probe = makeStrategy(options.strategy, options.params);
+    if (!probe)
+    {
+        std::cerr << "Unknown strategy '" << options.strategy << "' (expected " << strategyNames() << ")" << std::endl;
+        return 1;
+    }
+    fs::create_directories(options.outputDir);
+
+    BacktestConfig config;
+    config.startingCash = options.startingCash;
+    Backtest backtest(config);
+
+    std::cout << "Strategy " << probe->name() << ", starting cash INR " << std::fixed << std::setprecision(2) << options.startingCash << "\n\n";
+    std::cout << std::left << std::setw(12) << "Symbol" << std::right << std::setw(10) << "Candles" << std::setw(14) << "Final Equity"
+              << std::setw(10) << "Return%" << std::setw(10) << "MaxDD%" << std::setw(9) << "Sharpe" << std::setw(8) << "Fills"
+              << std::setw(8) << "Win%" << std::setw(10) << "Fees" << std::setw(14) << "Candles/s" << "\n";
+
+    size_t tested = 0;
+    for (const std::string &symbol : symbols)
+    {
+        CandleHistory history;
+        if (!history.openSymbol(symbol) || history.empty())
+        {
+            std::cout << std::left << std::setw(12) << symbol << "no stored candles" << "\n";
+            continue;
+        }
+
+        std::unique_ptr<Strategy> strategy = makeStrategy(options.strategy, options.params);
+        auto start = std::chrono::steady_clock::now();
+        BacktestResult result = backtest.run(history.data(), history.size(), *strategy);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++tested;
+
+        double winRate = result.closingTrades > 0 ? 100.0 * result.winningTrades / result.closingTrades : 0.0;
+        std::cout << std::left << std::setw(12) << symbol << std::right << std::setw(10) << result.candles
+                  << std::setw(14) << std::setprecision(2) << result.finalEquity << std::setw(10) << result.totalReturn
+                  << std::setw(10) << result.maxDrawdown << std::setw(9) << std::setprecision(3) << result.sharpe
+                  << std::setw(8) << result.fills << std::setw(8) << std::setprecision(1) << winRate
+                  << std::setw(10) << std::setprecision(2) << result.fees << std::setw(14) << std::setprecision(0)
+                  << (elapsed > 0 ? result.candles / elapsed : 0.0) << "\n";
+
+        writeBacktestOutput(options.outputDir + "/" + symbol + "_" + options.strategy, result);
+    }
+
+    if (tested > 0)
+        std::cout << "\nTrade lists and equity curves written to " << options.outputDir << "/" << std::endl;
+    return tested > 0 ? 0 : 1;
+}
+
+int runSweepMode(const SweepOptions &options)
+{
+    // Map each symbol's history once; every worker reads the same pages
+    std::vector<SweepSymbol> symbols;
+    for (const auto &pair : assetData)
+    {
+        if (!options.symbol.empty() && pair.first != options.symbol)
+            continue;
+        SweepSymbol entry;
+        entry.symbol = pair.first;
+        if (entry.history.openSymbol(pair.first) && !entry.history.empty())
+            symbols.push_back(std::move(entry));
+    }
+    if (symbols.empty())
+    {
+        std::cerr << "No stored candles to sweep." << std::endl;
+        return 1;
+    }
+
+    size_t totalCandles = 0;
+    for (const SweepSymbol &entry : symbols)
+        totalCandles += entry.history.size();
+
+    BacktestConfig config;
+    config.startingCash = options.startingCash;
+    // --threads gives the run its own pool; otherwise it shares the process's
+    std::unique_ptr<WorkStealingPool> ownPool;
+    if (options.threads != 0)
+        ownPool = std::make_unique<WorkStealingPool>(options.threads);
+    WorkStealingPool &pool = ownPool ? *ownPool : sharedPool();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepRow> rows = runParameterSweep(symbols, options.grid, config, pool);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << rows.size() << " parameter sets x " << symbols.size() << " symbols (" << totalCandles << " candles) on "
+              << pool.size() << " threads in " << std::fixed << std::setprecision(3) << elapsed << " s\n";
+    std::cout << "Workers (tasks/stolen/busy):";
+    for (const WorkStealingPool::WorkerStats &worker : pool.stats())
+        std::cout << "  " << worker.tasks << "/" << worker.stolen << "/" << std::setprecision(0) << worker.utilisation * 100.0 << "%";
+    std::cout << std::setprecision(3) << "\n\n";
+    std::cout << std::right << std::setw(5) << "Rank" << "  " << std::left << std::setw(24) << "Strategy" << std::right
+              << std::setw(12) << "Mean Ret%" << std::setw(12) << "Worst DD%" << std::setw(12) << "Mean Sharpe"
+              << std::setw(10) << "Fills" << std::setw(12) << "Profitable" << "\n";
+
+    size_t shown = (options.top == 0) ? rows.size() : std::min(options.top, rows.size());
+    for (size_t i = 0; i < shown; ++i)
+    {
+        const SweepRow &row = rows[i];
+        std::cout << std::right << std::setw(5) << (i + 1) << "  " << std::left << std::setw(24) << row.strategy << std::right
+                  << std::setw(12) << std::setprecision(2) << row.meanReturn << std::setw(12) << row.worstDrawdown
+                  << std::setw(12) << std::setprecision(4) << row.meanSharpe << std::setw(10) << row.fills
+                  << std::setw(8) << row.profitableSymbols << "/" << row.symbols << "\n";
+    }
+    std::cout << std::flush;
+    return 0;
+}
@@ -0,0 +1,2143 @@
+// src/benchmarks.cpp
+
+#include "utils.h"
+#include "benchmarks.h"
+#include "matching_engine.h"
+#include "trigger_index.h"
+#include "backtest.h"
+#include "candle_history.h"
+#include "parameter_sweep.h"
+#include "indicators.h"
+#include "indicator_batch.h"
+#include "fixed_indicators.h"
+#include "screener.h"
+#include "chart_renderer.h"
+#include "terminal_chart.h"
+#include "chart_export.h"
+#include "chart_downsample.h"
+#include "csv_ingest.h"
+#include "data_persistence.h"
+#include "market_data.h"
+#include "market_bus.h"
+#include "work_stealing_pool.h"
+#include "ui.h"
+#include "portfolio_snapshot.h"
+#include "event_loop.h"
+#include "trading.h"
+#include "visualization.h"
+#include "trading_engine.h"
+#include <charconv>
+#include <functional>
+#include <numeric>
+
+namespace
+{
+    using BenchClock = std::chrono::steady_clock;
+
+    double secondsSince(BenchClock::time_point start)
+    {
+        return std::chrono::duration<double>(BenchClock::now() - start).count();
+    }
+
+    void printRate(const std::string &label, size_t count, double seconds, const std::string &unit)
+    {
+        std::cout << std::left << std::setw(34) << label << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << (seconds > 0 ? count / seconds : 0.0) << " " << unit << "/s  ("
+                  << count << " in " << std::setprecision(3) << seconds << " s)" << std::endl;
+    }
+
+    // Random order flow around a fixed mid price: adds from many accounts with
+    // one command in ten a cancel of an earlier order
+    std::vector<BookCommand> makeOrderFlow(size_t count, AccountId accounts)
+    {
+        std::mt19937_64 gen(42);
+        std::uniform_int_distribution<int> offset(-50, 50);
+        std::uniform_int_distribution<int> quantity(1, 100);
+        std::uniform_int_distribution<AccountId> account(1, accounts);
+        std::bernoulli_distribution isBuy(0.5);
+        std::bernoulli_distribution isCancel(0.1);
+        const int64_t midTicks = 100000; // INR 1000.00
+
+        std::vector<BookCommand> flow;
+        std::vector<AccountId> owners; // owners[orderId - 1]
+        flow.reserve(count);
+        owners.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!owners.empty() && isCancel(gen))
+            {
+                uint64_t orderId = std::uniform_int_distribution<uint64_t>(1, owners.size())(gen);
+                flow.push_back(BookCommand{BookCommand::Cancel, 0, owners[orderId - 1], orderId, 0, Side::Buy, 0.0, 0.0});
+                continue;
+            }
+            AccountId owner = account(gen);
+            owners.push_back(owner);
+            flow.push_back(BookCommand{BookCommand::Add, 0, owner, owners.size(), 0, isBuy(gen) ? Side::Buy : Side::Sell,
+                                       static_cast<double>(quantity(gen)), ticksToPrice(midTicks + offset(gen))});
+        }
+        return flow;
+    }
+
+    int benchMatching()
+    {
+        const size_t ORDERS = 2000000;
+        const AccountId ACCOUNTS = 64;
+        std::vector<BookCommand> flow = makeOrderFlow(ORDERS, ACCOUNTS);
+
+        // 1. One book, called directly: the cost of matching itself
+        {
+            size_t fills = 0;
+            OrderBook book(0, [&fills](const BookEvent &event)
+                           {
+                               if (event.kind == BookEvent::Fill)
+                                   ++fills; });
+            auto start = BenchClock::now();
+            for (const auto &command : flow)
+            {
+                if (command.kind == BookCommand::Add)
+                    book.add(command);
+                else
+                    book.cancel(command.account, command.orderId, 0);
+            }
+            double elapsed = secondsSince(start);
+            printRate("OrderBook, direct", flow.size(), elapsed, "orders");
+            std::cout << "  fill events " << fills << ", resting " << book.size() << ", spread "
+                      << std::setprecision(2) << book.bestBid() << " / " << book.bestAsk() << std::endl;
+        }
+
+        // 2. One shard end to end: queue hand-off, matching and event delivery
+        {
+            MatchingEngine engine;
+            engine.start(1);
+
+            std::atomic<size_t> events(0);
+            std::atomic<bool> done(false);
+            const uint64_t SENTINEL = ~0ull;
+            for (AccountId i = 0; i < ACCOUNTS; ++i)
+            {
+                engine.registerAccount([&](const BookEvent &event)
+                                       {
+                                           events.fetch_add(1, std::memory_order_relaxed);
+                                           if (event.requestId == SENTINEL)
+                                               done.store(true, std::memory_order_release); });
+            }
+
+            auto start = BenchClock::now();
+            for (const auto &command : flow)
+            {
+                engine.submit(command);
+            }
+            // The shard applies commands in order, so this rejection arrives last
+            engine.submit(BookCommand{BookCommand::Cancel, 0, 1, 0, SENTINEL, Side::Buy, 0.0, 0.0});
+            while (!done.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            double elapsed = secondsSince(start);
+            engine.stop();
+
+            printRate("MatchingEngine, 1 shard", flow.size(), elapsed, "orders");
+            std::cout << "  events delivered " << events.load() << std::endl;
+        }
+        return 0;
+    }
+
+    // Arm one random stop around the current price: fixed or trailing, either side
+    void armRandomStop(TriggerIndex &index, TriggerIndex::Handle handle, int64_t priceTicks, std::mt19937_64 &gen)
+    {
+        std::uniform_int_distribution<int> kind(0, 9);
+        std::uniform_int_distribution<int64_t> offset(1, 2000);
+        std::uniform_int_distribution<int64_t> trail(1, 500);
+        int choice = kind(gen);
+        if (choice < 4)
+            index.arm(handle, TriggerIndex::FiresOnFall, priceTicks - offset(gen));
+        else if (choice < 8)
+            index.arm(handle, TriggerIndex::FiresOnRise, priceTicks + offset(gen));
+        else
+            index.armTrailing(handle, choice == 8 ? TriggerIndex::FiresOnFall : TriggerIndex::FiresOnRise, trail(gen));
+    }
+
+    int benchTriggers()
+    {
+        const uint32_t STOPS = 1000000;
+        const size_t TICKS = 1000000;
+        std::mt19937_64 gen(7);
+        std::uniform_int_distribution<int64_t> step(-3, 3);
+
+        // A random walk of prices in ticks, generated up front
+        std::vector<int64_t> prices(TICKS);
+        int64_t priceTicks = 100000;
+        for (auto &price : prices)
+        {
+            priceTicks += step(gen);
+            price = priceTicks;
+        }
+
+        // 1. The trigger index with 1M armed stops; fired stops are re-armed so the count stays at 1M
+        {
+            TriggerIndex index;
+            std::vector<TriggerIndex::Handle> fired;
+            index.onPrice(100000, fired);
+            for (uint32_t handle = 0; handle < STOPS; ++handle)
+            {
+                armRandomStop(index, handle, 100000, gen);
+            }
+
+            size_t triggered = 0;
+            auto start = BenchClock::now();
+            for (int64_t price : prices)
+            {
+                fired.clear();
+                index.onPrice(price, fired);
+                triggered += fired.size();
+                for (TriggerIndex::Handle handle : fired)
+                {
+                    armRandomStop(index, handle, price, gen);
+                }
+            }
+            double elapsed = secondsSince(start);
+            printRate("TriggerIndex, 1M armed stops", TICKS, elapsed, "ticks");
+            printRate("  stops fired and re-armed", triggered, elapsed, "stops");
+            std::cout << "  armed at end " << index.size() << std::endl;
+        }
+
+        // 2. The linear scan it replaces, over fixed stops only, for a few ticks
+        {
+            std::vector<std::pair<int64_t, bool>> stops(STOPS); // (trigger, firesOnRise)
+            for (auto &stop : stops)
+            {
+                stop.second = (gen() & 1) != 0;
+                stop.first = stop.second ? 100000 + (gen() % 2000) + 1 : 100000 - static_cast<int64_t>(gen() % 2000) - 1;
+            }
+
+            const size_t SCAN_TICKS = 200;
+            size_t triggered = 0;
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < SCAN_TICKS; ++i)
+            {
+                int64_t price = prices[i];
+                for (const auto &stop : stops)
+                {
+                    if (stop.second ? price >= stop.first : price <= stop.first)
+                        ++triggered;
+                }
+            }
+            double elapsed = secondsSince(start);
+            printRate("Linear scan, 1M stops", SCAN_TICKS, elapsed, "ticks");
+            std::cout << "  (" << triggered << " crossings counted, nothing removed)" << std::endl;
+        }
+        return 0;
+    }
+
+    // Write a random-walk candle history in the candles_history.dat layout
+    void writeRandomWalkHistory(const std::string &path, size_t count, uint64_t seed)
+    {
+        std::mt19937_64 gen(seed);
+        std::normal_distribution<double> move(0.0, 0.002);
+        std::vector<Candle> candles(count);
+        double price = 1000.0;
+        for (auto &candle : candles)
+        {
+            candle.open = price;
+            double a = price * (1.0 + move(gen));
+            double b = price * (1.0 + move(gen));
+            price *= 1.0 + move(gen);
+            candle.high = std::max({candle.open, a, b, price});
+            candle.low = std::min({candle.open, a, b, price});
+            candle.close = price;
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(candles.data()), candles.size() * sizeof(Candle));
+    }
+
+    // Keeps a limit buy under and a limit sell over the market, so every
+    // candle also runs through the order book
+    class BandQuoteStrategy : public Strategy
+    {
+    public:
+        std::string name() const override { return "band_quote"; }
+
+        void onCandle(Backtest &backtest, const Candle &candle, size_t index) override
+        {
+            if (backtest.openOrders() != 0)
+                return;
+            if (backtest.availableShares() >= 1.0)
+                backtest.limitSell(backtest.availableShares(), candle.close * 1.01);
+            else
+                backtest.limitBuy(10.0, candle.close * 0.99);
+        }
+    };
+
+    int benchBacktest()
+    {
+        const size_t CANDLES = 10000000;
+        std::string path = (fs::temp_directory_path() / "indinexus_bench_candles.dat").string();
+
+        writeRandomWalkHistory(path, CANDLES, 11);
+        CandleHistory history;
+        if (!history.open(path) || history.size() != CANDLES)
+        {
+            std::cerr << "Could not map " << path << std::endl;
+            return 1;
+        }
+
+        BacktestConfig config;
+        Backtest backtest(config);
+        StrategyParams params;
+        std::vector<std::unique_ptr<Strategy>> strategies;
+        strategies.push_back(makeStrategy("sma_cross", params));
+        params.period = 14;
+        strategies.push_back(makeStrategy("rsi", params));
+        strategies.push_back(std::make_unique<BandQuoteStrategy>());
+
+        for (auto &strategy : strategies)
+        {
+            auto start = BenchClock::now();
+            BacktestResult result = backtest.run(history.data(), history.size(), *strategy);
+            double elapsed = secondsSince(start);
+            printRate("Backtest, " + result.strategy, result.candles, elapsed, "candles");
+            std::cout << "  fills " << result.fills << ", return " << std::setprecision(2) << result.totalReturn
+                      << "%, max drawdown " << result.maxDrawdown << "%" << std::endl;
+        }
+
+        history.close();
+        fs::remove(path);
+        return 0;
+    }
+
+    int benchSweep()
+    {
+        const size_t SYMBOLS = 8;
+        const size_t CANDLES = 500000;
+
+        std::vector<SweepSymbol> symbols(SYMBOLS);
+        std::vector<std::string> paths;
+        for (size_t i = 0; i < SYMBOLS; ++i)
+        {
+            paths.push_back((fs::temp_directory_path() / ("indinexus_bench_sweep_" + std::to_string(i) + ".dat")).string());
+            writeRandomWalkHistory(paths.back(), CANDLES, 100 + i);
+            symbols[i].symbol = "SYM" + std::to_string(i);
+            if (!symbols[i].history.open(paths.back()))
+            {
+                std::cerr << "Could not map " << paths.back() << std::endl;
+                return 1;
+            }
+        }
+
+        // Thread counts 1, 2, 4, ... up to the core count
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> threadCounts;
+        for (unsigned threads = 1; threads < cores; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(cores);
+
+        SweepGrid grid;
+        BacktestConfig config;
+        double baseline = 0.0;
+        for (unsigned threads : threadCounts)
+        {
+            WorkStealingPool pool(threads);
+            auto start = BenchClock::now();
+            std::vector<SweepRow> rows = runParameterSweep(symbols, grid, config, pool);
+            double elapsed = secondsSince(start);
+            if (threads == 1)
+                baseline = elapsed;
+
+            size_t runs = rows.size() * SYMBOLS;
+            printRate("Sweep, " + std::to_string(threads) + " thread(s)", runs * CANDLES, elapsed, "candles");
+            std::cout << "  " << runs << " backtests, speedup " << std::setprecision(2) << (elapsed > 0 ? baseline / elapsed : 0.0)
+                      << "x, best " << rows.front().strategy << std::endl;
+        }
+
+        for (auto &entry : symbols)
+            entry.history.close();
+        for (const auto &path : paths)
+            fs::remove(path);
+        return 0;
+    }
+
+    int benchIndicators()
+    {
+        const size_t CANDLES = 100000; // About 11 days of 10-second candles
+        const size_t FRAMES = 1000;
+        std::string path = (fs::temp_directory_path() / "indinexus_bench_indicators.dat").string();
+        writeRandomWalkHistory(path, CANDLES + FRAMES, 5);
+        CandleHistory history;
+        if (!history.open(path))
+        {
+            std::cerr << "Could not map " << path << std::endl;
+            return 1;
+        }
+        std::vector<Candle> candles(history.begin(), history.begin() + CANDLES);
+
+        // 1. One chart frame the old way: every index re-sums its window
+        {
+            auto start = BenchClock::now();
+            double checksum = 0.0;
+            for (size_t i = 0; i < candles.size(); ++i)
+            {
+                checksum += calculateMovingAverage(candles, CHART_MA_PERIOD, static_cast<int>(i));
+                if (i > 0)
+                    checksum += calculateRSI(candles, CHART_RSI_PERIOD, static_cast<int>(i));
+            }
+            double elapsed = secondsSince(start);
+            printRate("Per-frame recompute, 100k candles", 1, elapsed, "frames");
+            std::cout << "  (checksum " << std::setprecision(0) << checksum << ")" << std::endl;
+        }
+
+        // 2. Backfill the whole history once with the streaming indicators
+        SymbolIndicators indicators(CHART_MA_PERIOD, CHART_RSI_PERIOD);
+        {
+            auto start = BenchClock::now();
+            indicators.sync(candles);
+            printRate("Streaming backfill, SMA + RSI", candles.size(), secondsSince(start), "candles");
+        }
+
+        // 3. Frames that each add one closed candle
+        {
+            auto start = BenchClock::now();
+            for (size_t frame = 0; frame < FRAMES; ++frame)
+            {
+                candles.push_back(history[CANDLES + frame]);
+                indicators.sync(candles);
+            }
+            printRate("Streaming frame, one new candle", FRAMES, secondsSince(start), "frames");
+        }
+
+        // The streaming SMA must agree with the windowed one
+        double maxDifference = 0.0;
+        for (size_t i = CHART_MA_PERIOD - 1; i < candles.size(); ++i)
+        {
+            maxDifference = std::max(maxDifference, std::fabs(indicators.movingAverage()[i] - calculateMovingAverage(candles, CHART_MA_PERIOD, static_cast<int>(i))));
+        }
+        std::cout << "  max |streaming SMA - windowed SMA| " << std::scientific << std::setprecision(2) << maxDifference << std::fixed << std::endl;
+
+        history.close();
+        fs::remove(path);
+        return 0;
+    }
+
+    // One batch indicator: run writes the series checked against reference,
+    // which computes it candle by candle with the streaming indicators
+    struct BatchCase
+    {
+        const char *name;
+        std::function<void(std::vector<double> &)> run;
+        std::function<void(std::vector<double> &)> reference;
+    };
+
+    int benchBatchIndicators()
+    {
+        const size_t CANDLES = 1000000;
+        std::string path = (fs::temp_directory_path() / "indinexus_bench_batch.dat").string();
+        writeRandomWalkHistory(path, CANDLES, 17);
+        CandleHistory history;
+        if (!history.open(path) || history.size() != CANDLES)
+        {
+            std::cerr << "Could not map " << path << std::endl;
+            return 1;
+        }
+
+        CandleColumns columns(history.data(), history.size());
+        std::mt19937_64 gen(23);
+        std::uniform_real_distribution<double> volumes(1000.0, 100000.0);
+        columns.volume.resize(CANDLES);
+        for (double &volume : columns.volume)
+            volume = volumes(gen);
+
+        const double *high = columns.high.data();
+        const double *low = columns.low.data();
+        const double *close = columns.close.data();
+        std::vector<double> second(CANDLES);
+        std::vector<double> third(CANDLES);
+
+        const BatchCase cases[] = {
+            {"SMA(20)", [&](std::vector<double> &out)
+             { smaBatch(close, CANDLES, 20, out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingSma sma(20); for (size_t i = 0; i < CANDLES; ++i) out[i] = sma.update(close[i]); }},
+            {"EMA(20)", [&](std::vector<double> &out)
+             { emaBatch(close, CANDLES, 20, out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingEma ema(20); for (size_t i = 0; i < CANDLES; ++i) out[i] = ema.update(close[i]); }},
+            {"RSI(14)", [&](std::vector<double> &out)
+             { rsiBatch(close, CANDLES, 14, out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingRsi rsi(14); for (size_t i = 0; i < CANDLES; ++i) out[i] = rsi.update(close[i]); }},
+            {"MACD(12,26,9) histogram", [&](std::vector<double> &out)
+             { macdBatch(close, CANDLES, 12, 26, 9, second.data(), third.data(), out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingMacd macd; for (size_t i = 0; i < CANDLES; ++i) { macd.update(close[i]); out[i] = macd.histogram(); } }},
+            {"Bollinger(20,2) upper", [&](std::vector<double> &out)
+             { bollingerBatch(close, CANDLES, 20, 2.0, second.data(), out.data(), third.data()); },
+             [&](std::vector<double> &out)
+             { StreamingBollinger bands; for (size_t i = 0; i < CANDLES; ++i) { bands.update(close[i]); out[i] = bands.upper(); } }},
+            {"ATR(14)", [&](std::vector<double> &out)
+             { atrBatch(high, low, close, CANDLES, 14, out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingAtr atr(14); for (size_t i = 0; i < CANDLES; ++i) out[i] = atr.update(history[i]); }},
+            {"Stochastic(14,3) %D", [&](std::vector<double> &out)
+             { stochasticBatch(high, low, close, CANDLES, 14, 3, second.data(), out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingStochastic stochastic; for (size_t i = 0; i < CANDLES; ++i) { stochastic.update(history[i]); out[i] = stochastic.d(); } }},
+            {"VWAP", [&](std::vector<double> &out)
+             { vwapBatch(high, low, close, columns.volume.data(), CANDLES, out.data()); },
+             [&](std::vector<double> &out)
+             { StreamingVwap vwap; for (size_t i = 0; i < CANDLES; ++i) out[i] = vwap.update(history[i], columns.volume[i]); }},
+        };
+
+        bool simd = batchSimdAvailable();
+        if (!simd)
+            std::cout << "  (no AVX2 on this CPU: scalar kernels only)" << std::endl;
+
+        std::vector<double> batch(CANDLES);
+        std::vector<double> reference(CANDLES);
+        for (const BatchCase &entry : cases)
+        {
+            auto start = BenchClock::now();
+            entry.reference(reference);
+            printRate(std::string("Streaming ") + entry.name, CANDLES, secondsSince(start), "candles");
+
+            for (int pass = 0; pass < (simd ? 2 : 1); ++pass)
+            {
+                setBatchSimdEnabled(pass == 1);
+                start = BenchClock::now();
+                entry.run(batch);
+                printRate(std::string("Batch ") + (pass == 1 ? "AVX2 " : "scalar ") + entry.name, CANDLES, secondsSince(start), "candles");
+
+                double maxDifference = 0.0;
+                for (size_t i = 0; i < CANDLES; ++i)
+                    maxDifference = std::max(maxDifference, std::fabs(batch[i] - reference[i]));
+                std::cout << "  max |batch - streaming| " << std::scientific << std::setprecision(2) << maxDifference << std::fixed << std::endl;
+            }
+        }
+        setBatchSimdEnabled(simd);
+
+        history.close();
+        fs::remove(path);
+        return 0;
+    }
+
+    int benchFixedPeriods()
+    {
+        const size_t CANDLES = 2000000;
+        std::string path = (fs::temp_directory_path() / "indinexus_bench_fixed.dat").string();
+        writeRandomWalkHistory(path, CANDLES, 29);
+        CandleHistory history;
+        if (!history.open(path) || history.size() != CANDLES)
+        {
+            std::cerr << "Could not map " << path << std::endl;
+            return 1;
+        }
+
+        using SeriesFunction = void (*)(const Candle *, size_t, int, double *);
+        struct Kernel
+        {
+            const char *name;
+            SeriesFunction generic;
+            SeriesFunction fixed;
+        };
+        const Kernel kernels[] = {
+            {"SMA", genericSmaSeries, smaSeries},
+            {"EMA", genericEmaSeries, emaSeries},
+            {"RSI", genericRsiSeries, rsiSeries},
+        };
+
+        // Fault the mapping in first so neither side pays for it
+        std::vector<double> generic(CANDLES);
+        std::vector<double> fixed(CANDLES);
+        smaSeries(history.data(), CANDLES, FIXED_PERIODS[0], fixed.data());
+
+        for (const Kernel &kernel : kernels)
+        {
+            for (int period : FIXED_PERIODS)
+            {
+                std::string label = std::string(kernel.name) + "(" + std::to_string(period) + ")";
+                auto start = BenchClock::now();
+                kernel.generic(history.data(), CANDLES, period, generic.data());
+                double genericSeconds = secondsSince(start);
+                start = BenchClock::now();
+                kernel.fixed(history.data(), CANDLES, period, fixed.data());
+                double fixedSeconds = secondsSince(start);
+
+                printRate(label + " runtime period", CANDLES, genericSeconds, "candles");
+                printRate(label + " fixed period", CANDLES, fixedSeconds, "candles");
+                double maxDifference = 0.0;
+                for (size_t i = 0; i < CANDLES; ++i)
+                    maxDifference = std::max(maxDifference, std::fabs(generic[i] - fixed[i]));
+                std::cout << "  speedup " << std::setprecision(2) << (fixedSeconds > 0 ? genericSeconds / fixedSeconds : 0.0)
+                          << "x, max difference " << std::scientific << maxDifference << std::fixed << std::endl;
+            }
+        }
+
+        history.close();
+        fs::remove(path);
+        return 0;
+    }
+
+    int benchScreener()
+    {
+        const size_t SYMBOLS = 5000;
+        const size_t CANDLES = 500;
+        const size_t ROUNDS = 20;
+
+        // A universe of random walks, kept in memory as candlesMap is
+        std::map<std::string, std::vector<Candle>> candles;
+        std::mt19937_64 gen(31);
+        std::normal_distribution<double> move(0.0, 0.01);
+        auto nextCandle = [&](double open)
+        {
+            double close = open * (1.0 + move(gen));
+            return Candle{open, std::max(open, close) * 1.002, std::min(open, close) * 0.998, close};
+        };
+        for (size_t s = 0; s < SYMBOLS; ++s)
+        {
+            std::vector<Candle> &history = candles["SYM" + std::to_string(s)];
+            history.reserve(CANDLES + ROUNDS);
+            double price = 1000.0;
+            for (size_t i = 0; i < CANDLES; ++i)
+            {
+                history.push_back(nextCandle(price));
+                price = history.back().close;
+            }
+        }
+
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        WorkStealingPool pool(cores);
+        ScreenCriteria criteria;
+        std::map<std::string, SymbolIndicators> indicators;
+
+        // First scan: every symbol backfills its indicators
+        auto start = BenchClock::now();
+        std::vector<ScreenHit> hits = scanSymbols(candles, indicators, criteria, pool);
+        double elapsed = secondsSince(start);
+        printRate("Scan with backfill, 5k x 500", SYMBOLS, elapsed, "symbols");
+        std::cout << "  " << std::setprecision(2) << elapsed * 1000.0 << " ms, " << hits.size() << " matches" << std::endl;
+
+        // Later scans: one new candle per symbol since the last one
+        double total = 0.0;
+        for (size_t round = 0; round < ROUNDS; ++round)
+        {
+            for (auto &pair : candles)
+                pair.second.push_back(nextCandle(pair.second.back().close));
+            start = BenchClock::now();
+            hits = scanSymbols(candles, indicators, criteria, pool);
+            total += secondsSince(start);
+        }
+        printRate("Incremental scan, one new candle", SYMBOLS * ROUNDS, total, "symbols");
+        std::cout << "  " << std::setprecision(2) << total * 1000.0 / ROUNDS << " ms per scan on " << pool.size()
+                  << " threads, " << hits.size() << " matches" << std::endl;
+        return 0;
+    }
+
+    int benchChart()
+    {
+        const size_t FILE_FRAMES = 20;
+        const size_t FRAMES = 2000;
+        const std::string SYMBOL = "BENCHCHART";
+        std::string dir = fs::temp_directory_path().string();
+        std::mt19937_64 gen(37);
+        std::normal_distribution<double> move(0.0, 0.002);
+
+        for (size_t length : {1000, 10000, 100000, 1000000})
+        {
+            std::vector<Candle> history(length);
+            double price = 1000.0;
+            for (Candle &candle : history)
+            {
+                double close = price * (1.0 + move(gen));
+                candle = Candle{price, std::max(price, close), std::min(price, close), close};
+                price = close;
+            }
+            std::string label = std::to_string(length / 1000) + "k candles";
+
+            // Before: every series rewritten to a file in full with iostreams, each frame
+            if (length <= 100000)
+            {
+                std::vector<double> movingAverage = movingAverageSeries(history, CHART_MA_PERIOD);
+                std::vector<double> rsi = rsiSeries(history, CHART_RSI_PERIOD);
+                auto start = BenchClock::now();
+                for (size_t frame = 0; frame < FILE_FRAMES; ++frame)
+                {
+                    std::ofstream candlesFile(dir + "/indinexus_bench_candles_frame.dat");
+                    for (size_t i = 0; i < history.size(); ++i)
+                        candlesFile << i << " " << history[i].open << " " << history[i].high << " " << history[i].low << " " << history[i].close << "\n";
+                    std::ofstream maFile(dir + "/indinexus_bench_ma_frame.dat");
+                    for (size_t i = 0; i < movingAverage.size(); ++i)
+                        maFile << i << " " << movingAverage[i] << "\n";
+                    std::ofstream rsiFile(dir + "/indinexus_bench_rsi_frame.dat");
+                    for (size_t i = 1; i < rsi.size(); ++i)
+                        rsiFile << i << " " << rsi[i] << "\n";
+                }
+                printRate("Files, " + label, FILE_FRAMES, secondsSince(start), "frames");
+            }
+
+            // After: the visible window as datablocks into one reused buffer
+            {
+                std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(SYMBOL)).seriesLock);
+                candlesMap[SYMBOL] = std::move(history);
+                indicatorsMap.erase(SYMBOL);
+                ChartWindow window;
+                captureChartWindow(SYMBOL, CHART_VISIBLE_CANDLES, window); // Backfill outside the timing
+
+                std::string buffer;
+                auto start = BenchClock::now();
+                for (size_t frame = 0; frame < FRAMES; ++frame)
+                {
+                    captureChartWindow(SYMBOL, CHART_VISIBLE_CANDLES, window);
+                    buffer.clear();
+                    appendChartDatablocks(window, buffer);
+                }
+                printRate("Datablocks, " + label, FRAMES, secondsSince(start), "frames");
+                std::cout << "  " << buffer.size() << " bytes per frame" << std::endl;
+                candlesMap.erase(SYMBOL);
+                indicatorsMap.erase(SYMBOL);
+            }
+        }
+
+        for (const char *name : {"candles", "ma", "rsi"})
+            fs::remove(dir + "/indinexus_bench_" + name + "_frame.dat");
+        return 0;
+    }
+
+    int benchRender()
+    {
+        const size_t FRAMES = 1500;
+        const auto INTERVAL = std::chrono::milliseconds(1);
+        const std::string SYMBOL = "BENCHRENDER";
+        // Stands in for a gnuplot that is busy for a second before it reads anything
+        const char *SLOW_SINK = "sleep 1; cat > /dev/null";
+
+        {
+            std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(SYMBOL)).seriesLock);
+            std::vector<Candle> &history = candlesMap[SYMBOL];
+            double price = 1000.0;
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                double close = price * (1.0 + 0.001 * std::sin(i * 0.1));
+                history.push_back(Candle{price, std::max(price, close), std::min(price, close), close});
+                price = close;
+            }
+            indicatorsMap.erase(SYMBOL);
+        }
+
+        // Each frame's capture and hand-off, with the worst single frame
+        auto report = [](const std::string &label, const std::vector<double> &frameSeconds)
+        {
+            double total = std::accumulate(frameSeconds.begin(), frameSeconds.end(), 0.0);
+            double worst = *std::max_element(frameSeconds.begin(), frameSeconds.end());
+            printRate(label, frameSeconds.size(), total, "frames");
+            std::cout << "  worst frame " << std::fixed << std::setprecision(3) << worst * 1000.0 << " ms" << std::endl;
+        };
+
+        ChartWindow window;
+        std::vector<double> frameSeconds(FRAMES);
+
+        // Before: frames written from the posting thread, which waits whenever the pipe is full
+        {
+            FILE *pipe = popen(SLOW_SINK, "w");
+            if (pipe == nullptr)
+                return 1;
+            std::string buffer;
+            for (size_t frame = 0; frame < FRAMES; ++frame)
+            {
+                std::this_thread::sleep_for(INTERVAL);
+                auto start = BenchClock::now();
+                {
+                    std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(SYMBOL)).seriesLock);
+                    captureChartWindow(SYMBOL, CHART_VISIBLE_CANDLES, window);
+                }
+                buffer.clear();
+                appendGnuplotFrame(window, SYMBOL, buffer);
+                fwrite(buffer.data(), 1, buffer.size(), pipe);
+                fflush(pipe);
+                frameSeconds[frame] = secondsSince(start);
+            }
+            pclose(pipe);
+            report("Blocking writes", frameSeconds);
+        }
+
+        // After: frames posted from an event loop timer to a renderer writing the pipe as the
+        // loop finds it writable, dropping what it cannot keep up with
+        {
+            EventLoop loop;
+            ChartRenderer renderer(SYMBOL, SLOW_SINK, loop);
+            if (!renderer.isOpen())
+                return 1;
+            size_t frame = 0;
+            loop.addTimer(INTERVAL, [&](uint64_t)
+                          {
+                              auto start = BenchClock::now();
+                              {
+                                  std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(SYMBOL)).seriesLock);
+                                  captureChartWindow(SYMBOL, CHART_VISIBLE_CANDLES, window);
+                              }
+                              renderer.post(window);
+                              frameSeconds[frame] = secondsSince(start);
+                              if (++frame == FRAMES)
+                                  loop.stop(); });
+            loop.run();
+            report("Event loop", frameSeconds);
+            std::cout << "  " << renderer.framesRendered() << " rendered, " << renderer.framesDropped()
+                      << " dropped so far" << std::endl;
+        }
+
+        std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(SYMBOL)).seriesLock);
+        candlesMap.erase(SYMBOL);
+        indicatorsMap.erase(SYMBOL);
+        return 0;
+    }
+
+    int benchTerminalChart()
+    {
+        const size_t FRAMES = 2000;
+        const std::string SYMBOL = "BENCHTERM";
+        std::mt19937_64 gen(40);
+        std::normal_distribution<double> move(0.0, 0.004);
+
+        ChartWindow window;
+        {
+            std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(SYMBOL)).seriesLock);
+            std::vector<Candle> &history = candlesMap[SYMBOL];
+            double price = 1000.0;
+            for (size_t i = 0; i < 500; ++i)
+            {
+                double close = price * (1.0 + move(gen));
+                history.push_back(Candle{price, std::max(price, close) * 1.001, std::min(price, close) * 0.999, close});
+                price = close;
+            }
+            indicatorsMap.erase(SYMBOL);
+            captureChartWindow(SYMBOL, CHART_VISIBLE_CANDLES, window);
+            candlesMap.erase(SYMBOL);
+            indicatorsMap.erase(SYMBOL);
+        }
+
+        // Frames go to the null device, each in one call as they would to the terminal
+        FILE *sink = fopen(
+#ifdef _WIN32
+            "NUL",
+#else
+            "/dev/null",
+#endif
+            "wb");
+        if (sink == nullptr)
+            return 1;
+
+        TerminalChart chart;
+        std::string buffer;
+        for (auto size : {std::make_pair(80, 24), std::make_pair(200, 50), std::make_pair(400, 100)})
+        {
+            TerminalArea area;
+            area.width = size.first;
+            area.height = size.second;
+            auto start = BenchClock::now();
+            for (size_t frame = 0; frame < FRAMES; ++frame)
+            {
+                buffer.clear();
+                chart.appendFrame(window, SYMBOL, area, buffer);
+                fwrite(buffer.data(), 1, buffer.size(), sink);
+                fflush(sink);
+            }
+            printRate(std::to_string(area.width) + "x" + std::to_string(area.height) + " cells", FRAMES,
+                      secondsSince(start), "frames");
+            std::cout << "  " << buffer.size() << " bytes per frame" << std::endl;
+        }
+        fclose(sink);
+        return 0;
+    }
+
+    int benchExport()
+    {
+        const size_t SYMBOLS = 5000;
+        const size_t CANDLES = 1000;
+
+        // Histories go under a scratch data/ so the export finds them where it looks
+        fs::path previous = fs::current_path();
+        fs::path root = fs::temp_directory_path() / "indinexus_bench_export";
+        fs::remove_all(root);
+        std::vector<std::string> symbols;
+        for (size_t i = 0; i < SYMBOLS; ++i)
+        {
+            std::string symbol = "SYM" + std::to_string(i);
+            fs::create_directories(root / "data" / "stock_data" / symbol);
+            writeRandomWalkHistory((root / "data" / "stock_data" / symbol / "candles_history.dat").string(), CANDLES, 1000 + i);
+            symbols.push_back(symbol);
+        }
+        fs::current_path(root);
+
+        WorkStealingPool pool;
+        for (unsigned formats : {unsigned(CHART_SVG), unsigned(CHART_PNG)})
+        {
+            ChartExportSettings settings;
+            settings.formats = formats;
+            auto start = BenchClock::now();
+            ChartExportSummary summary = exportCharts(symbols, settings, pool);
+            double seconds = secondsSince(start);
+            printRate(std::string(formats == CHART_SVG ? "SVG" : "PNG") + ", " + std::to_string(pool.size()) + " threads",
+                      summary.charts, seconds, "charts");
+            std::cout << "  " << (summary.charts ? summary.bytes / summary.charts : 0) << " bytes per chart, "
+                      << summary.failed.size() << " failed" << std::endl;
+        }
+
+        fs::current_path(previous);
+        fs::remove_all(root);
+        return 0;
+    }
+
+    int benchDownsample()
+    {
+        const size_t CANDLES = 1000000; // About 116 days of 10-second candles
+        const size_t FRAMES = 10;
+        const std::string SYMBOL = "BENCHZOOM";
+
+        // The history goes under a scratch data/ so the reader finds it where it looks
+        fs::path previous = fs::current_path();
+        fs::path root = fs::temp_directory_path() / "indinexus_bench_zoom";
+        fs::remove_all(root);
+        fs::create_directories(root / "data" / "stock_data" / SYMBOL);
+        writeRandomWalkHistory((root / "data" / "stock_data" / SYMBOL / "candles_history.dat").string(), CANDLES, 42);
+        fs::current_path(root);
+
+        ChartHistoryReader reader(SYMBOL);
+        reader.refresh();
+        ChartWindow window;
+        std::string buffer;
+        std::vector<std::pair<size_t, std::string>> ranges;
+        for (const ChartZoomLevel &level : CHART_ZOOM_LEVELS)
+            ranges.emplace_back(level.candles, level.label);
+        ranges.emplace_back(CANDLES, "all 1M candles");
+
+        // Each frame reads the range from the mapped history and writes a whole gnuplot frame,
+        // first with every candle and then reduced to the window's pixel width
+        for (const auto &range : ranges)
+        {
+            for (size_t width : {range.first, GNUPLOT_CHART_PIXELS})
+            {
+                auto start = BenchClock::now();
+                for (size_t frame = 0; frame < FRAMES; ++frame)
+                {
+                    reader.window(range.first, width, window);
+                    buffer.clear();
+                    appendGnuplotFrame(window, SYMBOL, buffer);
+                }
+                printRate(range.second + (width == range.first ? ", every candle" : ", downsampled"), FRAMES,
+                          secondsSince(start), "frames");
+                std::cout << "  " << window.candles.size() << " entries, " << buffer.size() << " bytes per frame" << std::endl;
+                if (range.first <= GNUPLOT_CHART_PIXELS)
+                    break; // Nothing to reduce
+            }
+        }
+
+        fs::current_path(previous);
+        fs::remove_all(root);
+        return 0;
+    }
+
+    // Seven marked holdings and two resting orders on each, like a busy session
+    void makeBenchAccount(User &user, std::vector<SymbolId> &held)
+    {
+        user.username = "bench";
+        user.demoMoney = 100000.0;
+        user.initialDemoMoney = 100000.0;
+        for (const char *symbol : {"RELYCORP", "TECHSOL", "INFOWAVE", "NDFBANK", "FMCGUNION", "METALWORKS", "SAFEBANK"})
+        {
+            held.push_back(internSymbol(symbol));
+            user.holdings.buy(held.back(), 10.0, 1000.0);
+            Order order{0, symbol, "Limit_Buy", 5.0, 900.0};
+            user.pendingOrders.add(order);
+            order.type = "Stop_Sell";
+            order.stopPrice = 950.0;
+            user.pendingOrders.add(order);
+        }
+    }
+
+    FILE *openNullSink()
+    {
+        return fopen(
+#ifdef _WIN32
+            "NUL",
+#else
+            "/dev/null",
+#endif
+            "wb");
+    }
+
+    int benchPortfolio()
+    {
+        const size_t FRAMES = 20000;
+        const int SCREEN_WIDTH = 200;
+        const int SCREEN_HEIGHT = 60;
+
+        User user;
+        std::vector<SymbolId> held;
+        makeBenchAccount(user, held);
+        PortfolioSnapshots snapshots;
+
+        FILE *sink = openNullSink();
+        if (sink == nullptr)
+            return 1;
+
+        // Every frame re-marks each holding, as a second of the simulation would
+        std::mt19937_64 gen(43);
+        std::normal_distribution<double> move(0.0, 0.002);
+        std::vector<double> prices(held.size(), 1000.0);
+        for (bool diff : {false, true})
+        {
+            ScreenBuffer screen;
+            std::string frame;
+            int lastLineUsed = 0;
+            int maximumHoldingsCount = 0;
+            int maximumPendingOrdersCount = 0;
+            size_t bytes = 0;
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < FRAMES; ++i)
+            {
+                for (size_t h = 0; h < held.size(); ++h)
+                {
+                    prices[h] *= 1.0 + move(gen);
+                    user.holdings.markPrice(held[h], std::round(prices[h] * 100.0) / 100.0);
+                }
+                capturePortfolio(user, 0.0, 0.0, snapshots.back());
+                snapshots.publish();
+                composePortfolio(snapshots.latest(), SCREEN_WIDTH, SCREEN_HEIGHT, lastLineUsed, maximumHoldingsCount,
+                                 maximumPendingOrdersCount, screen);
+                if (!diff)
+                    screen.invalidate(); // Every line rewritten, as the panel used to be
+                frame.clear();
+                screen.present(frame);
+                fwrite(frame.data(), 1, frame.size(), sink);
+                fflush(sink);
+                bytes += frame.size();
+            }
+            printRate(diff ? "Changed spans" : "Full redraw", FRAMES, secondsSince(start), "frames");
+            std::cout << "  " << bytes / FRAMES << " bytes per frame" << std::endl;
+        }
+        fclose(sink);
+        return 0;
+    }
+
+    int benchSnapshot()
+    {
+        const size_t MARKS = 20000;
+        const auto MARK_GAP = std::chrono::microseconds(20);
+        const int SCREEN_WIDTH = 200;
+        const int SCREEN_HEIGHT = 60;
+
+        User user;
+        std::vector<SymbolId> held;
+        makeBenchAccount(user, held);
+
+        FILE *sink = openNullSink();
+        if (sink == nullptr)
+            return 1;
+
+        // The engine thread wakes every few microseconds to re-mark a holding under
+        // the account lock while the UI thread draws the panel flat out: under that
+        // lock, as it used to, or from published snapshots with no lock at all
+        for (bool snapshot : {false, true})
+        {
+            std::mutex accountLock;
+            PortfolioSnapshots snapshots;
+            capturePortfolio(user, 0.0, 0.0, snapshots.back());
+            snapshots.publish();
+            std::atomic<bool> done(false);
+            size_t panels = 0;
+
+            std::thread ui([&]
+                           {
+                               ScreenBuffer screen;
+                               std::string frame;
+                               int lastLineUsed = 0;
+                               int maximumHoldingsCount = 0;
+                               int maximumPendingOrdersCount = 0;
+                               PortfolioSnapshot locked;
+                               while (!done.load(std::memory_order_acquire))
+                               {
+                                   if (snapshot)
+                                   {
+                                       composePortfolio(snapshots.latest(), SCREEN_WIDTH, SCREEN_HEIGHT, lastLineUsed,
+                                                        maximumHoldingsCount, maximumPendingOrdersCount, screen);
+                                   }
+                                   else
+                                   {
+                                       std::lock_guard<std::mutex> lock(accountLock);
+                                       capturePortfolio(user, 0.0, 0.0, locked);
+                                       composePortfolio(locked, SCREEN_WIDTH, SCREEN_HEIGHT, lastLineUsed,
+                                                        maximumHoldingsCount, maximumPendingOrdersCount, screen);
+                                   }
+                                   frame.clear();
+                                   screen.present(frame);
+                                   fwrite(frame.data(), 1, frame.size(), sink);
+                                   ++panels;
+                               } });
+
+            std::mt19937_64 gen(44);
+            std::normal_distribution<double> move(0.0, 0.002);
+            std::vector<double> prices(held.size(), 1000.0);
+            size_t contended = 0;
+            double totalWait = 0.0;
+            double longestWait = 0.0;
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < MARKS; ++i)
+            {
+                // Only acquisitions that find the lock taken are timed, so being
+                // preempted is not counted as waiting
+                std::unique_lock<std::mutex> lock(accountLock, std::try_to_lock);
+                if (!lock.owns_lock())
+                {
+                    auto waitStart = BenchClock::now();
+                    lock.lock();
+                    double wait = secondsSince(waitStart);
+                    ++contended;
+                    totalWait += wait;
+                    longestWait = std::max(longestWait, wait);
+                }
+
+                size_t h = i % held.size();
+                prices[h] *= 1.0 + move(gen);
+                user.holdings.markPrice(held[h], std::round(prices[h] * 100.0) / 100.0);
+                lock.unlock();
+
+                if (snapshot)
+                {
+                    capturePortfolio(user, 0.0, 0.0, snapshots.back());
+                    snapshots.publish();
+                }
+                std::this_thread::sleep_for(MARK_GAP);
+            }
+            double seconds = secondsSince(start);
+            done.store(true, std::memory_order_release);
+            ui.join();
+
+            printRate(snapshot ? "Snapshot: marks" : "Account lock: marks", MARKS, seconds, "marks");
+            std::cout << "  " << contended << " marks waited for the account lock, " << std::setprecision(1)
+                      << totalWait * 1e3 << " ms in all, " << longestWait * 1e6 << " us longest; "
+                      << panels << " panels drawn" << std::endl;
+        }
+        fclose(sink);
+        return 0;
+    }
+
+    // Percentile of sorted latencies, in microseconds
+    double percentileMicros(const std::vector<double> &sorted, double fraction)
+    {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))] * 1e6;
+    }
+
+    int benchInput()
+    {
+#ifdef _WIN32
+        std::cerr << "The input benchmark needs pipes" << std::endl;
+        return 1;
+#else
+        const size_t ORDERS = 2000;
+        const std::string SYMBOL = "BENCHINPUT";
+        const std::string ORDER = "buy 1\n";
+        SymbolId symbolId = internSymbol(SYMBOL);
+        symbolMarket(symbolId).latest.publish(1000.0); // Market orders fill at the latest tick
+
+        // Prompts and results go nowhere; only their timing matters
+        std::ostringstream discarded;
+        std::streambuf *console = std::cout.rdbuf(discarded.rdbuf());
+
+        // A market buy typed on a line of its own is timed from the write that finishes
+        // the line until its result has been shown, one order at a time
+        std::vector<double> latencies(ORDERS);
+        auto report = [&](const std::string &label, double seconds)
+        {
+            std::cout.rdbuf(console);
+            std::sort(latencies.begin(), latencies.end());
+            printRate(label, ORDERS, seconds, "orders");
+            std::cout << "  input to acknowledge " << std::fixed << std::setprecision(1) << percentileMicros(latencies, 0.5)
+                      << " us median, " << percentileMicros(latencies, 0.99) << " us p99, "
+                      << latencies.back() * 1e6 << " us worst" << std::endl;
+            std::cout.rdbuf(discarded.rdbuf());
+            discarded.str("");
+        };
+
+        for (bool eventLoop : {false, true})
+        {
+            int input[2];
+            int acks[2];
+            if (pipe(input) != 0 || pipe(acks) != 0)
+                return 1;
+
+            User user;
+            user.username = "bench";
+            user.demoMoney = 1e12;
+            TradingEngine engine(&user);
+            BenchClock::time_point typed;
+            size_t acknowledged = 0;
+            auto acknowledge = [&]()
+            {
+                latencies[acknowledged++] = secondsSince(typed);
+                char byte = 0;
+                ssize_t written = write(acks[1], &byte, 1);
+                (void)written;
+            };
+
+            // The typist: one order, then wait for its acknowledgement
+            auto typist = [&]()
+            {
+                for (size_t i = 0; i < ORDERS; ++i)
+                {
+                    typed = BenchClock::now();
+                    ssize_t written = write(input[1], ORDER.data(), ORDER.size());
+                    char byte;
+                    ssize_t received = read(acks[0], &byte, 1);
+                    (void)written;
+                    (void)received;
+                }
+                close(input[1]);
+            };
+
+            auto start = BenchClock::now();
+            if (!eventLoop)
+            {
+                // Before: an input thread blocked reading tokens, as from std::cin, and
+                // results printed from the engine's thread
+                engine.setResultListener([&](const TradeResult &result)
+                                         {
+                                             {
+                                                 std::lock_guard<std::mutex> consoleLock(consoleMutex);
+                                                 moveCursor(2, 9);
+                                                 std::cout << CLEARLINE << result.message;
+                                                 moveCursor(2, 10);
+                                                 std::cout << CLEARLINE << result.detail;
+                                             }
+                                             acknowledge(); });
+                engine.start();
+                std::thread reader([&]
+                                   {
+                                       FILE *in = fdopen(input[0], "r");
+                                       char action[64];
+                                       char amount[64];
+                                       while (fscanf(in, "%63s %63s", action, amount) == 2)
+                                       {
+                                           TradeCommand command{CommandType::MarketBuy, symbolId, std::stod(amount), 0.0, 0, 0, {}};
+                                           command.submitted = BenchClock::now();
+                                           engine.submit(command);
+                                       }
+                                       fclose(in); });
+                typist();
+                reader.join();
+            }
+            else
+            {
+                // After: the line editor and order entry on an event loop watching the input,
+                // with results posted back to the loop
+                int savedInput = dup(STDIN_FILENO);
+                dup2(input[0], STDIN_FILENO);
+                close(input[0]);
+                {
+                    EventLoop loop;
+                    LineEditor editor;
+                    std::atomic<size_t> zoom(0);
+                    OrderEntry entry(&engine, SYMBOL, zoom, editor);
+                    engine.setResultListener([&](const TradeResult &result)
+                                             { loop.post([&, result]
+                                                         {
+                                                             entry.showResult(result);
+                                                             acknowledge(); }); });
+                    engine.start();
+
+                    std::vector<std::string> tokens;
+                    loop.watchReadable(editor.fd(), [&]
+                                       {
+                                           bool open = editor.read(tokens);
+                                           for (const std::string &token : tokens)
+                                               entry.onToken(token);
+                                           tokens.clear();
+                                           if (!open)
+                                               loop.stop(); });
+                    entry.start();
+                    std::thread typing(typist);
+                    loop.run();
+                    typing.join();
+                    engine.stop();
+                }
+                dup2(savedInput, STDIN_FILENO);
+                close(savedInput);
+            }
+            double seconds = secondsSince(start);
+            engine.stop();
+            close(acks[0]);
+            close(acks[1]);
+            report(eventLoop ? "Event loop" : "Blocking input thread", seconds);
+        }
+
+        std::cout.rdbuf(console);
+        return 0;
+#endif
+    }
+
+    int benchShards()
+    {
+        const size_t SYMBOLS = 1000;
+        const size_t WRITERS = 4;
+        const size_t READERS = 2;
+        const size_t PASSES = 200; // Two seconds at 100 Hz
+        const auto TICK = std::chrono::milliseconds(10);
+        const auto CHART_GAP = std::chrono::milliseconds(5);
+
+        std::vector<std::string> names(SYMBOLS);
+        std::vector<SymbolMarket *> markets(SYMBOLS);
+        for (size_t i = 0; i < SYMBOLS; ++i)
+        {
+            names[i] = "BENCHSHARD" + std::to_string(i);
+            markets[i] = &symbolMarket(internSymbol(names[i]));
+        }
+
+        // Writer threads tick their share of the symbols 100 times a second while readers
+        // look up latest prices flat out, as market orders and marking do, and a chart copies
+        // one symbol's window every few milliseconds. Before: every series behind one mutex,
+        // the latest price read from the series under it. After: each symbol's series behind
+        // its own lock, and the latest price read from its tick with no lock at all.
+        for (bool sharded : {false, true})
+        {
+            std::mutex globalLock;
+            std::map<std::string, std::vector<double>> series;
+            for (const std::string &name : names)
+            {
+                std::vector<double> &prices = series[name];
+                prices.reserve(PASSES + 1);
+                prices.push_back(1000.0);
+            }
+            auto seriesLock = [&](size_t symbol) -> std::mutex &
+            {
+                return sharded ? markets[symbol]->seriesLock : globalLock;
+            };
+            std::atomic<bool> done(false);
+
+            struct WriterStats
+            {
+                size_t contended = 0;
+                double totalWait = 0.0;
+                double longestWait = 0.0;
+                double worstPass = 0.0;
+                size_t late = 0; // Passes that ran into the next tick
+            };
+            std::vector<WriterStats> stats(WRITERS);
+            std::vector<size_t> reads(READERS);
+
+            std::vector<std::thread> readers;
+            for (size_t r = 0; r < READERS; ++r)
+            {
+                readers.emplace_back([&, r]
+                                     {
+                                         std::mt19937_64 gen(60 + r);
+                                         std::uniform_int_distribution<size_t> pick(0, SYMBOLS - 1);
+                                         size_t count = 0;
+                                         while (!done.load(std::memory_order_acquire))
+                                         {
+                                             size_t symbol = pick(gen);
+                                             double price;
+                                             if (sharded)
+                                             {
+                                                 price = markets[symbol]->latest.read().price;
+                                             }
+                                             else
+                                             {
+                                                 std::lock_guard<std::mutex> lock(globalLock);
+                                                 price = series.find(names[symbol])->second.back();
+                                             }
+                                             count += price > 0.0 ? 1 : 0;
+                                         }
+                                         reads[r] = count; });
+            }
+            std::thread chart([&]
+                              {
+                                  std::vector<double> window;
+                                  while (!done.load(std::memory_order_acquire))
+                                  {
+                                      {
+                                          std::lock_guard<std::mutex> lock(seriesLock(0));
+                                          const std::vector<double> &prices = series.find(names[0])->second;
+                                          window.assign(prices.end() - std::min<size_t>(prices.size(), CHART_VISIBLE_CANDLES), prices.end());
+                                      }
+                                      std::this_thread::sleep_for(CHART_GAP);
+                                  } });
+
+            auto start = BenchClock::now();
+            std::vector<std::thread> writers;
+            for (size_t w = 0; w < WRITERS; ++w)
+            {
+                writers.emplace_back([&, w]
+                                     {
+                                         WriterStats &stat = stats[w];
+                                         std::mt19937_64 gen(50 + w);
+                                         std::normal_distribution<double> move(0.0, 0.002);
+                                         std::vector<double> walk(SYMBOLS, 1000.0);
+                                         auto next = start;
+                                         for (size_t pass = 0; pass < PASSES; ++pass)
+                                         {
+                                             next += TICK;
+                                             std::this_thread::sleep_until(next);
+                                             auto passStart = BenchClock::now();
+                                             for (size_t symbol = w; symbol < SYMBOLS; symbol += WRITERS)
+                                             {
+                                                 double price = walk[symbol] *= 1.0 + move(gen);
+                                                 std::vector<double> &prices = series.find(names[symbol])->second;
+                                                 {
+                                                     // Only acquisitions that find the lock taken are timed
+                                                     std::unique_lock<std::mutex> lock(seriesLock(symbol), std::try_to_lock);
+                                                     if (!lock.owns_lock())
+                                                     {
+                                                         auto waitStart = BenchClock::now();
+                                                         lock.lock();
+                                                         double waited = secondsSince(waitStart);
+                                                         ++stat.contended;
+                                                         stat.totalWait += waited;
+                                                         stat.longestWait = std::max(stat.longestWait, waited);
+                                                     }
+                                                     prices.push_back(price);
+                                                 }
+                                                 if (sharded)
+                                                     markets[symbol]->latest.publish(price);
+                                             }
+                                             stat.worstPass = std::max(stat.worstPass, secondsSince(passStart));
+                                             if (BenchClock::now() >= next + TICK)
+                                                 ++stat.late;
+                                         } });
+            }
+            for (std::thread &writer : writers)
+                writer.join();
+            double seconds = secondsSince(start);
+            done.store(true, std::memory_order_release);
+            for (std::thread &reader : readers)
+                reader.join();
+            chart.join();
+
+            WriterStats total;
+            for (const WriterStats &stat : stats)
+            {
+                total.contended += stat.contended;
+                total.totalWait += stat.totalWait;
+                total.longestWait = std::max(total.longestWait, stat.longestWait);
+                total.worstPass = std::max(total.worstPass, stat.worstPass);
+                total.late += stat.late;
+            }
+            printRate(sharded ? "Sharded: ticks" : "Global lock: ticks", SYMBOLS * PASSES, seconds, "ticks");
+            std::cout << "  " << total.contended << " ticks waited for a lock, " << std::setprecision(1)
+                      << total.totalWait * 1e3 << " ms in all, " << total.longestWait * 1e6 << " us longest; worst pass "
+                      << std::setprecision(2) << total.worstPass * 1e3 << " ms, " << total.late << " of "
+                      << PASSES * WRITERS << " passes late" << std::endl;
+            printRate(sharded ? "Sharded: latest-price reads" : "Global lock: latest-price reads",
+                      std::accumulate(reads.begin(), reads.end(), size_t(0)), seconds, "reads");
+        }
+        return 0;
+    }
+
+    int benchBus()
+    {
+        const size_t PUBLISHED = 50000000;
+        const size_t FANNED_OUT = 20000000;
+        const size_t QUEUED = 2000000;
+        const size_t BATCH = 256;        // Events per commit
+        const size_t CONSUMERS = 3;      // Two fast, the last one slow
+        const size_t SYMBOLS = 1000;
+        const auto SLOW_GAP = std::chrono::milliseconds(1); // The slow consumer's pause after each batch, like a disk write
+        const auto WAIT = std::chrono::milliseconds(10);
+
+        auto eventAt = [](size_t i)
+        {
+            return MarketEvent{MarketEvent::Tick, static_cast<SymbolId>(i % SYMBOLS), 1000.0 + static_cast<double>(i & 1023), Candle{}};
+        };
+
+        // The producer alone
+        {
+            MarketBus bus(1 << 16);
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < PUBLISHED; ++i)
+            {
+                bus.publish(eventAt(i));
+                if ((i + 1) % BATCH == 0)
+                    bus.commit();
+            }
+            bus.commit();
+            printRate("Bus: publish only", PUBLISHED, secondsSince(start), "events");
+        }
+
+        // Before: a queue per consumer, each event copied into every queue; a full
+        // queue holds the producer up until its consumer has made room
+        {
+            std::vector<std::unique_ptr<MpscRingBuffer<MarketEvent>>> queues;
+            std::vector<std::unique_ptr<ConsumerWakeup>> wakeups;
+            for (size_t c = 0; c < CONSUMERS; ++c)
+            {
+                queues.push_back(std::make_unique<MpscRingBuffer<MarketEvent>>(1 << 14));
+                wakeups.push_back(std::make_unique<ConsumerWakeup>());
+            }
+            std::atomic<bool> done(false);
+            std::vector<size_t> handled(CONSUMERS);
+            std::vector<std::thread> consumers;
+            for (size_t c = 0; c < CONSUMERS; ++c)
+            {
+                consumers.emplace_back([&, c]
+                                       {
+                                           MpscRingBuffer<MarketEvent> &queue = *queues[c];
+                                           MarketEvent event;
+                                           double sum = 0.0;
+                                           for (;;)
+                                           {
+                                               bool finished = done.load(std::memory_order_acquire);
+                                               size_t batch = 0;
+                                               while (batch < 1024 && queue.tryPop(event))
+                                               {
+                                                   sum += event.price;
+                                                   ++batch;
+                                               }
+                                               handled[c] += batch;
+                                               if (batch == 0 && finished)
+                                                   break;
+                                               if (c == CONSUMERS - 1 && batch != 0)
+                                                   std::this_thread::sleep_for(SLOW_GAP);
+                                               else if (batch == 0)
+                                                   wakeups[c]->waitUntil(BenchClock::now() + WAIT, [&]
+                                                                         { return queue.size() != 0 || done.load(std::memory_order_acquire); });
+                                           }
+                                           (void)sum; });
+            }
+
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < QUEUED; ++i)
+            {
+                MarketEvent event = eventAt(i);
+                for (size_t c = 0; c < CONSUMERS; ++c)
+                {
+                    while (!queues[c]->tryPush(event))
+                        std::this_thread::yield();
+                }
+                if ((i + 1) % BATCH == 0)
+                {
+                    for (auto &wakeup : wakeups)
+                        wakeup->notify();
+                }
+            }
+            double seconds = secondsSince(start);
+            done.store(true, std::memory_order_release);
+            for (auto &wakeup : wakeups)
+                wakeup->wakeAlways();
+            for (std::thread &consumer : consumers)
+                consumer.join();
+            printRate("Queue per consumer: publish", QUEUED, seconds, "events");
+            std::cout << "  handled " << handled[0] << ", " << handled[1] << " and " << handled[2] << " (slow)" << std::endl;
+        }
+
+        // After: one bus, a cursor per consumer; the slow one misses what it is lapped on
+        {
+            MarketBus bus(1 << 16);
+            std::atomic<bool> done(false);
+            std::vector<size_t> handled(CONSUMERS);
+            std::vector<uint64_t> missed(CONSUMERS);
+            std::vector<std::unique_ptr<MarketBusReader>> readers;
+            for (size_t c = 0; c < CONSUMERS; ++c)
+                readers.push_back(std::make_unique<MarketBusReader>(bus));
+            std::vector<std::thread> consumers;
+            for (size_t c = 0; c < CONSUMERS; ++c)
+            {
+                consumers.emplace_back([&, c]
+                                       {
+                                           MarketBusReader &reader = *readers[c];
+                                           double sum = 0.0;
+                                           for (;;)
+                                           {
+                                               bool finished = done.load(std::memory_order_acquire);
+                                               size_t batch = reader.poll([&](const MarketEvent &event)
+                                                                          { sum += event.price; });
+                                               handled[c] += batch;
+                                               if (batch == 0 && finished)
+                                                   break;
+                                               if (c == CONSUMERS - 1 && batch != 0)
+                                                   std::this_thread::sleep_for(SLOW_GAP);
+                                               else if (batch == 0)
+                                                   reader.wakeup().waitUntil(BenchClock::now() + WAIT, [&]
+                                                                             { return reader.pending() || done.load(std::memory_order_acquire); });
+                                           }
+                                           missed[c] = reader.missed();
+                                           (void)sum; });
+            }
+
+            auto start = BenchClock::now();
+            for (size_t i = 0; i < FANNED_OUT; ++i)
+            {
+                bus.publish(eventAt(i));
+                if ((i + 1) % BATCH == 0)
+                    bus.commit();
+            }
+            bus.commit();
+            double seconds = secondsSince(start);
+            done.store(true, std::memory_order_release);
+            for (auto &reader : readers)
+                reader->wakeup().wakeAlways();
+            for (std::thread &consumer : consumers)
+                consumer.join();
+            printRate("Bus, 3 consumers: publish", FANNED_OUT, seconds, "events");
+            std::cout << "  handled " << handled[0] << " and " << handled[1] << " (" << missed[0] + missed[1]
+                      << " missed), " << handled[2] << " (slow, " << missed[2] << " missed)" << std::endl;
+        }
+        return 0;
+    }
+
+    int benchPool()
+    {
+        const auto FEED = std::chrono::seconds(1);              // How long bulk work keeps arriving
+        const auto BULK_TASK = std::chrono::microseconds(50);   // One sweep cell, roughly
+        const auto PROBE_GAP = std::chrono::milliseconds(5);    // Between probes
+        const size_t BACKLOG = 64;                              // Bulk tasks kept queued
+
+        // Stands in for a short computation
+        auto spin = [](std::chrono::microseconds length)
+        {
+            auto until = BenchClock::now() + length;
+            while (BenchClock::now() < until)
+            {
+            }
+        };
+
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (TaskPriority probePriority : {TaskPriority::Bulk, TaskPriority::Interactive})
+        {
+            // A feeder keeps the pool's bulk queue topped up while probes are
+            // submitted at the given priority; each probe is timed from its
+            // submission until a worker starts it
+            WorkStealingPool pool(cores);
+            TaskGroup bulk;
+            TaskGroup probes;
+            std::atomic<size_t> bulkStarted(0);
+            std::atomic<bool> feeding(true);
+            size_t bulkSubmitted = 0;
+            std::thread feeder([&]
+                               {
+                                   while (feeding.load(std::memory_order_acquire))
+                                   {
+                                       if (bulkSubmitted - bulkStarted.load(std::memory_order_relaxed) >= BACKLOG)
+                                       {
+                                           std::this_thread::yield();
+                                           continue;
+                                       }
+                                       pool.submit(bulk, [&]
+                                                   {
+                                                       bulkStarted.fetch_add(1, std::memory_order_relaxed);
+                                                       spin(BULK_TASK); }, TaskPriority::Bulk);
+                                       ++bulkSubmitted;
+                                   } });
+
+            std::vector<double> latencies;
+            latencies.reserve(FEED / PROBE_GAP);
+            std::mutex latencyMutex;
+            auto start = BenchClock::now();
+            while (BenchClock::now() - start < FEED)
+            {
+                auto submitted = BenchClock::now();
+                pool.submit(probes, [&latencies, &latencyMutex, submitted]
+                            {
+                                double waited = secondsSince(submitted);
+                                std::lock_guard<std::mutex> latencyLock(latencyMutex);
+                                latencies.push_back(waited); }, probePriority);
+                std::this_thread::sleep_for(PROBE_GAP);
+            }
+            feeding.store(false, std::memory_order_release);
+            feeder.join();
+            pool.wait(probes);
+            pool.wait(bulk);
+            double seconds = secondsSince(start);
+
+            std::sort(latencies.begin(), latencies.end());
+            std::cout << (probePriority == TaskPriority::Bulk ? "Probes at bulk priority" : "Probes at interactive priority")
+                      << ": " << latencies.size() << " probes, " << bulkSubmitted << " bulk tasks in " << std::fixed
+                      << std::setprecision(2) << seconds << " s" << std::endl;
+            std::cout << "  submit to start " << std::setprecision(1) << percentileMicros(latencies, 0.5) << " us median, "
+                      << percentileMicros(latencies, 0.99) << " us p99, " << latencies.back() * 1e6 << " us worst" << std::endl;
+            std::vector<WorkStealingPool::WorkerStats> workers = pool.stats();
+            for (size_t i = 0; i < workers.size(); ++i)
+            {
+                std::cout << "  worker " << i << ": " << workers[i].tasks << " tasks, " << workers[i].stolen << " stolen, "
+                          << std::setprecision(0) << workers[i].utilisation * 100.0 << "% busy" << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    // The old NSE bhavcopy layout, one row per symbol per day
+    void writeBhavcopy(const std::string &path, size_t symbols, size_t targetBytes)
+    {
+        std::mt19937_64 gen(7);
+        std::normal_distribution<double> move(0.0, 0.01);
+        std::vector<double> prices(symbols);
+        for (size_t i = 0; i < symbols; ++i)
+            prices[i] = 50.0 + (i * 37) % 5000;
+        static const char *MONTHS[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+
+        std::string text = "SYMBOL,SERIES,OPEN,HIGH,LOW,CLOSE,LAST,PREVCLOSE,TOTTRDQTY,TOTTRDVAL,TIMESTAMP,TOTALTRADES,ISIN,\n";
+        char number[32];
+        auto appendNumber = [&](double value)
+        {
+            text.append(number, std::to_chars(number, number + sizeof(number), value, std::chars_format::fixed, 2).ptr);
+            text += ',';
+        };
+        for (size_t day = 0; text.size() < targetBytes; ++day)
+        {
+            char date[16];
+            std::snprintf(date, sizeof(date), "%02d-%s-%04d", static_cast<int>(day % 28 + 1), MONTHS[day / 28 % 12],
+                          static_cast<int>(2000 + day / 336));
+            for (size_t i = 0; i < symbols; ++i)
+            {
+                double open = prices[i];
+                double close = open * (1.0 + move(gen));
+                prices[i] = close;
+                text += "SYM" + std::to_string(i) + ",EQ,";
+                appendNumber(open);
+                appendNumber(std::max(open, close) * 1.004);
+                appendNumber(std::min(open, close) * 0.996);
+                appendNumber(close);
+                appendNumber(close);
+                appendNumber(open);
+                text += std::to_string(100000 + i) + "," + std::to_string(250000000 + i * 13) + ".55," + date + "," +
+                        std::to_string(2000 + i) + ",INE" + std::to_string(100000 + i) + "A01018,\n";
+            }
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), text.size());
+    }
+
+    int benchIngest()
+    {
+        const size_t SYMBOLS = 2000;
+        const size_t BYTES = 256 << 20;
+
+        // The files go under a scratch data/ so the candles are written where they would be
+        fs::path previous = fs::current_path();
+        fs::path root = fs::temp_directory_path() / "indinexus_bench_ingest";
+        fs::remove_all(root);
+        fs::create_directories(root);
+        std::string path = (root / "bhavcopy.csv").string();
+        writeBhavcopy(path, SYMBOLS, BYTES);
+        size_t bytes = static_cast<size_t>(fs::file_size(path));
+        fs::current_path(root);
+
+        // Line by line with iostreams, splitting on commas and converting with stod
+        {
+            auto start = BenchClock::now();
+            std::ifstream in(path);
+            std::string line, field;
+            std::map<std::string, std::vector<Candle>> series;
+            std::getline(in, line);
+            while (std::getline(in, line))
+            {
+                std::istringstream fields(line);
+                std::vector<std::string> columns;
+                while (std::getline(fields, field, ','))
+                    columns.push_back(field);
+                if (columns.size() < 6 || columns[1] != "EQ")
+                    continue;
+                series[columns[0]].push_back(Candle{std::stod(columns[2]), std::stod(columns[3]), std::stod(columns[4]), std::stod(columns[5])});
+            }
+            double seconds = secondsSince(start);
+            printRate("getline and stod", bytes >> 20, seconds, "MB");
+        }
+
+        // Mapped and parsed in chunks on 1, 2, 4, ... threads up to the core count
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> threadCounts;
+        for (unsigned threads = 1; threads < cores; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(cores);
+        CsvIngestSettings settings;
+        for (unsigned threads : threadCounts)
+        {
+            WorkStealingPool pool(threads);
+            auto start = BenchClock::now();
+            CsvIngestSummary summary = ingestCsvFiles({path}, settings, pool);
+            double seconds = secondsSince(start);
+            printRate("Ingest, " + std::to_string(threads) + " thread(s)", bytes >> 20, seconds, "MB");
+            std::cout << "  " << summary.candles << " candles for " << summary.series.size() << " symbols; parse "
+                      << std::setprecision(0) << (summary.parseSeconds > 0 ? (bytes >> 20) / summary.parseSeconds : 0.0)
+                      << " MB/s, write " << std::setprecision(3) << summary.writeSeconds << " s" << std::endl;
+        }
+
+        fs::current_path(previous);
+        fs::remove_all(root);
+        return 0;
+    }
+
+    // Order-type checks: scripted books, then one account trading through the
+    // shared book, each compared with the events and balances it must produce
+
+    std::string describeEvent(const BookEvent &event)
+    {
+        static const char *KINDS[] = {"Fill", "Canceled", "CancelRejected", "Amended", "AmendRejected", "Triggered", "OcoCanceled", "StopMoved"};
+        std::ostringstream oss;
+        oss << KINDS[event.kind] << " " << event.account << "#" << event.orderId << " " << event.quantity << "@" << event.price
+            << " rest " << event.remaining;
+        return oss.str();
+    }
+
+    bool expect(const std::string &name, bool passed)
+    {
+        std::cout << (passed ? "  ok    " : "  FAIL  ") << name << std::endl;
+        return passed;
+    }
+
+    // Compares, then clears, the events a book has produced
+    bool expectEvents(const std::string &name, std::vector<BookEvent> &events, const std::vector<std::string> &expected)
+    {
+        std::vector<std::string> seen;
+        for (const auto &event : events)
+            seen.push_back(describeEvent(event));
+        events.clear();
+        if (expect(name, seen == expected))
+            return true;
+        std::cout << "    expected:" << std::endl;
+        for (const auto &line : expected)
+            std::cout << "      " << line << std::endl;
+        std::cout << "    got:" << std::endl;
+        for (const auto &line : seen)
+            std::cout << "      " << line << std::endl;
+        return false;
+    }
+
+    bool near(double a, double b)
+    {
+        return std::fabs(a - b) < 1e-6;
+    }
+
+    BookCommand limitOrder(AccountId account, uint64_t orderId, Side side, double quantity, double price, uint64_t linkedOrderId = 0)
+    {
+        BookCommand command{BookCommand::Add, 0, account, orderId, 0, side, quantity, price};
+        command.linkedOrderId = linkedOrderId;
+        return command;
+    }
+
+    BookCommand stopOrder(AccountId account, uint64_t orderId, Side side, double quantity, BookOrderType type, double stopPrice,
+                          double limitPrice = 0.0, uint64_t linkedOrderId = 0)
+    {
+        BookCommand command{BookCommand::Add, 0, account, orderId, 0, side, quantity, limitPrice};
+        command.orderType = type;
+        command.stopPrice = stopPrice;
+        command.linkedOrderId = linkedOrderId;
+        return command;
+    }
+
+    BookCommand trailingOrder(AccountId account, uint64_t orderId, Side side, double quantity, double trailAmount)
+    {
+        BookCommand command{BookCommand::Add, 0, account, orderId, 0, side, quantity, 0.0};
+        command.orderType = BookOrderType::TrailingStop;
+        command.trailAmount = trailAmount;
+        return command;
+    }
+
+    bool checkBooks()
+    {
+        bool passed = true;
+        std::vector<BookEvent> events;
+        auto record = [&events](const BookEvent &event)
+        { events.push_back(event); };
+
+        // Best price first, then oldest first within a price
+        {
+            OrderBook book(0, record);
+            book.add(limitOrder(1, 1, Side::Sell, 5, 100));
+            book.add(limitOrder(2, 1, Side::Sell, 5, 100));
+            book.add(limitOrder(3, 1, Side::Sell, 5, 99));
+            book.add(limitOrder(4, 1, Side::Buy, 8, 100));
+            passed &= expectEvents("price-time priority", events,
+                                   {"Fill 3#1 5@99 rest 0", "Fill 4#1 5@99 rest 3", "Fill 1#1 3@100 rest 2", "Fill 4#1 3@100 rest 0"});
+            passed &= expect("partly filled order keeps the front of its level", book.size() == 2 && book.bestAsk() == 100);
+
+            // Shrinking at the same price keeps the queue position
+            book.amend(1, 1, 7, 1, 100);
+            book.add(limitOrder(5, 1, Side::Buy, 2, 100));
+            passed &= expectEvents("amend down keeps time priority", events,
+                                   {"Amended 1#1 1@100 rest 1", "Fill 1#1 1@100 rest 0", "Fill 5#1 1@100 rest 1", "Fill 2#1 1@100 rest 4", "Fill 5#1 1@100 rest 0"});
+        }
+
+        // An order never trades with its own account's resting order
+        {
+            OrderBook book(0, record);
+            book.add(limitOrder(1, 1, Side::Sell, 5, 100));
+            book.add(limitOrder(2, 1, Side::Sell, 5, 101));
+            book.add(limitOrder(1, 2, Side::Buy, 8, 101));
+            passed &= expectEvents("self-trade cancels the resting order", events,
+                                   {"Canceled 1#1 5@100 rest 0", "Fill 2#1 5@101 rest 0", "Fill 1#2 5@101 rest 3"});
+            passed &= expect("self-trade remainder rests", book.size() == 1 && book.bestBid() == 101);
+        }
+
+        // Either leg of a one-cancels-other pair cancels the other
+        {
+            OrderBook book(0, record);
+            book.onReferencePrice(100);
+            book.add(limitOrder(1, 1, Side::Buy, 5, 95, 2));
+            book.add(stopOrder(1, 2, Side::Buy, 5, BookOrderType::StopMarket, 105, 0.0, 1));
+            book.add(limitOrder(2, 1, Side::Sell, 5, 95));
+            passed &= expectEvents("OCO limit leg fills, stop leg canceled", events,
+                                   {"Fill 1#1 5@95 rest 0", "OcoCanceled 1#2 5@0 rest 0", "Fill 2#1 5@95 rest 0"});
+
+            book.add(limitOrder(1, 3, Side::Buy, 5, 95, 4));
+            book.add(stopOrder(1, 4, Side::Buy, 5, BookOrderType::StopMarket, 105, 0.0, 3));
+            book.onReferencePrice(106);
+            passed &= expectEvents("OCO stop leg triggers, limit leg canceled", events,
+                                   {"Triggered 1#4 5@106 rest 5", "OcoCanceled 1#3 5@95 rest 0", "Fill 1#4 5@106 rest 0"});
+            passed &= expect("OCO pairs leave nothing behind", book.size() == 0 && book.armedStops() == 0);
+        }
+
+        // Stop-market and stop-limit orders fire on the reference price
+        {
+            OrderBook book(0, record);
+            book.onReferencePrice(100);
+            book.add(stopOrder(1, 1, Side::Sell, 5, BookOrderType::StopMarket, 98));
+            book.add(stopOrder(1, 2, Side::Buy, 5, BookOrderType::StopLimit, 102, 103));
+            book.onReferencePrice(99);
+            passed &= expectEvents("stops wait for their trigger", events, {});
+            book.onReferencePrice(97.5);
+            passed &= expectEvents("stop sell fills at the reference price", events,
+                                   {"Triggered 1#1 5@97.5 rest 5", "Fill 1#1 5@97.5 rest 0"});
+            book.onReferencePrice(102);
+            passed &= expectEvents("stop-limit buy enters at its limit and crosses", events,
+                                   {"Triggered 1#2 5@102 rest 5", "Fill 1#2 5@102 rest 0"});
+            book.add(stopOrder(1, 3, Side::Sell, 5, BookOrderType::StopMarket, 105));
+            passed &= expectEvents("stop already reached fires on arrival", events,
+                                   {"Triggered 1#3 5@102 rest 5", "Fill 1#3 5@102 rest 0"});
+        }
+
+        // Trailing stops follow the best price; stops armed at the same peak move as a cohort
+        {
+            OrderBook book(0, record);
+            book.onReferencePrice(100);
+            book.add(trailingOrder(1, 1, Side::Sell, 5, 2));
+            book.add(trailingOrder(1, 2, Side::Sell, 5, 5));
+            passed &= expectEvents("trailing sells start their trail at the last price", events,
+                                   {"StopMoved 1#1 5@98 rest 5", "StopMoved 1#2 5@95 rest 5"});
+            book.onReferencePrice(110);
+            book.onReferencePrice(108.5);
+            passed &= expectEvents("trailing sells ratchet up without firing", events,
+                                   {"StopMoved 1#1 5@108 rest 5", "StopMoved 1#2 5@105 rest 5"});
+            book.onReferencePrice(108);
+            passed &= expectEvents("tighter trailing sell fires first", events,
+                                   {"Triggered 1#1 5@108 rest 5", "Fill 1#1 5@108 rest 0"});
+            book.add(trailingOrder(1, 3, Side::Sell, 5, 2));
+            book.onReferencePrice(107);
+            book.onReferencePrice(105.5);
+            passed &= expectEvents("late trailing sell keeps its own peak", events,
+                                   {"StopMoved 1#3 5@106 rest 5", "Triggered 1#3 5@105.5 rest 5", "Fill 1#3 5@105.5 rest 0"});
+            book.onReferencePrice(105);
+            passed &= expectEvents("wider trailing sell fires at its own distance", events,
+                                   {"Triggered 1#2 5@105 rest 5", "Fill 1#2 5@105 rest 0"});
+
+            book.add(trailingOrder(1, 4, Side::Buy, 5, 3));
+            book.onReferencePrice(95);
+            book.onReferencePrice(97);
+            passed &= expectEvents("trailing buy ratchets down", events,
+                                   {"StopMoved 1#4 5@108 rest 5", "StopMoved 1#4 5@98 rest 5"});
+            book.onReferencePrice(98);
+            passed &= expectEvents("trailing buy fires on the rebound", events,
+                                   {"Triggered 1#4 5@98 rest 5", "Fill 1#4 5@98 rest 0"});
+        }
+        return passed;
+    }
+
+    bool checkAccount()
+    {
+        bool passed = true;
+        SymbolId symbolId = internSymbol("CHECKSYM");
+        User user;
+        user.username = "check";
+        user.demoMoney = 100000.0;
+        user.initialDemoMoney = 100000.0;
+
+        std::atomic<size_t> results(0);
+        size_t expectedResults = 0;
+        TradingEngine engine(&user);
+        engine.setResultListener([&results](const TradeResult &)
+                                 { results.fetch_add(1, std::memory_order_release); });
+        matchingEngine.start(1);
+        engine.start();
+
+        // Wait for the results a step produces; the account is settled once they are in
+        auto settle = [&](size_t count)
+        {
+            expectedResults += count;
+            auto deadline = BenchClock::now() + std::chrono::seconds(2);
+            while (results.load(std::memory_order_acquire) < expectedResults && BenchClock::now() < deadline)
+                std::this_thread::yield();
+            return results.load(std::memory_order_acquire) == expectedResults;
+        };
+        auto order = [&](CommandType type, double amount, double limitPrice, size_t count, double stopPrice = 0.0,
+                         double trailAmount = 0.0, double takeProfit = 0.0)
+        {
+            TradeCommand command{type, symbolId, amount, limitPrice, 0, 0, BenchClock::now()};
+            command.stopPrice = stopPrice;
+            command.trailAmount = trailAmount;
+            command.takeProfit = takeProfit;
+            engine.submit(command);
+            return settle(count);
+        };
+        auto price = [&](double reference, size_t count)
+        {
+            symbolMarket(symbolId).latest.publish(reference);
+            matchingEngine.submit(BookCommand{BookCommand::ReferencePrice, symbolId, LIQUIDITY_PROVIDER, 0, 0, Side::Buy, 0.0, reference});
+            return settle(count);
+        };
+        // Book events that produce no result are waited for by their effect
+        auto until = [&](const std::function<bool()> &settled)
+        {
+            auto deadline = BenchClock::now() + std::chrono::seconds(2);
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> accountGuard(engine.accountMutex());
+                    if (settled())
+                        return true;
+                }
+                if (BenchClock::now() >= deadline)
+                    return false;
+                std::this_thread::yield();
+            }
+        };
+        auto stopOf = [&](uint64_t orderId)
+        {
+            const User::Order *pending = user.pendingOrders.find(orderId);
+            return pending ? pending->stopPrice : 0.0;
+        };
+        auto account = [&](double cash, double reserved, double shares, size_t pending)
+        {
+            std::lock_guard<std::mutex> accountGuard(engine.accountMutex());
+            const Holding *holding = user.holdings.find(symbolId);
+            double held = holding ? holding->amount : 0.0;
+            return near(user.demoMoney, cash) && near(engine.reservedFunds(), reserved) && near(held, shares) &&
+                   user.pendingOrders.size() == pending;
+        };
+        auto cost = [](double amount, double fillPrice)
+        {
+            return amount * fillPrice + calculateBrokerFee(amount * fillPrice);
+        };
+        auto proceeds = [](double amount, double fillPrice)
+        {
+            return amount * fillPrice - calculateBrokerFee(amount * fillPrice);
+        };
+
+        double cash = user.demoMoney;
+        passed &= expect("engine: opening price", price(1000, 0));
+
+        passed &= expect("engine: limit buy reserves its value and fee",
+                         order(CommandType::LimitBuy, 10, 990, 1) && account(cash, cost(10, 990), 0, 1));
+        cash -= cost(10, 985);
+        passed &= expect("engine: limit buy fills below its limit and releases the reservation",
+                         price(985, 1) && account(cash, 0, 10, 0));
+
+        passed &= expect("engine: stop buy reserves at its trigger",
+                         order(CommandType::StopBuy, 5, 0, 1, 1010) && account(cash, cost(5, 1010), 10, 1));
+        cash -= cost(5, 1012);
+        passed &= expect("engine: stop buy triggers and fills at the reference price",
+                         price(1012, 2) && account(cash, 0, 15, 0));
+
+        passed &= expect("engine: OCO sell holds no cash",
+                         order(CommandType::OcoSell, 15, 1100, 1, 950) && account(cash, 0, 15, 2));
+        cash += proceeds(15, 940);
+        passed &= expect("engine: OCO stop leg fills, limit leg canceled",
+                         price(940, 3) && account(cash, 0, 0, 0));
+
+        passed &= expect("engine: bracket buy reserves its entry",
+                         order(CommandType::BracketBuy, 4, 930, 1, 900, 0, 960) && account(cash, cost(4, 930), 0, 1));
+        cash -= cost(4, 925);
+        passed &= expect("engine: bracket entry fills and places its exits",
+                         price(925, 2) && account(cash, 0, 4, 2));
+        cash += proceeds(4, 965);
+        passed &= expect("engine: take-profit fills, stop-loss canceled",
+                         price(965, 2) && account(cash, 0, 0, 0));
+
+        cash -= cost(3, 965);
+        passed &= expect("engine: market buy", order(CommandType::MarketBuy, 3, 0, 1) && account(cash, 0, 3, 0));
+        passed &= expect("engine: trailing sell placed",
+                         order(CommandType::TrailingStopSell, 3, 0, 1, 0, 10) && account(cash, 0, 3, 1));
+        uint64_t trailingId = user.pendingOrders.peekNextId() - 1;
+        passed &= expect("engine: trailing sell's stop follows the price up",
+                         price(1000, 0) && until([&]
+                                                 { return near(stopOf(trailingId), 990); }));
+        cash += proceeds(3, 990);
+        passed &= expect("engine: trailing sell fills", price(990, 2) && account(cash, 0, 0, 0));
+
+        passed &= expect("engine: trailing buy placed", order(CommandType::TrailingStopBuy, 2, 0, 1, 0, 10));
+        trailingId = user.pendingOrders.peekNextId() - 1;
+        passed &= expect("engine: trailing buy's stop and reservation follow the price down",
+                         price(950, 0) && until([&]
+                                                { return near(stopOf(trailingId), 960) && near(engine.reservedFunds(), cost(2, 960)); }));
+        cash -= cost(2, 961);
+        passed &= expect("engine: trailing buy fills", price(961, 2) && account(cash, 0, 2, 0));
+
+        // A stop buy that gaps far past its stop buys only what the cash covers
+        double stopAmount = std::floor((cash - 20) / 1010);
+        passed &= expect("engine: stop buy for nearly all the cash",
+                         order(CommandType::StopBuy, stopAmount, 0, 1, 1000) && account(cash, cost(stopAmount, 1000), 2, 1));
+        double affordable = (cash - calculateBrokerFee(cash)) / 1500;
+        cash -= cost(affordable, 1500);
+        passed &= expect("engine: gapped stop buy is cut to the cash available",
+                         price(1500, 2) && affordable < stopAmount && cash >= 0 && account(cash, 0, 2 + affordable, 0));
+
+        engine.stop();
+        matchingEngine.stop();
+        return passed;
+    }
+
+    int benchOrders()
+    {
+        std::cout << std::defaultfloat;
+        bool passed = checkBooks();
+        passed &= checkAccount();
+        std::cout << (passed ? "All order checks passed" : "Order checks FAILED") << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    struct Benchmark
+    {
+        const char *name;
+        int (*run)();
+    };
+
+    const Benchmark BENCHMARKS[] = {
+        {"matching", benchMatching},
+        {"triggers", benchTriggers},
+        {"backtest", benchBacktest},
+        {"sweep", benchSweep},
+        {"indicators", benchIndicators},
+        {"batch", benchBatchIndicators},
+        {"fixed", benchFixedPeriods},
+        {"screener", benchScreener},
+        {"chart", benchChart},
+        {"render", benchRender},
+        {"terminal", benchTerminalChart},
+        {"export", benchExport},
+        {"downsample", benchDownsample},
+        {"portfolio", benchPortfolio},
+        {"snapshot", benchSnapshot},
+        {"input", benchInput},
+        {"shards", benchShards},
+        {"bus", benchBus},
+        {"pool", benchPool},
+        {"ingest", benchIngest},
+        {"orders", benchOrders},
+    };
+}
+
+std::string benchmarkNames()
+{
+    std::string names;
+    for (const auto &benchmark : BENCHMARKS)
+    {
+        if (!names.empty())
+            names += "|";
+        names += benchmark.name;
+    }
+    return names;
+}
+
+int runBenchmark(const std::string &name)
+{
+    for (const auto &benchmark : BENCHMARKS)
+    {
+        if (name == benchmark.name)
+            return benchmark.run();
+    }
+    std::cerr << "Unknown benchmark '" << name << "'. Available: " << benchmarkNames() << std::endl;
+    return 1;
+}
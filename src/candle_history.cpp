@@ -0,0 +1,175 @@
+// src/candle_history.cpp
+
+#include "utils.h"
+#include "candle_history.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+CandleHistory::~CandleHistory()
+{
+    close();
+}
+
+CandleHistory::CandleHistory(CandleHistory &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+CandleHistory &CandleHistory::operator=(CandleHistory &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        mapping = other.mapping;
+        mappedBytes = other.mappedBytes;
+        candles = other.candles;
+        count = other.count;
+        headerBytes = other.headerBytes;
+        filePath = std::move(other.filePath);
+        other.mapping = nullptr;
+        other.mappedBytes = 0;
+        other.candles = nullptr;
+        other.count = 0;
+    }
+    return *this;
+}
+
+std::string CandleHistory::historyPath(const std::string &symbol)
+{
+    return "data/stock_data/" + symbol + "/candles_history.dat";
+}
+
+std::string CandleHistory::snapshotPath(const std::string &symbol)
+{
+    return "data/stock_data/" + symbol + "_candles.dat";
+}
+
+std::vector<std::string> CandleHistory::storedSymbols()
+{
+    const std::string SNAPSHOT_SUFFIX = "_candles.dat";
+    std::vector<std::string> symbols;
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator("data/stock_data", error))
+    {
+        std::string name = entry.path().filename().string();
+        if (entry.is_directory() && fs::exists(entry.path() / "candles_history.dat"))
+            symbols.push_back(name);
+        else if (name.size() > SNAPSHOT_SUFFIX.size() &&
+                 name.compare(name.size() - SNAPSHOT_SUFFIX.size(), SNAPSHOT_SUFFIX.size(), SNAPSHOT_SUFFIX) == 0)
+            symbols.push_back(name.substr(0, name.size() - SNAPSHOT_SUFFIX.size()));
+    }
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end()); // Both a history and a snapshot
+    return symbols;
+}
+
+bool CandleHistory::openSymbol(const std::string &symbol)
+{
+    if (fs::exists(historyPath(symbol)))
+        return open(historyPath(symbol));
+    return open(snapshotPath(symbol), sizeof(size_t)); // Snapshots start with their candle count
+}
+
+bool CandleHistory::open(const std::string &path, size_t headerBytes)
+{
+    close();
+    filePath = path;
+    this->headerBytes = headerBytes;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(fileSize.QuadPart);
+    if (bytes > headerBytes)
+    {
+        HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (fileMapping != nullptr)
+        {
+            mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(fileMapping); // The view keeps the mapping alive
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(fileStat.st_size);
+    if (bytes > headerBytes)
+    {
+        void *view = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED)
+        {
+            mapping = view;
+            madvise(view, bytes, MADV_SEQUENTIAL); // Backtests stream front to back
+        }
+    }
+    ::close(fd); // The mapping keeps the file alive
+#endif
+
+    if (bytes <= headerBytes)
+        return true; // Nothing recorded yet
+    if (mapping == nullptr)
+        return false;
+
+    mappedBytes = bytes;
+    candles = reinterpret_cast<const Candle *>(static_cast<const char *>(mapping) + headerBytes);
+    count = (bytes - headerBytes) / sizeof(Candle);
+    return true;
+}
+
+void CandleHistory::close()
+{
+    if (mapping != nullptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+#else
+        munmap(mapping, mappedBytes);
+#endif
+    }
+    mapping = nullptr;
+    mappedBytes = 0;
+    candles = nullptr;
+    count = 0;
+}
+
+bool CandleHistory::refresh()
+{
+    std::error_code error;
+    uintmax_t bytes = fs::file_size(filePath, error);
+    if (error)
+        return false;
+    size_t recorded = (bytes > headerBytes) ? static_cast<size_t>(bytes - headerBytes) / sizeof(Candle) : 0;
+    if (recorded == count)
+        return false;
+    std::string path = filePath; // open() starts by closing this view
+    open(path, headerBytes);
+    return true;
+}
+
+CandleRange CandleHistory::range(size_t first, size_t count) const
+{
+    CandleRange range;
+    range.first = std::min(first, this->count);
+    range.count = std::min(count, this->count - range.first);
+    range.candles = candles + range.first;
+    return range;
+}
@@ -0,0 +1,129 @@
+// src/chart_data.cpp
+
+#include "utils.h"
+#include "chart_data.h"
+#include "indicators.h"
+#include "data_persistence.h"
+#include "market_data.h"
+#include <charconv>
+
+namespace
+{
+    // Prices, averages and RSI are all shown to a few decimals at most
+    const int CHART_DECIMALS = 4;
+
+    // Copy the visible slice [first, first + count) of a series
+    void copySlice(const std::vector<double> &series, size_t first, size_t count, std::vector<double> &out)
+    {
+        out.assign(series.begin() + first, series.begin() + first + count);
+    }
+
+    // One datablock of index + values rows, from row `from` of the window on
+    template <typename Row>
+    void appendDatablock(std::string &buffer, const char *name, const ChartWindow &window, size_t from, Row row)
+    {
+        buffer += name;
+        buffer += " << EOD\n";
+        for (size_t i = from; i < window.candles.size(); ++i)
+        {
+            appendNumber(buffer, window.first + i * window.stride);
+            row(i);
+            buffer += '\n';
+        }
+        buffer += "EOD\n";
+    }
+
+    void appendField(std::string &buffer, double value)
+    {
+        buffer += ' ';
+        appendNumber(buffer, value, CHART_DECIMALS);
+    }
+}
+
+bool captureChartWindow(const std::string &symbol, size_t visible, ChartWindow &window)
+{
+    auto candlesIt = candlesMap.find(symbol);
+    if (candlesIt == candlesMap.end() || candlesIt->second.empty())
+        return false;
+    const std::vector<Candle> &candles = candlesIt->second;
+
+    // Indicators only process candles closed since the last frame
+    auto indicatorsIt = indicatorsMap.find(symbol);
+    if (indicatorsIt == indicatorsMap.end())
+        indicatorsIt = indicatorsMap.emplace(symbol, SymbolIndicators(CHART_MA_PERIOD, CHART_RSI_PERIOD)).first;
+    SymbolIndicators &indicators = indicatorsIt->second;
+    indicators.sync(candles);
+
+    size_t count = std::min(visible, candles.size());
+    window.first = candles.size() - count;
+    window.candles.assign(candles.end() - count, candles.end());
+    copySlice(indicators.movingAverage(), window.first, count, window.movingAverage);
+    copySlice(indicators.bollingerUpper(), window.first, count, window.bollingerUpper);
+    copySlice(indicators.bollingerLower(), window.first, count, window.bollingerLower);
+    copySlice(indicators.rsi(), window.first, count, window.rsi);
+
+    window.stride = 1;
+    window.currentPrice = chartCurrentPrice(symbol);
+    return true;
+}
+
+void syncChartIndicators(SymbolId symbolId)
+{
+    const std::string &symbol = symbolName(symbolId);
+    auto candlesIt = candlesMap.find(symbol);
+    auto indicatorsIt = indicatorsMap.find(symbol);
+    if (candlesIt == candlesMap.end() || indicatorsIt == indicatorsMap.end())
+        return;
+    std::lock_guard<std::mutex> seriesLock(symbolMarket(symbolId).seriesLock);
+    indicatorsIt->second.sync(candlesIt->second);
+}
+
+double chartCurrentPrice(const std::string &symbol)
+{
+    SymbolId id = findSymbolId(symbol);
+    return id == INVALID_SYMBOL_ID ? 0.0 : symbolMarket(id).latest.read().price;
+}
+
+void appendChartDatablocks(const ChartWindow &window, std::string &buffer)
+{
+    appendDatablock(buffer, "$candles", window, 0, [&](size_t i)
+                    {
+                        const Candle &candle = window.candles[i];
+                        appendField(buffer, candle.open);
+                        appendField(buffer, candle.high);
+                        appendField(buffer, candle.low);
+                        appendField(buffer, candle.close); });
+    appendDatablock(buffer, "$ma", window, firstReadyRow(window, CHART_MA_PERIOD - 1), [&](size_t i)
+                    { appendField(buffer, window.movingAverage[i]); });
+    appendDatablock(buffer, "$bands", window, firstReadyRow(window, CHART_BOLLINGER_PERIOD - 1), [&](size_t i)
+                    {
+                        appendField(buffer, window.bollingerUpper[i]);
+                        appendField(buffer, window.bollingerLower[i]); });
+    // The first candle has no change, so RSI starts at the second
+    appendDatablock(buffer, "$rsi", window, firstReadyRow(window, 1), [&](size_t i)
+                    { appendField(buffer, window.rsi[i]); });
+}
+
+size_t firstReadyRow(const ChartWindow &window, size_t ready)
+{
+    return (window.first >= ready) ? 0 : std::min(window.candles.size(), (ready - window.first) / window.stride);
+}
+
+void appendNumber(std::string &buffer, double value, int decimals)
+{
+    char text[64];
+    auto result = std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, decimals);
+    if (result.ec != std::errc())
+    {
+        buffer += "NaN"; // Too large to plot; gnuplot skips the point
+        return;
+    }
+    buffer.append(text, result.ptr);
+}
+
+void appendNumber(std::string &buffer, size_t value)
+{
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
+}
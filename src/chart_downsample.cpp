@@ -0,0 +1,150 @@
+// src/chart_downsample.cpp
+
+#include "utils.h"
+#include "chart_downsample.h"
+#include "indicators.h"
+#include "indicator_batch.h"
+
+namespace
+{
+    // StreamingBollinger's default band width, which the live chart uses
+    const double CHART_BOLLINGER_WIDTH = 2.0;
+
+    // Row of the range where a series that becomes ready at history index `ready` starts
+    size_t readyOffset(size_t first, size_t ready)
+    {
+        return (ready > first) ? ready - first : 0;
+    }
+}
+
+bool ChartHistoryReader::refresh()
+{
+    // Candles are recorded to the history as they close; until it exists the snapshot is all there is
+    bool recording = history.path() == CandleHistory::historyPath(symbol);
+    if (history.path().empty() || (!recording && fs::exists(CandleHistory::historyPath(symbol))))
+        return history.openSymbol(symbol);
+    return history.refresh();
+}
+
+bool ChartHistoryReader::window(size_t range, size_t width, ChartWindow &window)
+{
+    if (history.empty() || range == 0 || width == 0)
+        return false;
+
+    size_t count = history.size();
+    size_t shown = std::min(range, count);
+    size_t stride = (shown + width - 1) / width;
+    size_t first = (count - shown + stride - 1) / stride * stride; // Round up so there are at most `width` buckets
+    CandleRange candles = history.range(first, count - first);
+
+    // Indicators over the range and its warm-up, at full resolution
+    size_t warmupStart = first - std::min(first, CHART_WARMUP_CANDLES);
+    size_t total = count - warmupStart;
+    closes.resize(total);
+    for (size_t i = 0; i < total; ++i)
+        closes[i] = history[warmupStart + i].close;
+    movingAverage.resize(total);
+    bollingerMiddle.resize(total);
+    bollingerUpper.resize(total);
+    bollingerLower.resize(total);
+    rsi.resize(total);
+    smaBatch(closes.data(), total, CHART_MA_PERIOD, movingAverage.data());
+    bollingerBatch(closes.data(), total, CHART_BOLLINGER_PERIOD, CHART_BOLLINGER_WIDTH,
+                   bollingerMiddle.data(), bollingerUpper.data(), bollingerLower.data());
+    rsiBatch(closes.data(), total, CHART_RSI_PERIOD, rsi.data());
+
+    // Then reduced to the buckets
+    size_t skip = first - warmupStart;
+    window.first = first;
+    window.stride = stride;
+    bucketCandles(candles.candles, candles.count, stride, window.candles);
+    lttbBuckets(movingAverage.data() + skip, candles.count, stride,
+                readyOffset(first, CHART_MA_PERIOD - 1), window.movingAverage);
+    lttbBuckets(bollingerUpper.data() + skip, candles.count, stride,
+                readyOffset(first, CHART_BOLLINGER_PERIOD - 1), window.bollingerUpper);
+    lttbBuckets(bollingerLower.data() + skip, candles.count, stride,
+                readyOffset(first, CHART_BOLLINGER_PERIOD - 1), window.bollingerLower);
+    lttbBuckets(rsi.data() + skip, candles.count, stride, readyOffset(first, 1), window.rsi);
+    window.currentPrice = candles.candles[candles.count - 1].close;
+    return true;
+}
+
+void bucketCandles(const Candle *candles, size_t count, size_t stride, std::vector<Candle> &out)
+{
+    out.clear();
+    for (size_t start = 0; start < count; start += stride)
+    {
+        size_t end = std::min(count, start + stride);
+        Candle bucket = candles[start];
+        for (size_t i = start + 1; i < end; ++i)
+        {
+            bucket.high = std::max(bucket.high, candles[i].high);
+            bucket.low = std::min(bucket.low, candles[i].low);
+        }
+        bucket.close = candles[end - 1].close;
+        out.push_back(bucket);
+    }
+}
+
+void lttbBuckets(const double *values, size_t count, size_t stride, size_t from, std::vector<double> &out)
+{
+    size_t buckets = (count + stride - 1) / stride;
+    if (stride == 1)
+    {
+        out.assign(values, values + count);
+        return;
+    }
+    out.assign(buckets, 0.0);
+    if (from >= count)
+        return;
+
+    // The first ready point is kept as is
+    size_t bucket = from / stride;
+    size_t kept = from;
+    out[bucket] = values[kept];
+
+    for (++bucket; bucket + 1 < buckets; ++bucket)
+    {
+        // Average of the next bucket
+        size_t nextStart = (bucket + 1) * stride;
+        size_t nextEnd = std::min(count, nextStart + stride);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (size_t i = nextStart; i < nextEnd; ++i)
+        {
+            averageX += static_cast<double>(i);
+            averageY += values[i];
+        }
+        averageX /= static_cast<double>(nextEnd - nextStart);
+        averageY /= static_cast<double>(nextEnd - nextStart);
+
+        // Point of this bucket with the largest triangle; twice its area is enough to compare
+        double keptX = static_cast<double>(kept);
+        double keptY = values[kept];
+        double largest = -1.0;
+        size_t chosen = bucket * stride;
+        for (size_t i = bucket * stride; i < nextStart; ++i)
+        {
+            double area = std::abs((keptX - averageX) * (values[i] - keptY) -
+                                   (keptX - static_cast<double>(i)) * (averageY - keptY));
+            if (area > largest)
+            {
+                largest = area;
+                chosen = i;
+            }
+        }
+        kept = chosen;
+        out[bucket] = values[kept];
+    }
+
+    // And so is the last
+    if (bucket < buckets)
+        out[bucket] = values[count - 1];
+}
+
+size_t zoomChart(size_t level, bool zoomOut)
+{
+    if (zoomOut)
+        return std::min(level + 1, CHART_ZOOM_LEVEL_COUNT - 1);
+    return (level > 0) ? level - 1 : 0;
+}
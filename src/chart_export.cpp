@@ -0,0 +1,601 @@
+// src/chart_export.cpp
+
+#include "utils.h"
+#include "chart_export.h"
+#include "chart_downsample.h"
+#include "indicators.h"
+#include "png_writer.h"
+#include <cctype>
+
+namespace
+{
+    // Symbols per pool task, each task reusing its window and buffers
+    const size_t EXPORT_BATCH = 16;
+
+    // Layout in pixels
+    const double TITLE_HEIGHT = 30.0;
+    const double MARGIN = 10.0;
+    const double AXIS_WIDTH = 70.0;
+    const double PANE_GAP = 16.0;
+    const int PRICE_GRID_LINES = 5;
+
+    // Palette shared by SVG and PNG; indices are PNG pixel values
+    enum ChartColour : uint8_t
+    {
+        COLOUR_BACKGROUND,
+        COLOUR_GRID,
+        COLOUR_TEXT,
+        COLOUR_BORDER,
+        COLOUR_BULLISH,
+        COLOUR_BEARISH,
+        COLOUR_AVERAGE,
+        COLOUR_BANDS,
+        COLOUR_RSI,
+    };
+
+    const std::vector<PaletteColour> PALETTE = {
+        {0xFF, 0xFF, 0xFF},
+        {0xE6, 0xE6, 0xE6},
+        {0x33, 0x33, 0x33},
+        {0x99, 0x99, 0x99},
+        {0x1B, 0x9E, 0x3E},
+        {0xD6, 0x27, 0x28},
+        {0x1F, 0x4F, 0xD1},
+        {0x66, 0x66, 0x66},
+        {0x8E, 0x44, 0xAD},
+    };
+
+    const char *svgColour(ChartColour colour)
+    {
+        static const char *const NAMES[] = {"#ffffff", "#e6e6e6", "#333333", "#999999", "#1b9e3e",
+                                            "#d62728", "#1f4fd1", "#666666", "#8e44ad"};
+        return NAMES[colour];
+    }
+
+    // Where everything goes, shared by the SVG and PNG renderers so they match
+    struct ChartLayout
+    {
+        double plotLeft = 0.0;
+        double plotRight = 0.0;
+        double priceTop = 0.0;
+        double priceBottom = 0.0;
+        double rsiTop = 0.0;
+        double rsiBottom = 0.0;
+        double low = 0.0;
+        double high = 0.0;
+        double step = 0.0; // Pixels per candle
+
+        double x(size_t row) const { return plotLeft + step * (row + 0.5); }
+        double priceY(double value) const { return priceTop + (high - value) / (high - low) * (priceBottom - priceTop); }
+        double rsiY(double value) const { return rsiTop + (100.0 - value) / 100.0 * (rsiBottom - rsiTop); }
+        double gridValue(int line) const { return high - (high - low) * line / (PRICE_GRID_LINES - 1); }
+    };
+
+    ChartLayout layoutChart(const ChartWindow &window, const ChartImageSize &size)
+    {
+        ChartLayout layout;
+        layout.plotLeft = MARGIN;
+        layout.plotRight = size.width - AXIS_WIDTH;
+        double panes = size.height - TITLE_HEIGHT - MARGIN - PANE_GAP;
+        layout.priceTop = TITLE_HEIGHT;
+        layout.priceBottom = layout.priceTop + panes * 0.75;
+        layout.rsiTop = layout.priceBottom + PANE_GAP;
+        layout.rsiBottom = size.height - MARGIN;
+
+        // Price range of the candles, padded like the gnuplot chart
+        layout.low = std::numeric_limits<double>::max();
+        layout.high = std::numeric_limits<double>::lowest();
+        for (const Candle &candle : window.candles)
+        {
+            layout.low = std::min(layout.low, candle.low);
+            layout.high = std::max(layout.high, candle.high);
+        }
+        double padding = (layout.high > layout.low) ? (layout.high - layout.low) * 0.05 : 1.0;
+        layout.low -= padding;
+        layout.high += padding;
+        layout.step = (layout.plotRight - layout.plotLeft) / std::max<size_t>(1, window.candles.size());
+        return layout;
+    }
+
+    // The series the chart draws as lines, with the history index each becomes ready at
+    struct ChartLine
+    {
+        const std::vector<double> *values;
+        size_t ready;
+        ChartColour colour;
+        bool rsiPane;
+        bool dashed;
+    };
+
+    std::vector<ChartLine> chartLines(const ChartWindow &window)
+    {
+        return {
+            {&window.bollingerUpper, CHART_BOLLINGER_PERIOD - 1, COLOUR_BANDS, false, true},
+            {&window.bollingerLower, CHART_BOLLINGER_PERIOD - 1, COLOUR_BANDS, false, true},
+            {&window.movingAverage, CHART_MA_PERIOD - 1, COLOUR_AVERAGE, false, false},
+            {&window.rsi, 1, COLOUR_RSI, true, false}, // The first candle has no change
+        };
+    }
+
+    std::string formatValue(double value, int decimals)
+    {
+        std::string text;
+        appendNumber(text, value, decimals);
+        return text;
+    }
+
+    std::string chartTitle(const std::string &symbol)
+    {
+        return "IndiNexus - " + symbol;
+    }
+
+    std::string priceLabel(const ChartWindow &window)
+    {
+        return "Current Price: INR " + formatValue(window.currentPrice, 2);
+    }
+
+    void appendCoordinate(std::string &svg, double value)
+    {
+        appendNumber(svg, value, 1);
+    }
+
+    void appendEscaped(std::string &svg, const std::string &text)
+    {
+        for (char c : text)
+        {
+            if (c == '&')
+                svg += "&amp;";
+            else if (c == '<')
+                svg += "&lt;";
+            else if (c == '>')
+                svg += "&gt;";
+            else
+                svg += c;
+        }
+    }
+
+    void appendText(std::string &svg, double x, double y, const std::string &text, ChartColour colour, const char *anchor)
+    {
+        svg += "<text x=\"";
+        appendCoordinate(svg, x);
+        svg += "\" y=\"";
+        appendCoordinate(svg, y);
+        svg += "\" fill=\"";
+        svg += svgColour(colour);
+        svg += "\" text-anchor=\"";
+        svg += anchor;
+        svg += "\">";
+        appendEscaped(svg, text);
+        svg += "</text>\n";
+    }
+
+    // 3x5 pixel glyphs, one row of three bits per entry, most significant bit left
+    struct Glyph
+    {
+        char character;
+        uint8_t rows[5];
+    };
+
+    const Glyph FONT[] = {
+        {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}}, {'3', {7, 1, 7, 1, 7}},
+        {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}}, {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 1, 1, 1}},
+        {'8', {7, 5, 7, 5, 7}}, {'9', {7, 5, 7, 1, 7}}, {'.', {0, 0, 0, 0, 2}}, {'-', {0, 0, 7, 0, 0}},
+        {'(', {2, 4, 4, 4, 2}}, {')', {2, 1, 1, 1, 2}}, {':', {0, 2, 0, 2, 0}}, {'/', {1, 1, 2, 4, 4}},
+        {'A', {2, 5, 7, 5, 5}}, {'B', {6, 5, 6, 5, 6}}, {'C', {3, 4, 4, 4, 3}}, {'D', {6, 5, 5, 5, 6}},
+        {'E', {7, 4, 6, 4, 7}}, {'F', {7, 4, 6, 4, 4}}, {'G', {3, 4, 5, 5, 3}}, {'H', {5, 5, 7, 5, 5}},
+        {'I', {7, 2, 2, 2, 7}}, {'J', {1, 1, 1, 5, 2}}, {'K', {5, 5, 6, 5, 5}}, {'L', {4, 4, 4, 4, 7}},
+        {'M', {5, 7, 7, 5, 5}}, {'N', {6, 5, 5, 5, 5}}, {'O', {2, 5, 5, 5, 2}}, {'P', {6, 5, 6, 4, 4}},
+        {'Q', {2, 5, 5, 6, 3}}, {'R', {6, 5, 6, 5, 5}}, {'S', {3, 4, 2, 1, 6}}, {'T', {7, 2, 2, 2, 2}},
+        {'U', {5, 5, 5, 5, 7}}, {'V', {5, 5, 5, 5, 2}}, {'W', {5, 5, 7, 7, 5}}, {'X', {5, 5, 2, 5, 5}},
+        {'Y', {5, 5, 2, 2, 2}}, {'Z', {7, 1, 2, 4, 7}},
+    };
+
+    const int FONT_SCALE = 2;
+    const int GLYPH_ADVANCE = 4 * FONT_SCALE;
+    const int GLYPH_HEIGHT = 5 * FONT_SCALE;
+
+    const Glyph *findGlyph(char c)
+    {
+        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        for (const Glyph &glyph : FONT)
+        {
+            if (glyph.character == upper)
+                return &glyph;
+        }
+        return nullptr; // Drawn as a space
+    }
+
+    // Palette-indexed canvas the PNG is encoded from
+    class Raster
+    {
+    public:
+        Raster(std::vector<uint8_t> &pixels, int width, int height)
+            : pixels(pixels), width(width), height(height), clipBottom(height - 1)
+        {
+            pixels.assign(static_cast<size_t>(width) * height, COLOUR_BACKGROUND);
+        }
+
+        // Fill [x0, x1] x [y0, y1], clipped to the image
+        void fill(int x0, int y0, int x1, int y1, uint8_t colour)
+        {
+            x0 = std::max(x0, 0);
+            y0 = std::max(y0, 0);
+            x1 = std::min(x1, width - 1);
+            y1 = std::min(y1, height - 1);
+            for (int y = y0; y <= y1; ++y)
+                std::fill(pixels.begin() + static_cast<size_t>(y) * width + x0,
+                          pixels.begin() + static_cast<size_t>(y) * width + x1 + 1, colour);
+        }
+
+        void outline(int x0, int y0, int x1, int y1, uint8_t colour)
+        {
+            fill(x0, y0, x1, y0, colour);
+            fill(x0, y1, x1, y1, colour);
+            fill(x0, y0, x0, y1, colour);
+            fill(x1, y0, x1, y1, colour);
+        }
+
+        // Rows lines are drawn in, [top, bottom]; lines leaving a pane are cut at its edge
+        void clip(int top, int bottom)
+        {
+            clipTop = std::max(top, 0);
+            clipBottom = std::min(bottom, height - 1);
+        }
+
+        // Bresenham line; a dashed line draws 4 pixels of every 7, a thick one a second pixel below
+        void line(double fromX, double fromY, double toX, double toY, uint8_t colour, bool dashed, bool thick)
+        {
+            int x0 = static_cast<int>(std::lround(fromX));
+            int y0 = static_cast<int>(std::lround(fromY));
+            int x1 = static_cast<int>(std::lround(toX));
+            int y1 = static_cast<int>(std::lround(toY));
+            int dx = std::abs(x1 - x0);
+            int dy = -std::abs(y1 - y0);
+            int sx = (x0 < x1) ? 1 : -1;
+            int sy = (y0 < y1) ? 1 : -1;
+            int error = dx + dy;
+            for (int i = 0;; ++i)
+            {
+                if (!dashed || i % 7 < 4)
+                {
+                    plot(x0, y0, colour);
+                    if (thick)
+                        plot(x0, y0 + 1, colour);
+                }
+                if (x0 == x1 && y0 == y1)
+                    break;
+                int doubled = 2 * error;
+                if (doubled >= dy)
+                {
+                    error += dy;
+                    x0 += sx;
+                }
+                if (doubled <= dx)
+                {
+                    error += dx;
+                    y0 += sy;
+                }
+            }
+        }
+
+        // Text with its top-left corner at (x, y); right-aligned ends at x instead
+        void text(int x, int y, const std::string &value, uint8_t colour, bool rightAligned = false)
+        {
+            if (rightAligned)
+                x -= static_cast<int>(value.size()) * GLYPH_ADVANCE;
+            for (char c : value)
+            {
+                if (const Glyph *glyph = findGlyph(c))
+                {
+                    for (int row = 0; row < 5; ++row)
+                        for (int column = 0; column < 3; ++column)
+                            if (glyph->rows[row] & (4 >> column))
+                                fill(x + column * FONT_SCALE, y + row * FONT_SCALE,
+                                     x + (column + 1) * FONT_SCALE - 1, y + (row + 1) * FONT_SCALE - 1, colour);
+                }
+                x += GLYPH_ADVANCE;
+            }
+        }
+
+    private:
+        void plot(int x, int y, uint8_t colour)
+        {
+            if (x >= 0 && x < width && y >= clipTop && y <= clipBottom)
+                pixels[static_cast<size_t>(y) * width + x] = colour;
+        }
+
+        std::vector<uint8_t> &pixels;
+        int width;
+        int height;
+        int clipTop = 0;
+        int clipBottom;
+    };
+
+    bool writeFile(const std::string &path, const std::string &data)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(out);
+    }
+}
+
+void appendSvgChart(const ChartWindow &window, const std::string &symbol, const ChartImageSize &size, std::string &svg)
+{
+    ChartLayout layout = layoutChart(window, size);
+
+    svg += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"";
+    appendNumber(svg, static_cast<size_t>(size.width));
+    svg += "\" height=\"";
+    appendNumber(svg, static_cast<size_t>(size.height));
+    svg += "\" font-family=\"sans-serif\" font-size=\"12\">\n";
+    svg += "<rect width=\"100%\" height=\"100%\" fill=\"";
+    svg += svgColour(COLOUR_BACKGROUND);
+    svg += "\"/>\n";
+
+    // Title, legend and current price
+    svg += "<text x=\"10\" y=\"20\" font-size=\"14\" font-weight=\"bold\" fill=\"";
+    svg += svgColour(COLOUR_TEXT);
+    svg += "\">";
+    appendEscaped(svg, chartTitle(symbol));
+    svg += "<tspan dx=\"16\" font-size=\"12\" font-weight=\"normal\" fill=\"";
+    svg += svgColour(COLOUR_AVERAGE);
+    svg += "\">SMA(" + std::to_string(CHART_MA_PERIOD) + ")</tspan>";
+    svg += "<tspan dx=\"12\" font-size=\"12\" font-weight=\"normal\" fill=\"";
+    svg += svgColour(COLOUR_BANDS);
+    svg += "\">Bollinger(" + std::to_string(CHART_BOLLINGER_PERIOD) + ")</tspan>";
+    svg += "<tspan dx=\"12\" font-size=\"12\" font-weight=\"normal\" fill=\"";
+    svg += svgColour(COLOUR_RSI);
+    svg += "\">RSI(" + std::to_string(CHART_RSI_PERIOD) + ")</tspan></text>\n";
+    if (window.currentPrice > 0.0)
+        appendText(svg, layout.plotRight, 20.0, priceLabel(window), COLOUR_TEXT, "end");
+
+    // Grid, price labels and pane borders; lines leaving a pane are clipped at its border
+    svg += "<path stroke=\"";
+    svg += svgColour(COLOUR_GRID);
+    svg += "\" d=\"";
+    for (int line = 0; line < PRICE_GRID_LINES; ++line)
+    {
+        svg += 'M';
+        appendCoordinate(svg, layout.plotLeft);
+        svg += ' ';
+        appendCoordinate(svg, layout.priceY(layout.gridValue(line)));
+        svg += 'H';
+        appendCoordinate(svg, layout.plotRight);
+    }
+    svg += "\"/>\n";
+    for (int line = 0; line < PRICE_GRID_LINES; ++line)
+        appendText(svg, layout.plotRight + 6.0, layout.priceY(layout.gridValue(line)) + 4.0,
+                   formatValue(layout.gridValue(line), 2), COLOUR_TEXT, "start");
+    for (double level : {80.0, 20.0})
+        appendText(svg, layout.plotRight + 6.0, layout.rsiY(level) + 4.0, formatValue(level, 0), COLOUR_TEXT, "start");
+    for (auto pane : {std::make_pair(layout.priceTop, layout.priceBottom), std::make_pair(layout.rsiTop, layout.rsiBottom)})
+    {
+        std::string rect = "<rect x=\"";
+        appendCoordinate(rect, layout.plotLeft);
+        rect += "\" y=\"";
+        appendCoordinate(rect, pane.first);
+        rect += "\" width=\"";
+        appendCoordinate(rect, layout.plotRight - layout.plotLeft);
+        rect += "\" height=\"";
+        appendCoordinate(rect, pane.second - pane.first);
+        svg += "<clipPath id=\"";
+        svg += (pane.first == layout.priceTop) ? "price" : "rsi";
+        svg += "\">" + rect + "\"/></clipPath>\n";
+        svg += rect + "\" fill=\"none\" stroke=\"";
+        svg += svgColour(COLOUR_BORDER);
+        svg += "\"/>\n";
+    }
+
+    // RSI guides
+    svg += "<path stroke=\"";
+    svg += svgColour(COLOUR_BORDER);
+    svg += "\" stroke-dasharray=\"4 3\" d=\"";
+    for (double level : {80.0, 20.0})
+    {
+        svg += 'M';
+        appendCoordinate(svg, layout.plotLeft);
+        svg += ' ';
+        appendCoordinate(svg, layout.rsiY(level));
+        svg += 'H';
+        appendCoordinate(svg, layout.plotRight);
+    }
+    svg += "\"/>\n";
+
+    // Candles: one path of wicks and one of bodies per colour
+    double bodyWidth = std::max(1.0, layout.step * 0.6);
+    for (bool bullish : {true, false})
+    {
+        const char *colour = svgColour(bullish ? COLOUR_BULLISH : COLOUR_BEARISH);
+        std::string wicks;
+        std::string bodies;
+        for (size_t i = 0; i < window.candles.size(); ++i)
+        {
+            const Candle &candle = window.candles[i];
+            if ((candle.close > candle.open) != bullish)
+                continue;
+            double x = layout.x(i);
+            wicks += 'M';
+            appendCoordinate(wicks, x);
+            wicks += ' ';
+            appendCoordinate(wicks, layout.priceY(candle.high));
+            wicks += 'V';
+            appendCoordinate(wicks, layout.priceY(candle.low));
+
+            double top = layout.priceY(std::max(candle.open, candle.close));
+            double bottom = std::max(top + 1.0, layout.priceY(std::min(candle.open, candle.close)));
+            bodies += 'M';
+            appendCoordinate(bodies, x - bodyWidth / 2.0);
+            bodies += ' ';
+            appendCoordinate(bodies, top);
+            bodies += 'h';
+            appendCoordinate(bodies, bodyWidth);
+            bodies += 'V';
+            appendCoordinate(bodies, bottom);
+            bodies += 'h';
+            appendCoordinate(bodies, -bodyWidth);
+            bodies += 'Z';
+        }
+        if (wicks.empty())
+            continue;
+        svg += "<path stroke=\"";
+        svg += colour;
+        svg += "\" d=\"" + wicks + "\"/>\n";
+        svg += "<path fill=\"";
+        svg += colour;
+        svg += "\" d=\"" + bodies + "\"/>\n";
+    }
+
+    // Overlays and RSI
+    for (const ChartLine &line : chartLines(window))
+    {
+        size_t from = firstReadyRow(window, line.ready);
+        if (from >= line.values->size())
+            continue;
+        svg += "<polyline fill=\"none\" clip-path=\"url(#";
+        svg += line.rsiPane ? "rsi" : "price";
+        svg += ")\" stroke=\"";
+        svg += svgColour(line.colour);
+        svg += line.dashed ? "\" stroke-dasharray=\"4 3\"" : "\" stroke-width=\"2\"";
+        svg += " points=\"";
+        for (size_t i = from; i < line.values->size(); ++i)
+        {
+            double value = (*line.values)[i];
+            appendCoordinate(svg, layout.x(i));
+            svg += ',';
+            appendCoordinate(svg, line.rsiPane ? layout.rsiY(value) : layout.priceY(value));
+            svg += ' ';
+        }
+        svg += "\"/>\n";
+    }
+    svg += "</svg>\n";
+}
+
+void appendPngChart(const ChartWindow &window, const std::string &symbol, const ChartImageSize &size,
+                    std::vector<uint8_t> &pixels, std::string &png)
+{
+    ChartLayout layout = layoutChart(window, size);
+    Raster raster(pixels, size.width, size.height);
+    int left = static_cast<int>(layout.plotLeft);
+    int right = static_cast<int>(layout.plotRight);
+
+    // Title and current price
+    raster.text(10, 10, chartTitle(symbol), COLOUR_TEXT);
+    if (window.currentPrice > 0.0)
+        raster.text(right, 10, priceLabel(window), COLOUR_TEXT, true);
+
+    // Grid, price labels and pane borders
+    for (int line = 0; line < PRICE_GRID_LINES; ++line)
+    {
+        int y = static_cast<int>(std::lround(layout.priceY(layout.gridValue(line))));
+        raster.fill(left, y, right, y, COLOUR_GRID);
+        raster.text(right + 6, y - GLYPH_HEIGHT / 2, formatValue(layout.gridValue(line), 2), COLOUR_TEXT);
+    }
+    for (double level : {80.0, 20.0})
+    {
+        double y = layout.rsiY(level);
+        raster.line(layout.plotLeft, y, layout.plotRight, y, COLOUR_BORDER, true, false);
+        raster.text(right + 6, static_cast<int>(std::lround(y)) - GLYPH_HEIGHT / 2, formatValue(level, 0), COLOUR_TEXT);
+    }
+    raster.outline(left, static_cast<int>(layout.priceTop), right, static_cast<int>(layout.priceBottom), COLOUR_BORDER);
+    raster.outline(left, static_cast<int>(layout.rsiTop), right, static_cast<int>(layout.rsiBottom), COLOUR_BORDER);
+
+    // Candles
+    int halfBody = std::max(0, static_cast<int>(layout.step * 0.3));
+    for (size_t i = 0; i < window.candles.size(); ++i)
+    {
+        const Candle &candle = window.candles[i];
+        uint8_t colour = (candle.close > candle.open) ? COLOUR_BULLISH : COLOUR_BEARISH;
+        int x = static_cast<int>(std::lround(layout.x(i)));
+        raster.fill(x, static_cast<int>(std::lround(layout.priceY(candle.high))),
+                    x, static_cast<int>(std::lround(layout.priceY(candle.low))), colour);
+        raster.fill(x - halfBody, static_cast<int>(std::lround(layout.priceY(std::max(candle.open, candle.close)))),
+                    x + halfBody, static_cast<int>(std::lround(layout.priceY(std::min(candle.open, candle.close)))), colour);
+    }
+
+    // Overlays and RSI
+    for (const ChartLine &line : chartLines(window))
+    {
+        auto y = [&](size_t i)
+        {
+            double value = (*line.values)[i];
+            return line.rsiPane ? layout.rsiY(value) : layout.priceY(value);
+        };
+        if (line.rsiPane)
+            raster.clip(static_cast<int>(layout.rsiTop), static_cast<int>(layout.rsiBottom));
+        else
+            raster.clip(static_cast<int>(layout.priceTop), static_cast<int>(layout.priceBottom));
+        for (size_t i = firstReadyRow(window, line.ready) + 1; i < line.values->size(); ++i)
+            raster.line(layout.x(i - 1), y(i - 1), layout.x(i), y(i), line.colour, line.dashed, !line.dashed);
+    }
+
+    appendPng(pixels.data(), size.width, size.height, PALETTE, png);
+}
+
+ChartExportSummary exportCharts(const std::vector<std::string> &symbols, const ChartExportSettings &settings,
+                                WorkStealingPool &pool, TaskPriority priority)
+{
+    fs::create_directories(settings.outputDirectory);
+
+    struct SymbolResult
+    {
+        bool drawn = false;
+        size_t files = 0;
+        size_t bytes = 0;
+    };
+    std::vector<SymbolResult> results(symbols.size());
+
+    // At most one candle per pixel of the plot
+    size_t plotPixels = static_cast<size_t>(std::max(1.0, settings.size.width - AXIS_WIDTH - MARGIN));
+
+    TaskGroup charts;
+    for (size_t first = 0; first < symbols.size(); first += EXPORT_BATCH)
+    {
+        size_t last = std::min(symbols.size(), first + EXPORT_BATCH);
+        pool.submit(charts, [&symbols, &settings, &results, plotPixels, first, last]()
+                    {
+                        // Reused for every symbol in the batch
+                        ChartWindow window;
+                        std::vector<uint8_t> pixels;
+                        std::string image;
+                        for (size_t i = first; i < last; ++i)
+                        {
+                            ChartHistoryReader reader(symbols[i]);
+                            if (!reader.refresh() || !reader.window(settings.candles, plotPixels, window))
+                                continue;
+                            SymbolResult &result = results[i];
+                            result.drawn = true;
+                            std::string base = settings.outputDirectory + "/" + symbols[i];
+                            if (settings.formats & CHART_SVG)
+                            {
+                                image.clear();
+                                appendSvgChart(window, symbols[i], settings.size, image);
+                                result.drawn &= writeFile(base + ".svg", image);
+                                result.files++;
+                                result.bytes += image.size();
+                            }
+                            if (settings.formats & CHART_PNG)
+                            {
+                                image.clear();
+                                appendPngChart(window, symbols[i], settings.size, pixels, image);
+                                result.drawn &= writeFile(base + ".png", image);
+                                result.files++;
+                                result.bytes += image.size();
+                            }
+                        } }, priority);
+    }
+    pool.wait(charts);
+
+    ChartExportSummary summary;
+    for (size_t i = 0; i < symbols.size(); ++i)
+    {
+        if (!results[i].drawn)
+        {
+            summary.failed.push_back(symbols[i]);
+            continue;
+        }
+        summary.charts++;
+        summary.files += results[i].files;
+        summary.bytes += results[i].bytes;
+    }
+    return summary;
+}
@@ -0,0 +1,234 @@
+// src/chart_renderer.cpp
+
+#include "utils.h"
+#include "chart_renderer.h"
+#include "data_persistence.h"
+#include <cstdarg>
+#include <cerrno>
+#include <csignal>
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+namespace
+{
+    // printf-style append to buffer
+    void appendFormat(std::string &buffer, const char *format, ...)
+    {
+        char text[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        if (length > 0)
+            buffer.append(text, std::min(static_cast<size_t>(length), sizeof(text) - 1));
+    }
+
+    FILE *openGnuplot(const char *command)
+    {
+#ifndef _WIN32
+        // A closed gnuplot window must fail the write with EPIPE, not kill us
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        return popen(command, "w");
+    }
+}
+
+ChartStamp currentChartStamp(const std::string &symbol)
+{
+    ChartStamp stamp;
+    auto candlesIt = candlesMap.find(symbol);
+    if (candlesIt != candlesMap.end())
+        stamp.candles = candlesIt->second.size();
+    double price = chartCurrentPrice(symbol);
+    if (price > 0.0)
+        stamp.pricePaise = std::llround(price * 100.0); // The label shows two decimals
+    return stamp;
+}
+
+void appendGnuplotFrame(const ChartWindow &window, const std::string &symbol, std::string &buffer)
+{
+    // Calculate the minimum and maximum price from the visible candles
+    double minPrice = std::numeric_limits<double>::max();
+    double maxPrice = std::numeric_limits<double>::lowest();
+    for (const auto &candle : window.candles)
+    {
+        if (candle.low < minPrice)
+            minPrice = candle.low;
+        if (candle.high > maxPrice)
+            maxPrice = candle.high;
+    }
+
+    // Add some padding to the min and max prices for better visualization
+    double padding = (maxPrice - minPrice) * 0.05;
+    minPrice -= padding;
+    maxPrice += padding;
+
+    // x-range covers the visible candles by their history index
+    size_t xrangeMin = window.first;
+    size_t xrangeMax = window.first + (window.candles.size() - 1) * window.stride;
+
+    // The data goes down the pipe as inline datablocks, ahead of the commands that plot it
+    buffer += "reset\n";
+    appendChartDatablocks(window, buffer);
+    appendFormat(buffer, "set xrange [%zu:%zu]\n", xrangeMin, xrangeMax);
+    appendFormat(buffer, "set yrange [%f:%f]\n", minPrice, maxPrice);
+    buffer += "set style fill solid 0.4\n"; // Filled candlestick body
+    buffer += "set grid\n";
+
+    // Begin multiplot
+    appendFormat(buffer, "set multiplot title 'IndiNexus - %s'\n", symbol.c_str());
+
+    // First plot: Candlestick chart with Moving Average
+    buffer += "set size 1.0,0.75\n";
+    buffer += "set origin 0.0,0.2\n";        // Starting from y=0.2 to y=1.0
+    buffer += "set boxwidth 0.3 relative\n"; // Adjust boxwidth to make candles thinner
+    buffer += "set style data candlesticks\n";
+    buffer += "set key top right\n";
+
+    // Annotate the current price at the bottom right corner of the candlestick chart
+    if (window.currentPrice > 0.0)
+        appendFormat(buffer, "set label 1 'Current Price: INR %.2f' at graph 0.99, graph 0.04 right front\n", window.currentPrice);
+
+    // Plot the candlestick chart and moving average with titles for the legend
+    buffer += "plot \\\n";
+    buffer += "$candles using 1:($5>$2?$2:1):($5>$2?$3:1):($5>$2?$4:1):($5>$2?$5:1) with candlesticks lw 1 lc rgb 'green' title 'Bullish', \\\n";
+    buffer += "$candles using 1:($5<=$2?$2:1):($5<=$2?$3:1):($5<=$2?$4:1):($5<=$2?$5:1) with candlesticks lw 1 lc rgb 'red' title 'Bearish', \\\n";
+    buffer += "$ma using 1:2 with lines lw 2 lc rgb 'blue' title 'Moving Average', \\\n";
+    buffer += "$bands using 1:2 with lines lw 1 dt 2 lc rgb 'gray40' title 'Bollinger Bands', \\\n";
+    buffer += "$bands using 1:3 with lines lw 1 dt 2 lc rgb 'gray40' notitle\n";
+
+    // Unset the label after the first plot
+    buffer += "unset label 1\n";
+
+    // Second plot: RSI
+    buffer += "set size 1.0,0.2\n";
+    buffer += "set origin 0.0,0.0\n"; // Starting from y=0.0 to y=0.2
+    buffer += "set grid\n";
+    buffer += "set yrange [0:100]\n";
+    buffer += "plot \\\n";
+    buffer += "$rsi using 1:2 with lines lw 2 lc rgb 'red' title 'RSI', \\\n";
+    buffer += "80 with lines dt 2 lw 3 lc rgb 'gray' notitle, \\\n";
+    buffer += "20 with lines dt 2 lw 3 lc rgb 'gray' notitle\n";
+
+    // Finish multiplot
+    buffer += "unset multiplot\n";
+}
+
+ChartRenderer::ChartRenderer(const std::string &symbol, const char *command, EventLoop &loop)
+    : symbol(symbol), pipe(openGnuplot(command)), loop(loop)
+{
+    if (pipe == nullptr)
+        return;
+
+    // Set the terminal type once at the beginning
+    fprintf(pipe, "reset\n");
+#ifdef _WIN32
+    fprintf(pipe, "set term windows\n"); // Use 'windows' terminal
+#else
+    fprintf(pipe, "set term %s\n", "qt"); // Use 'qt' terminal
+#endif
+    fflush(pipe);
+#ifndef _WIN32
+    // Frames bypass stdio from here on
+    fcntl(fileno(pipe), F_SETFL, fcntl(fileno(pipe), F_GETFL) | O_NONBLOCK);
+#endif
+}
+
+ChartRenderer::~ChartRenderer()
+{
+    if (pipe == nullptr)
+        return;
+#ifndef _WIN32
+    if (waitingForPipe)
+        loop.unwatch(fileno(pipe));
+
+    // Whatever is left goes out blocking, as gnuplot reads it
+    fcntl(fileno(pipe), F_SETFL, fcntl(fileno(pipe), F_GETFL) & ~O_NONBLOCK);
+#endif
+    if (written == buffer.size() && hasPending)
+        startFrame();
+    writeSome();
+    pclose(pipe);
+}
+
+void ChartRenderer::post(ChartWindow &window)
+{
+    if (pipe == nullptr)
+        return;
+    if (hasPending)
+        ++dropped; // The pipe never got to the previous one
+    std::swap(pending, window);
+    hasPending = true;
+    if (written == buffer.size())
+    {
+        startFrame();
+        writeSome();
+    }
+}
+
+void ChartRenderer::startFrame()
+{
+    buffer.clear();
+    written = 0;
+    appendGnuplotFrame(pending, symbol, buffer);
+    hasPending = false;
+}
+
+void ChartRenderer::writeSome()
+{
+#ifdef _WIN32
+    fwrite(buffer.data() + written, 1, buffer.size() - written, pipe);
+    fflush(pipe);
+    written = buffer.size();
+    ++rendered;
+    if (hasPending)
+    {
+        startFrame();
+        writeSome();
+    }
+#else
+    int fd = fileno(pipe);
+    while (written < buffer.size())
+    {
+        ssize_t count = write(fd, buffer.data() + written, buffer.size() - written);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Full: the loop carries on once gnuplot has read some
+                if (!waitingForPipe)
+                {
+                    loop.watchWritable(fd, [this]
+                                       { writeSome(); });
+                    waitingForPipe = true;
+                }
+                return;
+            }
+            // gnuplot has gone (EPIPE): close the renderer, so isOpen() says so
+            if (waitingForPipe)
+                loop.unwatch(fd);
+            waitingForPipe = false;
+            pclose(pipe);
+            pipe = nullptr;
+            written = buffer.size();
+            hasPending = false;
+            return;
+        }
+        written += static_cast<size_t>(count);
+        if (written == buffer.size())
+        {
+            ++rendered;
+            if (hasPending)
+                startFrame();
+        }
+    }
+    if (waitingForPipe)
+    {
+        loop.unwatch(fd);
+        waitingForPipe = false;
+    }
+#endif
+}
@@ -0,0 +1,579 @@
+// src/client_mode.cpp
+
+#include "utils.h"
+#include "client_mode.h"
+#include "wire_protocol.h"
+#include "script_mode.h"
+#include "event_loop.h"
+#include <cerrno>
+#include <memory>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+
+namespace
+{
+    const size_t RECEIVE_BYTES = 64 << 10;
+
+    // How often the load generator sends the orders that are due
+    const auto ORDER_INTERVAL = std::chrono::milliseconds(10);
+
+    // The server's symbol table: its IDs for names, and names for its IDs
+    struct SymbolTable
+    {
+        std::map<std::string, SymbolId> ids;
+        std::unordered_map<SymbolId, std::string> names;
+    };
+
+    bool parsePort(const std::string &text, uint16_t &port)
+    {
+        unsigned long value = std::stoul(text);
+        port = static_cast<uint16_t>(value);
+        return value != 0 && value <= 65535;
+    }
+
+    bool sendAll(int fd, const std::string &bytes)
+    {
+        size_t sent = 0;
+        while (sent < bytes.size())
+        {
+            ssize_t written = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+            sent += static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    // Block until the next whole frame; false once the server has gone
+    bool receiveFrame(int fd, FrameReader &in, const char *&body, size_t &size)
+    {
+        while (!in.next(body, size))
+        {
+            if (in.broken())
+                return false;
+            ssize_t received = recv(fd, in.prepare(RECEIVE_BYTES), RECEIVE_BYTES, 0);
+            if (received < 0 && errno == EINTR)
+                continue;
+            if (received <= 0)
+                return false;
+            in.commit(static_cast<size_t>(received));
+        }
+        return true;
+    }
+
+    bool readSymbolTable(const char *body, size_t size, SymbolTable &table)
+    {
+        WireReader reader(body, size);
+        uint8_t type = 0;
+        uint32_t count = 0;
+        reader.read(type);
+        reader.read(count);
+        for (uint32_t i = 0; i < count && reader.ok(); ++i)
+        {
+            SymbolId id = 0;
+            double price = 0.0;
+            uint8_t length = 0;
+            std::string name;
+            reader.read(id);
+            reader.read(price);
+            reader.read(length);
+            reader.readString(length, name);
+            table.ids[name] = id;
+            table.names[id] = name;
+        }
+        return reader.ok() && type == static_cast<uint8_t>(WireType::SymbolTable);
+    }
+
+    int connectOrComplain(const std::string &socketPath, uint16_t port)
+    {
+        int fd = connectToServer(socketPath, port);
+        if (fd < 0)
+        {
+            std::cerr << "Could not connect to " << (port != 0 ? "127.0.0.1:" + std::to_string(port) : socketPath)
+                      << "; is IndiNexus --serve running?" << std::endl;
+        }
+        return fd;
+    }
+
+    // Percentile of sorted samples
+    double percentile(const std::vector<double> &sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+    }
+}
+
+bool parseClientOptions(int argc, char *argv[], ClientOptions &options)
+{
+    bool client = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--client")
+                client = true;
+            else if (arg == "--socket" && hasValue)
+                options.socketPath = argv[++i];
+            else if (arg == "--port" && hasValue)
+            {
+                if (!parsePort(argv[++i], options.port))
+                    return false;
+            }
+            else if (arg == "--symbols" && hasValue)
+            {
+                std::stringstream list(argv[++i]);
+                std::string symbol;
+                while (std::getline(list, symbol, ','))
+                {
+                    std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+                    options.symbols.push_back(symbol);
+                }
+            }
+            else if (arg == "--orders" && hasValue)
+                options.ordersPath = argv[++i];
+            else if (arg == "--batch" && hasValue)
+                options.batch = std::stoul(argv[++i]);
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    if (options.socketPath.empty())
+        options.socketPath = DEFAULT_SERVER_SOCKET;
+    return client && options.batch > 0;
+}
+
+bool parseLoadOptions(int argc, char *argv[], LoadOptions &options)
+{
+    bool load = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--loadgen")
+                load = true;
+            else if (arg == "--socket" && hasValue)
+                options.socketPath = argv[++i];
+            else if (arg == "--port" && hasValue)
+            {
+                if (!parsePort(argv[++i], options.port))
+                    return false;
+            }
+            else if (arg == "--subscribers" && hasValue)
+                options.subscribers = std::stoul(argv[++i]);
+            else if (arg == "--seconds" && hasValue)
+                options.seconds = std::stod(argv[++i]);
+            else if (arg == "--orders-per-second" && hasValue)
+                options.orderRate = std::stod(argv[++i]);
+            else if (arg == "--batch" && hasValue)
+                options.batch = std::stoul(argv[++i]);
+            else if (arg == "--symbol" && hasValue)
+            {
+                options.symbol = argv[++i];
+                std::transform(options.symbol.begin(), options.symbol.end(), options.symbol.begin(), ::toupper);
+            }
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    if (options.socketPath.empty())
+        options.socketPath = DEFAULT_SERVER_SOCKET;
+    return load && options.seconds > 0.0 && options.orderRate >= 0.0 && options.batch > 0;
+}
+
+int runClientMode(const ClientOptions &options)
+{
+    // Orders are read and checked before connecting
+    std::vector<TradeCommand> orders;
+    if (!options.ordersPath.empty())
+    {
+        std::ifstream ordersFile;
+        if (options.ordersPath != "-")
+        {
+            ordersFile.open(options.ordersPath);
+            if (!ordersFile)
+            {
+                std::cerr << "Could not open " << options.ordersPath << std::endl;
+                return 1;
+            }
+        }
+        std::istream &in = (options.ordersPath == "-") ? std::cin : ordersFile;
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(in, line))
+        {
+            ++lineNumber;
+            TradeCommand command;
+            std::string error;
+            if (parseScriptLine(line, command, error))
+                orders.push_back(command);
+            else if (!error.empty())
+                std::cerr << "Line " << lineNumber << ": " << error << " (skipped)" << std::endl;
+        }
+    }
+
+    int fd = connectOrComplain(options.socketPath, options.port);
+    if (fd < 0)
+        return 1;
+
+    FrameReader in;
+    const char *body;
+    size_t size;
+    SymbolTable table;
+    if (!receiveFrame(fd, in, body, size) || !readSymbolTable(body, size, table))
+    {
+        std::cerr << "The server did not send its symbol table." << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    // Market data unless only sending orders
+    std::string outgoing;
+    bool streaming = orders.empty() || !options.symbols.empty();
+    if (streaming)
+    {
+        std::vector<SymbolId> ids;
+        for (const std::string &symbol : options.symbols)
+        {
+            auto it = table.ids.find(symbol);
+            if (it == table.ids.end())
+            {
+                std::cerr << "The server does not trade " << symbol << std::endl;
+                close(fd);
+                return 1;
+            }
+            ids.push_back(it->second);
+        }
+        appendSubscribe(outgoing, WireType::Subscribe, ids);
+    }
+
+    // Tags are the orders' line positions; symbols are mapped to the server's IDs
+    std::vector<WireOrder> wireOrders;
+    for (size_t i = 0; i < orders.size(); ++i)
+    {
+        const TradeCommand &command = orders[i];
+        WireOrder order;
+        order.tag = i + 1;
+        order.type = command.type;
+        order.symbolId = INVALID_SYMBOL_ID;
+        if (command.symbolId != INVALID_SYMBOL_ID)
+        {
+            auto it = table.ids.find(symbolName(command.symbolId));
+            if (it != table.ids.end())
+                order.symbolId = it->second;
+        }
+        order.amount = command.amount;
+        order.limitPrice = command.limitPrice;
+        order.stopPrice = command.stopPrice;
+        order.trailAmount = command.trailAmount;
+        order.takeProfit = command.takeProfit;
+        order.orderId = command.orderId;
+        wireOrders.push_back(order);
+    }
+    for (size_t first = 0; first < wireOrders.size(); first += options.batch)
+        appendOrderBatch(outgoing, wireOrders.data() + first, std::min(options.batch, wireOrders.size() - first));
+    if (!sendAll(fd, outgoing))
+    {
+        std::cerr << "The server closed the connection." << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    size_t acknowledged = 0;
+    std::cout << std::fixed << std::setprecision(2);
+    while ((streaming || acknowledged < wireOrders.size()) && receiveFrame(fd, in, body, size))
+    {
+        WireReader reader(body, size);
+        uint8_t type = 0;
+        reader.read(type);
+        if (type == static_cast<uint8_t>(WireType::Tick) || type == static_cast<uint8_t>(WireType::CandleClose))
+        {
+            SymbolId id = 0;
+            uint64_t sequence = 0;
+            int64_t sent = 0;
+            reader.read(id);
+            reader.read(sequence);
+            reader.read(sent);
+            auto name = table.names.find(id);
+            if (!reader.ok() || name == table.names.end())
+                continue; // Not a symbol the server announced
+            std::cout << std::left << std::setw(12) << name->second << std::right;
+            if (type == static_cast<uint8_t>(WireType::Tick))
+            {
+                double price = 0.0;
+                reader.read(price);
+                std::cout << " tick   " << price << std::endl;
+            }
+            else
+            {
+                Candle candle{};
+                reader.read(candle.open);
+                reader.read(candle.high);
+                reader.read(candle.low);
+                reader.read(candle.close);
+                std::cout << " candle O " << candle.open << " H " << candle.high << " L " << candle.low << " C " << candle.close
+                          << std::endl;
+            }
+        }
+        else if (type == static_cast<uint8_t>(WireType::OrderAck))
+        {
+            WireAck ack;
+            if (!readWireAck(reader, ack))
+                break;
+            if (ack.tag == 0)
+            {
+                std::cout << "execution: " << ack.message << std::endl;
+                continue;
+            }
+            ++acknowledged;
+            std::cout << "order " << ack.tag << (ack.flags & WIRE_ACCEPTED ? " accepted" : " rejected")
+                      << (ack.orderId != 0 ? " (#" + std::to_string(ack.orderId) + ")" : std::string()) << ": " << ack.message
+                      << std::endl;
+        }
+    }
+    close(fd);
+    return acknowledged == wireOrders.size() ? 0 : 1;
+}
+
+int runLoadGenerator(const LoadOptions &options)
+{
+    size_t descriptors = raiseDescriptorLimit();
+    if (options.subscribers + 16 > descriptors)
+    {
+        std::cerr << options.subscribers << " subscribers need more than the " << descriptors << " descriptors allowed" << std::endl;
+        return 1;
+    }
+
+    // Subscribers: one connection each, subscribed to every symbol
+    struct Subscriber
+    {
+        int fd;
+        FrameReader in;
+    };
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    SymbolTable table;
+    std::string subscribe;
+    appendSubscribe(subscribe, WireType::Subscribe, {});
+
+    auto connectStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < options.subscribers; ++i)
+    {
+        int fd = connectOrComplain(options.socketPath, options.port);
+        if (fd < 0)
+            return 1;
+        if (!sendAll(fd, subscribe))
+        {
+            std::cerr << "Subscriber " << i << " was refused" << std::endl;
+            return 1;
+        }
+        auto subscriber = std::make_unique<Subscriber>();
+        subscriber->fd = fd;
+        subscribers.push_back(std::move(subscriber));
+    }
+    double connectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectStart).count();
+
+    EventLoop loop;
+    std::vector<double> fanOutMicros;
+    size_t ticks = 0;
+    size_t candles = 0;
+    size_t dropped = 0;
+    for (auto &entry : subscribers)
+    {
+        Subscriber *subscriber = entry.get();
+        int flags = fcntl(subscriber->fd, F_GETFL, 0);
+        fcntl(subscriber->fd, F_SETFL, flags | O_NONBLOCK);
+        loop.watchReadable(subscriber->fd, [&, subscriber]
+                           {
+                               ssize_t received = recv(subscriber->fd, subscriber->in.prepare(RECEIVE_BYTES), RECEIVE_BYTES, 0);
+                               if (received < 0 && (errno == EAGAIN || errno == EINTR))
+                                   return;
+                               if (received <= 0)
+                               {
+                                   loop.unwatch(subscriber->fd);
+                                   ++dropped;
+                                   return;
+                               }
+                               subscriber->in.commit(static_cast<size_t>(received));
+                               int64_t now = wireClockNanos();
+                               const char *body;
+                               size_t size;
+                               while (subscriber->in.next(body, size))
+                               {
+                                   WireReader reader(body, size);
+                                   uint8_t type = 0;
+                                   SymbolId id = 0;
+                                   uint64_t sequence = 0;
+                                   int64_t sent = 0;
+                                   reader.read(type);
+                                   if (type == static_cast<uint8_t>(WireType::SymbolTable))
+                                   {
+                                       if (table.ids.empty())
+                                           readSymbolTable(body, size, table);
+                                       continue;
+                                   }
+                                   reader.read(id);
+                                   reader.read(sequence);
+                                   reader.read(sent);
+                                   if (type == static_cast<uint8_t>(WireType::Tick))
+                                       ++ticks;
+                                   else if (type == static_cast<uint8_t>(WireType::CandleClose))
+                                       ++candles;
+                                   fanOutMicros.push_back((now - sent) / 1000.0);
+                               } });
+    }
+
+    // Orders: alternate buys and sells of one share over their own connection, at the given rate
+    int orderFd = -1;
+    FrameReader orderIn;
+    std::vector<int64_t> sentAt; // By tag - 1
+    std::vector<double> roundTripMicros;
+    size_t accepted = 0;
+    size_t rejected = 0;
+    size_t executions = 0;
+    std::string firstRejection;
+    auto start = std::chrono::steady_clock::now();
+    if (options.orderRate > 0.0)
+    {
+        orderFd = connectOrComplain(options.socketPath, options.port);
+        if (orderFd < 0)
+            return 1;
+        const char *body;
+        size_t size;
+        if (!receiveFrame(orderFd, orderIn, body, size) || !readSymbolTable(body, size, table) || table.ids.count(options.symbol) == 0)
+        {
+            std::cerr << "The server does not trade " << options.symbol << std::endl;
+            return 1;
+        }
+        SymbolId symbolId = table.ids[options.symbol];
+
+        loop.addTimer(ORDER_INTERVAL, [&, symbolId](uint64_t)
+                      {
+                          double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                          size_t due = static_cast<size_t>(elapsed * options.orderRate);
+                          std::vector<WireOrder> batch;
+                          std::string outgoing;
+                          while (sentAt.size() < due)
+                          {
+                              WireOrder order;
+                              order.tag = sentAt.size() + 1;
+                              order.type = (order.tag % 2 == 1) ? CommandType::MarketBuy : CommandType::MarketSell;
+                              order.symbolId = symbolId;
+                              order.amount = 1.0;
+                              batch.push_back(order);
+                              sentAt.push_back(wireClockNanos());
+                              if (batch.size() == options.batch || sentAt.size() == due)
+                              {
+                                  appendOrderBatch(outgoing, batch.data(), batch.size());
+                                  batch.clear();
+                              }
+                          }
+                          if (!outgoing.empty() && !sendAll(orderFd, outgoing))
+                              loop.stop(); });
+        loop.watchReadable(orderFd, [&]
+                           {
+                               ssize_t received = recv(orderFd, orderIn.prepare(RECEIVE_BYTES), RECEIVE_BYTES, MSG_DONTWAIT);
+                               if (received <= 0)
+                               {
+                                   if (received == 0 || (errno != EAGAIN && errno != EINTR))
+                                       loop.stop();
+                                   return;
+                               }
+                               orderIn.commit(static_cast<size_t>(received));
+                               int64_t now = wireClockNanos();
+                               const char *body;
+                               size_t size;
+                               while (orderIn.next(body, size))
+                               {
+                                   WireReader reader(body, size);
+                                   uint8_t type = 0;
+                                   WireAck ack;
+                                   reader.read(type);
+                                   if (type != static_cast<uint8_t>(WireType::OrderAck) || !readWireAck(reader, ack))
+                                       continue;
+                                   if (ack.tag == 0 || ack.tag > sentAt.size())
+                                   {
+                                       ++executions;
+                                       continue;
+                                   }
+                                   roundTripMicros.push_back((now - sentAt[ack.tag - 1]) / 1000.0);
+                                   if (ack.flags & WIRE_ACCEPTED)
+                                       ++accepted;
+                                   else if (rejected++ == 0)
+                                       firstRejection = ack.message;
+                               } });
+    }
+
+    loop.addTimer(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(options.seconds)), [&](uint64_t)
+                  { loop.stop(); });
+    loop.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto &subscriber : subscribers)
+        close(subscriber->fd);
+    if (orderFd >= 0)
+        close(orderFd);
+
+    std::sort(fanOutMicros.begin(), fanOutMicros.end());
+    std::sort(roundTripMicros.begin(), roundTripMicros.end());
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Subscribers:  " << subscribers.size() << " connected in " << connectSeconds << " s, " << dropped
+              << " dropped by the server" << "\n";
+    std::cout << "Market data:  " << ticks << " ticks and " << candles << " candles received in " << seconds << " s ("
+              << std::setprecision(0) << (ticks + candles) / seconds << " frames/s)" << "\n";
+    std::cout << std::setprecision(1);
+    std::cout << "Fan-out (us): server send to subscriber read, p50 " << percentile(fanOutMicros, 0.5) << ", p99 "
+              << percentile(fanOutMicros, 0.99) << ", max " << (fanOutMicros.empty() ? 0.0 : fanOutMicros.back()) << "\n";
+    if (orderFd >= 0)
+    {
+        std::cout << "Orders:       " << sentAt.size() << " sent in batches of up to " << options.batch << ", " << accepted
+                  << " accepted, " << rejected << " rejected, " << roundTripMicros.size() << " acknowledged ("
+                  << std::setprecision(0) << roundTripMicros.size() / seconds << "/s), " << executions << " executions";
+        if (!firstRejection.empty())
+            std::cout << "; first rejection: " << firstRejection;
+        std::cout << "\n";
+        std::cout << std::setprecision(1) << "Round trip (us): p50 " << percentile(roundTripMicros, 0.5) << ", p99 " << percentile(roundTripMicros, 0.99)
+                  << ", max " << (roundTripMicros.empty() ? 0.0 : roundTripMicros.back()) << "\n";
+    }
+    std::cout.flush();
+    return 0;
+}
+#else
+bool parseClientOptions(int argc, char *argv[], ClientOptions &options)
+{
+    return false;
+}
+
+bool parseLoadOptions(int argc, char *argv[], LoadOptions &options)
+{
+    return false;
+}
+
+int runClientMode(const ClientOptions &options)
+{
+    std::cerr << "The market client needs Unix sockets" << std::endl;
+    return 1;
+}
+
+int runLoadGenerator(const LoadOptions &options)
+{
+    std::cerr << "The load generator needs epoll and Unix sockets" << std::endl;
+    return 1;
+}
+#endif
@@ -0,0 +1,721 @@
+// src/csv_ingest.cpp
+
+#include "utils.h"
+#include "csv_ingest.h"
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define CSV_INGEST_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // Chunks are about this size, and there are at least as many as workers
+    const size_t CHUNK_BYTES = 32 << 20;
+
+    enum CsvField
+    {
+        SymbolField,
+        SeriesField,
+        DateField,
+        OpenField,
+        HighField,
+        LowField,
+        CloseField,
+        FIELD_COUNT,
+        NoField = FIELD_COUNT
+    };
+
+    // Header names of each field, upper-cased, across the formats we read
+    const std::vector<std::pair<std::string, CsvField>> FIELD_NAMES = {
+        {"SYMBOL", SymbolField}, {"TCKRSYMB", SymbolField}, {"TICKER", SymbolField},
+        {"SERIES", SeriesField}, {"SCTYSRS", SeriesField},
+        {"TIMESTAMP", DateField}, {"DATE", DateField}, {"DATE1", DateField}, {"TRADDT", DateField},
+        {"OPEN", OpenField}, {"OPNPRIC", OpenField}, {"OPEN_PRICE", OpenField},
+        {"HIGH", HighField}, {"HGHPRIC", HighField}, {"HIGH_PRICE", HighField},
+        {"LOW", LowField}, {"LWPRIC", LowField}, {"LOW_PRICE", LowField},
+        {"CLOSE", CloseField}, {"CLSPRIC", CloseField}, {"CLOSE_PRICE", CloseField},
+    };
+
+    // Which field each column holds, up to the last column we need
+    struct CsvLayout
+    {
+        std::vector<CsvField> columns;
+        bool has[FIELD_COUNT] = {};
+    };
+
+    // A row before it is put in date order
+    struct DatedCandle
+    {
+        int date; // YYYYMMDD, or 0
+        Candle candle;
+    };
+
+    // Rows by stored symbol, accumulated across files
+    using SymbolRows = std::map<std::string, std::vector<DatedCandle>>;
+
+    // What one chunk parsed; symbol names point into the mapped text
+    struct ChunkResult
+    {
+        std::unordered_map<std::string_view, uint32_t> slots;
+        std::vector<std::string_view> names;
+        std::vector<std::vector<DatedCandle>> rows;
+        std::vector<uint32_t> following; // The slot that came after each slot last time
+        size_t rowCount = 0;
+        size_t skipped = 0;
+        size_t filtered = 0;
+    };
+
+    // A read-only view of a whole file
+    class MappedFile
+    {
+    public:
+        ~MappedFile()
+        {
+#ifdef _WIN32
+            if (view != nullptr)
+                UnmapViewOfFile(view);
+#else
+            if (view != nullptr)
+                munmap(view, bytes);
+#endif
+        }
+
+        bool open(const std::string &path)
+        {
+#ifdef _WIN32
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+            {
+                HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (fileMapping != nullptr)
+                {
+                    view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(fileMapping); // The view keeps the mapping alive
+                }
+                bytes = static_cast<size_t>(fileSize.QuadPart);
+            }
+            CloseHandle(file);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+            {
+                bytes = static_cast<size_t>(fileStat.st_size);
+                void *mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED)
+                {
+                    view = mapped;
+                    madvise(view, bytes, MADV_SEQUENTIAL); // Each chunk is read front to back, once
+                }
+            }
+            ::close(fd); // The mapping keeps the file alive
+#endif
+            return view != nullptr;
+        }
+
+        const char *data() const { return static_cast<const char *>(view); }
+        size_t size() const { return bytes; }
+
+    private:
+        void *view = nullptr;
+        size_t bytes = 0;
+    };
+
+    std::string_view trim(const char *begin, const char *end)
+    {
+        while (begin < end && (*begin == ' ' || *begin == '\t'))
+            ++begin;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+            --end;
+        return std::string_view(begin, static_cast<size_t>(end - begin));
+    }
+
+    std::string upper(std::string_view text)
+    {
+        std::string result(text);
+        std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+        return result;
+    }
+
+    // A price field, which must be all number. Plain decimals of up to 15
+    // digits, which is nearly every price, are read as an integer and one
+    // division by an exact power of ten, which rounds correctly just as
+    // from_chars does; anything else goes to from_chars.
+    bool parsePrice(std::string_view text, double &value)
+    {
+        static const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+        const char *p = text.data();
+        const char *end = p + text.size();
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int decimals = -1; // Digits after the point, once there is one
+        for (; p < end; ++p)
+        {
+            if (*p >= '0' && *p <= '9')
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                ++digits;
+                if (decimals >= 0)
+                    ++decimals;
+            }
+            else if (*p == '.' && decimals < 0)
+                decimals = 0;
+            else
+                break;
+        }
+        if (p == end && digits > 0 && digits <= 15)
+        {
+            value = (decimals > 0) ? static_cast<double>(mantissa) / POWERS_OF_TEN[decimals] : static_cast<double>(mantissa);
+            return true;
+        }
+
+        std::from_chars_result result = std::from_chars(text.data(), end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    bool parseDigits(const char *text, int count, int &value)
+    {
+        value = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (text[i] < '0' || text[i] > '9')
+                return false;
+            value = value * 10 + (text[i] - '0');
+        }
+        return true;
+    }
+
+    int monthNumber(const char *text)
+    {
+        static const char MONTHS[] = "JANFEBMARAPRMAYJUNJULAUGSEPOCTNOVDEC";
+        // Clearing the ASCII case bit upper-cases letters without the locale
+        char first = static_cast<char>(text[0] & ~0x20), second = static_cast<char>(text[1] & ~0x20), third = static_cast<char>(text[2] & ~0x20);
+        for (int month = 0; month < 12; ++month)
+        {
+            if (MONTHS[month * 3] == first && MONTHS[month * 3 + 1] == second && MONTHS[month * 3 + 2] == third)
+                return month + 1;
+        }
+        return 0;
+    }
+
+    // A date as YYYYMMDD, from 2024-07-05, 05-JUL-2024, 05-07-2024 or
+    // 20240705 (anything after the date, such as a time, is ignored); 0 if
+    // it is none of those
+    int parseDate(std::string_view text)
+    {
+        const char *s = text.data();
+        int year = 0, month = 0, day = 0;
+        if (text.size() >= 10 && s[4] == '-' && s[7] == '-')
+        {
+            if (!parseDigits(s, 4, year) || !parseDigits(s + 5, 2, month) || !parseDigits(s + 8, 2, day))
+                return 0;
+        }
+        else if (text.size() >= 11 && s[2] == '-' && s[6] == '-')
+        {
+            month = monthNumber(s + 3);
+            if (!parseDigits(s, 2, day) || !parseDigits(s + 7, 4, year))
+                return 0;
+        }
+        else if (text.size() >= 10 && s[2] == '-' && s[5] == '-')
+        {
+            if (!parseDigits(s, 2, day) || !parseDigits(s + 3, 2, month) || !parseDigits(s + 6, 4, year))
+                return 0;
+        }
+        else if (text.size() == 8)
+        {
+            if (!parseDigits(s, 4, year) || !parseDigits(s + 4, 2, month) || !parseDigits(s + 6, 2, day))
+                return 0;
+        }
+        else
+            return 0;
+        if (month < 1 || month > 12 || day < 1 || day > 31)
+            return 0;
+        return year * 10000 + month * 100 + day;
+    }
+
+    // Find each field's column from the header line
+    bool readHeader(std::string_view header, CsvLayout &layout, std::string &error)
+    {
+        if (header.size() >= 3 && header.compare(0, 3, "\xEF\xBB\xBF") == 0)
+            header.remove_prefix(3); // UTF-8 byte order mark
+
+        size_t lastNeeded = 0;
+        size_t column = 0;
+        size_t start = 0;
+        while (start <= header.size())
+        {
+            size_t comma = header.find(',', start);
+            size_t stop = (comma == std::string_view::npos) ? header.size() : comma;
+            std::string name = upper(trim(header.data() + start, header.data() + stop));
+            if (name.size() >= 2 && name.front() == '"' && name.back() == '"')
+                name = name.substr(1, name.size() - 2);
+
+            CsvField field = NoField;
+            for (const auto &pair : FIELD_NAMES)
+            {
+                if (name == pair.first && !layout.has[pair.second])
+                    field = pair.second;
+            }
+            layout.columns.push_back(field);
+            if (field != NoField)
+            {
+                layout.has[field] = true;
+                lastNeeded = column;
+            }
+            if (comma == std::string_view::npos)
+                break;
+            start = comma + 1;
+            ++column;
+        }
+        layout.columns.resize(lastNeeded + 1);
+
+        for (CsvField field : {OpenField, HighField, LowField, CloseField})
+        {
+            if (!layout.has[field])
+            {
+                error = "no OPEN, HIGH, LOW and CLOSE columns in the header";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Split the needed columns of [line, lineEnd) into fields; false if the
+    // line has too few columns. A quoted field ends at its closing quote,
+    // whatever it contains.
+    bool splitFieldsScalar(const char *line, const char *lineEnd, const CsvLayout &layout, std::string_view *fields)
+    {
+        const char *p = line;
+        for (size_t column = 0; column < layout.columns.size(); ++column)
+        {
+            if (p > lineEnd)
+                return false;
+            const char *start = p;
+            const char *stop;
+            if (p < lineEnd && *p == '"')
+            {
+                start = p + 1;
+                const char *quote = static_cast<const char *>(std::memchr(start, '"', static_cast<size_t>(lineEnd - start)));
+                stop = quote ? quote : lineEnd;
+                const char *comma = quote ? static_cast<const char *>(std::memchr(quote, ',', static_cast<size_t>(lineEnd - quote))) : nullptr;
+                p = comma ? comma + 1 : lineEnd + 1;
+            }
+            else
+            {
+                while (p < lineEnd && *p != ',')
+                    ++p;
+                stop = p++;
+            }
+            CsvField field = layout.columns[column];
+            if (field != NoField)
+                fields[field] = trim(start, stop);
+        }
+        return true;
+    }
+
+    bool splitFields(const char *line, const char *lineEnd, const CsvLayout &layout, std::string_view *fields)
+    {
+#ifdef CSV_INGEST_SSE2
+        // Find the commas 16 bytes at a time and walk their bits; a line
+        // with a quote in the part we need is left to the scalar split
+        const __m128i commas = _mm_set1_epi8(',');
+        const __m128i quotes = _mm_set1_epi8('"');
+        const size_t columnCount = layout.columns.size();
+        const char *p = line;
+        const char *start = line;
+        size_t column = 0;
+        while (lineEnd - p >= 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, quotes)) != 0)
+                return splitFieldsScalar(line, lineEnd, layout, fields);
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, commas)));
+            while (mask != 0)
+            {
+                const char *comma = p + __builtin_ctz(mask);
+                mask &= mask - 1;
+                CsvField field = layout.columns[column];
+                if (field != NoField)
+                    fields[field] = trim(start, comma);
+                start = comma + 1;
+                if (++column == columnCount)
+                    return true;
+            }
+            p += 16;
+        }
+        for (; p < lineEnd; ++p)
+        {
+            if (*p == '"')
+                return splitFieldsScalar(line, lineEnd, layout, fields);
+            if (*p == ',')
+            {
+                CsvField field = layout.columns[column];
+                if (field != NoField)
+                    fields[field] = trim(start, p);
+                start = p + 1;
+                if (++column == columnCount)
+                    return true;
+            }
+        }
+        // The last field runs to the end of the line
+        if (column + 1 != columnCount)
+            return false;
+        if (layout.columns[column] != NoField)
+            fields[layout.columns[column]] = trim(start, lineEnd);
+        return true;
+#else
+        return splitFieldsScalar(line, lineEnd, layout, fields);
+#endif
+    }
+
+    // Parse the whole lines in [begin, end). Each line's end is found in one
+    // search, and only the columns up to the last one we need are split.
+    void parseChunk(const char *begin, const char *end, const CsvLayout &layout, const CsvIngestSettings &settings,
+                    ChunkResult &result)
+    {
+        std::string_view series(settings.series);
+        uint32_t previous = 0; // Slot of the last row
+        bool hasPrevious = false;
+        if (!layout.has[SymbolField])
+        {
+            result.names.push_back(settings.symbol);
+            result.rows.emplace_back();
+        }
+
+        const char *line = begin;
+        while (line < end)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+            const char *lineEnd = newline ? newline : end;
+            const char *next = newline ? newline + 1 : end;
+            if (lineEnd > line && lineEnd[-1] == '\r')
+                --lineEnd;
+            if (lineEnd == line)
+            {
+                line = next;
+                continue; // Blank line
+            }
+            ++result.rowCount;
+
+            std::string_view fields[FIELD_COUNT];
+            bool complete = splitFields(line, lineEnd, layout, fields);
+            line = next;
+            if (!complete)
+            {
+                ++result.skipped;
+                continue;
+            }
+
+            if (layout.has[SeriesField] && !series.empty() && fields[SeriesField] != series)
+            {
+                ++result.filtered;
+                continue;
+            }
+
+            DatedCandle row{0, Candle{}};
+            Candle &candle = row.candle;
+            if (!parsePrice(fields[OpenField], candle.open) || !parsePrice(fields[HighField], candle.high) ||
+                !parsePrice(fields[LowField], candle.low) || !parsePrice(fields[CloseField], candle.close) ||
+                !(candle.open > 0 && candle.high > 0 && candle.low > 0 && candle.close > 0 && candle.low <= candle.high))
+            {
+                ++result.skipped; // Includes the header lines of concatenated files
+                continue;
+            }
+            if (layout.has[DateField] && (row.date = parseDate(fields[DateField])) == 0)
+            {
+                ++result.skipped;
+                continue;
+            }
+
+            uint32_t slot = 0;
+            if (layout.has[SymbolField])
+            {
+                // Daily files list the symbols in the same order every day and
+                // per-symbol files repeat one symbol, so the symbol that followed
+                // the last row's symbol before is tried before the hash table
+                std::string_view symbol = fields[SymbolField];
+                if (symbol.empty())
+                {
+                    ++result.skipped;
+                    continue;
+                }
+                if (hasPrevious && result.names[result.following[previous]] == symbol)
+                    slot = result.following[previous];
+                else
+                {
+                    auto found = result.slots.find(symbol);
+                    if (found == result.slots.end())
+                    {
+                        uint32_t added = static_cast<uint32_t>(result.names.size());
+                        found = result.slots.emplace(symbol, added).first;
+                        result.names.push_back(symbol);
+                        result.rows.emplace_back();
+                        result.following.push_back(added);
+                    }
+                    slot = found->second;
+                    if (hasPrevious)
+                        result.following[previous] = slot;
+                }
+                previous = slot;
+                hasPrevious = true;
+            }
+            result.rows[slot].push_back(row);
+        }
+    }
+
+    // Stored symbols become file names
+    bool storableSymbol(const std::string &symbol)
+    {
+        return !symbol.empty() && symbol[0] != '.' && symbol.find_first_of("/\\:*?\"<>|") == std::string::npos;
+    }
+
+    // Parse one file's text into rows by stored symbol
+    bool parseInto(const char *data, size_t size, const CsvIngestSettings &settings, WorkStealingPool &pool,
+                   TaskPriority priority, SymbolRows &rows, CsvIngestSummary &summary, std::string &error)
+    {
+        const char *end = data + size;
+        const char *headerEnd = static_cast<const char *>(std::memchr(data, '\n', size));
+        if (headerEnd == nullptr)
+            headerEnd = end;
+        CsvLayout layout;
+        if (!readHeader(std::string_view(data, static_cast<size_t>(headerEnd - data)), layout, error))
+            return false;
+        if (!layout.has[SymbolField] && settings.symbol.empty())
+        {
+            error = "no SYMBOL column; give the file's symbol";
+            return false;
+        }
+
+        // Split the body at line starts into chunks of about CHUNK_BYTES
+        const char *body = (headerEnd < end) ? headerEnd + 1 : end;
+        size_t bodyBytes = static_cast<size_t>(end - body);
+        size_t chunkCount = std::max<size_t>(1, std::max<size_t>((bodyBytes + CHUNK_BYTES - 1) / CHUNK_BYTES,
+                                                                 bodyBytes >= (1 << 20) ? pool.size() : 1));
+        std::vector<const char *> bounds = {body};
+        for (size_t i = 1; i < chunkCount; ++i)
+        {
+            const char *cut = std::max(bounds.back(), body + bodyBytes * i / chunkCount);
+            const char *newline = static_cast<const char *>(std::memchr(cut, '\n', static_cast<size_t>(end - cut)));
+            bounds.push_back(newline ? newline + 1 : end);
+        }
+        bounds.push_back(end);
+
+        std::vector<ChunkResult> chunks(chunkCount);
+        TaskGroup parsing;
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            pool.submit(parsing, [&, i]
+                        { parseChunk(bounds[i], bounds[i + 1], layout, settings, chunks[i]); }, priority);
+        }
+        pool.wait(parsing);
+
+        // Gather the chunks in file order, so equal dates keep their order
+        for (ChunkResult &chunk : chunks)
+        {
+            summary.rows += chunk.rowCount;
+            summary.skipped += chunk.skipped;
+            summary.filtered += chunk.filtered;
+            for (size_t slot = 0; slot < chunk.names.size(); ++slot)
+            {
+                std::vector<DatedCandle> &chunkRows = chunk.rows[slot];
+                std::string source = upper(chunk.names[slot]);
+                if (!settings.symbols.empty() &&
+                    std::find(settings.symbols.begin(), settings.symbols.end(), source) == settings.symbols.end())
+                {
+                    summary.filtered += chunkRows.size();
+                    continue;
+                }
+                auto rename = settings.renames.find(source);
+                const std::string &stored = (rename != settings.renames.end()) ? rename->second : source;
+                if (!storableSymbol(stored))
+                {
+                    summary.skipped += chunkRows.size();
+                    continue;
+                }
+
+                std::vector<DatedCandle> &symbolRows = rows[stored];
+                if (symbolRows.empty())
+                    symbolRows = std::move(chunkRows);
+                else
+                    symbolRows.insert(symbolRows.end(), chunkRows.begin(), chunkRows.end());
+            }
+        }
+        return true;
+    }
+
+    // Put each symbol's rows in date order, one pool task per symbol
+    void finishSeries(SymbolRows &rows, WorkStealingPool &pool, TaskPriority priority, CsvIngestSummary &summary)
+    {
+        summary.series.resize(rows.size());
+        std::vector<size_t> duplicates(rows.size(), 0);
+        TaskGroup sorting;
+        size_t index = 0;
+        for (auto &pair : rows)
+        {
+            pool.submit(sorting, [&pair, &summary, &duplicates, index]
+                        {
+                            std::vector<DatedCandle> &symbolRows = pair.second;
+                            auto byDate = [](const DatedCandle &a, const DatedCandle &b)
+                            { return a.date < b.date; };
+                            if (!std::is_sorted(symbolRows.begin(), symbolRows.end(), byDate))
+                                std::stable_sort(symbolRows.begin(), symbolRows.end(), byDate);
+
+                            IngestedSeries &series = summary.series[index];
+                            series.symbol = pair.first;
+                            series.candles.reserve(symbolRows.size());
+                            for (size_t i = 0; i < symbolRows.size(); ++i)
+                            {
+                                // A later row for the same date replaces an earlier one
+                                if (symbolRows[i].date != 0 && i + 1 < symbolRows.size() && symbolRows[i + 1].date == symbolRows[i].date)
+                                {
+                                    ++duplicates[index];
+                                    continue;
+                                }
+                                series.candles.push_back(symbolRows[i].candle);
+                            }
+                            if (!symbolRows.empty())
+                            {
+                                series.firstDate = symbolRows.front().date;
+                                series.lastDate = symbolRows.back().date;
+                            }
+                            std::vector<DatedCandle>().swap(symbolRows); },
+                        priority);
+            ++index;
+        }
+        pool.wait(sorting);
+
+        for (size_t i = 0; i < summary.series.size(); ++i)
+        {
+            summary.duplicates += duplicates[i];
+            summary.candles += summary.series[i].candles.size();
+        }
+    }
+
+    template <typename T>
+    bool writeCountedSeries(const std::string &path, const std::vector<T> &series)
+    {
+        std::ofstream outFile(path, std::ios::binary | std::ios::trunc);
+        if (!outFile.is_open())
+            return false;
+        size_t size = series.size();
+        outFile.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        outFile.write(reinterpret_cast<const char *>(series.data()), size * sizeof(T));
+        return static_cast<bool>(outFile);
+    }
+
+    // Write one symbol as the snapshot pair loadStockData reads, and optionally as its history
+    bool writeSeries(const IngestedSeries &series, bool writeHistory)
+    {
+        const std::string base = "data/stock_data/" + series.symbol;
+        std::vector<double> closes;
+        closes.reserve(series.candles.size());
+        for (const Candle &candle : series.candles)
+            closes.push_back(candle.close);
+        if (!writeCountedSeries(base + "_candles.dat", series.candles) || !writeCountedSeries(base + "_closePrices.dat", closes))
+            return false;
+
+        if (writeHistory)
+        {
+            std::error_code error;
+            fs::create_directories(base, error);
+            std::ofstream outFile(base + "/candles_history.dat", std::ios::binary | std::ios::trunc);
+            if (!outFile.is_open())
+                return false;
+            outFile.write(reinterpret_cast<const char *>(series.candles.data()), series.candles.size() * sizeof(Candle));
+            if (!outFile)
+                return false;
+        }
+        return true;
+    }
+}
+
+bool parseCsvCandles(const char *data, size_t size, const CsvIngestSettings &settings, WorkStealingPool &pool,
+                     CsvIngestSummary &summary, std::string &error, TaskPriority priority)
+{
+    SymbolRows rows;
+    if (!parseInto(data, size, settings, pool, priority, rows, summary, error))
+        return false;
+    summary.files += 1;
+    summary.bytes += size;
+    finishSeries(rows, pool, priority, summary);
+    return true;
+}
+
+CsvIngestSummary ingestCsvFiles(const std::vector<std::string> &paths, const CsvIngestSettings &settings,
+                                WorkStealingPool &pool, TaskPriority priority)
+{
+    CsvIngestSummary summary;
+    auto start = std::chrono::steady_clock::now();
+
+    // A directory stands for the CSV files in it, such as a folder of daily bhavcopies
+    std::vector<std::string> files;
+    for (const std::string &path : paths)
+    {
+        std::error_code error;
+        if (!fs::is_directory(path, error))
+        {
+            files.push_back(path);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto &entry : fs::directory_iterator(path, error))
+        {
+            if (entry.is_regular_file() && upper(entry.path().extension().string()) == ".CSV")
+                found.push_back(entry.path().string());
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+
+    SymbolRows rows;
+    for (const std::string &file : files)
+    {
+        MappedFile mapped;
+        std::string error;
+        if (!mapped.open(file))
+            summary.errors.push_back(file + ": could not be read, or is empty");
+        else if (!parseInto(mapped.data(), mapped.size(), settings, pool, priority, rows, summary, error))
+            summary.errors.push_back(file + ": " + error);
+        else
+        {
+            summary.files += 1;
+            summary.bytes += mapped.size();
+        }
+    }
+    finishSeries(rows, pool, priority, summary);
+    summary.parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    fs::create_directories("data/stock_data");
+    std::vector<char> written(summary.series.size(), 0);
+    TaskGroup writes;
+    for (size_t i = 0; i < summary.series.size(); ++i)
+    {
+        pool.submit(writes, [&summary, &settings, &written, i]
+                    { written[i] = writeSeries(summary.series[i], settings.writeHistory); }, priority);
+    }
+    pool.wait(writes);
+    for (size_t i = 0; i < summary.series.size(); ++i)
+    {
+        if (!written[i])
+            summary.errors.push_back(summary.series[i].symbol + ": could not be written");
+    }
+    summary.writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
@@ -42,7 +42,13 @@ void User::saveUserData()
         outFile << encrypt(order.symbol, ENCRYPTION_SHIFT) << ' '
                 << encrypt(order.type, ENCRYPTION_SHIFT) << ' '
                 << encrypt(std::to_string(order.amount), ENCRYPTION_SHIFT) << ' '
-                << encrypt(std::to_string(order.limitPrice), ENCRYPTION_SHIFT) << '\n';
+                << encrypt(std::to_string(order.limitPrice), ENCRYPTION_SHIFT) << ' '
+                << encrypt(std::to_string(order.id), ENCRYPTION_SHIFT) << ' '
+                << encrypt(std::to_string(order.stopPrice), ENCRYPTION_SHIFT) << ' '
+                << encrypt(std::to_string(order.trailAmount), ENCRYPTION_SHIFT) << ' '
+                << encrypt(std::to_string(order.takeProfit), ENCRYPTION_SHIFT) << ' '
+                << encrypt(std::to_string(order.linkedId), ENCRYPTION_SHIFT) << ' '
+                << encrypt(std::to_string(order.filled), ENCRYPTION_SHIFT) << '\n';
     }
 
     // Save transactions
@@ -102,10 +108,11 @@ bool User::loadUserData()
             break;
         }
         std::istringstream iss(decryptedLine);
-        Holding holding;
-        if (iss >> holding.symbol >> holding.amount >> holding.averagePrice)
+        std::string symbol;
+        double amount, averagePrice;
+        if (iss >> symbol >> amount >> averagePrice)
         {
-            holdings.push_back(holding);
+            holdings.restore(internSymbol(symbol), amount, averagePrice);
         }
         else
         {
@@ -126,7 +133,15 @@ bool User::loadUserData()
         Order order;
         if (iss >> order.symbol >> order.type >> order.amount >> order.limitPrice)
         {
-            pendingOrders.push_back(order);
+            // Files written before order IDs existed have no ID column
+            if (iss >> order.id)
+            {
+                // Stop, trailing, OCO and bracket details; absent for plain limit orders saved earlier
+                iss >> order.stopPrice >> order.trailAmount >> order.takeProfit >> order.linkedId >> order.filled;
+                pendingOrders.restore(order);
+            }
+            else
+                pendingOrders.add(order);
         }
         else
         {
@@ -2,59 +2,61 @@
 
 #include "utils.h"
 #include "data_persistence.h"
+#include "market_data.h"
+#include "work_stealing_pool.h"
 
 // Define the variables
 std::map<std::string, std::vector<double>> closePricesMap;
 std::map<std::string, std::vector<Candle>> candlesMap;
-std::map<std::string, std::atomic<bool>> stopFlags;
 
-// Function to save stock data to disk
-void saveStockData(const std::map<std::string, std::vector<double>> &closePricesMap,
-                   const std::map<std::string, std::vector<Candle>> &candlesMap)
+namespace
 {
-    std::lock_guard<std::mutex> dataLock(dataMutex); // Ensure thread safety
-
-    fs::create_directories("data/stock_data"); // Ensure the directory exists
-
-    // Save closePricesMap
-    for (const auto &pair : closePricesMap)
+    // Write one series to its file, under the symbol's lock
+    template <typename T>
+    void saveSeries(const std::string &symbol, const std::vector<T> &series, const std::string &suffix)
     {
-        const std::string &symbol = pair.first;
-        const std::vector<double> &prices = pair.second;
+        std::lock_guard<std::mutex> seriesLock(symbolMarket(internSymbol(symbol)).seriesLock);
 
-        std::ofstream outFile("data/stock_data/" + symbol + "_closePrices.dat", std::ios::binary);
+        std::ofstream outFile("data/stock_data/" + symbol + suffix, std::ios::binary);
         if (outFile.is_open())
         {
-            size_t size = prices.size();
+            size_t size = series.size();
             outFile.write(reinterpret_cast<const char *>(&size), sizeof(size));
-            outFile.write(reinterpret_cast<const char *>(prices.data()), size * sizeof(double));
+            outFile.write(reinterpret_cast<const char *>(series.data()), size * sizeof(T));
             outFile.close();
         }
     }
+}
+
+// Function to save stock data to disk; each file is written by its own task on the shared pool
+void saveStockData(const std::map<std::string, std::vector<double>> &closePricesMap,
+                   const std::map<std::string, std::vector<Candle>> &candlesMap)
+{
+    fs::create_directories("data/stock_data"); // Ensure the directory exists
+
+    TaskGroup writes;
+
+    // Save closePricesMap
+    for (const auto &pair : closePricesMap)
+    {
+        sharedPool().submit(writes, [&pair]
+                            { saveSeries(pair.first, pair.second, "_closePrices.dat"); });
+    }
 
     // Save candlesMap
     for (const auto &pair : candlesMap)
     {
-        const std::string &symbol = pair.first;
-        const std::vector<Candle> &candles = pair.second;
-
-        std::ofstream outFile("data/stock_data/" + symbol + "_candles.dat", std::ios::binary);
-        if (outFile.is_open())
-        {
-            size_t size = candles.size();
-            outFile.write(reinterpret_cast<const char *>(&size), sizeof(size));
-            outFile.write(reinterpret_cast<const char *>(candles.data()), size * sizeof(Candle));
-            outFile.close();
-        }
+        sharedPool().submit(writes, [&pair]
+                            { saveSeries(pair.first, pair.second, "_candles.dat"); });
     }
+
+    sharedPool().wait(writes);
 }
 
-// Function to load stock data from disk
+// Function to load stock data from disk; called before the simulations start, as it adds the maps' keys
 void loadStockData(std::map<std::string, std::vector<double>> &closePricesMap,
                    std::map<std::string, std::vector<Candle>> &candlesMap)
 {
-    std::lock_guard<std::mutex> dataLock(dataMutex); // Ensure thread safety
-
     // Load closePricesMap
     for (const auto &pair : assetData)
     {
@@ -0,0 +1,275 @@
+// src/event_loop.cpp
+
+#include "utils.h"
+#include "event_loop.h"
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace
+{
+    // Events taken from the kernel per epoll_wait
+    const int EVENT_BATCH = 16;
+}
+
+EventLoop::EventLoop()
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+}
+
+EventLoop::~EventLoop()
+{
+    for (const auto &pair : timers)
+        close(pair.first);
+    close(wakeFd);
+    close(epollFd);
+}
+
+void EventLoop::updateWatch(int fd, const Watch &watch, bool added)
+{
+    epoll_event event{};
+    event.events = (watch.readable ? EPOLLIN : 0) | (watch.writable ? EPOLLOUT : 0);
+    event.data.fd = fd;
+    epoll_ctl(epollFd, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event);
+}
+
+void EventLoop::watchReadable(int fd, Handler handler)
+{
+    bool added = watches.find(fd) == watches.end();
+    Watch &watch = watches[fd];
+    watch.readable = std::move(handler);
+    updateWatch(fd, watch, added);
+}
+
+void EventLoop::watchWritable(int fd, Handler handler)
+{
+    bool added = watches.find(fd) == watches.end();
+    Watch &watch = watches[fd];
+    watch.writable = std::move(handler);
+    updateWatch(fd, watch, added);
+}
+
+void EventLoop::unwatch(int fd)
+{
+    if (watches.erase(fd) != 0)
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int EventLoop::addTimer(std::chrono::nanoseconds period, TimerHandler handler)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    itimerspec spec{};
+    spec.it_interval.tv_sec = static_cast<time_t>(period.count() / 1000000000);
+    spec.it_interval.tv_nsec = static_cast<long>(period.count() % 1000000000);
+    spec.it_value = spec.it_interval;
+    timerfd_settime(fd, 0, &spec, nullptr);
+
+    timers[fd] = std::move(handler);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    return fd;
+}
+
+void EventLoop::removeTimer(int id)
+{
+    if (timers.erase(id) == 0)
+        return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, id, nullptr);
+    close(id);
+}
+
+void EventLoop::post(Handler task)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskLock);
+        tasks.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written; // Only fails if the counter is already non-zero, which wakes the loop anyway
+}
+
+void EventLoop::stop()
+{
+    stopping.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+void EventLoop::run()
+{
+    epoll_event events[EVENT_BATCH];
+    while (!stopping.load(std::memory_order_acquire))
+    {
+        int ready = epoll_wait(epollFd, events, EVENT_BATCH, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (int i = 0; i < ready && !stopping.load(std::memory_order_acquire); ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd)
+            {
+                uint64_t count;
+                ssize_t drained = read(wakeFd, &count, sizeof(count));
+                (void)drained;
+                runTasks();
+            }
+            else
+            {
+                dispatch(fd, events[i].events);
+            }
+        }
+    }
+    stopping.store(false, std::memory_order_relaxed);
+}
+
+void EventLoop::dispatch(int fd, uint32_t events)
+{
+    auto timerIt = timers.find(fd);
+    if (timerIt != timers.end())
+    {
+        uint64_t ticks = 0;
+        if (read(fd, &ticks, sizeof(ticks)) == sizeof(ticks) && ticks > 0)
+        {
+            TimerHandler handler = timerIt->second; // The handler may remove its own timer
+            handler(ticks);
+        }
+        return;
+    }
+
+    // Either handler may unwatch the descriptor, so it is looked up again for each
+    auto it = watches.find(fd);
+    if (it != watches.end() && it->second.readable && (events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+    {
+        Handler handler = it->second.readable;
+        handler();
+    }
+    it = watches.find(fd);
+    if (it != watches.end() && it->second.writable && (events & (EPOLLOUT | EPOLLERR)))
+    {
+        Handler handler = it->second.writable;
+        handler();
+    }
+}
+#else
+EventLoop::EventLoop() = default;
+EventLoop::~EventLoop() = default;
+
+int EventLoop::addTimer(std::chrono::nanoseconds period, TimerHandler handler)
+{
+    std::lock_guard<std::mutex> lock(taskLock);
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    int id = nextTimerId++;
+    timers[id] = Timer{interval, std::chrono::steady_clock::now() + interval, std::move(handler)};
+    woken.notify_one();
+    return id;
+}
+
+void EventLoop::removeTimer(int id)
+{
+    std::lock_guard<std::mutex> lock(taskLock);
+    timers.erase(id);
+}
+
+void EventLoop::post(Handler task)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskLock);
+        tasks.push_back(std::move(task));
+    }
+    woken.notify_one();
+}
+
+void EventLoop::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(taskLock);
+        stopping.store(true, std::memory_order_release);
+    }
+    woken.notify_one();
+}
+
+void EventLoop::run()
+{
+    while (!stopping.load(std::memory_order_acquire))
+    {
+        // Wait for the earliest deadline, a task or stop()
+        std::vector<std::pair<int, uint64_t>> due;
+        {
+            std::unique_lock<std::mutex> lock(taskLock);
+            auto woke = [this]
+            { return !tasks.empty() || stopping.load(std::memory_order_acquire); };
+            if (timers.empty())
+            {
+                woken.wait(lock, woke);
+            }
+            else
+            {
+                auto wakeAt = timers.begin()->second.deadline;
+                for (const auto &pair : timers)
+                    wakeAt = std::min(wakeAt, pair.second.deadline);
+                woken.wait_until(lock, wakeAt, woke);
+            }
+
+            // Deadlines move on by whole periods, so ticks do not drift
+            auto now = std::chrono::steady_clock::now();
+            for (auto &pair : timers)
+            {
+                Timer &timer = pair.second;
+                if (now < timer.deadline)
+                    continue;
+                uint64_t ticks = 1 + static_cast<uint64_t>((now - timer.deadline) / timer.period);
+                timer.deadline += timer.period * ticks;
+                due.emplace_back(pair.first, ticks);
+            }
+        }
+
+        for (const auto &pair : due)
+        {
+            TimerHandler handler;
+            {
+                std::lock_guard<std::mutex> lock(taskLock);
+                auto it = timers.find(pair.first);
+                if (it == timers.end())
+                    continue; // Removed by an earlier handler
+                handler = it->second.handler;
+            }
+            handler(pair.second);
+        }
+        runTasks();
+    }
+    stopping.store(false, std::memory_order_relaxed);
+}
+#endif
+
+void EventLoop::runTasks()
+{
+    {
+        std::lock_guard<std::mutex> lock(taskLock);
+        running.swap(tasks);
+    }
+    for (Handler &task : running)
+    {
+        if (stopping.load(std::memory_order_acquire))
+            break;
+        task();
+    }
+    running.clear();
+}
@@ -0,0 +1,98 @@
+// src/export_mode.cpp
+
+#include "utils.h"
+#include "export_mode.h"
+#include "candle_history.h"
+
+// Function to parse "svg", "png" or "svg,png" into format bits
+static bool parseFormats(const std::string &text, unsigned &formats)
+{
+    formats = 0;
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        if (item == "svg")
+            formats |= CHART_SVG;
+        else if (item == "png")
+            formats |= CHART_PNG;
+        else
+            return false;
+    }
+    return formats != 0;
+}
+
+bool parseExportOptions(int argc, char *argv[], ExportOptions &options)
+{
+    bool exportCharts = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--export")
+                exportCharts = true;
+            else if (arg == "--symbols" && hasValue)
+            {
+                std::istringstream iss(argv[++i]);
+                std::string symbol;
+                while (std::getline(iss, symbol, ','))
+                {
+                    std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+                    options.symbols.push_back(symbol);
+                }
+            }
+            else if (arg == "--format" && hasValue)
+            {
+                if (!parseFormats(argv[++i], options.settings.formats))
+                    return false;
+            }
+            else if (arg == "--candles" && hasValue)
+                options.settings.candles = std::stoul(argv[++i]);
+            else if (arg == "--width" && hasValue)
+                options.settings.size.width = std::stoi(argv[++i]);
+            else if (arg == "--height" && hasValue)
+                options.settings.size.height = std::stoi(argv[++i]);
+            else if (arg == "--out" && hasValue)
+                options.settings.outputDirectory = argv[++i];
+            else if (arg == "--threads" && hasValue)
+                options.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    // Room for the axis, the title and both panes
+    return exportCharts && options.settings.candles > 0 && options.settings.size.width >= 200 &&
+           options.settings.size.height >= 150;
+}
+
+int runExportMode(const ExportOptions &options)
+{
+    std::vector<std::string> symbols = options.symbols.empty() ? CandleHistory::storedSymbols() : options.symbols;
+    if (symbols.empty())
+    {
+        std::cerr << "No stored candles found under data/stock_data." << std::endl;
+        return 1;
+    }
+
+    // --threads gives the run its own pool; otherwise it shares the process's
+    std::unique_ptr<WorkStealingPool> ownPool;
+    if (options.threads != 0)
+        ownPool = std::make_unique<WorkStealingPool>(options.threads);
+    WorkStealingPool &pool = ownPool ? *ownPool : sharedPool();
+    auto start = std::chrono::steady_clock::now();
+    ChartExportSummary summary = exportCharts(symbols, options.settings, pool);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Exported " << summary.charts << " charts (" << summary.files << " files, " << std::fixed << std::setprecision(1)
+              << summary.bytes / 1048576.0 << " MB) to " << options.settings.outputDirectory << " on " << pool.size()
+              << " threads in " << std::setprecision(3) << elapsed << " s" << std::endl;
+    for (const std::string &symbol : summary.failed)
+        std::cerr << "Could not export " << symbol << std::endl;
+    return summary.failed.empty() ? 0 : 1;
+}
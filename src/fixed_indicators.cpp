@@ -0,0 +1,49 @@
+// src/fixed_indicators.cpp
+
+#include "utils.h"
+#include "fixed_indicators.h"
+
+void smaSeries(const Candle *candles, size_t count, int period, double *out)
+{
+    bool fixed = dispatchFixedPeriod(period, [&](auto constant)
+                                     { FixedSma<decltype(constant)::value> sma;
+                                       closeSeries(sma, candles, count, out); });
+    if (!fixed)
+        genericSmaSeries(candles, count, period, out);
+}
+
+void emaSeries(const Candle *candles, size_t count, int period, double *out)
+{
+    bool fixed = dispatchFixedPeriod(period, [&](auto constant)
+                                     { FixedEma<decltype(constant)::value> ema;
+                                       closeSeries(ema, candles, count, out); });
+    if (!fixed)
+        genericEmaSeries(candles, count, period, out);
+}
+
+void rsiSeries(const Candle *candles, size_t count, int period, double *out)
+{
+    bool fixed = dispatchFixedPeriod(period, [&](auto constant)
+                                     { FixedRsi<decltype(constant)::value> rsi;
+                                       closeSeries(rsi, candles, count, out); });
+    if (!fixed)
+        genericRsiSeries(candles, count, period, out);
+}
+
+void genericSmaSeries(const Candle *candles, size_t count, int period, double *out)
+{
+    StreamingSma sma(period);
+    closeSeries(sma, candles, count, out);
+}
+
+void genericEmaSeries(const Candle *candles, size_t count, int period, double *out)
+{
+    StreamingEma ema(period);
+    closeSeries(ema, candles, count, out);
+}
+
+void genericRsiSeries(const Candle *candles, size_t count, int period, double *out)
+{
+    StreamingRsi rsi(period);
+    closeSeries(rsi, candles, count, out);
+}
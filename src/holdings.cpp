@@ -0,0 +1,168 @@
+// src/holdings.cpp
+
+#include "holdings.h"
+
+namespace
+{
+    // Shares left below this after a sale are rounding residue, not a position
+    const double AMOUNT_EPSILON = 1e-9;
+
+    // Multiplicative hash; the odd multiplier keeps consecutive symbol IDs in distinct slots
+    inline size_t hashSymbol(SymbolId id, size_t mask)
+    {
+        return static_cast<size_t>((id * 2654435761u) & mask);
+    }
+}
+
+size_t HoldingsMap::slotFor(SymbolId id) const
+{
+    size_t mask = slots.size() - 1;
+    size_t slot = hashSymbol(id, mask);
+    while (slots[slot].symbolId != INVALID_SYMBOL_ID && slots[slot].symbolId != id)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+const Holding *HoldingsMap::find(SymbolId id) const
+{
+    if (slots.empty())
+        return nullptr;
+    const Holding &holding = slots[slotFor(id)];
+    return holding.symbolId == id ? &holding : nullptr;
+}
+
+void HoldingsMap::grow()
+{
+    std::vector<Holding> old;
+    old.swap(slots);
+    slots.assign(old.empty() ? 16 : old.size() * 2, Holding{INVALID_SYMBOL_ID, "", 0.0, 0.0, 0.0});
+    for (auto &holding : old)
+    {
+        if (holding.symbolId != INVALID_SYMBOL_ID)
+            slots[slotFor(holding.symbolId)] = std::move(holding);
+    }
+}
+
+Holding &HoldingsMap::insert(SymbolId id)
+{
+    // Keep the load factor at or below one half
+    if ((count + 1) * 2 > slots.size())
+        grow();
+
+    Holding &holding = slots[slotFor(id)];
+    if (holding.symbolId != id)
+    {
+        holding = Holding{id, symbolName(id), 0.0, 0.0, 0.0};
+        ++count;
+    }
+    return holding;
+}
+
+void HoldingsMap::erase(size_t slot)
+{
+    size_t mask = slots.size() - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+
+    // Shift back every entry in the probe chain that can move into the hole
+    while (slots[next].symbolId != INVALID_SYMBOL_ID)
+    {
+        size_t home = hashSymbol(slots[next].symbolId, mask);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            slots[hole] = std::move(slots[next]);
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[hole] = Holding{INVALID_SYMBOL_ID, "", 0.0, 0.0, 0.0};
+    --count;
+}
+
+void HoldingsMap::buy(SymbolId id, double amount, double price)
+{
+    Holding &holding = insert(id);
+
+    costBasis -= holding.amount * holding.averagePrice;
+    marketValue -= holding.amount * holding.markPrice;
+
+    // Update average price
+    holding.averagePrice = ((holding.averagePrice * holding.amount) + (price * amount)) / (holding.amount + amount);
+    holding.amount += amount;
+    holding.markPrice = price;
+
+    costBasis += holding.amount * holding.averagePrice;
+    marketValue += holding.amount * holding.markPrice;
+}
+
+double HoldingsMap::sell(SymbolId id, double amount, double price)
+{
+    if (slots.empty())
+        return 0.0;
+    size_t slot = slotFor(id);
+    Holding &holding = slots[slot];
+    if (holding.symbolId != id)
+        return 0.0;
+
+    double soldAmount = std::min(amount, holding.amount);
+    double pnl = soldAmount * (price - holding.averagePrice);
+    realized += pnl;
+
+    costBasis -= soldAmount * holding.averagePrice;
+    marketValue -= holding.amount * holding.markPrice;
+    holding.amount -= soldAmount;
+    holding.markPrice = price;
+    marketValue += holding.amount * holding.markPrice;
+
+    if (holding.amount < AMOUNT_EPSILON)
+    {
+        // Take the residue's value out of the totals along with it
+        costBasis -= holding.amount * holding.averagePrice;
+        marketValue -= holding.amount * holding.markPrice;
+        erase(slot);
+        // Clamp rounding residue once nothing is held
+        if (count == 0)
+        {
+            costBasis = 0.0;
+            marketValue = 0.0;
+        }
+    }
+    return pnl;
+}
+
+void HoldingsMap::markPrice(SymbolId id, double price)
+{
+    if (slots.empty())
+        return;
+    Holding &holding = slots[slotFor(id)];
+    if (holding.symbolId != id)
+        return;
+
+    marketValue += holding.amount * (price - holding.markPrice);
+    holding.markPrice = price;
+}
+
+void HoldingsMap::restore(SymbolId id, double amount, double averagePrice)
+{
+    Holding &holding = insert(id);
+    costBasis -= holding.amount * holding.averagePrice;
+    marketValue -= holding.amount * holding.markPrice;
+
+    holding.amount = amount;
+    holding.averagePrice = averagePrice;
+    holding.markPrice = averagePrice; // Re-marked once prices arrive
+
+    costBasis += amount * averagePrice;
+    marketValue += amount * averagePrice;
+}
+
+void HoldingsMap::clear()
+{
+    slots.clear();
+    count = 0;
+    costBasis = 0.0;
+    marketValue = 0.0;
+    realized = 0.0;
+}
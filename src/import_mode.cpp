@@ -0,0 +1,104 @@
+// src/import_mode.cpp
+
+#include "utils.h"
+#include "import_mode.h"
+
+// Function to split "A,B,C" into upper-cased items
+static std::vector<std::string> splitUpper(const std::string &text)
+{
+    std::vector<std::string> items;
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        std::transform(item.begin(), item.end(), item.begin(), ::toupper);
+        if (!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+bool parseImportOptions(int argc, char *argv[], ImportOptions &options)
+{
+    bool import = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--import")
+            {
+                import = true;
+                while (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+                    options.paths.push_back(argv[++i]);
+            }
+            else if (arg == "--series" && hasValue)
+            {
+                std::string series = argv[++i];
+                std::transform(series.begin(), series.end(), series.begin(), ::toupper);
+                options.settings.series = (series == "ALL") ? std::string() : series;
+            }
+            else if (arg == "--symbol" && hasValue)
+            {
+                options.settings.symbol = argv[++i];
+                std::transform(options.settings.symbol.begin(), options.settings.symbol.end(), options.settings.symbol.begin(), ::toupper);
+            }
+            else if (arg == "--symbols" && hasValue)
+                options.settings.symbols = splitUpper(argv[++i]);
+            else if (arg == "--rename" && hasValue)
+            {
+                for (const std::string &pair : splitUpper(argv[++i]))
+                {
+                    size_t equals = pair.find('=');
+                    if (equals == std::string::npos || equals == 0 || equals + 1 == pair.size())
+                        return false;
+                    options.settings.renames[pair.substr(0, equals)] = pair.substr(equals + 1);
+                }
+            }
+            else if (arg == "--history")
+                options.settings.writeHistory = true;
+            else if (arg == "--threads" && hasValue)
+                options.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    return import && !options.paths.empty();
+}
+
+int runImportMode(const ImportOptions &options)
+{
+    // --threads gives the run its own pool; otherwise it shares the process's
+    std::unique_ptr<WorkStealingPool> ownPool;
+    if (options.threads != 0)
+        ownPool = std::make_unique<WorkStealingPool>(options.threads);
+    WorkStealingPool &pool = ownPool ? *ownPool : sharedPool();
+    CsvIngestSummary summary = ingestCsvFiles(options.paths, options.settings, pool);
+
+    for (const IngestedSeries &series : summary.series)
+    {
+        std::cout << std::left << std::setw(14) << series.symbol << std::right << std::setw(10) << series.candles.size() << " candles";
+        if (series.firstDate != 0)
+            std::cout << "  " << series.firstDate << " - " << series.lastDate;
+        if (assetData.find(series.symbol) != assetData.end())
+            std::cout << "  (seeds the simulation)";
+        std::cout << "\n";
+    }
+
+    double mb = summary.bytes / 1048576.0;
+    std::cout << std::fixed << std::setprecision(1) << "Imported " << summary.candles << " candles for " << summary.series.size()
+              << " symbols from " << summary.files << " files (" << mb << " MB) on " << pool.size() << " threads: parsed in "
+              << std::setprecision(3) << summary.parseSeconds << " s (" << std::setprecision(0)
+              << (summary.parseSeconds > 0 ? mb / summary.parseSeconds : 0.0) << " MB/s), written in " << std::setprecision(3)
+              << summary.writeSeconds << " s" << std::endl;
+    std::cout << summary.rows << " rows: " << summary.filtered << " filtered out, " << summary.skipped << " malformed, "
+              << summary.duplicates << " replaced by a later row for the same date" << std::endl;
+    for (const std::string &error : summary.errors)
+        std::cerr << error << std::endl;
+    return summary.errors.empty() && !summary.series.empty() ? 0 : 1;
+}
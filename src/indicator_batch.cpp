@@ -0,0 +1,468 @@
+// src/indicator_batch.cpp
+
+#include "utils.h"
+#include "indicator_batch.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INDICATOR_BATCH_AVX2 1
+#include <immintrin.h>
+#endif
+
+CandleColumns::CandleColumns(const Candle *candles, size_t count)
+    : open(count), high(count), low(count), close(count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        open[i] = candles[i].open;
+        high[i] = candles[i].high;
+        low[i] = candles[i].low;
+        close[i] = candles[i].close;
+    }
+}
+
+namespace
+{
+    std::atomic<bool> &simdSwitch()
+    {
+        static std::atomic<bool> enabled(batchSimdAvailable());
+        return enabled;
+    }
+
+    // Scalar kernels; each covers indices [from, to)
+
+    void windowMeanScalar(const double *prefix, size_t from, size_t to, int period, double shift, double *out)
+    {
+        double scale = 1.0 / period;
+        for (size_t i = from; i < to; ++i)
+            out[i] = shift + (prefix[i + 1] - prefix[i + 1 - period]) * scale;
+    }
+
+    void bandsScalar(const double *sums, const double *squares, size_t from, size_t to, int period, double shift, double width,
+                     double *middle, double *upper, double *lower)
+    {
+        double scale = 1.0 / period;
+        for (size_t i = from; i < to; ++i)
+        {
+            double mean = (sums[i + 1] - sums[i + 1 - period]) * scale;
+            double variance = (squares[i + 1] - squares[i + 1 - period]) * scale - mean * mean;
+            double band = width * std::sqrt(std::max(0.0, variance));
+            middle[i] = shift + mean;
+            upper[i] = middle[i] + band;
+            lower[i] = middle[i] - band;
+        }
+    }
+
+    void trueRangeScalar(const double *high, const double *low, const double *close, size_t from, size_t to, double *out)
+    {
+        for (size_t i = from; i < to; ++i)
+            out[i] = std::max({high[i] - low[i], std::fabs(high[i] - close[i - 1]), std::fabs(low[i] - close[i - 1])});
+    }
+
+    void gainsLossesScalar(const double *close, size_t from, size_t to, double *gains, double *losses)
+    {
+        for (size_t i = from; i < to; ++i)
+        {
+            double change = close[i] - close[i - 1];
+            gains[i] = change > 0.0 ? change : 0.0;
+            losses[i] = change < 0.0 ? -change : 0.0;
+        }
+    }
+
+    void stochasticKScalar(const double *close, const double *highest, const double *lowest, size_t from, size_t to, double *out)
+    {
+        for (size_t i = from; i < to; ++i)
+        {
+            double range = highest[i] - lowest[i];
+            out[i] = range > 0.0 ? 100.0 * (close[i] - lowest[i]) / range : 50.0;
+        }
+    }
+
+    void typicalVolumeScalar(const double *high, const double *low, const double *close, const double *volume, size_t count, double *out)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = (high[i] + low[i] + close[i]) * (1.0 / 3.0) * volume[i];
+    }
+
+    void ratioScalar(const double *numerator, const double *denominator, size_t count, double *out)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = denominator[i] > 0.0 ? numerator[i] / denominator[i] : 0.0;
+    }
+
+    void subtractScalar(const double *a, const double *b, size_t from, size_t to, double *out)
+    {
+        for (size_t i = from; i < to; ++i)
+            out[i] = a[i] - b[i];
+    }
+
+#ifdef INDICATOR_BATCH_AVX2
+    // AVX2 kernels: four doubles per step, with the scalar kernel for the tail
+
+    __attribute__((target("avx2"))) void windowMeanAvx2(const double *prefix, size_t from, size_t to, int period, double shift, double *out)
+    {
+        const __m256d scale = _mm256_set1_pd(1.0 / period);
+        const __m256d offset = _mm256_set1_pd(shift);
+        size_t i = from;
+        for (; i + 4 <= to; i += 4)
+        {
+            __m256d newer = _mm256_loadu_pd(prefix + i + 1);
+            __m256d older = _mm256_loadu_pd(prefix + i + 1 - period);
+            _mm256_storeu_pd(out + i, _mm256_add_pd(offset, _mm256_mul_pd(_mm256_sub_pd(newer, older), scale)));
+        }
+        windowMeanScalar(prefix, i, to, period, shift, out);
+    }
+
+    __attribute__((target("avx2"))) void bandsAvx2(const double *sums, const double *squares, size_t from, size_t to, int period, double shift,
+                                                   double width, double *middle, double *upper, double *lower)
+    {
+        const __m256d scale = _mm256_set1_pd(1.0 / period);
+        const __m256d offset = _mm256_set1_pd(shift);
+        const __m256d widths = _mm256_set1_pd(width);
+        const __m256d zero = _mm256_setzero_pd();
+        size_t i = from;
+        for (; i + 4 <= to; i += 4)
+        {
+            __m256d mean = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(sums + i + 1), _mm256_loadu_pd(sums + i + 1 - period)), scale);
+            __m256d meanSquare = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(squares + i + 1), _mm256_loadu_pd(squares + i + 1 - period)), scale);
+            __m256d variance = _mm256_max_pd(zero, _mm256_sub_pd(meanSquare, _mm256_mul_pd(mean, mean)));
+            __m256d band = _mm256_mul_pd(widths, _mm256_sqrt_pd(variance));
+            __m256d centre = _mm256_add_pd(offset, mean);
+            _mm256_storeu_pd(middle + i, centre);
+            _mm256_storeu_pd(upper + i, _mm256_add_pd(centre, band));
+            _mm256_storeu_pd(lower + i, _mm256_sub_pd(centre, band));
+        }
+        bandsScalar(sums, squares, i, to, period, shift, width, middle, upper, lower);
+    }
+
+    __attribute__((target("avx2"))) void trueRangeAvx2(const double *high, const double *low, const double *close, size_t from, size_t to, double *out)
+    {
+        const __m256d signBit = _mm256_set1_pd(-0.0);
+        size_t i = from;
+        for (; i + 4 <= to; i += 4)
+        {
+            __m256d h = _mm256_loadu_pd(high + i);
+            __m256d l = _mm256_loadu_pd(low + i);
+            __m256d previous = _mm256_loadu_pd(close + i - 1);
+            __m256d range = _mm256_sub_pd(h, l);
+            __m256d upMove = _mm256_andnot_pd(signBit, _mm256_sub_pd(h, previous));
+            __m256d downMove = _mm256_andnot_pd(signBit, _mm256_sub_pd(l, previous));
+            _mm256_storeu_pd(out + i, _mm256_max_pd(range, _mm256_max_pd(upMove, downMove)));
+        }
+        trueRangeScalar(high, low, close, i, to, out);
+    }
+
+    __attribute__((target("avx2"))) void gainsLossesAvx2(const double *close, size_t from, size_t to, double *gains, double *losses)
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        size_t i = from;
+        for (; i + 4 <= to; i += 4)
+        {
+            __m256d change = _mm256_sub_pd(_mm256_loadu_pd(close + i), _mm256_loadu_pd(close + i - 1));
+            _mm256_storeu_pd(gains + i, _mm256_max_pd(change, zero));
+            _mm256_storeu_pd(losses + i, _mm256_max_pd(_mm256_sub_pd(zero, change), zero));
+        }
+        gainsLossesScalar(close, i, to, gains, losses);
+    }
+
+    __attribute__((target("avx2"))) void stochasticKAvx2(const double *close, const double *highest, const double *lowest, size_t from, size_t to, double *out)
+    {
+        const __m256d hundred = _mm256_set1_pd(100.0);
+        const __m256d neutral = _mm256_set1_pd(50.0);
+        const __m256d zero = _mm256_setzero_pd();
+        size_t i = from;
+        for (; i + 4 <= to; i += 4)
+        {
+            __m256d l = _mm256_loadu_pd(lowest + i);
+            __m256d range = _mm256_sub_pd(_mm256_loadu_pd(highest + i), l);
+            __m256d k = _mm256_div_pd(_mm256_mul_pd(hundred, _mm256_sub_pd(_mm256_loadu_pd(close + i), l)), range);
+            __m256d flat = _mm256_cmp_pd(range, zero, _CMP_LE_OQ); // No range: neutral, not 0/0
+            _mm256_storeu_pd(out + i, _mm256_blendv_pd(k, neutral, flat));
+        }
+        stochasticKScalar(close, highest, lowest, i, to, out);
+    }
+
+    __attribute__((target("avx2"))) void typicalVolumeAvx2(const double *high, const double *low, const double *close, const double *volume, size_t count, double *out)
+    {
+        const __m256d third = _mm256_set1_pd(1.0 / 3.0);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d sum = _mm256_add_pd(_mm256_add_pd(_mm256_loadu_pd(high + i), _mm256_loadu_pd(low + i)), _mm256_loadu_pd(close + i));
+            _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_mul_pd(sum, third), _mm256_loadu_pd(volume + i)));
+        }
+        typicalVolumeScalar(high + i, low + i, close + i, volume + i, count - i, out + i);
+    }
+
+    __attribute__((target("avx2"))) void ratioAvx2(const double *numerator, const double *denominator, size_t count, double *out)
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d den = _mm256_loadu_pd(denominator + i);
+            __m256d quotient = _mm256_div_pd(_mm256_loadu_pd(numerator + i), den);
+            __m256d positive = _mm256_cmp_pd(den, zero, _CMP_GT_OQ);
+            _mm256_storeu_pd(out + i, _mm256_and_pd(quotient, positive));
+        }
+        ratioScalar(numerator + i, denominator + i, count - i, out + i);
+    }
+
+    __attribute__((target("avx2"))) void subtractAvx2(const double *a, const double *b, size_t from, size_t to, double *out)
+    {
+        size_t i = from;
+        for (; i + 4 <= to; i += 4)
+            _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        subtractScalar(a, b, i, to, out);
+    }
+
+#define BATCH_KERNEL(name, ...) (batchSimdEnabled() ? name##Avx2(__VA_ARGS__) : name##Scalar(__VA_ARGS__))
+#else
+#define BATCH_KERNEL(name, ...) name##Scalar(__VA_ARGS__)
+#endif
+
+    // Windowed sums come from prefix sums of (value - shift). One prefix over
+    // the whole history would grow with it and swamp the small differences a
+    // window needs, so it restarts every WINDOW_BLOCK outputs, shifted by the
+    // first value it covers.
+    const size_t WINDOW_BLOCK = 1024;
+
+    // Highest high and lowest low of the period candles ending at each index
+    // from period - 1 on (van Herk/Gil-Werman): running extremes from the start
+    // and from the end of each period-long block, so any window is one max of
+    // a suffix and a prefix. Branch-free, unlike a monotonic queue, whose pops
+    // mispredict on noisy prices.
+    void windowExtremes(const double *high, const double *low, size_t count, int period, double *highest, double *lowest)
+    {
+        size_t block = period;
+        std::vector<double> highPrefix(count), highSuffix(count), lowPrefix(count), lowSuffix(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            bool start = i % block == 0;
+            highPrefix[i] = start ? high[i] : std::max(highPrefix[i - 1], high[i]);
+            lowPrefix[i] = start ? low[i] : std::min(lowPrefix[i - 1], low[i]);
+        }
+        for (size_t i = count; i-- > 0;)
+        {
+            bool end = i + 1 == count || (i + 1) % block == 0;
+            highSuffix[i] = end ? high[i] : std::max(highSuffix[i + 1], high[i]);
+            lowSuffix[i] = end ? low[i] : std::min(lowSuffix[i + 1], low[i]);
+        }
+        for (size_t i = block - 1; i < count; ++i)
+        {
+            highest[i] = std::max(highSuffix[i + 1 - block], highPrefix[i]);
+            lowest[i] = std::min(lowSuffix[i + 1 - block], lowPrefix[i]);
+        }
+    }
+
+    // Wilder smoothing of series[first..count): the mean of the first period
+    // values, then (previous * (period - 1) + value) / period
+    void wilderSmooth(const double *series, size_t first, size_t count, int period, double *out)
+    {
+        double average = 0.0;
+        for (size_t i = first; i < count; ++i)
+        {
+            size_t seen = i - first + 1;
+            if (seen <= static_cast<size_t>(period))
+                average += series[i] / period;
+            else
+                average = (average * (period - 1) + series[i]) / period;
+            out[i] = average;
+        }
+    }
+}
+
+bool batchSimdAvailable()
+{
+#ifdef INDICATOR_BATCH_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool batchSimdEnabled()
+{
+    return simdSwitch().load(std::memory_order_relaxed);
+}
+
+void setBatchSimdEnabled(bool enabled)
+{
+    simdSwitch().store(enabled && batchSimdAvailable(), std::memory_order_relaxed);
+}
+
+void smaBatch(const double *values, size_t count, int period, double *out)
+{
+    period = std::max(1, period);
+    size_t warmup = period - 1;
+    std::fill(out, out + std::min(count, warmup), 0.0);
+
+    std::vector<double> prefix(std::min(count, WINDOW_BLOCK + warmup) + 1);
+    for (size_t first = warmup; first < count; first += WINDOW_BLOCK)
+    {
+        size_t base = first - warmup;
+        size_t length = std::min(count, first + WINDOW_BLOCK) - base;
+        double shift = values[base];
+        prefix[0] = 0.0;
+        for (size_t j = 0; j < length; ++j)
+            prefix[j + 1] = prefix[j] + (values[base + j] - shift);
+        BATCH_KERNEL(windowMean, prefix.data(), warmup, length, period, shift, out + base);
+    }
+}
+
+void emaBatch(const double *values, size_t count, int period, double *out)
+{
+    period = std::max(1, period);
+    size_t warmup = std::min(count, static_cast<size_t>(period - 1));
+    std::fill(out, out + warmup, 0.0);
+    if (count < static_cast<size_t>(period))
+        return;
+
+    // Seed with the simple average, summed in order as StreamingEma does
+    double average = 0.0;
+    for (size_t i = 0; i < warmup; ++i)
+        average += values[i];
+    average = (average + values[warmup]) / period;
+    out[warmup] = average;
+
+    double alpha = 2.0 / (period + 1);
+    for (size_t i = period; i < count; ++i)
+    {
+        average += alpha * (values[i] - average);
+        out[i] = average;
+    }
+}
+
+void rsiBatch(const double *close, size_t count, int period, double *out)
+{
+    period = std::max(1, period);
+    std::fill(out, out + std::min(count, static_cast<size_t>(period)), 50.0);
+    if (count <= static_cast<size_t>(period))
+        return;
+
+    std::vector<double> gains(count);
+    std::vector<double> losses(count);
+    BATCH_KERNEL(gainsLosses, close, 1, count, gains.data(), losses.data());
+
+    // Wilder smoothing, as StreamingRsi: plain means of the first period changes, then blended
+    double averageGain = 0.0;
+    double averageLoss = 0.0;
+    for (size_t i = 1; i <= static_cast<size_t>(period); ++i)
+    {
+        averageGain += gains[i] / period;
+        averageLoss += losses[i] / period;
+    }
+    for (size_t i = period; i < count; ++i)
+    {
+        if (i > static_cast<size_t>(period))
+        {
+            averageGain = (averageGain * (period - 1) + gains[i]) / period;
+            averageLoss = (averageLoss * (period - 1) + losses[i]) / period;
+        }
+        double total = averageGain + averageLoss;
+        out[i] = total > 0.0 ? 100.0 * averageGain / total : 50.0;
+    }
+}
+
+void macdBatch(const double *close, size_t count, int fastPeriod, int slowPeriod, int signalPeriod,
+               double *macd, double *signal, double *histogram)
+{
+    std::vector<double> fast(count);
+    std::vector<double> slow(count);
+    emaBatch(close, count, fastPeriod, fast.data());
+    emaBatch(close, count, slowPeriod, slow.data());
+
+    // MACD exists once both averages do; the signal line is an EMA of it from there
+    size_t start = std::min(count, static_cast<size_t>(std::max({1, fastPeriod, slowPeriod}) - 1));
+    std::fill(macd, macd + start, 0.0);
+    std::fill(signal, signal + start, 0.0);
+    BATCH_KERNEL(subtract, fast.data(), slow.data(), start, count, macd);
+    emaBatch(macd + start, count - start, signalPeriod, signal + start);
+
+    size_t signalStart = std::min(count, start + std::max(1, signalPeriod) - 1);
+    std::fill(histogram, histogram + signalStart, 0.0);
+    BATCH_KERNEL(subtract, macd, signal, signalStart, count, histogram);
+}
+
+void bollingerBatch(const double *close, size_t count, int period, double width,
+                    double *middle, double *upper, double *lower)
+{
+    period = std::max(1, period);
+    size_t ready = std::min(count, static_cast<size_t>(period - 1));
+    std::fill(middle, middle + ready, 0.0);
+    std::fill(upper, upper + ready, 0.0);
+    std::fill(lower, lower + ready, 0.0);
+    if (count < static_cast<size_t>(period))
+        return;
+
+    size_t warmup = period - 1;
+    size_t length = std::min(count, WINDOW_BLOCK + warmup) + 1;
+    std::vector<double> sums(length);
+    std::vector<double> squares(length);
+    for (size_t first = warmup; first < count; first += WINDOW_BLOCK)
+    {
+        size_t base = first - warmup;
+        size_t blockLength = std::min(count, first + WINDOW_BLOCK) - base;
+        double shift = close[base];
+        sums[0] = 0.0;
+        squares[0] = 0.0;
+        for (size_t j = 0; j < blockLength; ++j)
+        {
+            double value = close[base + j] - shift;
+            sums[j + 1] = sums[j] + value;
+            squares[j + 1] = squares[j] + value * value;
+        }
+        BATCH_KERNEL(bands, sums.data(), squares.data(), warmup, blockLength, period, shift, width,
+                     middle + base, upper + base, lower + base);
+    }
+}
+
+void atrBatch(const double *high, const double *low, const double *close, size_t count, int period, double *out)
+{
+    if (count == 0)
+        return;
+    period = std::max(1, period);
+
+    std::vector<double> trueRange(count);
+    trueRange[0] = high[0] - low[0]; // No previous close
+    BATCH_KERNEL(trueRange, high, low, close, 1, count, trueRange.data());
+    wilderSmooth(trueRange.data(), 0, count, period, out);
+    std::fill(out, out + std::min(count, static_cast<size_t>(period - 1)), 0.0);
+}
+
+void stochasticBatch(const double *high, const double *low, const double *close, size_t count,
+                     int kPeriod, int dPeriod, double *k, double *d)
+{
+    kPeriod = std::max(1, kPeriod);
+    size_t start = std::min(count, static_cast<size_t>(kPeriod - 1));
+    std::fill(k, k + start, 50.0);
+    std::fill(d, d + count, 50.0);
+    if (count < static_cast<size_t>(kPeriod))
+        return;
+
+    std::vector<double> highest(count);
+    std::vector<double> lowest(count);
+    windowExtremes(high, low, count, kPeriod, highest.data(), lowest.data());
+    BATCH_KERNEL(stochasticK, close, highest.data(), lowest.data(), start, count, k);
+
+    // %D averages %K from where %K exists; neutral until its window fills
+    smaBatch(k + start, count - start, dPeriod, d + start);
+    std::fill(d + start, d + std::min(count, start + std::max(1, dPeriod) - 1), 50.0);
+}
+
+void vwapBatch(const double *high, const double *low, const double *close, const double *volume, size_t count, double *out)
+{
+    std::vector<double> priceVolume(count);
+    BATCH_KERNEL(typicalVolume, high, low, close, volume, count, priceVolume.data());
+
+    std::vector<double> totalVolume(count);
+    double runningPriceVolume = 0.0;
+    double runningVolume = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        runningPriceVolume += priceVolume[i];
+        runningVolume += volume[i];
+        priceVolume[i] = runningPriceVolume;
+        totalVolume[i] = runningVolume;
+    }
+    BATCH_KERNEL(ratio, priceVolume.data(), totalVolume.data(), count, out);
+}
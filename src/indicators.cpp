@@ -0,0 +1,321 @@
+// src/indicators.cpp
+
+#include "utils.h"
+#include "indicators.h"
+#include "fixed_indicators.h"
+
+std::map<std::string, SymbolIndicators> indicatorsMap;
+
+StreamingSma::StreamingSma(int period)
+    : window(std::max(1, period), 0.0)
+{
+}
+
+double StreamingSma::update(double value)
+{
+    sum += value - window[next];
+    window[next] = value;
+    if (++next == window.size())
+    {
+        next = 0;
+        sum = 0.0;
+        for (double v : window)
+            sum += v;
+    }
+    if (count < window.size())
+        ++count;
+    return this->value();
+}
+
+void StreamingSma::reset()
+{
+    std::fill(window.begin(), window.end(), 0.0);
+    next = 0;
+    count = 0;
+    sum = 0.0;
+}
+
+StreamingRsi::StreamingRsi(int period)
+    : rsiPeriod(std::max(1, period))
+{
+}
+
+double StreamingRsi::update(double close)
+{
+    if (changes > 0)
+    {
+        double change = close - previousClose;
+        double gain = change > 0.0 ? change : 0.0;
+        double loss = change < 0.0 ? -change : 0.0;
+        if (changes <= static_cast<size_t>(rsiPeriod))
+        {
+            // Seed with the plain mean of the first period changes
+            averageGain += gain / rsiPeriod;
+            averageLoss += loss / rsiPeriod;
+        }
+        else
+        {
+            averageGain = (averageGain * (rsiPeriod - 1) + gain) / rsiPeriod;
+            averageLoss = (averageLoss * (rsiPeriod - 1) + loss) / rsiPeriod;
+        }
+    }
+    previousClose = close;
+    ++changes;
+    return value();
+}
+
+double StreamingRsi::value() const
+{
+    if (!ready() || averageGain + averageLoss <= 0.0)
+        return 50.0; // Neutral until there is data, as calculateRSI
+    return 100.0 * averageGain / (averageGain + averageLoss);
+}
+
+void StreamingRsi::reset()
+{
+    changes = 0;
+    previousClose = 0.0;
+    averageGain = 0.0;
+    averageLoss = 0.0;
+}
+
+StreamingEma::StreamingEma(int period)
+    : emaPeriod(std::max(1, period)), alpha(2.0 / (std::max(1, period) + 1))
+{
+}
+
+double StreamingEma::update(double value)
+{
+    ++count;
+    if (count < static_cast<size_t>(emaPeriod))
+        average += value; // Summing the seed window
+    else if (count == static_cast<size_t>(emaPeriod))
+        average = (average + value) / emaPeriod;
+    else
+        average += alpha * (value - average);
+    return this->value();
+}
+
+void StreamingEma::reset()
+{
+    count = 0;
+    average = 0.0;
+}
+
+StreamingMacd::StreamingMacd(int fastPeriod, int slowPeriod, int signalPeriod)
+    : fastEma(fastPeriod), slowEma(slowPeriod), signalEma(signalPeriod)
+{
+}
+
+void StreamingMacd::update(double close)
+{
+    fastEma.update(close);
+    slowEma.update(close);
+    if (!fastEma.ready() || !slowEma.ready())
+        return;
+    macdValue = fastEma.value() - slowEma.value();
+    signalEma.update(macdValue);
+}
+
+void StreamingMacd::reset()
+{
+    fastEma.reset();
+    slowEma.reset();
+    signalEma.reset();
+    macdValue = 0.0;
+}
+
+StreamingBollinger::StreamingBollinger(int period, double width)
+    : window(std::max(1, period), 0.0), width(width)
+{
+}
+
+void StreamingBollinger::update(double close)
+{
+    double old = window[next];
+    sum += close - old;
+    sumOfSquares += close * close - old * old;
+    window[next] = close;
+    if (++next == window.size())
+    {
+        next = 0;
+        sum = 0.0;
+        sumOfSquares = 0.0;
+        for (double v : window)
+        {
+            sum += v;
+            sumOfSquares += v * v;
+        }
+    }
+    if (count < window.size())
+        ++count;
+
+    double n = static_cast<double>(window.size());
+    mean = sum / n;
+    deviation = std::sqrt(std::max(0.0, sumOfSquares / n - mean * mean));
+}
+
+void StreamingBollinger::reset()
+{
+    std::fill(window.begin(), window.end(), 0.0);
+    next = 0;
+    count = 0;
+    sum = 0.0;
+    sumOfSquares = 0.0;
+    mean = 0.0;
+    deviation = 0.0;
+}
+
+StreamingAtr::StreamingAtr(int period)
+    : atrPeriod(std::max(1, period))
+{
+}
+
+double StreamingAtr::update(const Candle &candle)
+{
+    // The first candle has no previous close, so its range is just high - low
+    double trueRange = candle.high - candle.low;
+    if (count > 0)
+        trueRange = std::max({trueRange, std::fabs(candle.high - previousClose), std::fabs(candle.low - previousClose)});
+    previousClose = candle.close;
+
+    ++count;
+    if (count <= static_cast<size_t>(atrPeriod))
+        average += trueRange / atrPeriod; // Seed with the plain mean
+    else
+        average = (average * (atrPeriod - 1) + trueRange) / atrPeriod;
+    return value();
+}
+
+void StreamingAtr::reset()
+{
+    count = 0;
+    previousClose = 0.0;
+    average = 0.0;
+}
+
+StreamingStochastic::StreamingStochastic(int kPeriod, int dPeriod)
+    : kPeriod(std::max(1, kPeriod)), dSma(dPeriod)
+{
+}
+
+void StreamingStochastic::update(const Candle &candle)
+{
+    size_t index = seen++;
+    while (!highs.empty() && highs.back().second <= candle.high)
+        highs.pop_back();
+    highs.emplace_back(index, candle.high);
+    while (!lows.empty() && lows.back().second >= candle.low)
+        lows.pop_back();
+    lows.emplace_back(index, candle.low);
+
+    // Drop candles that have left the window
+    size_t oldest = (seen > static_cast<size_t>(kPeriod)) ? seen - kPeriod : 0;
+    while (highs.front().first < oldest)
+        highs.pop_front();
+    while (lows.front().first < oldest)
+        lows.pop_front();
+
+    if (!ready())
+        return;
+    double range = highs.front().second - lows.front().second;
+    kValue = (range > 0.0) ? 100.0 * (candle.close - lows.front().second) / range : 50.0;
+    dSma.update(kValue);
+}
+
+void StreamingStochastic::reset()
+{
+    seen = 0;
+    highs.clear();
+    lows.clear();
+    kValue = 50.0;
+    dSma.reset();
+}
+
+double StreamingVwap::update(const Candle &candle, double volume)
+{
+    priceVolume += (candle.high + candle.low + candle.close) / 3.0 * volume;
+    totalVolume += volume;
+    return value();
+}
+
+void StreamingVwap::reset()
+{
+    priceVolume = 0.0;
+    totalVolume = 0.0;
+}
+
+SymbolIndicators::SymbolIndicators(int maPeriod, int rsiPeriod)
+    : sma(maPeriod), rsiState(rsiPeriod), ema(CHART_EMA_PERIOD), bollinger(CHART_BOLLINGER_PERIOD)
+{
+}
+
+void SymbolIndicators::sync(const std::vector<Candle> &candles)
+{
+    if (candles.size() < processed)
+    {
+        sma.reset();
+        rsiState.reset();
+        ema.reset();
+        macd.reset();
+        bollinger.reset();
+        atr.reset();
+        stochastic.reset();
+        maValues.clear();
+        rsiValues.clear();
+        upperValues.clear();
+        lowerValues.clear();
+        snapshot = IndicatorSnapshot();
+        processed = 0;
+    }
+
+    if (processed == 0)
+    {
+        maValues.reserve(candles.size()); // Backfill in one allocation
+        rsiValues.reserve(candles.size());
+        upperValues.reserve(candles.size());
+        lowerValues.reserve(candles.size());
+    }
+    for (; processed < candles.size(); ++processed)
+    {
+        const Candle &candle = candles[processed];
+        snapshot.previousClose = snapshot.close;
+        snapshot.previousMovingAverage = snapshot.movingAverage;
+
+        maValues.push_back(sma.update(candle.close));
+        rsiValues.push_back(rsiState.update(candle.close));
+        ema.update(candle.close);
+        macd.update(candle.close);
+        bollinger.update(candle.close);
+        upperValues.push_back(bollinger.upper());
+        lowerValues.push_back(bollinger.lower());
+        atr.update(candle);
+        stochastic.update(candle);
+
+        snapshot.close = candle.close;
+        snapshot.movingAverage = maValues.back();
+        snapshot.rsi = rsiValues.back();
+        snapshot.ema = ema.value();
+        snapshot.macd = macd.macd();
+        snapshot.macdSignal = macd.signal();
+        snapshot.bollingerUpper = bollinger.upper();
+        snapshot.bollingerLower = bollinger.lower();
+        snapshot.atr = atr.value();
+        snapshot.stochasticK = stochastic.k();
+        snapshot.stochasticD = stochastic.d();
+    }
+}
+
+std::vector<double> movingAverageSeries(const std::vector<Candle> &candles, int period)
+{
+    std::vector<double> series(candles.size());
+    smaSeries(candles.data(), candles.size(), period, series.data());
+    return series;
+}
+
+std::vector<double> rsiSeries(const std::vector<Candle> &candles, int period)
+{
+    std::vector<double> series(candles.size());
+    rsiSeries(candles.data(), candles.size(), period, series.data());
+    return series;
+}
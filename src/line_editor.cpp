@@ -0,0 +1,183 @@
+// src/line_editor.cpp
+
+#include "utils.h"
+#include "line_editor.h"
+#include <cerrno>
+#include <csignal>
+
+namespace
+{
+    const char CTRL_D = 0x04;
+    const char CTRL_U = 0x15;
+    const char CTRL_W = 0x17;
+    const char ESC = 0x1B;
+
+#ifndef _WIN32
+    // Terminal settings from before raw mode, put back on exit or on a fatal signal
+    termios savedTerminal;
+    void (*previousInterrupt)(int) = SIG_DFL;
+    void (*previousTerminate)(int) = SIG_DFL;
+
+    void restoreAndRaise(int signal)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+#endif
+}
+
+LineEditor::LineEditor()
+{
+#ifdef _WIN32
+    raw = true; // _getch() neither waits for Enter nor echoes
+#else
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &savedTerminal) != 0)
+        return;
+    termios settings = savedTerminal;
+    settings.c_lflag &= ~(ICANON | ECHO); // Signals still work, so Ctrl-C quits as before
+    settings.c_cc[VMIN] = 1;
+    settings.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &settings) != 0)
+        return;
+    raw = true;
+    previousInterrupt = std::signal(SIGINT, restoreAndRaise);
+    previousTerminate = std::signal(SIGTERM, restoreAndRaise);
+#endif
+}
+
+LineEditor::~LineEditor()
+{
+#ifndef _WIN32
+    if (!raw)
+        return;
+    tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+    std::signal(SIGINT, previousInterrupt);
+    std::signal(SIGTERM, previousTerminate);
+#endif
+}
+
+void LineEditor::prompt(int column, int row, const std::string &text)
+{
+    promptColumn = column;
+    promptRow = row;
+    promptText = text;
+    redraw();
+}
+
+void LineEditor::redraw()
+{
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+    moveCursor(promptColumn, promptRow);
+    std::cout << CLEARLINE << promptText << line << SHOW_CURSOR;
+    std::cout.flush();
+}
+
+void LineEditor::echo(const std::string &text)
+{
+    if (!raw)
+        return; // The terminal is not ours to echo on
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+    std::cout << text; // Everything else drawn in the trading view puts the cursor back
+    std::cout.flush();
+}
+
+void LineEditor::erase(size_t count)
+{
+    count = std::min(count, line.size());
+    line.resize(line.size() - count);
+    std::string rubout;
+    for (size_t i = 0; i < count; ++i)
+        rubout += "\b \b";
+    echo(rubout);
+}
+
+void LineEditor::key(char c, std::vector<std::string> &tokens)
+{
+    // Skip escape sequences: ESC, an optional '[' or 'O', parameters, then a final byte
+    if (escape == 1)
+    {
+        escape = (c == '[' || c == 'O') ? 2 : 0;
+        return;
+    }
+    if (escape == 2)
+    {
+        if (c >= 0x40 && c <= 0x7E)
+            escape = 0;
+        return;
+    }
+
+    if (c == '\r' || c == '\n')
+    {
+        std::istringstream words(line);
+        std::string token;
+        while (words >> token)
+            tokens.push_back(token);
+        line.clear();
+        if (raw)
+        {
+            std::lock_guard<std::mutex> consoleLock(consoleMutex);
+            std::cout << HIDE_CURSOR;
+            std::cout.flush();
+        }
+    }
+    else if (c == '\b' || c == 0x7F)
+    {
+        erase(1);
+    }
+    else if (c == CTRL_U)
+    {
+        erase(line.size());
+    }
+    else if (c == CTRL_W)
+    {
+        size_t end = line.find_last_not_of(' ');
+        size_t start = (end == std::string::npos) ? 0 : line.find_last_of(' ', end);
+        start = (start == std::string::npos) ? 0 : start + 1;
+        erase(line.size() - start);
+    }
+    else if (c == ESC)
+    {
+        escape = 1;
+    }
+    else if (static_cast<unsigned char>(c) >= 0x20)
+    {
+        line += c;
+        echo(std::string(1, c));
+    }
+}
+
+bool LineEditor::read(std::vector<std::string> &tokens)
+{
+#ifdef _WIN32
+    while (_kbhit())
+    {
+        int c = _getch();
+        if (c == 0 || c == 0xE0)
+        {
+            _getch(); // Second half of a function or arrow key
+            continue;
+        }
+        key(static_cast<char>(c), tokens);
+    }
+    return true;
+#else
+    // Called when the terminal is readable, so this one read does not block
+    char buffer[256];
+    ssize_t count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (count < 0)
+        return errno == EINTR || errno == EAGAIN;
+    if (count == 0)
+    {
+        key('\n', tokens); // A last line without a newline still counts
+        return false;
+    }
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        if (raw && buffer[i] == CTRL_D && line.empty())
+            return false;
+        key(buffer[i], tokens);
+    }
+    return true;
+#endif
+}
@@ -5,12 +5,30 @@
 #include "authentication.h"
 #include "data_management.h"
 #include "trading.h"
+#include "trading_engine.h"
 #include "simulations.h"
 #include "visualization.h"
+#include "indicators.h"
+#include "chart_renderer.h"
+#include "terminal_chart.h"
+#include "chart_downsample.h"
+#include "event_loop.h"
+#include "line_editor.h"
 #include "data_persistence.h"
+#include "market_data.h"
+#include "market_bus.h"
+#include "script_mode.h"
+#include "matching_engine.h"
+#include "benchmarks.h"
+#include "backtest_mode.h"
+#include "scan_mode.h"
+#include "export_mode.h"
+#include "import_mode.h"
+#include "server_mode.h"
+#include "client_mode.h"
+#include <memory>
 
 // Mutexes for synchronization
-std::mutex dataMutex;                    // Mutex for data synchronization
 std::mutex consoleMutex;                 // Mutex for console output synchronization
 std::atomic<bool> stopSimulation(false); // To stop the simulation
 std::atomic<bool> changeStock(false);    // To change the stock
@@ -28,12 +46,134 @@ std::map<std::string, std::pair<double, double>> assetData = {
 };
 
 // Updated main function
-int main()
+int main(int argc, char *argv[])
 {
 #ifdef _WIN32
     EnableVirtualTerminalProcessing(); // Enable ANSI escape codes
 #endif
 
+    // Non-interactive modes
+    if (argc == 3 && std::string(argv[1]) == "--bench")
+        return runBenchmark(argv[2]);
+    if (argc > 2 && std::string(argv[1]) == "--backtest")
+    {
+        BacktestOptions backtestOptions;
+        if (!parseBacktestOptions(argc, argv, backtestOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --backtest <" << strategyNames() << "> [--symbol <SYMBOL>] [--period <n>]"
+                      << " [--lower <rsi>] [--upper <rsi>] [--cash <amount>] [--out <dir>]" << std::endl;
+            return 1;
+        }
+        return runBacktestMode(backtestOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sweep")
+    {
+        SweepOptions sweepOptions;
+        if (!parseSweepOptions(argc, argv, sweepOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --sweep [--symbol <SYMBOL>] [--threads <n>] [--sma <p1,p2,...>]"
+                      << " [--rsi <p1,p2,...>] [--bands <lo/hi,...>] [--cash <amount>] [--top <n>]" << std::endl;
+            return 1;
+        }
+        return runSweepMode(sweepOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--scan")
+    {
+        ScanOptions scanOptions;
+        if (!parseScanOptions(argc, argv, scanOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --scan [--conditions <oversold,overbought,cross_up,cross_down,breakout,breakdown>]"
+                      << " [--rsi-below <rsi>] [--rsi-above <rsi>] [--threads <n>] [--top <n>]" << std::endl;
+            return 1;
+        }
+        return runScanMode(scanOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--export")
+    {
+        ExportOptions exportOptions;
+        if (!parseExportOptions(argc, argv, exportOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --export [--symbols <A,B,...>] [--format <svg|png|svg,png>] [--candles <n>]"
+                      << " [--width <px>] [--height <px>] [--out <dir>] [--threads <n>]" << std::endl;
+            return 1;
+        }
+        return runExportMode(exportOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--import")
+    {
+        ImportOptions importOptions;
+        if (!parseImportOptions(argc, argv, importOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --import <file.csv|dir>... [--series <EQ|...|all>] [--symbol <SYMBOL>]"
+                      << " [--symbols <A,B,...>] [--rename <SRC=DEST,...>] [--history] [--threads <n>]" << std::endl;
+            return 1;
+        }
+        return runImportMode(importOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--serve")
+    {
+        ServeOptions serveOptions;
+        if (!parseServeOptions(argc, argv, serveOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --serve [--socket <path>] [--port <n>] [--account <username>] [--save]" << std::endl;
+            return 1;
+        }
+        return runServeMode(serveOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--client")
+    {
+        ClientOptions clientOptions;
+        if (!parseClientOptions(argc, argv, clientOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --client [--socket <path>] [--port <n>] [--symbols <A,B,...>]"
+                      << " [--orders <file|->] [--batch <n>]" << std::endl;
+            return 1;
+        }
+        return runClientMode(clientOptions);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--loadgen")
+    {
+        LoadOptions loadOptions;
+        if (!parseLoadOptions(argc, argv, loadOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " --loadgen [--socket <path>] [--port <n>] [--subscribers <n>] [--seconds <s>]"
+                      << " [--orders-per-second <n>] [--batch <n>] [--symbol <SYMBOL>]" << std::endl;
+            return 1;
+        }
+        return runLoadGenerator(loadOptions);
+    }
+
+    // Where the trading view's chart goes
+    ChartOutput chartOutput = defaultChartOutput();
+    if (argc == 3 && std::string(argv[1]) == "--chart")
+    {
+        if (!parseChartOutput(argv[2], chartOutput))
+        {
+            std::cerr << "Usage: " << argv[0] << " --chart <gnuplot|terminal>" << std::endl;
+            return 1;
+        }
+    }
+    else if (argc > 1)
+    {
+        ScriptOptions scriptOptions;
+        if (!parseScriptOptions(argc, argv, scriptOptions))
+        {
+            std::cerr << "Usage: " << argv[0] << " [--script <file|-> --account <username> [--rate <orders/sec>] [--save]]" << std::endl;
+            std::cerr << "       " << argv[0] << " --backtest <" << strategyNames() << "> [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --sweep [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --scan [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --export [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --import <file.csv|dir>... [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --serve [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --client [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --loadgen [options]" << std::endl;
+            std::cerr << "       " << argv[0] << " --chart <gnuplot|terminal>" << std::endl;
+            std::cerr << "       " << argv[0] << " --bench <" << benchmarkNames() << ">" << std::endl;
+            return 1;
+        }
+        return runOrderScript(scriptOptions);
+    }
+
     User user;
 
     int option;
@@ -72,23 +212,36 @@ int main()
         return 1;
     }
 
+    // Register every tradable symbol so each has a compact ID
+    for (const auto &pair : assetData)
+    {
+        internSymbol(pair.first);
+    }
+
     // Load stock data from disk if available
     loadStockData(closePricesMap, candlesMap);
 
+    // The shared order book must be up before prices start flowing into it
+    matchingEngine.start();
+
     // Start real-time simulations for all symbols in separate threads
-    std::vector<std::thread> simulationThreads;
-    for (const auto &pair : assetData)
-    {
-        const std::string &simSymbol = pair.first;
-        stopFlags[simSymbol] = false;
-        // Initialize vectors if not loaded
-        if (closePricesMap.find(simSymbol) == closePricesMap.end())
-            closePricesMap[simSymbol] = std::vector<double>();
-        if (candlesMap.find(simSymbol) == candlesMap.end())
-            candlesMap[simSymbol] = std::vector<Candle>();
-        simulationThreads.emplace_back(simulateSymbolPrice, simSymbol, std::ref(closePricesMap[simSymbol]),
-                                       std::ref(candlesMap[simSymbol]), std::ref(stopFlags[simSymbol]));
-    }
+    startSimulations();
+
+    // The trading engine owns the account from here on; order entry only queues commands
+    TradingEngine engine(&user);
+    // Results are shown by the trading view's event loop, on its own thread; none while at the main menu
+    std::mutex tradingViewLock;
+    EventLoop *tradingLoop = nullptr;
+    OrderEntry *orderEntry = nullptr;
+    engine.setResultListener([&](const TradeResult &result)
+                             {
+                                 std::lock_guard<std::mutex> viewLock(tradingViewLock);
+                                 if (tradingLoop == nullptr)
+                                     return; // Keep the main menu clean
+                                 OrderEntry *entry = orderEntry;
+                                 tradingLoop->post([entry, result]
+                                                   { entry->showResult(result); }); });
+    engine.start();
 
     // Terminal control
     std::cout << CLEAR_SCREEN << HIDE_CURSOR;
@@ -105,15 +258,18 @@ int main()
 
     int lastLineUsed = 0; // To keep track of the last line used in the portfolio display
 
+    // Index into CHART_ZOOM_LEVELS, set by the zoom commands; kept when switching stock
+    std::atomic<size_t> chartZoom(0);
+
     while (!exitProgram)
     {
         stopSimulation = false;      // Reset the stopSimulation flag
         changeStock = false;         // Reset the changeStock flag
-        double lastOrderPrice = 0.0; // Reset lastOrderPrice
 
         {
             std::lock_guard<std::mutex> consoleLock(consoleMutex);
-            std::cout << CLEAR_SCREEN << HIDE_CURSOR;
+            clearScreen();
+            std::cout << HIDE_CURSOR;
             moveCursor(2, 2);
             std::cout << "Welcome to IndiNexus - Learn Indian Equity Markets with Realistic Simulations, " << user.username << "!";
             moveCursor(2, 3);
@@ -121,7 +277,7 @@ int main()
             moveCursor(2, 4);
             std::cout << "RELYCORP, TECHSOL, INFOWAVE, NDFBANK, FMCGUNION, METALWORKS, SAFEBANK";
             moveCursor(2, 5);
-            std::cout << "Enter the stock you want to trade, or type 'transactions' to view your transactions, or 'exit' to quit: ";
+            std::cout << "Enter the stock you want to trade, or type 'transactions' to view your transactions, 'scan' to screen all stocks, or 'exit' to quit: ";
             std::cout << SHOW_CURSOR;
             std::cout.flush();
         }
@@ -140,9 +296,14 @@ int main()
 
         if (inputUpper == "TRANSACTIONS")
         {
-            displayTransactions(user);
+            displayTransactions(engine);
             continue; // Return to the start of the loop
         }
+        else if (inputUpper == "SCAN")
+        {
+            displayScan();
+            continue;
+        }
         else if (inputUpper == "EXIT")
         {
             stopSimulation = true; // Signal to stop the simulation
@@ -164,8 +325,13 @@ int main()
                 continue; // Return to the start of the loop
             }
 
-            // Start user input handling in a separate thread
-            std::thread inputThread(userInputThread, &user, std::ref(closePricesMap), std::ref(symbol), std::ref(lastOrderPrice));
+            // The trading view runs on this thread's event loop: keystrokes, the once-a-second
+            // frame timer, the gnuplot pipe and the engine's results, with nothing blocking
+            EventLoop loop;
+            LineEditor editor;
+            OrderEntry entry(&engine, symbol, chartZoom, editor);
+            SymbolId symbolId = internSymbol(symbol);
+            SymbolMarket &market = symbolMarket(symbolId);
 
             // Open gnuplot pipe and redirect output to NUL to suppress messages
 #ifdef _WIN32
@@ -174,296 +340,190 @@ int main()
 #define GNUPLOT_PATH "gnuplot > /dev/null 2>&1"
 #endif
 
-            FILE *gnuplotPipe = popen(GNUPLOT_PATH, "w");
-            if (gnuplotPipe == NULL)
+            // Frames are written to gnuplot as the loop finds its pipe writable, or drawn in the terminal
+            std::unique_ptr<ChartRenderer> chartRenderer;
+            if (chartOutput == ChartOutput::Gnuplot)
             {
-                std::cerr << "Error: Could not open gnuplot pipe." << std::endl;
-                return 1;
+                chartRenderer = std::make_unique<ChartRenderer>(symbol, GNUPLOT_PATH, loop);
+                if (!chartRenderer->isOpen())
+                {
+                    std::cerr << "Error: Could not open gnuplot pipe." << std::endl;
+                    return 1;
+                }
             }
-
-            // Set the terminal type once at the beginning
-            fprintf(gnuplotPipe, "reset\n");
-#ifdef _WIN32
-            fprintf(gnuplotPipe, "set term windows\n"); // Use 'windows' terminal
-#else
-            fprintf(gnuplotPipe, "set term %s\n", "qt"); // Use 'qt' terminal
-#endif
+            TerminalChart terminalChart;
+            TerminalArea renderedArea;
+            std::string terminalFrame;
 
             // Reset lastLineUsed for the new simulation
             lastLineUsed = 0;
 
-            // Main loop: Update portfolio display, execute limit orders, and plot every second
-            while (!stopSimulation)
+            // The portfolio panel's screen model; only the lines that change are written
+            ScreenBuffer portfolioScreen;
+            std::string portfolioFrame;
+
+            // Reused every frame, so steady-state frames do not allocate
+            ChartWindow chartWindow;
+            ChartStamp renderedStamp;
+
+            // Zoomed out, the chart is read from the recorded history and downsampled; that
+            // window is rebuilt only when a candle is recorded or the range or width changes
+            ChartHistoryReader historyReader(symbol);
+            ChartWindow rangeWindow;
+            size_t rangeCandles = 0;
+            size_t rangeWidth = 0;
+            size_t renderedZoom = 0;
+
+            // The chart's own cursor on the market bus, drained once a frame, tells it whether
+            // this symbol has ticked since the last one
+            MarketBusReader marketEvents(marketBus);
+            bool marketChanged = true;
+
+            // Update the portfolio display and post a chart frame when it has changed
+            // (limit orders fill in the matching engine)
+            auto drawFrame = [&]()
             {
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-
-                // Update portfolio display
+                // Update portfolio display: composed from the engine's latest snapshot with no
+                // lock held, then diffed and written in one call under the console lock
+                composePortfolio(engine.portfolio(), screenWidth, screenHeight, lastLineUsed,
+                                 maximumHoldingsCount, maximumPendingOrdersCount, portfolioScreen);
                 {
                     std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    displayPortfolio(&user, closePricesMap, lastOrderPrice, screenWidth, screenHeight,
-                                     lastLineUsed, maximumHoldingsCount, maximumPendingOrdersCount);
-
-                    std::cout.flush();
+                    portfolioFrame.clear();
+                    portfolioScreen.present(portfolioFrame);
+                    writeTerminal(portfolioFrame);
                 }
 
-                // Check and execute pending limit orders
+                // The terminal chart fills the rows between the trading menu and the portfolio
+                TerminalArea area;
+                if (!chartRenderer)
                 {
-                    std::lock_guard<std::mutex> dataLock(dataMutex);
-                    // Iterate through a copy of pendingOrders to safely remove executed orders
-                    std::vector<User::Order> executedOrders;
-                    for (const auto &order : user.pendingOrders)
-                    {
-                        // Get current price for order.symbol
-                        double currentPrice = 0.0;
-                        if (!closePricesMap[order.symbol].empty())
-                        {
-                            currentPrice = closePricesMap[order.symbol].back();
-                        }
-                        else
-                        {
-                            // No price data available for this symbol
-                            continue;
-                        }
-
-                        if (order.type == "Limit_Buy" && currentPrice <= order.limitPrice)
-                        {
-                            // Check if user has sufficient funds
-                            if (!hasSufficientFunds(&user, order.amount * currentPrice))
-                            {
-                                continue; // Skip to next order
-                            }
-
-                            // Execute Limit Buy
-                            user.transactions.emplace_back(order.symbol, order.amount, currentPrice, "Limit_Buy", calculateBrokerFee(order.amount * currentPrice));
-                            user.demoMoney -= order.amount * currentPrice;
-
-                            // Update holdings
-                            bool found = false;
-                            for (auto &holding : user.holdings)
-                            {
-                                if (holding.symbol == order.symbol)
-                                {
-                                    // Update average price
-                                    holding.averagePrice = ((holding.averagePrice * holding.amount) + (currentPrice * order.amount)) / (holding.amount + order.amount);
-                                    holding.amount += order.amount;
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found)
-                            {
-                                // Add new holding
-                                User::Holding newHolding;
-                                newHolding.symbol = order.symbol;
-                                newHolding.amount = order.amount;
-                                newHolding.averagePrice = currentPrice;
-                                user.holdings.push_back(newHolding);
-                            }
-
-                            lastOrderPrice = currentPrice;
-                            executedOrders.push_back(order);
-
-                            // Inform the user
-                            {
-                                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                                moveCursor(2, 9);
-                                std::cout << CLEARLINE << "Limit_Buy order executed for " << order.amount << " of " << order.symbol << " at INR " << currentPrice;
-                                moveCursor(2, 7);
-                            }
-                            displayInputPrompt();
-                        }
-                        else if (order.type == "Limit_Sell" && currentPrice >= order.limitPrice)
-                        {
-                            // Check if user has sufficient holdings
-                            if (!hasSufficientHoldings(&user, order.symbol, order.amount))
-                            {
-                                continue; // Skip to next order
-                            }
-
-                            // Execute Limit Sell
-                            user.transactions.emplace_back(order.symbol, order.amount, currentPrice, "Limit_Sell", calculateBrokerFee(order.amount * currentPrice));
-                            user.demoMoney += order.amount * currentPrice;
-
-                            // Update holdings
-                            for (auto it = user.holdings.begin(); it != user.holdings.end(); ++it)
-                            {
-                                if (it->symbol == order.symbol)
-                                {
-                                    it->amount -= order.amount;
-                                    if (it->amount <= 0)
-                                    {
-                                        // Remove holding from vector
-                                        it = user.holdings.erase(it);
-                                    }
-                                    // No need to update 'it' because we break immediately
-                                    break;
-                                }
-                            }
-
-                            lastOrderPrice = currentPrice;
-                            executedOrders.push_back(order);
-
-                            // Inform the user
-                            {
-                                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                                moveCursor(2, 9);
-                                std::cout << CLEARLINE << "Limit_Sell order executed for " << order.amount << " of " << order.symbol << " at INR " << currentPrice;
-                                moveCursor(2, 7);
-                            }
-                            displayInputPrompt();
-                        }
-                    }
-
-                    // Remove executed orders from pendingOrders
-                    for (const auto &executedOrder : executedOrders)
-                    {
-                        auto it = std::find_if(user.pendingOrders.begin(), user.pendingOrders.end(),
-                                               [&executedOrder](const User::Order &o)
-                                               {
-                                                   return o.symbol == executedOrder.symbol &&
-                                                          o.type == executedOrder.type &&
-                                                          o.amount == executedOrder.amount &&
-                                                          o.limitPrice == executedOrder.limitPrice;
-                                               });
-                        if (it != user.pendingOrders.end())
-                        {
-                            user.pendingOrders.erase(it);
-                        }
-                    }
+                    area.row = TERMINAL_CHART_TOP_LINE;
+                    area.width = screenWidth;
+                    area.height = portfolioTopLine(screenHeight, maximumHoldingsCount, maximumPendingOrdersCount) - 1 - area.row;
                 }
 
-                // Write data files for plotting
-                std::vector<Candle> candles;
+                size_t zoom = chartZoom;
+                size_t range = CHART_ZOOM_LEVELS[zoom].candles;
+                size_t width = chartRenderer ? GNUPLOT_CHART_PIXELS
+                                             : static_cast<size_t>(std::max(1, area.width - TERMINAL_CHART_AXIS_WIDTH));
+                bool zoomed = range > CHART_VISIBLE_CANDLES;
+                if (zoomed && (historyReader.refresh() || range != rangeCandles || width != rangeWidth))
                 {
-                    std::lock_guard<std::mutex> dataLock(dataMutex);
-
-                    // Check if there is price data for the current symbol
-                    if (candlesMap[symbol].empty())
-                        continue;
-
-                    candles = candlesMap[symbol];
+                    if (!historyReader.window(range, width, rangeWindow))
+                        rangeWindow.candles.clear();
+                    rangeCandles = range;
+                    rangeWidth = width;
+                    marketChanged = true;
+                }
+                zoomed = zoomed && !rangeWindow.candles.empty(); // Nothing recorded yet: stay on the live window
 
-                    // Write candles data
-                    std::ofstream candlesFile("data/candles.dat");
-                    for (size_t i = 0; i < candles.size(); ++i)
-                    {
-                        candlesFile << i << " " << candles[i].open << " " << candles[i].high << " " << candles[i].low << " " << candles[i].close << "\n";
-                    }
-                    candlesFile.close();
+                uint64_t missed = marketEvents.missed();
+                while (marketEvents.poll([&](const MarketEvent &event)
+                                         { marketChanged = marketChanged || event.symbolId == symbolId; }) != 0)
+                {
+                }
+                marketChanged = marketChanged || marketEvents.missed() != missed;
+                if (!marketChanged && area == renderedArea && zoom == renderedZoom)
+                    return;
 
-                    // Calculate moving average
-                    const int maPeriod = 5;
-                    std::ofstream maFile("data/moving_average.dat");
-                    for (size_t i = 0; i < candles.size(); ++i)
+                // Redraw only when a candle has closed, the price label has changed, the zoom has
+                // changed or the terminal area has moved; only this symbol's series are locked, for
+                // O(visible) work, so the other symbols tick on undisturbed
+                {
+                    std::lock_guard<std::mutex> seriesLock(market.seriesLock);
+                    ChartStamp stamp = currentChartStamp(symbol);
+                    marketChanged = false;
+                    if (stamp == renderedStamp && area == renderedArea && zoom == renderedZoom)
+                        return;
+                    if (zoomed)
                     {
-                        double ma = calculateMovingAverage(candles, maPeriod, i);
-                        maFile << i << " " << ma << "\n";
+                        chartWindow = rangeWindow;
+                        chartWindow.currentPrice = chartCurrentPrice(symbol);
                     }
-                    maFile.close();
-
-                    // Calculate RSI
-                    const int rsiPeriod = 14;
-                    std::ofstream rsiFile("data/rsi.dat");
-                    for (size_t i = 1; i < candles.size(); ++i)
+                    else if (!captureChartWindow(symbol, CHART_VISIBLE_CANDLES, chartWindow))
                     {
-                        double rsi = calculateRSI(candles, rsiPeriod, i);
-                        rsiFile << i << " " << rsi << "\n";
+                        marketChanged = true; // No candles yet: look again next frame
+                        return;
                     }
-                    rsiFile.close();
+                    renderedStamp = stamp;
+                    renderedArea = area;
+                    renderedZoom = zoom;
                 }
 
-                // Calculate the minimum and maximum price from candles
-                double minPrice = std::numeric_limits<double>::max();
-                double maxPrice = std::numeric_limits<double>::lowest();
-
-                for (const auto &candle : candles)
+                if (chartRenderer)
                 {
-                    if (candle.low < minPrice)
-                        minPrice = candle.low;
-                    if (candle.high > maxPrice)
-                        maxPrice = candle.high;
+                    // Never blocks on gnuplot: a frame it has not taken yet is replaced
+                    chartRenderer->post(chartWindow);
                 }
+                else
+                {
+                    terminalFrame.clear();
+                    if (terminalChart.appendFrame(chartWindow, symbol, area, terminalFrame))
+                    {
+                        std::lock_guard<std::mutex> consoleLock(consoleMutex);
+                        writeTerminal(terminalFrame);
+                    }
+                }
+            };
 
-                // Add some padding to the min and max prices for better visualization
-                double padding = (maxPrice - minPrice) * 0.05;
-                minPrice -= padding;
-                maxPrice += padding;
-
-                // Calculate x-range to focus on recent candles
-                size_t numCandles = candles.size();
-                size_t xrange_min = numCandles >= 50 ? numCandles - 50 : 0; // Display last 50 candles
-                size_t xrange_max = numCandles - 1;
-
-                // Send Gnuplot commands directly
-                fprintf(gnuplotPipe, "reset\n");
-                fprintf(gnuplotPipe, "set xrange [%zu:%zu]\n", xrange_min, xrange_max);
-                fprintf(gnuplotPipe, "set yrange [%f:%f]\n", minPrice, maxPrice); // Set yrange
-                fprintf(gnuplotPipe, "set style fill solid 0.4\n");               // Filled candlestick body
-                fprintf(gnuplotPipe, "set grid\n");
-
-                // Begin multiplot
-                fprintf(gnuplotPipe, "set multiplot title 'IndiNexus - %s'\n", symbol.c_str());
-
-                // First plot: Candlestick chart with Moving Average
-                fprintf(gnuplotPipe, "set size 1.0,0.75\n");
-                fprintf(gnuplotPipe, "set origin 0.0,0.2\n");        // Starting from y=0.2 to y=1.0
-                fprintf(gnuplotPipe, "set boxwidth 0.3 relative\n"); // Adjust boxwidth to make candles thinner
-                fprintf(gnuplotPipe, "set style data candlesticks\n");
-
-                // Optional: Set the legend/key position for the candlestick chart
-                fprintf(gnuplotPipe, "set key top right\n"); // You can customize the position (e.g., "top right", "bottom left")
-
-                // Annotate the current price at the bottom right corner of the candlestick chart
+            // Tokens go to order entry as lines are finished; a zoom is drawn at once.
+            // Leaving the view, or the end of input, stops the loop straight away.
+            std::vector<std::string> tokens;
+            auto readInput = [&]()
+            {
+                size_t zoom = chartZoom;
+                bool open = editor.read(tokens);
+                for (const std::string &token : tokens)
                 {
-                    std::lock_guard<std::mutex> dataLock(dataMutex);
-                    if (!closePricesMap[symbol].empty())
+                    if (!entry.onToken(token))
                     {
-                        double currentPrice = closePricesMap[symbol].back();
-                        // Place the label after setting size and origin
-                        fprintf(gnuplotPipe, "set label 1 'Current Price: INR %.2f' at graph 0.99, graph 0.04 right front\n", currentPrice);
+                        open = false;
+                        break;
                     }
                 }
+                tokens.clear();
+                if (!open)
+                {
+                    stopSimulation = true;
+                    loop.stop();
+                }
+                else if (chartZoom != zoom)
+                {
+                    drawFrame();
+                }
+            };
+#ifdef _WIN32
+            loop.addTimer(std::chrono::milliseconds(20), [&](uint64_t)
+                          { readInput(); });
+#else
+            loop.watchReadable(editor.fd(), readInput);
+#endif
+            loop.addTimer(std::chrono::seconds(1), [&](uint64_t)
+                          { drawFrame(); });
 
-                // Plot the candlestick chart and moving average with titles for the legend
-                fprintf(gnuplotPipe, "plot \\\n");
-                fprintf(gnuplotPipe, "'data/candles.dat' using 1:($5>$2?$2:1):($5>$2?$3:1):($5>$2?$4:1):($5>$2?$5:1) with candlesticks lw 1 lc rgb 'green' title 'Bullish', \\\n");
-                fprintf(gnuplotPipe, "'data/candles.dat' using 1:($5<=$2?$2:1):($5<=$2?$3:1):($5<=$2?$4:1):($5<=$2?$5:1) with candlesticks lw 1 lc rgb 'red' title 'Bearish', \\\n");
-                fprintf(gnuplotPipe, "'data/moving_average.dat' using 1:2 with lines lw 2 lc rgb 'blue' title 'Moving Average'\n");
-
-                // Unset the label after the first plot
-                fprintf(gnuplotPipe, "unset label 1\n");
-
-                // Second plot: RSI
-                fprintf(gnuplotPipe, "set size 1.0,0.2\n");
-                fprintf(gnuplotPipe, "set origin 0.0,0.0\n"); // Starting from y=0.0 to y=0.2
-                fprintf(gnuplotPipe, "set grid\n");
-                fprintf(gnuplotPipe, "set yrange [0:100]\n");
-                fprintf(gnuplotPipe, "set key autotitle columnheader\n"); // This is why RSI legend appears
-                fprintf(gnuplotPipe, "plot \\\n");
-                fprintf(gnuplotPipe, "'data/rsi.dat' using 1:2 with lines lw 2 lc rgb 'red' title 'RSI', \\\n");
-                fprintf(gnuplotPipe, "80 with lines dt 2 lw 3 lc rgb 'gray' notitle, \\\n");
-                fprintf(gnuplotPipe, "20 with lines dt 2 lw 3 lc rgb 'gray' notitle\n");
-
-                // Finish multiplot
-                fprintf(gnuplotPipe, "unset multiplot\n");
-                fflush(gnuplotPipe);
-                std::cout.flush();
+            {
+                std::lock_guard<std::mutex> viewLock(tradingViewLock);
+                tradingLoop = &loop;
+                orderEntry = &entry;
             }
-
-            // Close gnuplot pipe
-            pclose(gnuplotPipe);
-
-            // Wait for user input thread to finish
-            if (inputThread.joinable())
+            entry.start();
+            drawFrame();
+            loop.run();
             {
-                inputThread.join();
+                std::lock_guard<std::mutex> viewLock(tradingViewLock);
+                tradingLoop = nullptr;
+                orderEntry = nullptr;
             }
 
             // If the user wants to change stock, continue
             if (changeStock)
             {
                 // Save user data before changing stock
-                user.saveUserData();
+                {
+                    std::lock_guard<std::mutex> accountLock(engine.accountMutex());
+                    user.saveUserData();
+                }
                 // Inform the user
                 {
                     std::lock_guard<std::mutex> consoleLock(consoleMutex);
@@ -491,26 +551,16 @@ int main()
         std::cout << SHOW_CURSOR;
     }
 
-    // Save user data before exiting
+    // Apply any queued commands, then save user data before exiting
+    engine.stop();
     user.saveUserData();
 
     // Save stock data before exiting
     saveStockData(closePricesMap, candlesMap);
 
-    // Signal all simulation threads to stop
-    for (auto &pair : stopFlags)
-    {
-        pair.second = true;
-    }
-
-    // Wait for simulation threads to finish
-    for (auto &simThread : simulationThreads)
-    {
-        if (simThread.joinable())
-        {
-            simThread.join();
-        }
-    }
+    // Stop the simulation threads, then the order book they feed
+    stopSimulations();
+    matchingEngine.stop();
 
     return 0;
 }
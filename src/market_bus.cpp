@@ -0,0 +1,127 @@
+// src/market_bus.cpp
+
+#include "utils.h"
+#include "market_bus.h"
+#include <stdexcept>
+
+namespace
+{
+    // Ticks of every symbol for a few hours at the simulation's pace
+    const size_t MARKET_BUS_CAPACITY = 16384;
+
+    // Consumers re-check the bus at least this often, even if no commit wakes them
+    const auto CONSUMER_POLL_INTERVAL = std::chrono::milliseconds(100);
+}
+
+MarketBus marketBus(MARKET_BUS_CAPACITY);
+
+MarketBus::MarketBus(size_t requestedCapacity)
+{
+    size_t capacity = 1;
+    while (capacity < requestedCapacity)
+        capacity <<= 1;
+    mask = capacity - 1;
+    slots.reset(new Slot[capacity]);
+}
+
+void MarketBus::commit()
+{
+    committed.store(next, std::memory_order_release);
+    size_t seen = readerSlotsSeen.load(std::memory_order_acquire);
+    for (size_t i = 0; i < seen; ++i)
+    {
+        if (readers[i].used.load(std::memory_order_relaxed))
+            readers[i].wakeup.notify(); // Only takes a lock if that consumer is asleep
+    }
+}
+
+int MarketBus::attach()
+{
+    for (size_t i = 0; i < MAX_READERS; ++i)
+    {
+        bool expected = false;
+        if (readers[i].used.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            size_t seen = readerSlotsSeen.load(std::memory_order_relaxed);
+            while (seen < i + 1 && !readerSlotsSeen.compare_exchange_weak(seen, i + 1, std::memory_order_release))
+            {
+            }
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void MarketBus::detach(int reader)
+{
+    if (reader >= 0)
+        readers[reader].used.store(false, std::memory_order_release);
+}
+
+MarketBusReader::MarketBusReader(MarketBus &bus)
+    : bus(bus), slot(bus.attach()), next(bus.cursor())
+{
+    // A reader without a slot would never be woken by commits
+    if (slot < 0)
+        throw std::runtime_error("Market bus has no free reader slot (" + std::to_string(MarketBus::MAX_READERS) + " in use)");
+}
+
+MarketBusReader::~MarketBusReader()
+{
+    bus.detach(slot);
+}
+
+void MarketBusReader::skipAhead(uint64_t available)
+{
+    // Resume half a ring behind the producer, so the reader is not lapped again at once
+    uint64_t resume = available - std::min<uint64_t>(available, bus.capacity() / 2);
+    if (resume > next)
+    {
+        missedEvents += resume - next;
+        next = resume;
+    }
+}
+
+MarketBusConsumer::MarketBusConsumer(MarketBus &bus, Handler handler, GapHandler gapHandler)
+    : reader(bus), handler(std::move(handler)), gapHandler(std::move(gapHandler))
+{
+    worker = std::thread(&MarketBusConsumer::run, this);
+}
+
+MarketBusConsumer::~MarketBusConsumer()
+{
+    stop();
+}
+
+void MarketBusConsumer::stop()
+{
+    running.store(false, std::memory_order_release);
+    reader.wakeup().wakeAlways();
+    if (worker.joinable())
+        worker.join();
+}
+
+void MarketBusConsumer::run()
+{
+    for (;;)
+    {
+        bool stopping = !running.load(std::memory_order_acquire);
+        for (;;)
+        {
+            size_t handled = reader.poll(handler);
+            if (reader.missed() != missedReported)
+            {
+                uint64_t missed = reader.missed() - missedReported;
+                missedReported = reader.missed();
+                if (gapHandler)
+                    gapHandler(missed);
+            }
+            if (handled == 0)
+                break;
+        }
+        if (stopping)
+            break;
+        reader.wakeup().waitUntil(std::chrono::steady_clock::now() + CONSUMER_POLL_INTERVAL, [this]
+                                  { return reader.pending() || !running.load(std::memory_order_acquire); });
+    }
+}
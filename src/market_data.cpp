@@ -0,0 +1,39 @@
+// src/market_data.cpp
+
+#include "utils.h"
+#include "market_data.h"
+
+namespace
+{
+    // Shards are allocated in chunks that never move, found through a fixed
+    // directory of atomic pointers, so a lookup is two loads
+    const size_t CHUNK_BITS = 8;
+    const size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    const size_t MAX_CHUNKS = 4096; // Room for a million symbols
+
+    std::atomic<SymbolMarket *> chunks[MAX_CHUNKS];
+    std::mutex chunkMutex; // Only taken to allocate a chunk
+}
+
+SymbolMarket &symbolMarket(SymbolId id)
+{
+    size_t chunk = id >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS)
+    {
+        static SymbolMarket unknown; // Never ticks
+        return unknown;
+    }
+
+    SymbolMarket *markets = chunks[chunk].load(std::memory_order_acquire);
+    if (markets == nullptr)
+    {
+        std::lock_guard<std::mutex> chunkLock(chunkMutex);
+        markets = chunks[chunk].load(std::memory_order_relaxed);
+        if (markets == nullptr)
+        {
+            markets = new SymbolMarket[CHUNK_SIZE];
+            chunks[chunk].store(markets, std::memory_order_release);
+        }
+    }
+    return markets[id & (CHUNK_SIZE - 1)];
+}
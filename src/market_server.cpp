@@ -0,0 +1,569 @@
+// src/market_server.cpp
+
+#include "utils.h"
+#include "market_server.h"
+#include "market_data.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cmath>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+namespace
+{
+    // A subscriber this far behind is disconnected
+    const size_t MAX_QUEUED_BYTES = 4 << 20;
+
+    // Blocks handed to the kernel per send
+    const int MAX_IOVECS = 64;
+
+    // Bytes read per readable event; the loop is level-triggered, so the rest waits for the next
+    const size_t RECEIVE_BYTES = 64 << 10;
+
+    // The watcher re-checks the bus at least this often, even if no commit wakes it
+    const auto BUS_POLL_INTERVAL = std::chrono::milliseconds(100);
+
+    const int LISTEN_BACKLOG = 4096;
+
+    // Which prices a command needs, so malformed orders are refused before they reach the engine
+    bool hasRequiredPrices(const WireOrder &order)
+    {
+        bool limit = false, stop = false, trail = false, takeProfit = false;
+        switch (order.type)
+        {
+        case CommandType::LimitBuy:
+        case CommandType::LimitSell:
+        case CommandType::AmendOrder:
+            limit = true;
+            break;
+        case CommandType::StopBuy:
+        case CommandType::StopSell:
+            stop = true;
+            break;
+        case CommandType::StopLimitBuy:
+        case CommandType::StopLimitSell:
+        case CommandType::OcoBuy:
+        case CommandType::OcoSell:
+            limit = stop = true;
+            break;
+        case CommandType::TrailingStopBuy:
+        case CommandType::TrailingStopSell:
+            trail = true;
+            break;
+        case CommandType::BracketBuy:
+        case CommandType::BracketSell:
+            limit = stop = takeProfit = true;
+            break;
+        default:
+            break;
+        }
+        auto valid = [](double value, bool required)
+        { return std::isfinite(value) && value >= 0.0 && (!required || value > 0.0); };
+        return valid(order.limitPrice, limit) && valid(order.stopPrice, stop) && valid(order.trailAmount, trail) &&
+               valid(order.takeProfit, takeProfit);
+    }
+}
+
+MarketServer::MarketServer(EventLoop &loop, MarketBus &bus, TradingEngine *engine)
+    : loop(loop), bus(bus), events(bus), engine(engine), spareFd(open("/dev/null", O_RDONLY | O_CLOEXEC))
+{
+    for (const auto &pair : assetData)
+    {
+        SymbolId id = internSymbol(pair.first);
+        if (tradable.size() <= id)
+            tradable.resize(id + 1, false);
+        tradable[id] = true;
+    }
+
+    if (engine != nullptr)
+    {
+        engine->setResultListener([this](const TradeResult &result)
+                                  {
+                                      std::lock_guard<std::mutex> resultGuard(resultLock);
+                                      results.push_back(result);
+                                      if (!resultsPosted)
+                                      {
+                                          resultsPosted = true;
+                                          this->loop.post([this]
+                                                          { deliverResults(); });
+                                      } });
+    }
+    busWatcher = std::thread(&MarketServer::watchBus, this);
+}
+
+MarketServer::~MarketServer()
+{
+    watching.store(false, std::memory_order_release);
+    events.wakeup().wakeAlways();
+    if (busWatcher.joinable())
+        busWatcher.join();
+
+    while (!connections.empty())
+        closeConnection(connections.begin()->first);
+    for (int fd : listeners)
+    {
+        loop.unwatch(fd);
+        close(fd);
+    }
+    if (!unixPath.empty())
+        unlink(unixPath.c_str());
+    if (spareFd >= 0)
+        close(spareFd);
+}
+
+bool MarketServer::listenUnix(const std::string &path)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+        return false;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    unlink(path.c_str()); // Left behind by a server that did not shut down cleanly
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, LISTEN_BACKLOG) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    unixPath = path;
+    listeners.push_back(fd);
+    loop.watchReadable(fd, [this, fd]
+                       { acceptFrom(fd); });
+    return true;
+}
+
+bool MarketServer::listenTcp(uint16_t port)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, LISTEN_BACKLOG) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    listeners.push_back(fd);
+    loop.watchReadable(fd, [this, fd]
+                       { acceptFrom(fd); });
+    return true;
+}
+
+MarketServer::Stats MarketServer::stats() const
+{
+    Stats current = counters;
+    current.eventsMissed = events.missed();
+    current.connections = connections.size();
+    current.subscribers = 0;
+    for (const auto &pair : connections)
+    {
+        if (pair.second->subscribed)
+            current.subscribers++;
+    }
+    return current;
+}
+
+void MarketServer::acceptFrom(int listenFd)
+{
+    // Take every waiting connection, so a burst of connects does not cost a wakeup each
+    for (;;)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0 && (errno == EMFILE || errno == ENFILE) && spareFd >= 0)
+        {
+            // Out of descriptors: the listener stays readable and the
+            // level-triggered loop would spin, so use the spare descriptor to
+            // take the connection off the backlog and close it
+            close(spareFd);
+            fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0)
+            {
+                close(fd);
+                counters.refusedConnections++;
+            }
+            spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (fd >= 0)
+                continue;
+        }
+        if (fd < 0)
+            return; // EAGAIN, or out of descriptors with no spare left
+
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // Fails harmlessly on Unix sockets
+
+        uint64_t id = nextConnection++;
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->symbols.assign(tradable.size(), false);
+
+        // The symbol table first, so the client can map IDs to names
+        std::vector<std::pair<SymbolId, double>> table;
+        for (SymbolId symbol = 0; symbol < tradable.size(); ++symbol)
+        {
+            if (tradable[symbol])
+                table.emplace_back(symbol, symbolMarket(symbol).latest.read().price);
+        }
+        std::string hello;
+        appendSymbolTable(hello, table);
+        enqueue(*connection, std::make_shared<const std::string>(std::move(hello)));
+
+        connections.emplace(id, std::move(connection));
+        loop.watchReadable(fd, [this, id]
+                           { receive(id); });
+        flush(id);
+    }
+}
+
+void MarketServer::receive(uint64_t id)
+{
+    auto it = connections.find(id);
+    if (it == connections.end())
+        return;
+    Connection &connection = *it->second;
+
+    char *space = connection.in.prepare(RECEIVE_BYTES);
+    ssize_t received = recv(connection.fd, space, RECEIVE_BYTES, 0);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        closeConnection(id);
+        return;
+    }
+    if (received < 0)
+        return;
+    connection.in.commit(static_cast<size_t>(received));
+
+    const char *body;
+    size_t size;
+    while (connection.in.next(body, size))
+    {
+        if (!handleFrame(id, connection, body, size))
+            return; // Closed
+    }
+    if (connection.in.broken())
+        closeConnection(id);
+}
+
+bool MarketServer::handleFrame(uint64_t id, Connection &connection, const char *body, size_t size)
+{
+    WireReader reader(body, size);
+    uint8_t type = 0;
+    reader.read(type);
+    if (type == static_cast<uint8_t>(WireType::OrderBatch))
+        return handleOrders(id, connection, reader);
+    bool subscription = type == static_cast<uint8_t>(WireType::Subscribe) || type == static_cast<uint8_t>(WireType::Unsubscribe);
+    if (subscription)
+        handleSubscription(connection, reader, type == static_cast<uint8_t>(WireType::Subscribe));
+
+    if (!subscription || !reader.ok())
+    {
+        closeConnection(id); // Not speaking the protocol
+        return false;
+    }
+    return true;
+}
+
+void MarketServer::handleSubscription(Connection &connection, WireReader &reader, bool subscribe)
+{
+    uint32_t count = 0;
+    if (!reader.read(count))
+        return;
+    if (count == 0)
+    {
+        connection.allSymbols = subscribe;
+        std::fill(connection.symbols.begin(), connection.symbols.end(), false);
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        SymbolId symbol;
+        if (!reader.read(symbol))
+            return;
+        if (symbol < connection.symbols.size() && tradable[symbol])
+            connection.symbols[symbol] = subscribe;
+    }
+    connection.subscribed = connection.allSymbols ||
+                            std::find(connection.symbols.begin(), connection.symbols.end(), true) != connection.symbols.end();
+}
+
+bool MarketServer::handleOrders(uint64_t id, Connection &connection, WireReader &reader)
+{
+    uint32_t count = 0;
+    if (!reader.read(count))
+    {
+        closeConnection(id);
+        return false;
+    }
+    connection.trading = true;
+
+    // Orders refused here are answered together, after the batch
+    std::string refusals;
+    auto refuse = [&refusals](const WireOrder &order, const char *message)
+    {
+        appendAck(refusals, WireAck{order.tag, order.type, 0, 0, message});
+    };
+
+    auto now = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        WireOrder order;
+        if (!readWireOrder(reader, order) || order.tag == 0)
+        {
+            closeConnection(id);
+            return false;
+        }
+        counters.ordersReceived++;
+
+        bool cancel = order.type == CommandType::CancelOrder;
+        bool amend = order.type == CommandType::AmendOrder;
+        if (engine == nullptr)
+            refuse(order, "This server only publishes market data.");
+        else if (!cancel && !amend && (order.symbolId >= tradable.size() || !tradable[order.symbolId]))
+            refuse(order, "Unknown symbol.");
+        else if (!cancel && !(std::isfinite(order.amount) && order.amount > 0.0))
+            refuse(order, "The amount must be positive.");
+        else if (!hasRequiredPrices(order))
+            refuse(order, "Missing or invalid price for this order type.");
+        else
+        {
+            uint64_t request = nextRequest++;
+            TradeCommand command{order.type, cancel || amend ? INVALID_SYMBOL_ID : order.symbolId, order.amount, order.limitPrice,
+                                 order.orderId, request, now, order.stopPrice, order.trailAmount, order.takeProfit};
+            if (engine->trySubmit(command))
+                inFlight.emplace(request, std::make_pair(id, order.tag));
+            else
+                refuse(order, "The order queue is full; try again.");
+        }
+    }
+
+    if (!refusals.empty())
+    {
+        enqueue(connection, std::make_shared<const std::string>(std::move(refusals)));
+        return flush(id);
+    }
+    return true;
+}
+
+void MarketServer::deliverResults()
+{
+    std::vector<TradeResult> batch;
+    {
+        std::lock_guard<std::mutex> resultGuard(resultLock);
+        batch.swap(results);
+        resultsPosted = false;
+    }
+
+    // Acknowledgements are gathered per connection and sent once per batch
+    std::unordered_map<uint64_t, std::string> acks;
+    std::string executions;
+    for (const TradeResult &result : batch)
+    {
+        uint8_t flags = (result.accepted ? WIRE_ACCEPTED : 0) | (result.filled ? WIRE_FILLED : 0);
+        if (result.requestId == 0)
+        {
+            appendAck(executions, WireAck{0, result.type, flags, result.orderId, result.message});
+            continue;
+        }
+        auto it = inFlight.find(result.requestId);
+        if (it == inFlight.end())
+            continue;
+        appendAck(acks[it->second.first], WireAck{it->second.second, result.type, flags, result.orderId, result.message});
+        inFlight.erase(it);
+    }
+
+    std::shared_ptr<const std::string> executionBlock;
+    if (!executions.empty())
+        executionBlock = std::make_shared<const std::string>(std::move(executions));
+
+    std::vector<uint64_t> touched;
+    for (auto &pair : connections)
+    {
+        Connection &connection = *pair.second;
+        auto ack = acks.find(pair.first);
+        if (ack != acks.end())
+            enqueue(connection, std::make_shared<const std::string>(std::move(ack->second)));
+        if (executionBlock && connection.trading)
+            enqueue(connection, executionBlock);
+        if (ack != acks.end() || (executionBlock && connection.trading))
+            touched.push_back(pair.first);
+    }
+    for (uint64_t id : touched)
+        flush(id);
+}
+
+void MarketServer::fanOut()
+{
+    fanOutPosted.store(false, std::memory_order_release);
+
+    // Every frame of the batch, and each symbol's frames on their own
+    std::string all;
+    std::map<SymbolId, std::string> bySymbol;
+    int64_t sent = wireClockNanos();
+    auto encode = [&](const MarketEvent &event)
+    {
+        uint64_t sequence = events.position() - 1;
+        counters.eventsFannedOut++;
+        std::string &own = bySymbol[event.symbolId];
+        size_t start = all.size();
+        if (event.type == MarketEvent::Tick)
+            appendTick(all, event.symbolId, sequence, sent, event.price);
+        else
+            appendCandle(all, event.symbolId, sequence, sent, event.candle);
+        own.append(all, start, std::string::npos);
+    };
+    while (events.poll(encode) != 0)
+    {
+    }
+    if (all.empty())
+        return;
+
+    auto allBlock = std::make_shared<const std::string>(std::move(all));
+    std::vector<std::pair<SymbolId, std::shared_ptr<const std::string>>> symbolBlocks;
+    bool anyPartial = false;
+    for (const auto &pair : connections)
+        anyPartial |= pair.second->subscribed && !pair.second->allSymbols;
+    if (anyPartial)
+    {
+        for (auto &pair : bySymbol)
+            symbolBlocks.emplace_back(pair.first, std::make_shared<const std::string>(std::move(pair.second)));
+    }
+
+    std::vector<uint64_t> subscribers;
+    for (auto &pair : connections)
+    {
+        Connection &connection = *pair.second;
+        if (!connection.subscribed)
+            continue;
+        if (connection.allSymbols)
+        {
+            enqueue(connection, allBlock);
+        }
+        else
+        {
+            for (const auto &block : symbolBlocks)
+            {
+                if (block.first < connection.symbols.size() && connection.symbols[block.first])
+                    enqueue(connection, block.second);
+            }
+        }
+        subscribers.push_back(pair.first);
+    }
+    for (uint64_t id : subscribers)
+        flush(id);
+}
+
+void MarketServer::enqueue(Connection &connection, std::shared_ptr<const std::string> block)
+{
+    connection.queuedBytes += block->size();
+    counters.framesQueued++;
+    connection.out.push_back(Chunk{std::move(block), 0});
+}
+
+bool MarketServer::flush(uint64_t id)
+{
+    auto it = connections.find(id);
+    if (it == connections.end())
+        return false;
+    Connection &connection = *it->second;
+
+    while (!connection.out.empty())
+    {
+        iovec vectors[MAX_IOVECS];
+        int count = 0;
+        for (auto chunk = connection.out.begin(); chunk != connection.out.end() && count < MAX_IOVECS; ++chunk, ++count)
+        {
+            vectors[count].iov_base = const_cast<char *>(chunk->data->data() + chunk->offset);
+            vectors[count].iov_len = chunk->data->size() - chunk->offset;
+        }
+        msghdr message{};
+        message.msg_iov = vectors;
+        message.msg_iovlen = count;
+        ssize_t sent = sendmsg(connection.fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            closeConnection(id);
+            return false;
+        }
+
+        size_t written = static_cast<size_t>(sent);
+        connection.queuedBytes -= written;
+        while (written > 0)
+        {
+            Chunk &front = connection.out.front();
+            size_t left = front.data->size() - front.offset;
+            if (written < left)
+            {
+                front.offset += written;
+                break;
+            }
+            written -= left;
+            connection.out.pop_front();
+        }
+    }
+
+    if (connection.queuedBytes > MAX_QUEUED_BYTES)
+    {
+        counters.slowDisconnects++;
+        closeConnection(id);
+        return false;
+    }
+
+    // Only ask for writability while something is waiting, or the loop would spin on it
+    bool waiting = !connection.out.empty();
+    if (waiting != connection.waitingToWrite)
+    {
+        connection.waitingToWrite = waiting;
+        if (waiting)
+            loop.watchWritable(connection.fd, [this, id]
+                               { flush(id); });
+        else
+            loop.watchWritable(connection.fd, EventLoop::Handler());
+    }
+    return true;
+}
+
+void MarketServer::closeConnection(uint64_t id)
+{
+    auto it = connections.find(id);
+    if (it == connections.end())
+        return;
+    loop.unwatch(it->second->fd);
+    close(it->second->fd);
+    connections.erase(it);
+    // Its orders still in flight are answered to nobody; the engine applies them regardless
+}
+
+void MarketServer::watchBus()
+{
+    uint64_t seen = bus.cursor();
+    while (watching.load(std::memory_order_acquire))
+    {
+        events.wakeup().waitUntil(std::chrono::steady_clock::now() + BUS_POLL_INTERVAL, [this, seen]
+                                  { return bus.cursor() != seen || !watching.load(std::memory_order_acquire); });
+        uint64_t cursor = bus.cursor();
+        if (cursor == seen)
+            continue;
+        seen = cursor;
+        if (!fanOutPosted.exchange(true, std::memory_order_acq_rel))
+            loop.post([this]
+                      { fanOut(); });
+    }
+}
+#endif
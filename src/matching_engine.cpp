@@ -0,0 +1,533 @@
+// src/matching_engine.cpp
+
+#include "matching_engine.h"
+
+MatchingEngine matchingEngine;
+
+namespace
+{
+    // Quantities are fractional; treat anything below this as filled
+    const double QUANTITY_EPSILON = 1e-9;
+}
+
+OrderBook::OrderBook(SymbolId symbolId, EventSink sink)
+    : symbolId(symbolId), sink(std::move(sink))
+{
+}
+
+void OrderBook::fill(uint32_t slot, double quantity, double price, AccountId counterparty)
+{
+    Resting &order = pool[slot];
+    order.remaining -= quantity;
+    if (order.remaining < QUANTITY_EPSILON)
+        order.remaining = 0.0;
+
+    sink(BookEvent{BookEvent::Fill, symbolId, order.account, order.orderId, 0, order.side,
+                   quantity, price, order.remaining, counterparty});
+
+    // Any execution of a one-cancels-other leg cancels its sibling
+    if (order.linkedOrderId != 0)
+    {
+        uint64_t siblingId = order.linkedOrderId;
+        order.linkedOrderId = 0;
+        cancelSibling(order.account, siblingId, order.orderId);
+    }
+}
+
+template <typename Levels>
+void OrderBook::matchAgainst(Levels &levels, AccountId account, uint64_t orderId, Side side, double &quantity, int64_t limitTicks, uint64_t &linkedOrderId)
+{
+    // Levels are ordered best first, so the incoming order crosses while the
+    // best level is at or better than its limit
+    while (quantity >= QUANTITY_EPSILON && !levels.empty())
+    {
+        auto levelIt = levels.begin();
+        if (levels.key_comp()(limitTicks, levelIt->first))
+            break;
+
+        // Oldest order at the best level trades first, at its resting price
+        uint32_t slot = levelIt->second.head;
+        Resting &resting = pool[slot];
+        double price = ticksToPrice(levelIt->first);
+
+        if (resting.account == account)
+        {
+            // Self-trade prevention: the older resting order is canceled
+            Resting canceled = resting;
+            unlink(slot);
+            forgetSibling(account, canceled.linkedOrderId);
+            sink(BookEvent{BookEvent::Canceled, symbolId, account, canceled.orderId, 0, canceled.side,
+                           canceled.remaining, ticksToPrice(canceled.priceTicks), 0.0, account});
+            continue;
+        }
+
+        double traded = std::min(quantity, resting.remaining);
+        AccountId restingAccount = resting.account;
+        fill(slot, traded, price, account);
+        if (pool[slot].remaining == 0.0)
+            unlink(slot);
+
+        quantity -= traded;
+        if (quantity < QUANTITY_EPSILON)
+            quantity = 0.0;
+        sink(BookEvent{BookEvent::Fill, symbolId, account, orderId, 0, side, traded, price, quantity, restingAccount});
+        if (linkedOrderId != 0)
+        {
+            uint64_t siblingId = linkedOrderId;
+            linkedOrderId = 0;
+            cancelSibling(account, siblingId, orderId);
+        }
+    }
+}
+
+template <typename Levels>
+void OrderBook::sweepAgainstReference(Levels &levels, int64_t referenceTicks, double price)
+{
+    // Bids at or above the reference and asks at or below it cross; the
+    // liquidity provider takes them whole, oldest first, at the reference price
+    while (!levels.empty())
+    {
+        auto levelIt = levels.begin();
+        if (levels.key_comp()(referenceTicks, levelIt->first))
+            break;
+
+        uint32_t slot = levelIt->second.head;
+        fill(slot, pool[slot].remaining, price, LIQUIDITY_PROVIDER);
+        unlink(slot);
+    }
+}
+
+void OrderBook::rest(AccountId account, uint64_t orderId, Side side, double quantity, int64_t priceTicks, uint64_t linkedOrderId)
+{
+    uint32_t slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(pool.size());
+        pool.emplace_back();
+    }
+
+    Level &level = (side == Side::Buy) ? bids[priceTicks] : asks[priceTicks];
+    pool[slot] = Resting{account, orderId, side, priceTicks, quantity, level.tail, NIL, linkedOrderId};
+    if (level.tail != NIL)
+        pool[level.tail].next = slot;
+    else
+        level.head = slot;
+    level.tail = slot;
+
+    index[key(account, orderId)] = slot;
+}
+
+void OrderBook::unlink(uint32_t slot)
+{
+    Resting &order = pool[slot];
+    if (order.side == Side::Buy)
+    {
+        auto levelIt = bids.find(order.priceTicks);
+        Level &level = levelIt->second;
+        if (order.prev != NIL)
+            pool[order.prev].next = order.next;
+        else
+            level.head = order.next;
+        if (order.next != NIL)
+            pool[order.next].prev = order.prev;
+        else
+            level.tail = order.prev;
+        if (level.head == NIL)
+            bids.erase(levelIt);
+    }
+    else
+    {
+        auto levelIt = asks.find(order.priceTicks);
+        Level &level = levelIt->second;
+        if (order.prev != NIL)
+            pool[order.prev].next = order.next;
+        else
+            level.head = order.next;
+        if (order.next != NIL)
+            pool[order.next].prev = order.prev;
+        else
+            level.tail = order.prev;
+        if (level.head == NIL)
+            asks.erase(levelIt);
+    }
+
+    index.erase(key(order.account, order.orderId));
+    freeSlots.push_back(slot);
+}
+
+void OrderBook::add(const BookCommand &command)
+{
+    // An OCO leg whose sibling traded before it arrived never enters the book
+    if (command.linkedOrderId != 0 && canceledBeforeArrival.erase(key(command.account, command.orderId)))
+    {
+        sink(BookEvent{BookEvent::OcoCanceled, symbolId, command.account, command.orderId, 0, command.side,
+                       command.quantity, command.price, 0.0, command.account});
+        return;
+    }
+
+    if (command.orderType == BookOrderType::Limit)
+        addLimit(command.account, command.orderId, command.side, command.quantity, command.price, command.linkedOrderId);
+    else
+        armStop(command);
+}
+
+void OrderBook::addLimit(AccountId account, uint64_t orderId, Side side, double quantity, double price, uint64_t linkedOrderId)
+{
+    int64_t limitTicks = priceToTicks(price);
+
+    if (side == Side::Buy)
+        matchAgainst(asks, account, orderId, side, quantity, limitTicks, linkedOrderId);
+    else
+        matchAgainst(bids, account, orderId, side, quantity, limitTicks, linkedOrderId);
+
+    if (quantity >= QUANTITY_EPSILON)
+        rest(account, orderId, side, quantity, limitTicks, linkedOrderId);
+}
+
+void OrderBook::armStop(const BookCommand &command)
+{
+    uint32_t slot;
+    if (!freeStops.empty())
+    {
+        slot = freeStops.back();
+        freeStops.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(stops.size());
+        stops.emplace_back();
+    }
+    stops[slot] = Stop{command.account, command.orderId, command.side, command.orderType, command.quantity,
+                       command.price, command.linkedOrderId, true};
+    stopIndex[key(command.account, command.orderId)] = slot;
+
+    TriggerIndex::Direction direction = (command.side == Side::Buy) ? TriggerIndex::FiresOnRise : TriggerIndex::FiresOnFall;
+    if (command.orderType == BookOrderType::TrailingStop)
+    {
+        triggers.armTrailing(slot, direction, std::max<int64_t>(1, priceToTicks(command.trailAmount)));
+        if (triggers.hasPrice())
+            reportStopMoved(slot); // Otherwise reported once the first price arms it
+        return;
+    }
+
+    // A stop the last reference price has already reached fires straight away
+    int64_t stopTicks = priceToTicks(command.stopPrice);
+    if (triggers.hasPrice())
+    {
+        int64_t lastTicks = triggers.lastPrice();
+        if ((command.side == Side::Buy && lastTicks >= stopTicks) || (command.side == Side::Sell && lastTicks <= stopTicks))
+        {
+            triggerStop(slot, ticksToPrice(lastTicks));
+            return;
+        }
+    }
+    triggers.arm(slot, direction, stopTicks);
+}
+
+void OrderBook::reportStopMoved(uint32_t stopSlot)
+{
+    const Stop &stop = stops[stopSlot];
+    sink(BookEvent{BookEvent::StopMoved, symbolId, stop.account, stop.orderId, 0, stop.side, stop.quantity,
+                   ticksToPrice(triggers.trigger(stopSlot)), stop.quantity, LIQUIDITY_PROVIDER});
+}
+
+void OrderBook::releaseStop(uint32_t stopSlot)
+{
+    Stop &stop = stops[stopSlot];
+    stop.live = false;
+    triggers.disarm(stopSlot); // No-op if it just fired
+    stopIndex.erase(key(stop.account, stop.orderId));
+    freeStops.push_back(stopSlot);
+}
+
+void OrderBook::triggerStop(uint32_t stopSlot, double price)
+{
+    if (!stops[stopSlot].live)
+        return; // Canceled as an OCO sibling earlier on this tick
+    Stop stop = stops[stopSlot];
+    releaseStop(stopSlot);
+
+    sink(BookEvent{BookEvent::Triggered, symbolId, stop.account, stop.orderId, 0, stop.side, stop.quantity, price,
+                   stop.quantity, LIQUIDITY_PROVIDER});
+    if (stop.linkedOrderId != 0)
+        cancelSibling(stop.account, stop.linkedOrderId, stop.orderId);
+
+    if (stop.type == BookOrderType::StopLimit)
+    {
+        addLimit(stop.account, stop.orderId, stop.side, stop.quantity, stop.limitPrice, 0);
+    }
+    else
+    {
+        // Stop-market and trailing stops trade with the liquidity provider at the reference price
+        sink(BookEvent{BookEvent::Fill, symbolId, stop.account, stop.orderId, 0, stop.side, stop.quantity, price,
+                       0.0, LIQUIDITY_PROVIDER});
+    }
+}
+
+void OrderBook::forgetSibling(AccountId account, uint64_t siblingId)
+{
+    // The sibling of a canceled OCO leg stands alone from now on
+    if (siblingId == 0)
+        return;
+    uint64_t siblingKey = key(account, siblingId);
+    auto it = index.find(siblingKey);
+    if (it != index.end())
+        pool[it->second].linkedOrderId = 0;
+    auto stopIt = stopIndex.find(siblingKey);
+    if (stopIt != stopIndex.end())
+        stops[stopIt->second].linkedOrderId = 0;
+    canceledBeforeArrival.erase(siblingKey);
+}
+
+void OrderBook::cancelSibling(AccountId account, uint64_t siblingId, uint64_t orderId)
+{
+    uint64_t siblingKey = key(account, siblingId);
+
+    auto it = index.find(siblingKey);
+    if (it != index.end())
+    {
+        Resting sibling = pool[it->second];
+        unlink(it->second);
+        sink(BookEvent{BookEvent::OcoCanceled, symbolId, account, siblingId, 0, sibling.side, sibling.remaining,
+                       ticksToPrice(sibling.priceTicks), 0.0, account});
+        return;
+    }
+
+    auto stopIt = stopIndex.find(siblingKey);
+    if (stopIt != stopIndex.end())
+    {
+        Stop sibling = stops[stopIt->second];
+        releaseStop(stopIt->second);
+        sink(BookEvent{BookEvent::OcoCanceled, symbolId, account, siblingId, 0, sibling.side, sibling.quantity,
+                       sibling.limitPrice, 0.0, account});
+        return;
+    }
+
+    // Legs are submitted in ID order, so a missing later leg is still on its way
+    if (siblingId > orderId)
+        canceledBeforeArrival.insert(siblingKey);
+}
+
+void OrderBook::cancel(AccountId account, uint64_t orderId, uint64_t requestId)
+{
+    auto it = index.find(key(account, orderId));
+    if (it == index.end())
+    {
+        auto stopIt = stopIndex.find(key(account, orderId));
+        if (stopIt != stopIndex.end())
+        {
+            Stop stop = stops[stopIt->second];
+            releaseStop(stopIt->second);
+            forgetSibling(account, stop.linkedOrderId);
+            sink(BookEvent{BookEvent::Canceled, symbolId, account, orderId, requestId, stop.side, stop.quantity,
+                           stop.limitPrice, 0.0, account});
+            return;
+        }
+        sink(BookEvent{BookEvent::CancelRejected, symbolId, account, orderId, requestId, Side::Buy, 0.0, 0.0, 0.0, account});
+        return;
+    }
+
+    uint32_t slot = it->second;
+    Resting order = pool[slot];
+    unlink(slot);
+    forgetSibling(account, order.linkedOrderId);
+    sink(BookEvent{BookEvent::Canceled, symbolId, account, orderId, requestId, order.side, order.remaining,
+                   ticksToPrice(order.priceTicks), 0.0, account});
+}
+
+void OrderBook::amend(AccountId account, uint64_t orderId, uint64_t requestId, double quantity, double price)
+{
+    auto it = index.find(key(account, orderId));
+    if (it == index.end())
+    {
+        sink(BookEvent{BookEvent::AmendRejected, symbolId, account, orderId, requestId, Side::Buy, 0.0, price, 0.0, account});
+        return;
+    }
+
+    uint32_t slot = it->second;
+    Resting &order = pool[slot];
+    int64_t newTicks = priceToTicks(price);
+    Side side = order.side;
+
+    if (newTicks == order.priceTicks && quantity <= order.remaining)
+    {
+        // Shrinking in place keeps the order's queue position
+        order.remaining = quantity;
+        sink(BookEvent{BookEvent::Amended, symbolId, account, orderId, requestId, side, quantity, price, quantity, account});
+        return;
+    }
+
+    // Any other change loses time priority: re-enter as a new order
+    uint64_t linkedOrderId = order.linkedOrderId;
+    unlink(slot);
+    sink(BookEvent{BookEvent::Amended, symbolId, account, orderId, requestId, side, quantity, price, quantity, account});
+    addLimit(account, orderId, side, quantity, price, linkedOrderId);
+}
+
+void OrderBook::onReferencePrice(double price)
+{
+    int64_t referenceTicks = priceToTicks(price);
+
+    // Stops first, so stop-limit orders they release can trade on this price too
+    fired.clear();
+    moved.clear();
+    triggers.onPrice(referenceTicks, fired, &moved);
+    for (TriggerIndex::Handle stopSlot : moved)
+    {
+        reportStopMoved(stopSlot);
+    }
+    for (TriggerIndex::Handle stopSlot : fired)
+    {
+        triggerStop(stopSlot, price);
+    }
+
+    // Bids at or above the reference price and asks at or below it cross the synthetic market
+    sweepAgainstReference(bids, referenceTicks, price);
+    sweepAgainstReference(asks, referenceTicks, price);
+}
+
+void MatchingEngine::start(unsigned shardCount)
+{
+    if (running.load(std::memory_order_acquire))
+        return;
+
+    // A shard per hardware thread, but no idle shards when there are fewer symbols
+    if (shardCount == 0)
+    {
+        size_t symbols = std::max<size_t>(1, symbolCount());
+        shardCount = static_cast<unsigned>(std::min<size_t>(symbols, std::max(1u, std::thread::hardware_concurrency())));
+    }
+
+    shards.clear();
+    for (unsigned i = 0; i < shardCount; ++i)
+        shards.push_back(std::make_unique<Shard>(65536, i));
+
+    running.store(true, std::memory_order_release);
+    for (auto &shard : shards)
+        shard->worker = std::thread(&MatchingEngine::runShard, this, std::ref(*shard));
+}
+
+void MatchingEngine::stop()
+{
+    if (!running.exchange(false))
+        return;
+    for (auto &shard : shards)
+    {
+        shard->wakeup.wakeAlways();
+        if (shard->worker.joinable())
+            shard->worker.join();
+    }
+}
+
+AccountId MatchingEngine::registerAccount(AccountListener listener)
+{
+    std::unique_lock<std::shared_mutex> accountsLock(accountsMutex);
+    if (accounts.empty())
+        accounts.emplace_back(); // Slot 0 is the liquidity provider
+    accounts.push_back(std::move(listener));
+    return static_cast<AccountId>(accounts.size() - 1);
+}
+
+void MatchingEngine::unregisterAccount(AccountId account)
+{
+    std::unique_lock<std::shared_mutex> accountsLock(accountsMutex);
+    if (account < accounts.size())
+        accounts[account] = nullptr;
+}
+
+void MatchingEngine::deliver(const BookEvent &event)
+{
+    // Shard threads deliver concurrently; the shared lock only excludes (un)registration
+    std::shared_lock<std::shared_mutex> accountsLock(accountsMutex);
+    if (event.account < accounts.size() && accounts[event.account])
+        accounts[event.account](event);
+}
+
+bool MatchingEngine::trySubmit(const BookCommand &command)
+{
+    if (!running.load(std::memory_order_acquire) || shards.empty())
+        return false;
+
+    Shard &shard = *shards[command.symbolId % shards.size()];
+    if (!shard.commands.tryPush(command))
+        return false;
+    shard.wakeup.notify();
+    return true;
+}
+
+bool MatchingEngine::submit(const BookCommand &command)
+{
+    while (!trySubmit(command))
+    {
+        if (!running.load(std::memory_order_acquire))
+            return false;
+        std::this_thread::yield(); // Shard queue full: back-pressure the producer
+    }
+    return true;
+}
+
+OrderBook &MatchingEngine::bookFor(Shard &shard, SymbolId symbolId)
+{
+    auto it = shard.books.find(symbolId);
+    if (it == shard.books.end())
+    {
+        it = shard.books.emplace(symbolId, std::make_unique<OrderBook>(symbolId, [this](const BookEvent &event)
+                                                                       { deliver(event); }))
+                 .first;
+    }
+    return *it->second;
+}
+
+void MatchingEngine::runShard(Shard &shard)
+{
+    BookCommand command;
+    for (;;)
+    {
+        bool didWork = false;
+        while (shard.commands.tryPop(command))
+        {
+            OrderBook &book = bookFor(shard, command.symbolId);
+            switch (command.kind)
+            {
+            case BookCommand::Add:
+                book.add(command);
+                break;
+            case BookCommand::Cancel:
+                book.cancel(command.account, command.orderId, command.requestId);
+                break;
+            case BookCommand::Amend:
+                book.amend(command.account, command.orderId, command.requestId, command.quantity, command.price);
+                break;
+            case BookCommand::ReferencePrice:
+                book.onReferencePrice(command.price);
+                break;
+            }
+            didWork = true;
+        }
+
+        // Ticks of every symbol are on the bus; this shard applies those of its own books
+        size_t shardCount = shards.size();
+        if (shard.prices.poll([&](const MarketEvent &event)
+                              {
+                                  if (event.type == MarketEvent::Tick && event.symbolId % shardCount == shard.index)
+                                      bookFor(shard, event.symbolId).onReferencePrice(event.price); }) != 0)
+            didWork = true;
+
+        if (!running.load(std::memory_order_acquire))
+        {
+            if (shard.commands.size() == 0)
+                break;
+            continue;
+        }
+        if (didWork)
+            continue;
+
+        shard.wakeup.waitUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&]
+                               { return shard.commands.size() != 0 || shard.prices.pending() || !running.load(std::memory_order_acquire); });
+    }
+}
@@ -0,0 +1,107 @@
+// src/order_store.cpp
+
+#include "order_store.h"
+
+uint32_t OrderStore::acquireSlot(const Order &order)
+{
+    uint32_t slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        slots[slot].order = order;
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back({order, NIL, NIL});
+    }
+
+    // Link at the back of the time priority list
+    slots[slot].prev = tail;
+    slots[slot].next = NIL;
+    if (tail != NIL)
+        slots[tail].next = slot;
+    else
+        head = slot;
+    tail = slot;
+
+    index[order.id] = slot;
+    return slot;
+}
+
+void OrderStore::releaseSlot(uint32_t slot)
+{
+    Slot &s = slots[slot];
+    if (s.prev != NIL)
+        slots[s.prev].next = s.next;
+    else
+        head = s.next;
+    if (s.next != NIL)
+        slots[s.next].prev = s.prev;
+    else
+        tail = s.prev;
+
+    s.order.symbol.clear();
+    s.order.type.clear();
+    freeSlots.push_back(slot);
+}
+
+uint64_t OrderStore::add(Order order)
+{
+    order.id = nextId++;
+    acquireSlot(order);
+    return order.id;
+}
+
+void OrderStore::restore(const Order &order)
+{
+    if (index.count(order.id))
+        return; // Duplicate ID, keep the first one
+    acquireSlot(order);
+    if (order.id >= nextId)
+        nextId = order.id + 1;
+}
+
+bool OrderStore::cancel(uint64_t id)
+{
+    auto it = index.find(id);
+    if (it == index.end())
+        return false;
+
+    releaseSlot(it->second);
+    index.erase(it);
+    return true;
+}
+
+bool OrderStore::amend(uint64_t id, double amount, double limitPrice)
+{
+    Order *order = find(id);
+    if (order == nullptr)
+        return false;
+
+    order->amount = amount;
+    order->limitPrice = limitPrice;
+    return true;
+}
+
+Order *OrderStore::find(uint64_t id)
+{
+    auto it = index.find(id);
+    return it == index.end() ? nullptr : &slots[it->second].order;
+}
+
+const Order *OrderStore::find(uint64_t id) const
+{
+    auto it = index.find(id);
+    return it == index.end() ? nullptr : &slots[it->second].order;
+}
+
+void OrderStore::clear()
+{
+    slots.clear();
+    freeSlots.clear();
+    index.clear();
+    head = NIL;
+    tail = NIL;
+}
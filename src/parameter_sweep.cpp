@@ -0,0 +1,75 @@
+// src/parameter_sweep.cpp
+
+#include "utils.h"
+#include "parameter_sweep.h"
+
+std::vector<SweepRow> runParameterSweep(const std::vector<SweepSymbol> &symbols, const SweepGrid &grid,
+                                        const BacktestConfig &config, WorkStealingPool &pool, TaskPriority priority)
+{
+    std::vector<SweepRow> rows;
+    for (int period : grid.smaPeriods)
+    {
+        SweepRow row;
+        row.strategyName = "sma_cross";
+        row.params.period = period;
+        rows.push_back(row);
+    }
+    for (int period : grid.rsiPeriods)
+    {
+        for (const auto &bands : grid.rsiBands)
+        {
+            SweepRow row;
+            row.strategyName = "rsi";
+            row.params.period = period;
+            row.params.lowerBand = bands.first;
+            row.params.upperBand = bands.second;
+            rows.push_back(row);
+        }
+    }
+
+    // Each task writes only its own cell, so no locking is needed
+    BacktestConfig taskConfig = config;
+    taskConfig.recordTrades = false;
+    taskConfig.equityStride = 0;
+    std::vector<BacktestResult> results(rows.size() * symbols.size());
+    TaskGroup sweep;
+    for (size_t r = 0; r < rows.size(); ++r)
+    {
+        for (size_t s = 0; s < symbols.size(); ++s)
+        {
+            pool.submit(sweep, [&, r, s]
+                        {
+                            std::unique_ptr<Strategy> strategy = makeStrategy(rows[r].strategyName, rows[r].params);
+                            Backtest backtest(taskConfig);
+                            const CandleHistory &history = symbols[s].history;
+                            results[r * symbols.size() + s] = backtest.run(history.data(), history.size(), *strategy); }, priority);
+        }
+    }
+    pool.wait(sweep);
+
+    for (size_t r = 0; r < rows.size(); ++r)
+    {
+        SweepRow &row = rows[r];
+        row.strategy = makeStrategy(row.strategyName, row.params)->name();
+        for (size_t s = 0; s < symbols.size(); ++s)
+        {
+            const BacktestResult &result = results[r * symbols.size() + s];
+            ++row.symbols;
+            if (result.totalReturn > 0.0)
+                ++row.profitableSymbols;
+            row.meanReturn += result.totalReturn;
+            row.meanSharpe += result.sharpe;
+            row.worstDrawdown = std::max(row.worstDrawdown, result.maxDrawdown);
+            row.fills += result.fills;
+        }
+        if (row.symbols > 0)
+        {
+            row.meanReturn /= row.symbols;
+            row.meanSharpe /= row.symbols;
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const SweepRow &a, const SweepRow &b)
+              { return a.meanReturn > b.meanReturn; });
+    return rows;
+}
@@ -0,0 +1,239 @@
+// src/png_writer.cpp
+
+#include "utils.h"
+#include "png_writer.h"
+#include <cstring>
+
+namespace
+{
+    // Longest match deflate can encode
+    const size_t MAX_MATCH = 258;
+    const size_t MIN_MATCH = 3;
+
+    const int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115,
+                                 131, 163, 195, 227, 258};
+    const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    const int DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537,
+                                   2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    const int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    // Deflate packs bits least significant first
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::string &out) : out(out) {}
+
+        void put(uint32_t value, int count)
+        {
+            bits |= value << used;
+            used += count;
+            while (used >= 8)
+            {
+                out += static_cast<char>(bits & 0xFF);
+                bits >>= 8;
+                used -= 8;
+            }
+        }
+
+        // Huffman codes go most significant bit first
+        void putCode(uint32_t code, int count)
+        {
+            uint32_t reversed = 0;
+            for (int i = 0; i < count; ++i)
+                reversed |= ((code >> i) & 1u) << (count - 1 - i);
+            put(reversed, count);
+        }
+
+        void flush()
+        {
+            if (used > 0)
+                out += static_cast<char>(bits & 0xFF);
+            bits = 0;
+            used = 0;
+        }
+
+    private:
+        std::string &out;
+        uint32_t bits = 0;
+        int used = 0;
+    };
+
+    // Fixed Huffman code of a literal/length symbol (RFC 1951, 3.2.6)
+    void putSymbol(BitWriter &writer, int symbol)
+    {
+        if (symbol < 144)
+            writer.putCode(0x30 + symbol, 8);
+        else if (symbol < 256)
+            writer.putCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            writer.putCode(symbol - 256, 7);
+        else
+            writer.putCode(0xC0 + symbol - 280, 8);
+    }
+
+    void putMatch(BitWriter &writer, size_t length, size_t distance)
+    {
+        int code = 28;
+        while (LENGTH_BASE[code] > static_cast<int>(length))
+            --code;
+        putSymbol(writer, 257 + code);
+        writer.put(static_cast<uint32_t>(length - LENGTH_BASE[code]), LENGTH_EXTRA[code]);
+
+        code = 29;
+        while (DISTANCE_BASE[code] > static_cast<int>(distance))
+            --code;
+        writer.putCode(code, 5);
+        writer.put(static_cast<uint32_t>(distance - DISTANCE_BASE[code]), DISTANCE_EXTRA[code]);
+    }
+
+    // Bytes from `at` that repeat the ones `distance` earlier, compared 8 at a time
+    size_t matchLength(const std::string &data, size_t at, size_t distance)
+    {
+        size_t limit = std::min(MAX_MATCH, data.size() - at);
+        const char *current = data.data() + at;
+        const char *earlier = current - distance;
+        size_t length = 0;
+        if (distance >= sizeof(uint64_t))
+        {
+            for (; length + sizeof(uint64_t) <= limit; length += sizeof(uint64_t))
+            {
+                uint64_t a;
+                uint64_t b;
+                std::memcpy(&a, current + length, sizeof(a));
+                std::memcpy(&b, earlier + length, sizeof(b));
+                if (a != b)
+                    break;
+            }
+        }
+        else if (distance == 1)
+        {
+            // A run of the previous byte
+            uint64_t repeated = 0x0101010101010101ull * static_cast<uint8_t>(earlier[0]);
+            for (; length + sizeof(uint64_t) <= limit; length += sizeof(uint64_t))
+            {
+                uint64_t a;
+                std::memcpy(&a, current + length, sizeof(a));
+                if (a != repeated)
+                    break;
+            }
+        }
+        while (length < limit && current[length] == earlier[length])
+            ++length;
+        return length;
+    }
+
+    // zlib stream of data in one fixed-Huffman deflate block
+    void appendZlib(const std::string &data, size_t stride, std::string &out)
+    {
+        out += static_cast<char>(0x78); // Deflate, 32K window
+        out += static_cast<char>(0x01); // Fastest, no dictionary
+        BitWriter writer(out);
+        writer.put(1, 1); // Final block
+        writer.put(1, 2); // Fixed Huffman codes
+
+        size_t i = 0;
+        while (i < data.size())
+        {
+            size_t above = (i >= stride) ? matchLength(data, i, stride) : 0;
+            size_t run = (i >= 1 && above < MAX_MATCH) ? matchLength(data, i, 1) : 0;
+            size_t length = std::max(run, above);
+            if (length >= MIN_MATCH)
+            {
+                putMatch(writer, length, (above >= run) ? stride : 1);
+                i += length;
+            }
+            else
+            {
+                putSymbol(writer, static_cast<uint8_t>(data[i]));
+                ++i;
+            }
+        }
+        putSymbol(writer, 256); // End of block
+        writer.flush();
+
+        // Adler-32, reduced once per 5552 bytes: the most that cannot overflow 32 bits
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (size_t start = 0; start < data.size(); start += 5552)
+        {
+            size_t end = std::min(data.size(), start + 5552);
+            for (size_t i = start; i < end; ++i)
+            {
+                a += static_cast<uint8_t>(data[i]);
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        uint32_t adler = (b << 16) | a;
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out += static_cast<char>((adler >> shift) & 0xFF);
+    }
+
+    uint32_t crc32(const char *data, size_t size)
+    {
+        static const std::array<uint32_t, 256> table = []
+        {
+            std::array<uint32_t, 256> entries{};
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+            return entries;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void appendBigEndian(std::string &out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out += static_cast<char>((value >> shift) & 0xFF);
+    }
+
+    void appendChunk(std::string &png, const char *type, const std::string &data)
+    {
+        appendBigEndian(png, static_cast<uint32_t>(data.size()));
+        size_t start = png.size();
+        png.append(type, 4);
+        png += data;
+        appendBigEndian(png, crc32(png.data() + start, png.size() - start));
+    }
+}
+
+void appendPng(const uint8_t *pixels, int width, int height, const std::vector<PaletteColour> &palette, std::string &png)
+{
+    png.append("\x89PNG\r\n\x1a\n", 8);
+
+    std::string header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    header += static_cast<char>(8); // Bits per index
+    header += static_cast<char>(3); // Palette colour
+    header.append(3, '\0');         // Deflate, adaptive filtering, no interlace
+    appendChunk(png, "IHDR", header);
+
+    std::string colours;
+    for (const PaletteColour &colour : palette)
+        colours.append(reinterpret_cast<const char *>(colour.data()), colour.size());
+    appendChunk(png, "PLTE", colours);
+
+    // Every row is stored unfiltered; the deflate matches do the work a filter would
+    size_t stride = static_cast<size_t>(width) + 1;
+    std::string rows;
+    rows.reserve(stride * height);
+    for (int y = 0; y < height; ++y)
+    {
+        rows += '\0';
+        rows.append(reinterpret_cast<const char *>(pixels) + static_cast<size_t>(y) * width, width);
+    }
+    std::string compressed;
+    appendZlib(rows, stride, compressed);
+    appendChunk(png, "IDAT", compressed);
+    appendChunk(png, "IEND", std::string());
+}
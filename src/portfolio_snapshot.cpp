@@ -0,0 +1,27 @@
+// src/portfolio_snapshot.cpp
+
+#include "utils.h"
+#include "portfolio_snapshot.h"
+
+void capturePortfolio(const User &user, double reservedCash, double lastOrderPrice, PortfolioSnapshot &snapshot)
+{
+    snapshot.username = user.username;
+
+    // Element-wise assignment keeps the strings' storage from the last capture
+    snapshot.holdings.resize(user.holdings.size());
+    size_t i = 0;
+    for (const Holding &holding : user.holdings)
+        snapshot.holdings[i++] = holding;
+
+    snapshot.pendingOrders.resize(user.pendingOrders.size());
+    i = 0;
+    for (const Order &order : user.pendingOrders)
+        snapshot.pendingOrders[i++] = order;
+
+    snapshot.totalInvestment = user.holdings.totalInvestment();
+    snapshot.currentValue = user.holdings.currentValue();
+    snapshot.realizedPnL = user.holdings.realizedPnL();
+    snapshot.demoMoney = user.demoMoney;
+    snapshot.reservedCash = reservedCash;
+    snapshot.lastOrderPrice = lastOrderPrice;
+}
@@ -0,0 +1,60 @@
+// src/scan_mode.cpp
+
+#include "utils.h"
+#include "scan_mode.h"
+#include "data_persistence.h"
+
+bool parseScanOptions(int argc, char *argv[], ScanOptions &options)
+{
+    bool scan = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--scan")
+                scan = true;
+            else if (arg == "--conditions" && hasValue)
+            {
+                if (!parseScreenConditions(argv[++i], options.criteria.conditions))
+                    return false;
+            }
+            else if (arg == "--rsi-below" && hasValue)
+                options.criteria.rsiBelow = std::stod(argv[++i]);
+            else if (arg == "--rsi-above" && hasValue)
+                options.criteria.rsiAbove = std::stod(argv[++i]);
+            else if (arg == "--threads" && hasValue)
+                options.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if (arg == "--top" && hasValue)
+                options.top = std::stoul(argv[++i]);
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    return scan && options.criteria.rsiBelow < options.criteria.rsiAbove;
+}
+
+int runScanMode(const ScanOptions &options)
+{
+    loadStockData(closePricesMap, candlesMap);
+
+    // --threads gives the run its own pool; otherwise it shares the process's
+    std::unique_ptr<WorkStealingPool> ownPool;
+    if (options.threads != 0)
+        ownPool = std::make_unique<WorkStealingPool>(options.threads);
+    WorkStealingPool &pool = ownPool ? *ownPool : sharedPool();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ScreenHit> hits = scanSymbols(candlesMap, indicatorsMap, options.criteria, pool);
+    size_t symbols = indicatorsMap.size();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Scanned " << symbols << " symbols on " << pool.size() << " threads in " << std::fixed << std::setprecision(3)
+              << elapsed * 1000.0 << " ms: " << hits.size() << " match\n\n";
+    printScanTable(hits, options.criteria, options.top);
+    return 0;
+}
@@ -0,0 +1,144 @@
+// src/screen_buffer.cpp
+
+#include "utils.h"
+#include "screen_buffer.h"
+#include <cerrno>
+
+namespace
+{
+    // Equal cells between two changes that are rewritten rather than skipped:
+    // a cursor move costs about this many bytes
+    const int MERGE_GAP = 8;
+
+    std::atomic<unsigned> screenClears(0);
+}
+
+void ScreenBuffer::setArea(const TerminalArea &area)
+{
+    if (area == current)
+        return;
+    current = area;
+    back.assign(static_cast<size_t>(std::max(0, area.width)) * std::max(0, area.height), ' ');
+    redrawAll = true;
+}
+
+void ScreenBuffer::clear()
+{
+    std::fill(back.begin(), back.end(), ' ');
+}
+
+void ScreenBuffer::print(int column, int row, const std::string &text)
+{
+    if (row < 0 || row >= current.height || column < 0 || column >= current.width)
+        return;
+    size_t length = std::min(text.size(), static_cast<size_t>(current.width - column));
+    std::copy(text.begin(), text.begin() + length, back.begin() + static_cast<size_t>(row) * current.width + column);
+}
+
+void ScreenBuffer::present(std::string &out)
+{
+    unsigned clears = screenClears.load();
+    if (clears != shownClears)
+    {
+        redrawAll = true;
+        shownClears = clears;
+    }
+
+    size_t start = out.size();
+    out += "\033[s"; // Save cursor position
+    if (redrawAll)
+    {
+        // Rows of the old area outside the new one
+        for (int y = shown.row; y < shown.row + shown.height; ++y)
+        {
+            if (y >= current.row && y < current.row + current.height)
+                continue;
+            appendMoveCursor(out, shown.column, y);
+            out += CLEARLINE;
+        }
+        front.assign(back.size(), '\0'); // Matches no cell, so every row is written
+        shown = current;
+    }
+    size_t unchanged = out.size();
+    for (int y = 0; y < current.height; ++y)
+        presentRow(y, out);
+
+    if (out.size() == unchanged && !redrawAll)
+    {
+        out.resize(start); // Nothing to show
+        return;
+    }
+    out += "\033[u"; // Restore cursor position
+    front = back;
+    redrawAll = false;
+}
+
+void ScreenBuffer::presentRow(int row, std::string &out)
+{
+    const int width = current.width;
+    const char *next = back.data() + static_cast<size_t>(row) * width;
+    const char *previous = front.data() + static_cast<size_t>(row) * width;
+
+    // Past the last non-blank cell the row is cleared in one escape instead
+    int textEnd = width;
+    while (textEnd > 0 && next[textEnd - 1] == ' ')
+        --textEnd;
+
+    int x = 0;
+    while (x < width)
+    {
+        if (next[x] == previous[x])
+        {
+            ++x;
+            continue;
+        }
+
+        // A changed span, running on over short gaps of equal cells
+        int end = x + 1;
+        for (int i = x + 1; i < width && i - end < MERGE_GAP; ++i)
+        {
+            if (next[i] != previous[i])
+                end = i + 1;
+        }
+
+        appendMoveCursor(out, current.column + x, current.row + row);
+        if (end > textEnd)
+        {
+            out.append(next + x, next + std::max(x, textEnd));
+            out += CLEARLINE;
+            return;
+        }
+        out.append(next + x, next + end);
+        x = end;
+    }
+}
+
+void clearScreen()
+{
+    std::cout << CLEAR_SCREEN;
+    ++screenClears;
+}
+
+void writeTerminal(const std::string &buffer)
+{
+    std::cout.flush(); // Anything already queued goes first
+#ifdef _WIN32
+    fwrite(buffer.data(), 1, buffer.size(), stdout);
+    fflush(stdout);
+#else
+    const char *data = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0)
+    {
+        ssize_t written = write(STDOUT_FILENO, data, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return; // Nowhere to report it; the next frame tries again
+        }
+        data += written;
+        left -= static_cast<size_t>(written);
+    }
+#endif
+}
@@ -0,0 +1,220 @@
+// src/screener.cpp
+
+#include "utils.h"
+#include "screener.h"
+#include "market_data.h"
+#include <bitset>
+
+namespace
+{
+    // Symbols per pool task: enough work to outweigh scheduling a task
+    const size_t SCAN_BATCH = 64;
+
+    struct ConditionName
+    {
+        ScreenCondition condition;
+        const char *option; // For --conditions
+    };
+
+    const ConditionName CONDITION_NAMES[] = {
+        {SCREEN_RSI_OVERSOLD, "oversold"},
+        {SCREEN_RSI_OVERBOUGHT, "overbought"},
+        {SCREEN_SMA_CROSS_UP, "cross_up"},
+        {SCREEN_SMA_CROSS_DOWN, "cross_down"},
+        {SCREEN_BOLLINGER_BREAKOUT, "breakout"},
+        {SCREEN_BOLLINGER_BREAKDOWN, "breakdown"},
+    };
+
+    // One symbol's work: its candles, its indicators, and where its result goes
+    struct ScanItem
+    {
+        const std::string *symbol;
+        const std::vector<Candle> *candles;
+        SymbolIndicators *indicators;
+        SymbolMarket *market;
+        unsigned matched = 0;
+        double score = 0.0;
+    };
+}
+
+unsigned evaluateScreen(const IndicatorSnapshot &snapshot, const ScreenCriteria &criteria, double &score)
+{
+    unsigned matched = 0;
+    score = 0.0;
+
+    // RSI stays at its neutral 50 until it has enough candles, so it cannot trigger early
+    if ((criteria.conditions & SCREEN_RSI_OVERSOLD) && snapshot.rsi < criteria.rsiBelow)
+    {
+        matched |= SCREEN_RSI_OVERSOLD;
+        score += criteria.rsiBelow - snapshot.rsi;
+    }
+    if ((criteria.conditions & SCREEN_RSI_OVERBOUGHT) && snapshot.rsi > criteria.rsiAbove)
+    {
+        matched |= SCREEN_RSI_OVERBOUGHT;
+        score += snapshot.rsi - criteria.rsiAbove;
+    }
+
+    // A cross needs the average on both the last candle and the one before
+    if (snapshot.movingAverage > 0.0 && snapshot.previousMovingAverage > 0.0)
+    {
+        bool wasAbove = snapshot.previousClose > snapshot.previousMovingAverage;
+        bool isAbove = snapshot.close > snapshot.movingAverage;
+        double distance = std::fabs(snapshot.close / snapshot.movingAverage - 1.0) * 100.0;
+        if ((criteria.conditions & SCREEN_SMA_CROSS_UP) && isAbove && !wasAbove)
+        {
+            matched |= SCREEN_SMA_CROSS_UP;
+            score += distance;
+        }
+        if ((criteria.conditions & SCREEN_SMA_CROSS_DOWN) && !isAbove && wasAbove)
+        {
+            matched |= SCREEN_SMA_CROSS_DOWN;
+            score += distance;
+        }
+    }
+
+    // Bands are 0 until their window has filled
+    if (snapshot.bollingerUpper > 0.0)
+    {
+        if ((criteria.conditions & SCREEN_BOLLINGER_BREAKOUT) && snapshot.close > snapshot.bollingerUpper)
+        {
+            matched |= SCREEN_BOLLINGER_BREAKOUT;
+            score += (snapshot.close / snapshot.bollingerUpper - 1.0) * 100.0;
+        }
+        if ((criteria.conditions & SCREEN_BOLLINGER_BREAKDOWN) && snapshot.close < snapshot.bollingerLower)
+        {
+            matched |= SCREEN_BOLLINGER_BREAKDOWN;
+            score += (1.0 - snapshot.close / snapshot.bollingerLower) * 100.0;
+        }
+    }
+    return matched;
+}
+
+std::vector<ScreenHit> scanSymbols(const std::map<std::string, std::vector<Candle>> &candles,
+                                   std::map<std::string, SymbolIndicators> &indicators,
+                                   const ScreenCriteria &criteria, WorkStealingPool &pool, TaskPriority priority)
+{
+    // The map is only changed here, before any task runs; tasks touch one item each
+    std::vector<ScanItem> items;
+    items.reserve(candles.size());
+    for (const auto &pair : candles)
+    {
+        if (pair.second.empty())
+            continue;
+        auto it = indicators.find(pair.first);
+        if (it == indicators.end())
+            it = indicators.emplace(pair.first, SymbolIndicators(CHART_MA_PERIOD, CHART_RSI_PERIOD)).first;
+        items.push_back(ScanItem{&pair.first, &pair.second, &it->second, &symbolMarket(internSymbol(pair.first))});
+    }
+
+    TaskGroup scan;
+    for (size_t first = 0; first < items.size(); first += SCAN_BATCH)
+    {
+        size_t last = std::min(items.size(), first + SCAN_BATCH);
+        pool.submit(scan, [&items, &criteria, first, last]()
+                    {
+                        for (size_t i = first; i < last; ++i)
+                        {
+                            ScanItem &item = items[i];
+                            std::lock_guard<std::mutex> seriesLock(item.market->seriesLock); // Only this symbol waits
+                            item.indicators->sync(*item.candles);
+                            item.matched = evaluateScreen(item.indicators->latest(), criteria, item.score);
+                        } }, priority);
+    }
+    pool.wait(scan);
+
+    std::vector<ScreenHit> hits;
+    for (const ScanItem &item : items)
+    {
+        if (item.matched != 0)
+            hits.push_back(ScreenHit{*item.symbol, item.matched, item.score, item.indicators->latest()});
+    }
+    std::sort(hits.begin(), hits.end(), [](const ScreenHit &a, const ScreenHit &b)
+              {
+                  size_t aCount = std::bitset<32>(a.matched).count();
+                  size_t bCount = std::bitset<32>(b.matched).count();
+                  if (aCount != bCount)
+                      return aCount > bCount;
+                  if (a.score != b.score)
+                      return a.score > b.score;
+                  return a.symbol < b.symbol; });
+    return hits;
+}
+
+std::string screenConditionNames(unsigned matched, const ScreenCriteria &criteria)
+{
+    std::ostringstream oss;
+    auto add = [&oss](const std::string &name)
+    {
+        if (oss.tellp() > 0)
+            oss << ", ";
+        oss << name;
+    };
+    auto threshold = [](double value)
+    {
+        std::ostringstream text;
+        text << value; // Default formatting: 20, not 20.000000
+        return text.str();
+    };
+    if (matched & SCREEN_RSI_OVERSOLD)
+        add("RSI<" + threshold(criteria.rsiBelow));
+    if (matched & SCREEN_RSI_OVERBOUGHT)
+        add("RSI>" + threshold(criteria.rsiAbove));
+    if (matched & SCREEN_SMA_CROSS_UP)
+        add("SMA cross up");
+    if (matched & SCREEN_SMA_CROSS_DOWN)
+        add("SMA cross down");
+    if (matched & SCREEN_BOLLINGER_BREAKOUT)
+        add("Bollinger breakout");
+    if (matched & SCREEN_BOLLINGER_BREAKDOWN)
+        add("Bollinger breakdown");
+    return oss.str();
+}
+
+bool parseScreenConditions(const std::string &text, unsigned &conditions)
+{
+    conditions = 0;
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        bool known = false;
+        for (const ConditionName &entry : CONDITION_NAMES)
+        {
+            if (item == entry.option)
+            {
+                conditions |= entry.condition;
+                known = true;
+            }
+        }
+        if (!known)
+            return false;
+    }
+    return conditions != 0;
+}
+
+void printScanTable(const std::vector<ScreenHit> &hits, const ScreenCriteria &criteria, size_t top)
+{
+    if (hits.empty())
+    {
+        std::cout << "No symbol meets any of the conditions.\n";
+        return;
+    }
+
+    std::cout << std::right << std::setw(5) << "Rank" << "  " << std::left << std::setw(12) << "Symbol" << std::right
+              << std::setw(12) << "Close" << std::setw(8) << "RSI" << std::setw(12) << "SMA" << std::setw(12) << "BB Upper"
+              << std::setw(12) << "BB Lower" << std::setw(8) << "Score" << "  " << std::left << "Conditions" << "\n";
+
+    size_t shown = (top == 0) ? hits.size() : std::min(top, hits.size());
+    for (size_t i = 0; i < shown; ++i)
+    {
+        const ScreenHit &hit = hits[i];
+        const IndicatorSnapshot &s = hit.snapshot;
+        std::cout << std::right << std::setw(5) << (i + 1) << "  " << std::left << std::setw(12) << hit.symbol << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(12) << s.close << std::setw(8) << s.rsi
+                  << std::setw(12) << s.movingAverage << std::setw(12) << s.bollingerUpper << std::setw(12) << s.bollingerLower
+                  << std::setw(8) << hit.score << "  " << std::left << screenConditionNames(hit.matched, criteria) << "\n";
+    }
+    if (shown < hits.size())
+        std::cout << "... " << (hits.size() - shown) << " more\n";
+    std::cout << std::flush;
+}
@@ -0,0 +1,295 @@
+// src/script_mode.cpp
+
+#include "utils.h"
+#include "script_mode.h"
+#include "trading_engine.h"
+#include "trading.h"
+#include "simulations.h"
+#include "data_persistence.h"
+#include "matching_engine.h"
+#include "market_data.h"
+
+// Script format, one command per line ('#' starts a comment):
+//   buy <SYMBOL> <amount>
+//   sell <SYMBOL> <amount>
+//   limit_buy <SYMBOL> <amount> <limitPrice>
+//   limit_sell <SYMBOL> <amount> <limitPrice>
+//   stop_buy|stop_sell <SYMBOL> <amount> <stopPrice>
+//   stop_limit_buy|stop_limit_sell <SYMBOL> <amount> <stopPrice> <limitPrice>
+//   trailing_stop_buy|trailing_stop_sell <SYMBOL> <amount> <trailAmount>
+//   oco_buy|oco_sell <SYMBOL> <amount> <limitPrice> <stopPrice>
+//   bracket_buy|bracket_sell <SYMBOL> <amount> <limitPrice> <takeProfit> <stopLoss>
+//   cancel <orderId>
+//   amend <orderId> <amount> <limitPrice>
+
+bool parseScriptOptions(int argc, char *argv[], ScriptOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--script" && hasValue)
+            options.scriptPath = argv[++i];
+        else if (arg == "--account" && hasValue)
+            options.account = argv[++i];
+        else if (arg == "--rate" && hasValue)
+        {
+            try
+            {
+                options.rate = std::stod(argv[++i]);
+            }
+            catch (const std::exception &e)
+            {
+                return false;
+            }
+        }
+        else if (arg == "--save")
+            options.save = true;
+        else
+            return false;
+    }
+    return !options.scriptPath.empty() && !options.account.empty() && options.rate >= 0.0;
+}
+
+// Function to parse one script line into a command; returns false for blank or invalid lines
+bool parseScriptLine(const std::string &line, TradeCommand &command, std::string &error)
+{
+    std::istringstream iss(line.substr(0, line.find('#')));
+    std::string action;
+    if (!(iss >> action))
+        return false; // Blank or comment-only line
+
+    std::transform(action.begin(), action.end(), action.begin(), ::tolower);
+    command = TradeCommand{CommandType::MarketBuy, INVALID_SYMBOL_ID, 0.0, 0.0, 0, 0, {}};
+
+    if (action == "cancel" || action == "amend")
+    {
+        command.type = (action == "cancel") ? CommandType::CancelOrder : CommandType::AmendOrder;
+        std::string orderIdStr;
+        if (!(iss >> orderIdStr))
+        {
+            error = "missing order ID";
+            return false;
+        }
+        if (orderIdStr[0] == '#')
+            orderIdStr.erase(0, 1);
+        try
+        {
+            command.orderId = std::stoull(orderIdStr);
+        }
+        catch (const std::exception &e)
+        {
+            error = "invalid order ID";
+            return false;
+        }
+        if (command.type == CommandType::AmendOrder && !(iss >> command.amount >> command.limitPrice))
+        {
+            error = "amend needs <orderId> <amount> <limitPrice>";
+            return false;
+        }
+        if (command.type == CommandType::AmendOrder && (command.amount <= 0 || command.limitPrice <= 0))
+        {
+            error = "expected a positive amount and limit price";
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<PriceField> priceFields;
+    if (!lookupOrderAction(action, command.type, priceFields))
+    {
+        error = "unknown command " + action;
+        return false;
+    }
+
+    std::string symbol;
+    if (!(iss >> symbol >> command.amount) || command.amount <= 0)
+    {
+        error = "expected <SYMBOL> <positive amount>";
+        return false;
+    }
+    std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+    if (assetData.find(symbol) == assetData.end())
+    {
+        error = "unknown symbol " + symbol;
+        return false;
+    }
+    command.symbolId = internSymbol(symbol);
+
+    for (PriceField field : priceFields)
+    {
+        double value;
+        if (!(iss >> value) || value <= 0)
+        {
+            error = std::string("expected a positive ") + priceFieldName(field);
+            return false;
+        }
+        setPriceField(command, field, value);
+    }
+    return true;
+}
+
+// Function to return the p-th percentile of sorted samples
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+int runOrderScript(const ScriptOptions &options)
+{
+    // Load the named account
+    User user;
+    user.username = options.account;
+    if (!fs::exists("data/users/" + user.username + ".txt") || !user.loadUserData())
+    {
+        std::cerr << "Account '" << options.account << "' not found." << std::endl;
+        return 1;
+    }
+
+    // Read and parse the whole script up front so parsing is not measured
+    std::ifstream scriptFile;
+    if (options.scriptPath != "-")
+    {
+        scriptFile.open(options.scriptPath);
+        if (!scriptFile)
+        {
+            std::cerr << "Could not open script " << options.scriptPath << std::endl;
+            return 1;
+        }
+    }
+    std::istream &in = (options.scriptPath == "-") ? std::cin : scriptFile;
+
+    for (const auto &pair : assetData)
+    {
+        internSymbol(pair.first);
+    }
+
+    std::vector<TradeCommand> script;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        TradeCommand command;
+        std::string error;
+        if (parseScriptLine(line, command, error))
+        {
+            command.requestId = script.size() + 1;
+            script.push_back(command);
+        }
+        else if (!error.empty())
+        {
+            std::cerr << "Line " << lineNumber << ": " << error << " (skipped)" << std::endl;
+        }
+    }
+
+    // Prices come from the same simulation threads as the interactive mode
+    loadStockData(closePricesMap, candlesMap);
+    matchingEngine.start();
+    startSimulations();
+    for (const auto &pair : assetData)
+    {
+        const LatestTick &latest = symbolMarket(internSymbol(pair.first)).latest;
+        while (latest.read().sequence == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Results arrive on the engine thread; only it writes these
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(script.size());
+    size_t fills = 0;
+    size_t rejected = 0;
+    std::vector<char> answered(script.size() + 1, 0); // By request ID
+    std::atomic<size_t> completed(0);
+    std::chrono::steady_clock::time_point lastCompletion;
+
+    TradingEngine engine(&user, 65536);
+    engine.setResultListener([&](const TradeResult &result)
+                             {
+                                 if (result.filled)
+                                     ++fills;
+                                 if (result.requestId == 0 || result.requestId >= answered.size() || answered[result.requestId])
+                                     return; // Resting limit order executed later, or a follow-up
+                                 answered[result.requestId] = 1;
+                                 if (!result.accepted)
+                                     ++rejected;
+                                 latenciesUs.push_back(std::chrono::duration<double, std::micro>(result.completed - result.submitted).count());
+                                 lastCompletion = result.completed;
+                                 completed.fetch_add(1, std::memory_order_release); });
+
+    std::cout << "Running " << script.size() << " commands as '" << user.username << "' (next order ID #"
+              << user.pendingOrders.peekNextId() << ", rate " << (options.rate > 0 ? std::to_string(options.rate) + "/s" : std::string("unthrottled")) << ")" << std::endl;
+    engine.start();
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < script.size(); ++i)
+    {
+        if (options.rate > 0)
+        {
+            // Pace against the schedule, not the previous send, so timing does not drift
+            auto due = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(i / options.rate));
+            std::this_thread::sleep_until(due);
+        }
+        script[i].submitted = std::chrono::steady_clock::now();
+        engine.submit(script[i]);
+    }
+
+    // Every request should be answered; stop waiting once replies stall
+    const auto REPLY_TIMEOUT = std::chrono::seconds(5);
+    size_t seen = completed.load(std::memory_order_acquire);
+    auto lastProgress = std::chrono::steady_clock::now();
+    while (seen < script.size())
+    {
+        std::this_thread::yield();
+        size_t now = completed.load(std::memory_order_acquire);
+        if (now != seen)
+        {
+            seen = now;
+            lastProgress = std::chrono::steady_clock::now();
+        }
+        else if (std::chrono::steady_clock::now() - lastProgress > REPLY_TIMEOUT)
+        {
+            break;
+        }
+    }
+    engine.stop();
+    stopSimulations();
+    matchingEngine.stop();
+
+    // The engine thread has stopped, so the answers can be read here
+    if (seen < script.size())
+    {
+        std::cerr << "Warning: " << (script.size() - seen) << " command(s) got no reply within "
+                  << REPLY_TIMEOUT.count() << " s:";
+        for (size_t id = 1; id < answered.size(); ++id)
+        {
+            if (!answered[id])
+                std::cerr << " #" << id;
+        }
+        std::cerr << std::endl;
+    }
+
+    double elapsed = script.empty() ? 0.0 : std::chrono::duration<double>(lastCompletion - startTime).count();
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Commands:     " << script.size() << " in " << std::setprecision(3) << elapsed << " s" << std::setprecision(1) << "\n";
+    std::cout << "Rejected:     " << rejected << "\n";
+    std::cout << "Fills:        " << fills << "\n";
+    std::cout << "Orders/sec:   " << (elapsed > 0 ? script.size() / elapsed : 0.0) << "\n";
+    std::cout << "Fills/sec:    " << (elapsed > 0 ? fills / elapsed : 0.0) << "\n";
+    std::cout << "Latency (us): p50 " << percentile(latenciesUs, 50) << ", p90 " << percentile(latenciesUs, 90)
+              << ", p99 " << percentile(latenciesUs, 99) << ", p99.9 " << percentile(latenciesUs, 99.9)
+              << ", max " << (latenciesUs.empty() ? 0.0 : latenciesUs.back()) << std::endl;
+
+    if (options.save)
+    {
+        user.saveUserData();
+        saveStockData(closePricesMap, candlesMap);
+    }
+    return 0;
+}
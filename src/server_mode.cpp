@@ -0,0 +1,157 @@
+// src/server_mode.cpp
+
+#include "utils.h"
+#include "server_mode.h"
+#include "market_server.h"
+#include "trading_engine.h"
+#include "simulations.h"
+#include "data_persistence.h"
+#include "matching_engine.h"
+#include "market_bus.h"
+#include <csignal>
+#include <memory>
+
+namespace
+{
+    // How often the server prints its counters
+    const auto STATUS_INTERVAL = std::chrono::seconds(10);
+
+    // The loop SIGINT and SIGTERM stop; stop() only stores a flag and writes an eventfd
+    EventLoop *signalledLoop = nullptr;
+
+    void stopOnSignal(int)
+    {
+        if (signalledLoop != nullptr)
+            signalledLoop->stop();
+    }
+
+    void printStatus(const MarketServer::Stats &stats)
+    {
+        std::cout << stats.connections << " connections, " << stats.subscribers << " subscribed; " << stats.eventsFannedOut
+                  << " events fanned out as " << stats.framesQueued << " blocks, " << stats.eventsMissed << " missed; "
+                  << stats.ordersReceived << " orders; " << stats.slowDisconnects << " slow subscribers dropped, "
+                  << stats.refusedConnections << " connections refused" << std::endl;
+    }
+}
+
+bool parseServeOptions(int argc, char *argv[], ServeOptions &options)
+{
+    bool serve = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--serve")
+                serve = true;
+            else if (arg == "--socket" && hasValue)
+                options.socketPath = argv[++i];
+            else if (arg == "--port" && hasValue)
+            {
+                unsigned long port = std::stoul(argv[++i]);
+                if (port == 0 || port > 65535)
+                    return false;
+                options.port = static_cast<uint16_t>(port);
+            }
+            else if (arg == "--account" && hasValue)
+                options.account = argv[++i];
+            else if (arg == "--save")
+                options.save = true;
+            else
+                return false;
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+    }
+    if (options.socketPath.empty() && options.port == 0)
+        options.socketPath = DEFAULT_SERVER_SOCKET;
+    return serve;
+}
+
+int runServeMode(const ServeOptions &options)
+{
+#ifdef _WIN32
+    std::cerr << "The market server needs epoll and Unix sockets" << std::endl;
+    return 1;
+#else
+    // Orders trade as one existing account
+    User user;
+    if (!options.account.empty())
+    {
+        user.username = options.account;
+        if (!fs::exists("data/users/" + user.username + ".txt") || !user.loadUserData())
+        {
+            std::cerr << "Account '" << options.account << "' not found." << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto &pair : assetData)
+    {
+        internSymbol(pair.first);
+    }
+    size_t descriptors = raiseDescriptorLimit();
+
+    loadStockData(closePricesMap, candlesMap);
+    matchingEngine.start();
+
+    EventLoop loop;
+    std::unique_ptr<TradingEngine> engine;
+    if (!options.account.empty())
+        engine = std::make_unique<TradingEngine>(&user, 65536);
+    {
+        MarketServer server(loop, marketBus, engine.get());
+        if (!options.socketPath.empty() && fs::path(options.socketPath).has_parent_path())
+            fs::create_directories(fs::path(options.socketPath).parent_path());
+        if (!options.socketPath.empty() && !server.listenUnix(options.socketPath))
+        {
+            std::cerr << "Could not listen on " << options.socketPath << std::endl;
+            matchingEngine.stop();
+            return 1;
+        }
+        if (options.port != 0 && !server.listenTcp(options.port))
+        {
+            std::cerr << "Could not listen on 127.0.0.1:" << options.port << std::endl;
+            matchingEngine.stop();
+            return 1;
+        }
+
+        if (engine)
+            engine->start();
+        startSimulations();
+
+        std::cout << "Serving market data" << (engine ? " and orders for '" + user.username + "'" : std::string()) << " on "
+                  << (options.socketPath.empty() ? std::string() : options.socketPath)
+                  << (!options.socketPath.empty() && options.port != 0 ? " and " : "")
+                  << (options.port != 0 ? "127.0.0.1:" + std::to_string(options.port) : std::string())
+                  << " (up to " << descriptors << " descriptors); Ctrl-C stops" << std::endl;
+
+        signalledLoop = &loop;
+        std::signal(SIGINT, stopOnSignal);
+        std::signal(SIGTERM, stopOnSignal);
+        loop.addTimer(STATUS_INTERVAL, [&server](uint64_t)
+                      { printStatus(server.stats()); });
+        loop.run();
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        signalledLoop = nullptr;
+
+        stopSimulations();
+        if (engine)
+            engine->stop();
+        printStatus(server.stats());
+    }
+    matchingEngine.stop();
+
+    if (options.save)
+    {
+        if (engine)
+            user.saveUserData();
+        saveStockData(closePricesMap, candlesMap);
+    }
+    return 0;
+#endif
+}
@@ -3,43 +3,53 @@
 #include "utils.h"
 #include "simulations.h"
 #include "data_persistence.h"
+#include "event_loop.h"
+#include "market_data.h"
+#include "market_bus.h"
+#include "chart_data.h"
+#include "indicators.h"
+#include "work_stealing_pool.h"
+#include <memory>
+#include <unordered_map>
 
-// Function to simulate real-time price updates for a single symbol
-void simulateSymbolPrice(const std::string &symbol, std::vector<double> &closePrices, std::vector<Candle> &candles, std::atomic<bool> &stopFlag)
+namespace
 {
-    // Retrieve initial price and volatility for the symbol
-    double initialPrice = assetData[symbol].first;
-    double volatility = assetData[symbol].second;
-
-    // Seed the generator based on the symbol for consistency
-    std::mt19937 gen(std::hash<std::string>{}(symbol));
-    std::normal_distribution<> normDist(0.0, 1.0);
-
-    double dt = 1.0 / 60.0; // Assume 60 time steps per minute
+    const double DT = 1.0 / 60.0; // Assume 60 time steps per minute
 
     // Define candle interval in seconds
-    const int candleInterval = 10; // Each candle represents 10 seconds
-
-    // Initialize price
-    double price = initialPrice;
+    const int CANDLE_INTERVAL = 10; // Each candle represents 10 seconds
 
     // Pre-load at least 50 candles before starting the live simulation
-    const int preLoadCandles = 50;
-    const int preLoadSeconds = preLoadCandles * candleInterval;
-
-    // Initialize candle variables
-    double openPrice = price;
-    double highPrice = price;
-    double lowPrice = price;
-    double closePrice = price;
-    int secondCounter = 0;
-
-    // Pre-load data
-    for (int i = 0; i < preLoadSeconds; ++i)
+    const int PRELOAD_CANDLES = 50;
+
+    // One symbol's random walk and the candle being built from it
+    struct SymbolSimulation
+    {
+        SymbolId symbolId;
+        SymbolMarket *market;
+        std::vector<double> *closePrices;
+        std::vector<Candle> *candles;
+        std::mt19937 gen;
+        std::normal_distribution<> normDist{0.0, 1.0};
+        double volatility;
+        double price;
+        double openPrice;
+        double highPrice;
+        double lowPrice;
+        double closePrice;
+        int secondCounter = 0;
+    };
+
+    // Advance a symbol by one second. Live steps put closed candles and ticks on
+    // the market bus, where the order books take a tick as the liquidity
+    // provider's price; the caller commits what was published. Preload steps
+    // publish nothing, so symbols can be preloaded on several threads while
+    // the bus keeps its single producer.
+    void stepSimulation(SymbolSimulation &sim, bool live)
     {
         // Generate a new price point
-        double randStdNormal = normDist(gen);
-        double changePercent = volatility * sqrt(dt) * randStdNormal / 100.0; // Convert volatility to a percentage
+        double randStdNormal = sim.normDist(sim.gen);
+        double changePercent = sim.volatility * sqrt(DT) * randStdNormal / 100.0; // Convert volatility to a percentage
 
         // Constrain changePercent to prevent underflow/overflow
         const double maxChangePercent = 0.1; // Maximum 10% change per time step
@@ -48,123 +58,209 @@ void simulateSymbolPrice(const std::string &symbol, std::vector<double> &closePr
         else if (changePercent < -maxChangePercent)
             changePercent = -maxChangePercent;
 
-        price = price * exp(changePercent);
+        sim.price = sim.price * exp(changePercent);
 
         // Ensure price does not become zero or negative
-        if (price < 0.01)
-            price = 0.01;
+        if (sim.price < 0.01)
+            sim.price = 0.01;
+        double price = sim.price;
 
-        // Update price data
+        // Update price data; readers of the latest price take it from the tick, without the lock
         {
-            std::lock_guard<std::mutex> dataLock(dataMutex);
-            closePrices.push_back(price);
+            std::lock_guard<std::mutex> seriesLock(sim.market->seriesLock);
+            sim.closePrices->push_back(price);
         }
+        sim.market->latest.publish(price);
+        if (live)
+            marketBus.publish(MarketEvent{MarketEvent::Tick, sim.symbolId, price, Candle{}});
 
         // Update candle data
-        if (secondCounter == 0)
+        if (sim.secondCounter == 0)
         {
-            openPrice = price;
-            highPrice = price;
-            lowPrice = price;
+            sim.openPrice = price;
+            sim.highPrice = price;
+            sim.lowPrice = price;
         }
         else
         {
-            if (price > highPrice)
-                highPrice = price;
-            if (price < lowPrice)
-                lowPrice = price;
+            if (price > sim.highPrice)
+                sim.highPrice = price;
+            if (price < sim.lowPrice)
+                sim.lowPrice = price;
         }
 
-        closePrice = price;
-        secondCounter++;
+        sim.closePrice = price;
+        sim.secondCounter++;
 
-        if (secondCounter >= candleInterval)
+        if (sim.secondCounter >= CANDLE_INTERVAL)
         {
             // Aggregate into a candle
-            Candle candle = {openPrice, highPrice, lowPrice, closePrice};
+            Candle candle = {sim.openPrice, sim.highPrice, sim.lowPrice, sim.closePrice};
             {
-                std::lock_guard<std::mutex> dataLock(dataMutex);
-                candles.push_back(candle);
+                std::lock_guard<std::mutex> seriesLock(sim.market->seriesLock);
+                sim.candles->push_back(candle);
             }
 
-            // Save the candle to disk
-            saveCandleToDisk(symbol, candle);
+            // Recorded to disk and fed to the indicators by their own consumers
+            if (live)
+                marketBus.publish(MarketEvent{MarketEvent::CandleClose, sim.symbolId, candle.close, candle});
 
             // Reset for the next interval
-            openPrice = price;
-            highPrice = price;
-            lowPrice = price;
-            closePrice = price;
-            secondCounter = 0;
+            sim.secondCounter = 0;
         }
     }
 
-    // Now start the live simulation
-    secondCounter = 0; // Reset the counter for the live simulation
-
-    while (!stopFlag)
-    {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-
-        // Generate a new price point
-        double randStdNormal = normDist(gen);
-        double changePercent = volatility * sqrt(dt) * randStdNormal / 100.0; // Convert volatility to a percentage
-
-        // Constrain changePercent to prevent underflow/overflow
-        const double maxChangePercent = 0.1; // Maximum 10% change per time step
-        if (changePercent > maxChangePercent)
-            changePercent = maxChangePercent;
-        else if (changePercent < -maxChangePercent)
-            changePercent = -maxChangePercent;
+    // Every symbol is stepped on one thread, from one drift-free timer
+    std::vector<SymbolSimulation> simulations;
+    std::unique_ptr<EventLoop> simulationLoop;
+    std::thread simulationThread;
 
-        price = price * exp(changePercent);
+    // Consumers of the bus that live as long as the simulation
+    std::unique_ptr<MarketBusConsumer> candleRecorder;
+    std::unique_ptr<MarketBusConsumer> indicatorUpdater;
 
-        // Ensure price does not become zero or negative
-        if (price < 0.01)
-            price = 0.01;
+    // Candles of each symbol already in its history file; only the recorder uses it
+    std::unordered_map<SymbolId, size_t> recordedCandles;
+    std::vector<Candle> unrecorded;
 
-        // Update price data
+    // Append the candles closed since the last call to the symbol's history.
+    // candlesMap is the record, so a CandleClose the recorder was lapped on is
+    // still written by the next call, and a candle is never written twice.
+    void recordCandles(SymbolId symbolId)
+    {
+        const std::string &symbol = symbolName(symbolId);
+        auto candlesIt = candlesMap.find(symbol);
+        if (candlesIt == candlesMap.end())
+            return;
+        size_t &recorded = recordedCandles[symbolId];
         {
-            std::lock_guard<std::mutex> dataLock(dataMutex);
-            closePrices.push_back(price);
+            std::lock_guard<std::mutex> seriesLock(symbolMarket(symbolId).seriesLock);
+            const std::vector<Candle> &candles = candlesIt->second;
+            unrecorded.assign(candles.begin() + std::min(recorded, candles.size()), candles.end());
+            recorded = candles.size();
         }
+        for (const Candle &candle : unrecorded)
+            saveCandleToDisk(symbol, candle);
+    }
 
-        // Update candle data
-        if (secondCounter == 0)
-        {
-            openPrice = price;
-            highPrice = price;
-            lowPrice = price;
-        }
-        else
+    void runSimulations()
+    {
+        // Pre-load data, one pool task per symbol; each symbol's walk is seeded, so the order does not matter
+        std::vector<size_t> preloadFrom;
+        for (const SymbolSimulation &sim : simulations)
+            preloadFrom.push_back(sim.candles->size());
+        TaskGroup preload;
+        for (SymbolSimulation &sim : simulations)
         {
-            if (price > highPrice)
-                highPrice = price;
-            if (price < lowPrice)
-                lowPrice = price;
+            sharedPool().submit(preload, [&sim]
+                                {
+                                    for (int i = 0; i < PRELOAD_CANDLES * CANDLE_INTERVAL; ++i)
+                                        stepSimulation(sim, false); });
         }
+        sharedPool().wait(preload);
 
-        closePrice = price;
-        secondCounter++;
-
-        if (secondCounter >= candleInterval)
+        // Then publish the preloaded candles from this thread, the bus's only producer
+        for (size_t s = 0; s < simulations.size(); ++s)
         {
-            // Aggregate into a candle
-            Candle candle = {openPrice, highPrice, lowPrice, closePrice};
+            const SymbolSimulation &sim = simulations[s];
+            for (size_t i = preloadFrom[s]; i < sim.candles->size(); ++i)
             {
-                std::lock_guard<std::mutex> dataLock(dataMutex);
-                candles.push_back(candle);
+                const Candle &candle = (*sim.candles)[i];
+                marketBus.publish(MarketEvent{MarketEvent::CandleClose, sim.symbolId, candle.close, candle});
             }
+            marketBus.commit();
+        }
 
-            // Save the candle to disk
-            saveCandleToDisk(symbol, candle);
+        // Now start the live simulation: one step a second, and one per second missed if late
+        simulationLoop->addTimer(std::chrono::seconds(1), [](uint64_t ticks)
+                                 {
+                                     for (uint64_t tick = 0; tick < ticks; ++tick)
+                                     {
+                                         for (SymbolSimulation &sim : simulations)
+                                             stepSimulation(sim, true);
+                                         marketBus.commit(); // One batch per step of every symbol
+                                     } });
+        simulationLoop->run();
+    }
+}
 
-            // Reset for the next interval
-            openPrice = price;
-            highPrice = price;
-            lowPrice = price;
-            closePrice = price;
-            secondCounter = 0;
+// Function to start simulating every symbol in assetData. Every symbol's
+// series are added here, before the simulation thread starts.
+void startSimulations()
+{
+    simulations.clear();
+    for (const auto &pair : assetData)
+    {
+        const std::string &simSymbol = pair.first;
+        // Initialize vectors if not loaded
+        if (closePricesMap.find(simSymbol) == closePricesMap.end())
+            closePricesMap[simSymbol] = std::vector<double>();
+        if (candlesMap.find(simSymbol) == candlesMap.end())
+            candlesMap[simSymbol] = std::vector<Candle>();
+        indicatorsMap.emplace(simSymbol, SymbolIndicators(CHART_MA_PERIOD, CHART_RSI_PERIOD));
+
+        // Retrieve initial price and volatility, and seed the generator based on the symbol for consistency
+        SymbolSimulation sim;
+        sim.symbolId = internSymbol(simSymbol);
+        sim.market = &symbolMarket(sim.symbolId);
+        sim.closePrices = &closePricesMap[simSymbol];
+        sim.candles = &candlesMap[simSymbol];
+        sim.gen.seed(std::hash<std::string>{}(simSymbol));
+        sim.price = pair.second.first;
+        sim.volatility = pair.second.second;
+
+        // A price loaded from disk (recorded, or imported by --import) is the
+        // latest until the first step, and the walk continues from it
+        if (!sim.closePrices->empty())
+        {
+            sim.price = sim.closePrices->back();
+            sim.market->latest.publish(sim.price);
         }
+        sim.openPrice = sim.highPrice = sim.lowPrice = sim.closePrice = sim.price;
+        simulations.push_back(std::move(sim));
     }
-}
\ No newline at end of file
+
+    // Candles loaded from disk were recorded by an earlier session
+    recordedCandles.clear();
+    for (const SymbolSimulation &sim : simulations)
+        recordedCandles[sim.symbolId] = sim.candles->size();
+
+    // Consumers attach before the first candle is published, so they see the preload too.
+    // Either one lapped by the simulation catches every symbol up from candlesMap.
+    candleRecorder = std::make_unique<MarketBusConsumer>(
+        marketBus, [](const MarketEvent &event)
+        {
+            if (event.type == MarketEvent::CandleClose)
+                recordCandles(event.symbolId); },
+        [](uint64_t)
+        {
+            for (const SymbolSimulation &sim : simulations)
+                recordCandles(sim.symbolId); });
+    indicatorUpdater = std::make_unique<MarketBusConsumer>(
+        marketBus, [](const MarketEvent &event)
+        {
+            if (event.type == MarketEvent::CandleClose)
+                syncChartIndicators(event.symbolId); },
+        [](uint64_t)
+        {
+            for (const SymbolSimulation &sim : simulations)
+                syncChartIndicators(sim.symbolId); });
+
+    simulationLoop = std::make_unique<EventLoop>();
+    simulationThread = std::thread(runSimulations);
+}
+
+// Function to stop the simulations; returns at once rather than at the next tick
+void stopSimulations()
+{
+    if (!simulationLoop)
+        return;
+    simulationLoop->stop();
+    if (simulationThread.joinable())
+        simulationThread.join();
+    simulationLoop.reset();
+
+    // The consumers finish what was published before they go
+    candleRecorder.reset();
+    indicatorUpdater.reset();
+}
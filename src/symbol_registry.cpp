@@ -0,0 +1,45 @@
+// src/symbol_registry.cpp
+
+#include "symbol_registry.h"
+#include <deque>
+#include <unordered_map>
+
+namespace
+{
+    std::mutex registryMutex;
+    std::unordered_map<std::string, SymbolId> idsByName;
+    std::deque<std::string> namesById; // deque keeps references stable on growth
+}
+
+SymbolId internSymbol(const std::string &symbol)
+{
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    auto it = idsByName.find(symbol);
+    if (it != idsByName.end())
+        return it->second;
+
+    SymbolId id = static_cast<SymbolId>(namesById.size());
+    namesById.push_back(symbol);
+    idsByName.emplace(symbol, id);
+    return id;
+}
+
+SymbolId findSymbolId(const std::string &symbol)
+{
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    auto it = idsByName.find(symbol);
+    return it == idsByName.end() ? INVALID_SYMBOL_ID : it->second;
+}
+
+const std::string &symbolName(SymbolId id)
+{
+    static const std::string unknown = "?";
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    return id < namesById.size() ? namesById[id] : unknown;
+}
+
+size_t symbolCount()
+{
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    return namesById.size();
+}
@@ -0,0 +1,277 @@
+// src/terminal_chart.cpp
+
+#include "utils.h"
+#include "terminal_chart.h"
+#include "indicators.h"
+#include <cstdlib>
+
+namespace
+{
+    enum Colour : uint8_t
+    {
+        COLOUR_DEFAULT,
+        COLOUR_GREEN,
+        COLOUR_RED,
+        COLOUR_BLUE,
+        COLOUR_GRAY,
+        COLOUR_MAGENTA,
+        COLOUR_YELLOW,
+    };
+
+    const char *const COLOUR_CODES[] = {"\033[0m", "\033[32m", "\033[31m", "\033[34m", "\033[90m", "\033[35m", "\033[33m"};
+
+    // Braille dot bit for (row, column) of a cell's 4x2 dots
+    const uint8_t BRAILLE_BITS[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+
+    // Candle parts by the halves of a cell they cover
+    const char *const FULL_BODY = "█";
+    const char *const UPPER_BODY = "▀";
+    const char *const LOWER_BODY = "▄";
+    const char *const FULL_WICK = "│";
+    const char *const UPPER_WICK = "╵";
+    const char *const LOWER_WICK = "╷";
+
+    // Position of value on a scale of `steps` rows where high is row 0
+    int scaleRow(double value, double low, double high, int steps)
+    {
+        return static_cast<int>(std::lround((high - value) / (high - low) * (steps - 1)));
+    }
+
+    std::string formatValue(double value, int decimals)
+    {
+        std::string text;
+        appendNumber(text, value, decimals);
+        return text;
+    }
+
+    void appendBraille(std::string &buffer, uint8_t dots)
+    {
+        // U+2800 + dots, as UTF-8
+        buffer += static_cast<char>(0xE2);
+        buffer += static_cast<char>(0xA0 | (dots >> 6));
+        buffer += static_cast<char>(0x80 | (dots & 0x3F));
+    }
+}
+
+void TerminalChart::setDot(int dotX, int dotY, uint8_t colour)
+{
+    if (dotX < 0 || dotX >= width * 2 || dotY < clipTop || dotY >= clipBottom)
+        return;
+    Cell &cell = at(dotX / 2, dotY / 4);
+    cell.dots |= BRAILLE_BITS[dotY % 4][dotX % 2];
+    cell.dotColour = colour;
+}
+
+void TerminalChart::drawSegment(int x0, int y0, int x1, int y1, uint8_t colour)
+{
+    int steps = std::max({std::abs(x1 - x0), std::abs(y1 - y0), 1});
+    for (int step = 0; step <= steps; ++step)
+    {
+        int x = x0 + static_cast<int>(std::lround(static_cast<double>(x1 - x0) * step / steps));
+        int y = y0 + static_cast<int>(std::lround(static_cast<double>(y1 - y0) * step / steps));
+        setDot(x, y, colour);
+    }
+}
+
+void TerminalChart::drawSeries(const std::vector<double> &series, size_t skip, size_t from, int top, int rows,
+                               double low, double high, uint8_t colour)
+{
+    clipTop = top * 4;
+    clipBottom = (top + rows) * 4;
+    bool havePrevious = false;
+    int previousX = 0;
+    int previousY = 0;
+    for (size_t i = std::max(skip, from); i < series.size(); ++i)
+    {
+        int x = candleColumns[i - skip] * 2; // Left dot column, so the line meets the candle's wick
+        int y = clipTop + scaleRow(series[i], low, high, rows * 4);
+        if (havePrevious)
+            drawSegment(previousX, previousY, x, y, colour);
+        else
+            setDot(x, y, colour);
+        havePrevious = true;
+        previousX = x;
+        previousY = y;
+    }
+}
+
+void TerminalChart::drawText(int x, int y, const std::string &text, uint8_t colour)
+{
+    for (size_t i = 0; i < text.size() && x + static_cast<int>(i) < width; ++i)
+    {
+        Cell &cell = at(x + static_cast<int>(i), y);
+        cell.text = text[i];
+        cell.glyphColour = colour;
+    }
+}
+
+bool TerminalChart::appendFrame(const ChartWindow &window, const std::string &symbol, const TerminalArea &area,
+                                std::string &buffer)
+{
+    if (area.width < TERMINAL_CHART_MIN_WIDTH || area.height < TERMINAL_CHART_MIN_HEIGHT || window.candles.empty())
+        return false;
+
+    width = area.width;
+    height = area.height;
+    cells.assign(static_cast<size_t>(width) * height, Cell());
+
+    // Row 0 is the title; the RSI pane takes a quarter of the rest
+    const int plotWidth = width - TERMINAL_CHART_AXIS_WIDTH;
+    const int rsiRows = std::max(3, (height - 1) / 4);
+    const int priceTop = 1;
+    const int priceRows = height - 1 - rsiRows;
+    const int rsiTop = priceTop + priceRows;
+
+    // The newest candles that fit, right-aligned, `slot` columns each
+    size_t count = std::min(window.candles.size(), static_cast<size_t>(plotWidth));
+    size_t skip = window.candles.size() - count;
+    int slot = plotWidth / static_cast<int>(count);
+    candleColumns.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        candleColumns[i] = plotWidth - static_cast<int>(count - i) * slot + slot / 2;
+
+    // Price range of the visible candles, padded like the gnuplot chart
+    double low = std::numeric_limits<double>::max();
+    double high = std::numeric_limits<double>::lowest();
+    for (size_t i = skip; i < window.candles.size(); ++i)
+    {
+        low = std::min(low, window.candles[i].low);
+        high = std::max(high, window.candles[i].high);
+    }
+    double padding = (high > low) ? (high - low) * 0.05 : 1.0;
+    low -= padding;
+    high += padding;
+
+    // Candles at half-cell resolution: each cell row is an upper and a lower half
+    const int halves = priceRows * 2;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Candle &candle = window.candles[skip + i];
+        uint8_t colour = (candle.close > candle.open) ? COLOUR_GREEN : COLOUR_RED;
+        int wickTop = scaleRow(candle.high, low, high, halves);
+        int wickBottom = scaleRow(candle.low, low, high, halves);
+        int bodyTop = scaleRow(std::max(candle.open, candle.close), low, high, halves);
+        int bodyBottom = scaleRow(std::min(candle.open, candle.close), low, high, halves);
+        for (int row = wickTop / 2; row <= wickBottom / 2; ++row)
+        {
+            int upper = row * 2;
+            int lower = upper + 1;
+            bool upperBody = upper >= bodyTop && upper <= bodyBottom;
+            bool lowerBody = lower >= bodyTop && lower <= bodyBottom;
+            bool upperWick = upper >= wickTop && upper <= wickBottom;
+            bool lowerWick = lower >= wickTop && lower <= wickBottom;
+
+            const char *glyph = nullptr;
+            if (upperBody && lowerBody)
+                glyph = FULL_BODY;
+            else if (upperBody)
+                glyph = UPPER_BODY;
+            else if (lowerBody)
+                glyph = LOWER_BODY;
+            else if (upperWick && lowerWick)
+                glyph = FULL_WICK;
+            else if (upperWick)
+                glyph = UPPER_WICK;
+            else if (lowerWick)
+                glyph = LOWER_WICK;
+            if (glyph == nullptr)
+                continue;
+            Cell &cell = at(candleColumns[i], priceTop + row);
+            cell.glyph = glyph;
+            cell.glyphColour = colour;
+        }
+    }
+
+    // Overlays, drawn as braille lines between candle columns
+    drawSeries(window.bollingerUpper, skip, firstReadyRow(window, CHART_BOLLINGER_PERIOD - 1), priceTop, priceRows, low, high, COLOUR_GRAY);
+    drawSeries(window.bollingerLower, skip, firstReadyRow(window, CHART_BOLLINGER_PERIOD - 1), priceTop, priceRows, low, high, COLOUR_GRAY);
+    drawSeries(window.movingAverage, skip, firstReadyRow(window, CHART_MA_PERIOD - 1), priceTop, priceRows, low, high, COLOUR_BLUE);
+
+    // RSI pane with dotted 80 and 20 guides; the first candle has no change, so RSI starts at the second
+    clipTop = rsiTop * 4;
+    clipBottom = (rsiTop + rsiRows) * 4;
+    for (double level : {80.0, 20.0})
+    {
+        int y = rsiTop * 4 + scaleRow(level, 0.0, 100.0, rsiRows * 4);
+        for (int x = 0; x < plotWidth * 2; x += 4)
+            setDot(x, y, COLOUR_GRAY);
+        drawText(plotWidth + 1, y / 4, formatValue(level, 0), COLOUR_GRAY);
+    }
+    drawSeries(window.rsi, skip, firstReadyRow(window, 1), rsiTop, rsiRows, 0.0, 100.0, COLOUR_MAGENTA);
+
+    // Price axis: top, middle and bottom of the pane
+    for (int row : {0, (priceRows - 1) / 2, priceRows - 1})
+    {
+        double value = high - (high - low) * row / std::max(1, priceRows - 1);
+        drawText(plotWidth + 1, priceTop + row, formatValue(value, 2), COLOUR_DEFAULT);
+    }
+
+    // Title and legend
+    int x = 0;
+    auto title = [&](const std::string &text, uint8_t colour)
+    {
+        drawText(x, 0, text, colour);
+        x += static_cast<int>(text.size());
+    };
+    title("IndiNexus - " + symbol, COLOUR_DEFAULT);
+    if (window.currentPrice > 0.0)
+        title("  Current Price: INR " + formatValue(window.currentPrice, 2), COLOUR_YELLOW);
+    title("  SMA(" + std::to_string(CHART_MA_PERIOD) + ")", COLOUR_BLUE);
+    title("  Bollinger(" + std::to_string(CHART_BOLLINGER_PERIOD) + ")", COLOUR_GRAY);
+    title("  RSI(" + std::to_string(CHART_RSI_PERIOD) + ") " + formatValue(window.rsi.back(), 1), COLOUR_MAGENTA);
+
+    // Compose: each row positioned and cleared like the portfolio lines, colours only emitted on change
+    buffer += "\033[s"; // Save cursor position
+    for (int y = 0; y < height; ++y)
+    {
+        appendMoveCursor(buffer, area.column, area.row + y);
+        buffer += CLEARLINE;
+        uint8_t current = COLOUR_DEFAULT;
+        for (int cx = 0; cx < width; ++cx)
+        {
+            const Cell &cell = at(cx, y);
+            uint8_t colour = (cell.text != 0 || cell.glyph != nullptr) ? cell.glyphColour : cell.dotColour;
+            if (cell.text == 0 && cell.glyph == nullptr && cell.dots == 0)
+                colour = current; // A blank needs no colour change
+            if (colour != current)
+            {
+                buffer += COLOUR_CODES[colour];
+                current = colour;
+            }
+            if (cell.text != 0)
+                buffer += cell.text;
+            else if (cell.glyph != nullptr)
+                buffer += cell.glyph;
+            else if (cell.dots != 0)
+                appendBraille(buffer, cell.dots);
+            else
+                buffer += ' ';
+        }
+        if (current != COLOUR_DEFAULT)
+            buffer += COLOUR_CODES[COLOUR_DEFAULT];
+    }
+    buffer += "\033[u"; // Restore cursor position
+    return true;
+}
+
+ChartOutput defaultChartOutput()
+{
+#ifdef _WIN32
+    return ChartOutput::Gnuplot;
+#else
+    // gnuplot's qt terminal needs a display; over SSH or on a server there is none
+    bool display = std::getenv("DISPLAY") != nullptr || std::getenv("WAYLAND_DISPLAY") != nullptr;
+    return display ? ChartOutput::Gnuplot : ChartOutput::Terminal;
+#endif
+}
+
+bool parseChartOutput(const std::string &text, ChartOutput &output)
+{
+    if (text == "gnuplot")
+        output = ChartOutput::Gnuplot;
+    else if (text == "terminal")
+        output = ChartOutput::Terminal;
+    else
+        return false;
+    return true;
+}
@@ -3,6 +3,8 @@
 #include "utils.h"
 #include "trading.h"
 #include "ui.h"
+#include "trading_engine.h"
+#include "chart_downsample.h"
 
 double calculateBrokerFee(double transactionValue)
 {
@@ -16,474 +18,328 @@ bool hasSufficientFunds(User *user, double totalCost)
 }
 
 // Function to check if user has sufficient holdings
+bool hasSufficientHoldings(User *user, SymbolId symbolId, double amount)
+{
+    const User::Holding *holding = user->holdings.find(symbolId);
+    return holding != nullptr && holding->amount >= amount;
+}
+
 bool hasSufficientHoldings(User *user, const std::string &symbol, double amount)
 {
-    for (const auto &holding : user->holdings)
+    return hasSufficientHoldings(user, findSymbolId(symbol), amount);
+}
+
+// Function to look up an order-entry action ("limit_buy", "oco_sell", ...) and the prices it needs
+bool lookupOrderAction(const std::string &action, CommandType &type, std::vector<PriceField> &fields)
+{
+    static const std::map<std::string, std::pair<CommandType, std::vector<PriceField>>> actions = {
+        {"buy", {CommandType::MarketBuy, {}}},
+        {"sell", {CommandType::MarketSell, {}}},
+        {"limit_buy", {CommandType::LimitBuy, {PriceField::Limit}}},
+        {"limit_sell", {CommandType::LimitSell, {PriceField::Limit}}},
+        {"stop_buy", {CommandType::StopBuy, {PriceField::Stop}}},
+        {"stop_sell", {CommandType::StopSell, {PriceField::Stop}}},
+        {"stop_limit_buy", {CommandType::StopLimitBuy, {PriceField::Stop, PriceField::Limit}}},
+        {"stop_limit_sell", {CommandType::StopLimitSell, {PriceField::Stop, PriceField::Limit}}},
+        {"trailing_stop_buy", {CommandType::TrailingStopBuy, {PriceField::Trail}}},
+        {"trailing_stop_sell", {CommandType::TrailingStopSell, {PriceField::Trail}}},
+        {"oco_buy", {CommandType::OcoBuy, {PriceField::Limit, PriceField::Stop}}},
+        {"oco_sell", {CommandType::OcoSell, {PriceField::Limit, PriceField::Stop}}},
+        {"bracket_buy", {CommandType::BracketBuy, {PriceField::Limit, PriceField::TakeProfit, PriceField::Stop}}},
+        {"bracket_sell", {CommandType::BracketSell, {PriceField::Limit, PriceField::TakeProfit, PriceField::Stop}}},
+    };
+
+    auto it = actions.find(action);
+    if (it == actions.end())
+        return false;
+    type = it->second.first;
+    fields = it->second.second;
+    return true;
+}
+
+const char *priceFieldName(PriceField field)
+{
+    switch (field)
     {
-        if (holding.symbol == symbol && holding.amount >= amount)
-        {
-            return true;
-        }
+    case PriceField::Limit:
+        return "limit price";
+    case PriceField::Stop:
+        return "stop price";
+    case PriceField::Trail:
+        return "trail amount";
+    case PriceField::TakeProfit:
+        return "take-profit price";
     }
-    return false;
+    return "price";
 }
 
-// Thread to handle user input
-void userInputThread(User *user, std::map<std::string, std::vector<double>> &closePricesMap,
-                     std::string &symbol, double &lastOrderPrice)
+void setPriceField(TradeCommand &command, PriceField field, double value)
 {
-    while (!stopSimulation)
+    switch (field)
     {
-        displayInputPrompt();
-
-        std::string action;
-        std::cin >> action;
-
-        {
-            std::lock_guard<std::mutex> consoleLock(consoleMutex);
-            std::cout << HIDE_CURSOR;
-            std::cout.flush();
-        }
-
-        // Convert action to lowercase
-        std::transform(action.begin(), action.end(), action.begin(), ::tolower);
+    case PriceField::Limit:
+        command.limitPrice = value;
+        break;
+    case PriceField::Stop:
+        command.stopPrice = value;
+        break;
+    case PriceField::Trail:
+        command.trailAmount = value;
+        break;
+    case PriceField::TakeProfit:
+        command.takeProfit = value;
+        break;
+    }
+}
 
-        if (action == "help")
-        {
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                moveCursor(2, 8);
-                std::cout << CLEAR_SCREEN;
-                moveCursor(2, 2);
-                std::cout << "Available commands:";
-                moveCursor(2, 3);
-                std::cout << "Buy - Buy a specified amount at the current market price.";
-                moveCursor(2, 4);
-                std::cout << "Sell - Sell a specified amount at the current market price.";
-                moveCursor(2, 5);
-                std::cout << "Limit_Buy - Place a limit buy order.";
-                moveCursor(2, 6);
-                std::cout << "Limit_Sell - Place a limit sell order.";
-                moveCursor(2, 7);
-                std::cout << "Cancel_Limit_Order - Cancel a pending limit order.";
-                moveCursor(2, 8);
-                std::cout << "Help - Display this help message.";
-                moveCursor(2, 9);
-                std::cout << "Return_Main_Menu - Return to the main menu to switch stock.";
-                moveCursor(2, 10);
-                std::cout << "Exit - Exit the trading simulator.";
-            }
-            // Re-display the input prompt
-            moveCursor(2, 7);
-            displayInputPrompt();
-            continue;
-        }
+namespace
+{
+    // Row and text of the command prompt
+    const int ACTION_PROMPT_LINE = 7;
+    const char *const ACTION_PROMPT = "Enter 'Buy', 'Sell', 'Limit_Buy', 'Limit_Sell', 'Stop_Sell', 'OCO_Sell', ..., 'Cancel_Limit_Order', 'Amend_Limit_Order', 'Help', 'Return_Main_Menu', or 'Exit': ";
 
-        if (action == "exit")
+    // A positive number, or false
+    bool parsePositive(const std::string &text, double &value)
+    {
+        try
         {
-            stopSimulation = true; // Signal to stop the simulation
-            break;
+            value = std::stod(text);
         }
-        else if (action == "return_main_menu")
+        catch (const std::exception &e)
         {
-            stopSimulation = true; // Signal to stop the simulation
-            changeStock = true;    // Indicate that the user wants to change stock
-            break;
+            return false;
         }
-        else if (action == "buy" || action == "sell" ||
-                 action == "limit_buy" || action == "limit_sell")
-        {
-            if (closePricesMap[symbol].empty())
-            {
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, 8);
-                    std::cout << CLEARLINE << "No price data available yet. Please wait...";
-                }
-                // Re-display the input prompt
-                moveCursor(2, 7);
-                displayInputPrompt();
-                continue;
-            }
-
-            double amount;
-            double limitPrice = 0.0;
-            bool isLimitOrder = false;
-
-            std::string amountStr;
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                moveCursor(2, 8);
-                std::cout << CLEARLINE << "Enter amount: ";
-                std::cout << SHOW_CURSOR;
-                std::cout.flush();
-            }
-            std::cin >> amountStr;
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                std::cout << HIDE_CURSOR;
-            }
-
-            try
-            {
-                amount = std::stod(amountStr);
-                if (amount <= 0)
-                {
-                    throw std::invalid_argument("Amount must be positive.");
-                }
-            }
-            catch (const std::exception &e)
-            {
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, 9);
-                    std::cout << CLEARLINE << "Invalid amount entered. Please enter a positive number.";
-                }
-                // Re-display the input prompt
-                moveCursor(2, 7);
-                displayInputPrompt();
-                continue;
-            }
-
-            // Check if it's a limit order
-            if (action.find("limit") != std::string::npos)
-            {
-                isLimitOrder = true;
-                std::string limitPriceStr;
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, 9);
-                    std::cout << CLEARLINE << "Enter limit price: ";
-                    std::cout << SHOW_CURSOR;
-                    std::cout.flush();
-                }
-                std::cin >> limitPriceStr;
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    std::cout << HIDE_CURSOR;
-                }
-
-                try
-                {
-                    limitPrice = std::stod(limitPriceStr);
-                    if (limitPrice <= 0)
-                    {
-                        throw std::invalid_argument("Limit price must be positive.");
-                    }
-                }
-                catch (const std::exception &e)
-                {
-                    {
-                        std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                        moveCursor(2, 10);
-                        std::cout << CLEARLINE << "Invalid limit price entered. Please enter a positive number.";
-                    }
-                    // Re-display the input prompt
-                    moveCursor(2, 7);
-                    displayInputPrompt();
-                    continue;
-                }
-            }
-
-            if (isLimitOrder)
-            {
-                if (action == "limit_buy")
-                {
-                    double transactionCost = amount * limitPrice;
-                    double estimatedBrokerFee = calculateBrokerFee(transactionCost);
-                    double totalCost = transactionCost + estimatedBrokerFee;
-
-                    // Validate funds for limit buy orders
-                    if (!hasSufficientFunds(user, totalCost))
-                    {
-                        {
-                            std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                            moveCursor(2, 10);
-                            std::cout << CLEARLINE << "Insufficient funds to place limit buy order including broker fee.";
-                        }
-                        // Re-display the input prompt
-                        moveCursor(2, 7);
-                        displayInputPrompt();
-                        continue; // Skip to next iteration
-                    }
-                }
-                else if (action == "limit_sell")
-                {
-                    // Validate holdings for limit sell orders
-                    if (!hasSufficientHoldings(user, symbol, amount))
-                    {
-                        {
-                            std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                            moveCursor(2, 10);
-                            std::cout << CLEARLINE << "Insufficient holdings to place limit sell order.";
-                        }
-                        // Re-display the input prompt
-                        moveCursor(2, 7);
-                        displayInputPrompt();
-                        continue; // Skip to next iteration
-                    }
-                }
-
-                // Create a limit order
-                User::Order newOrder;
-                newOrder.symbol = symbol;
-                newOrder.type = (action == "limit_buy") ? "Limit_Buy" : "Limit_Sell";
-                newOrder.amount = amount;
-                newOrder.limitPrice = limitPrice;
-
-                {
-                    std::lock_guard<std::mutex> dataLock(dataMutex);
-                    user->pendingOrders.push_back(newOrder);
-                }
-
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, 10);
-                    std::cout << CLEARLINE << newOrder.type << " order placed for " << amount << " of " << symbol << " at limit price INR " << limitPrice;
-                }
-
-                // Re-display the input prompt
-                moveCursor(2, 7);
-                displayInputPrompt();
-            }
-            else
-            {
-                double currentPrice;
-                {
-                    std::lock_guard<std::mutex> dataLock(dataMutex);
-                    currentPrice = closePricesMap[symbol].back();
-                }
-
-                if (action == "buy")
-                {
-                    double transactionCost = amount * currentPrice;
-                    double brokerFee = calculateBrokerFee(transactionCost);
-                    double totalCost = transactionCost + brokerFee;
+        return value > 0;
+    }
+}
 
-                    // Validate funds for buy orders
-                    if (!hasSufficientFunds(user, totalCost))
-                    {
-                        {
-                            std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                            moveCursor(2, 10);
-                            std::cout << CLEARLINE << "Insufficient funds to execute buy order including broker fee.";
-                        }
-                        // Re-display the input prompt
-                        moveCursor(2, 7);
-                        displayInputPrompt();
-                        continue; // Skip to next iteration
-                    }
+OrderEntry::OrderEntry(TradingEngine *engine, const std::string &symbol, std::atomic<size_t> &chartZoom, LineEditor &editor)
+    : engine(engine), symbolId(internSymbol(symbol)), chartZoom(chartZoom), editor(editor)
+{
+}
 
-                    // Market buy order execution
-                    {
-                        std::lock_guard<std::mutex> dataLock(dataMutex);
-                        user->demoMoney -= totalCost;
+void OrderEntry::start()
+{
+    promptAction();
+}
 
-                        // Update holdings
-                        bool found = false;
-                        for (auto &holding : user->holdings)
-                        {
-                            if (holding.symbol == symbol)
-                            {
-                                // Update average price
-                                holding.averagePrice = ((holding.averagePrice * holding.amount) + (currentPrice * amount)) / (holding.amount + amount);
-                                holding.amount += amount;
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found)
-                        {
-                            // Add new holding
-                            User::Holding newHolding;
-                            newHolding.symbol = symbol;
-                            newHolding.amount = amount;
-                            newHolding.averagePrice = currentPrice;
-                            user->holdings.push_back(newHolding);
-                        }
+void OrderEntry::promptAction()
+{
+    step = Step::Action;
+    line = ACTION_PROMPT_LINE;
+    editor.prompt(2, line, ACTION_PROMPT);
+}
 
-                        // Update transactions
-                        user->transactions.push_back({symbol, amount, currentPrice, std::string("Buy"), brokerFee});
-                    }
+void OrderEntry::ask(Step next, int promptLine, const std::string &prompt)
+{
+    step = next;
+    line = promptLine;
+    editor.prompt(2, line, prompt);
+}
 
-                    // After processing the order, set the lastOrderPrice to the current price
-                    {
-                        std::lock_guard<std::mutex> dataLock(dataMutex);
-                        lastOrderPrice = currentPrice; // Update the last order price
-                    }
+// Show a one-line message and re-display the command prompt
+void OrderEntry::showMessage(int messageLine, const std::string &message)
+{
+    {
+        std::lock_guard<std::mutex> consoleLock(consoleMutex);
+        moveCursor(2, messageLine);
+        std::cout << CLEARLINE << message;
+    }
+    promptAction();
+}
 
-                    {
-                        std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                        moveCursor(2, 9);
-                        std::cout << CLEARLINE << "Buy order placed for " << amount << " of " << symbol << " at INR " << currentPrice;
-                        moveCursor(2, 10);
-                        std::cout << CLEARLINE << "Broker Fee: INR " << brokerFee << ", Total Cost: INR " << totalCost;
-                    }
+void OrderEntry::showResult(const TradeResult &result)
+{
+    {
+        std::lock_guard<std::mutex> consoleLock(consoleMutex);
+        moveCursor(2, 9);
+        std::cout << CLEARLINE << result.message;
+        moveCursor(2, 10);
+        std::cout << CLEARLINE << result.detail;
+    }
+    editor.redraw();
+}
 
-                    // Re-display the input prompt
-                    moveCursor(2, 7);
-                    displayInputPrompt();
-                }
-                else if (action == "sell")
-                {
-                    // Validate holdings for sell orders
-                    if (!hasSufficientHoldings(user, symbol, amount))
-                    {
-                        {
-                            std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                            moveCursor(2, 10);
-                            std::cout << CLEARLINE << "Insufficient holdings to execute sell order.";
-                        }
-                        // Re-display the input prompt
-                        moveCursor(2, 7);
-                        displayInputPrompt();
-                        continue; // Skip to next iteration
-                    }
+void OrderEntry::showHelp()
+{
+    {
+        std::lock_guard<std::mutex> consoleLock(consoleMutex);
+        moveCursor(2, 8);
+        clearScreen(); // The portfolio panel is redrawn in full on its next frame
+        moveCursor(2, 2);
+        std::cout << "Available commands:";
+        moveCursor(2, 3);
+        std::cout << "Buy - Buy a specified amount at the current market price.";
+        moveCursor(2, 4);
+        std::cout << "Sell - Sell a specified amount at the current market price.";
+        moveCursor(2, 5);
+        std::cout << "Limit_Buy - Place a limit buy order.";
+        moveCursor(2, 6);
+        std::cout << "Limit_Sell - Place a limit sell order.";
+        moveCursor(2, 7);
+        std::cout << "Stop_Buy / Stop_Sell - Buy or sell at market once the price reaches a stop price.";
+        moveCursor(2, 8);
+        std::cout << "Stop_Limit_Buy / Stop_Limit_Sell - Place a limit order once the price reaches a stop price.";
+        moveCursor(2, 9);
+        std::cout << "Trailing_Stop_Buy / Trailing_Stop_Sell - A stop that follows the best price by a trail amount.";
+        moveCursor(2, 10);
+        std::cout << "OCO_Buy / OCO_Sell - A limit and a stop order; when one executes the other is canceled.";
+        moveCursor(2, 11);
+        std::cout << "Bracket_Buy / Bracket_Sell - A limit entry that places take-profit and stop-loss exits once filled.";
+        moveCursor(2, 12);
+        std::cout << "Cancel_Limit_Order - Cancel a pending order by its ID.";
+        moveCursor(2, 13);
+        std::cout << "Amend_Limit_Order - Change the amount or limit price of a pending limit order.";
+        moveCursor(2, 14);
+        std::cout << "Zoom_Out / Zoom_In - Show more or less of the chart's history, from 50 candles to 30 days.";
+        moveCursor(2, 15);
+        std::cout << "Help - Display this help message.";
+        moveCursor(2, 16);
+        std::cout << "Return_Main_Menu - Return to the main menu to switch stock.";
+        moveCursor(2, 17);
+        std::cout << "Exit - Exit the trading simulator.";
+    }
+    promptAction();
+}
 
-                    double transactionValue = amount * currentPrice;
-                    double brokerFee = calculateBrokerFee(transactionValue);
-                    double netProceeds = transactionValue - brokerFee;
+void OrderEntry::submitCommand()
+{
+    // Hand the command to the engine; the result is reported asynchronously
+    command.submitted = std::chrono::steady_clock::now();
+    engine->submit(command);
+    promptAction();
+}
 
-                    // Market sell order execution
-                    {
-                        std::lock_guard<std::mutex> dataLock(dataMutex);
-                        user->demoMoney += netProceeds;
+bool OrderEntry::onToken(std::string token)
+{
+    switch (step)
+    {
+    case Step::Action:
+        // Convert action to lowercase
+        std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+        return onAction(token);
 
-                        // Update holdings
-                        for (auto it = user->holdings.begin(); it != user->holdings.end(); ++it)
-                        {
-                            if (it->symbol == symbol)
-                            {
-                                it->amount -= amount;
-                                if (it->amount <= 0)
-                                {
-                                    // Remove holding from vector
-                                    it = user->holdings.erase(it);
-                                }
-                                // No need to update 'it' because we break immediately
-                                break;
-                            }
-                        }
+    case Step::Amount:
+        if (!parsePositive(token, command.amount))
+        {
+            showMessage(9, "Invalid amount entered. Please enter a positive number.");
+            break;
+        }
+        nextField = 0;
+        onPrice(std::string());
+        break;
 
-                        // Update transactions
-                        user->transactions.push_back({symbol, amount, currentPrice, std::string("Sell"), brokerFee});
-                    }
+    case Step::Price:
+        onPrice(token);
+        break;
 
-                    // After processing the order, set the lastOrderPrice to the current price
-                    {
-                        std::lock_guard<std::mutex> dataLock(dataMutex);
-                        lastOrderPrice = currentPrice; // Update the last order price
-                    }
+    case Step::OrderId:
+    {
+        // Accept both "12" and "#12"
+        if (!token.empty() && token[0] == '#')
+            token.erase(0, 1);
+        try
+        {
+            command.orderId = std::stoull(token);
+        }
+        catch (const std::exception &e)
+        {
+            showMessage(9, "Invalid order ID.");
+            break;
+        }
+        command.type = CommandType::CancelOrder;
+        if (amending)
+            ask(Step::NewAmount, 9, "Enter new amount: ");
+        else
+            submitCommand();
+        break;
+    }
 
-                    {
-                        std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                        moveCursor(2, 9);
-                        std::cout << CLEARLINE << "Sell order executed for " << amount << " of " << symbol << " at INR " << currentPrice;
-                        moveCursor(2, 10);
-                        std::cout << CLEARLINE << "Broker Fee: INR " << brokerFee << ", Net Proceeds: INR " << netProceeds;
-                    }
+    case Step::NewAmount:
+        newAmount = token;
+        ask(Step::NewLimitPrice, 10, "Enter new limit price: ");
+        break;
 
-                    // Re-display the input prompt
-                    moveCursor(2, 7);
-                    displayInputPrompt();
-                }
-            }
-        }
-        else if (action == "cancel_limit_order")
+    case Step::NewLimitPrice:
+        if (!parsePositive(newAmount, command.amount) || !parsePositive(token, command.limitPrice))
         {
-            bool hasOrders = false;
-            std::vector<User::Order> ordersCopy;
+            showMessage(11, "Invalid amount or limit price. Please enter positive numbers.");
+            break;
+        }
+        command.type = CommandType::AmendOrder;
+        submitCommand();
+        break;
+    }
+    return true;
+}
 
-            // Check if there are pending orders and make a copy
-            {
-                std::lock_guard<std::mutex> dataLock(dataMutex);
-                hasOrders = !user->pendingOrders.empty();
-                if (hasOrders)
-                {
-                    ordersCopy = user->pendingOrders; // Copy the orders
-                }
-            }
+// Limit, stop, trail and take-profit prices, as the order type needs them; an
+// empty token asks for the first
+void OrderEntry::onPrice(const std::string &token)
+{
+    if (!token.empty())
+    {
+        PriceField field = priceFields[nextField];
+        double value = 0.0;
+        if (!parsePositive(token, value))
+        {
+            showMessage(line + 1, std::string("Invalid ") + priceFieldName(field) + " entered. Please enter a positive number.");
+            return;
+        }
+        setPriceField(command, field, value);
+        ++nextField;
+    }
 
-            if (!hasOrders)
-            {
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, 8);
-                    std::cout << CLEARLINE << "No pending limit orders to cancel.";
-                }
-                // Re-display the input prompt
-                moveCursor(2, 7);
-                displayInputPrompt();
-                continue;
-            }
+    if (nextField < priceFields.size())
+    {
+        int nextLine = (step == Step::Amount) ? 9 : line + 1;
+        ask(Step::Price, nextLine, std::string("Enter ") + priceFieldName(priceFields[nextField]) + ": ");
+        return;
+    }
+    submitCommand();
+}
 
-            // Display pending limit orders with indices
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                moveCursor(2, 8);
-                std::cout << CLEARLINE << "Your Pending Limit Orders:";
-            }
-            int index = 1;
-            int displayLine = 9;
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                for (const auto &order : ordersCopy)
-                {
-                    moveCursor(2, displayLine++);
-                    std::cout << CLEARLINE << index << ". " << order.symbol << " - " << order.type << " - Amount: " << order.amount << ", Limit Price: INR " << order.limitPrice;
-                    index++;
-                }
-                moveCursor(2, displayLine);
-                std::cout << CLEARLINE << "Enter the number of the order you wish to cancel: ";
-                std::cout << SHOW_CURSOR;
-                std::cout.flush();
-            }
-            std::vector<User::Order>::size_type cancelIndex;
-            std::cin >> cancelIndex;
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                std::cout << HIDE_CURSOR;
-            }
+bool OrderEntry::onAction(const std::string &action)
+{
+    command = TradeCommand{CommandType::MarketBuy, symbolId, 0.0, 0.0, 0, 0, {}};
+    priceFields.clear();
 
-            if (cancelIndex >= 1 && cancelIndex <= ordersCopy.size())
-            {
-                // Remove the selected order
-                {
-                    std::lock_guard<std::mutex> dataLock(dataMutex);
-                    if (cancelIndex <= user->pendingOrders.size())
-                    {
-                        user->pendingOrders.erase(user->pendingOrders.begin() + cancelIndex - 1);
-                    }
-                }
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, displayLine + 1);
-                    std::cout << CLEARLINE << "Limit order #" << cancelIndex << " has been canceled.";
-                }
-            }
-            else
-            {
-                {
-                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                    moveCursor(2, displayLine + 1);
-                    std::cout << CLEARLINE << "Invalid order number.";
-                }
-            }
+    if (action == "help")
+    {
+        showHelp();
+    }
+    else if (action == "zoom_in" || action == "zoom_out")
+    {
+        // The trading view redraws the chart at the new range straight away
+        chartZoom = zoomChart(chartZoom, action == "zoom_out");
+        showMessage(8, std::string("Chart range: ") + CHART_ZOOM_LEVELS[chartZoom].label);
+    }
+    else if (action == "exit")
+    {
+        stopSimulation = true; // Signal to stop the simulation
+        return false;
+    }
+    else if (action == "return_main_menu")
+    {
+        stopSimulation = true; // Signal to stop the simulation
+        changeStock = true;    // Indicate that the user wants to change stock
+        return false;
+    }
+    else if (lookupOrderAction(action, command.type, priceFields))
+    {
+        ask(Step::Amount, 8, "Enter amount: ");
+    }
+    else if (action == "cancel_limit_order" || action == "amend_limit_order")
+    {
+        amending = (action == "amend_limit_order");
 
-            // Re-display the input prompt
-            moveCursor(2, 7);
-            displayInputPrompt();
-        }
-        else
-        {
-            {
-                std::lock_guard<std::mutex> consoleLock(consoleMutex);
-                moveCursor(2, 9);
-                std::cout << CLEARLINE << "Invalid input. Please enter 'Buy', 'Sell', 'Limit_Buy', 'Limit_Sell', 'Cancel_Limit_Order', 'Help', 'Return_Main_Menu', or 'Exit'.";
-            }
-            // Re-display the input prompt
-            moveCursor(2, 7);
-            displayInputPrompt();
-        }
+        // Orders are listed with their IDs in the portfolio panel
+        ask(Step::OrderId, 8, std::string("Enter the ID of the order you wish to ") + (amending ? "amend" : "cancel") +
+                                  " (see Pending Orders): ");
     }
-}
\ No newline at end of file
+    else
+    {
+        showMessage(9, "Invalid input. Please enter 'Buy', 'Sell', 'Limit_Buy', 'Limit_Sell', a stop, OCO or bracket order, 'Cancel_Limit_Order', 'Amend_Limit_Order', 'Zoom_In', 'Zoom_Out', 'Help', 'Return_Main_Menu', or 'Exit'.");
+    }
+    return true;
+}
@@ -0,0 +1,972 @@
+// src/trading_engine.cpp
+
+#include "utils.h"
+#include "trading_engine.h"
+#include "trading.h"
+#include "market_data.h"
+
+namespace
+{
+    // Holdings are marked to the latest prices on this cadence
+    const auto MARK_INTERVAL = std::chrono::seconds(1);
+
+    // Book events applied per account-lock hold, so readers are not starved
+    const size_t EVENT_BATCH = 256;
+
+    // A buy cut down below this by a funds shortfall does not execute at all
+    const double AMOUNT_EPSILON = 1e-9;
+
+    std::string formatOrderMessage(const std::string &prefix, double amount, const std::string &symbol, const std::string &suffix, double price)
+    {
+        std::ostringstream oss;
+        oss << prefix << amount << " of " << symbol << suffix << price;
+        return oss.str();
+    }
+
+    // Cash a resting limit buy ties up: its full value plus the fee on it
+    double cashReservation(double amount, double limitPrice)
+    {
+        double transactionCost = amount * limitPrice;
+        return transactionCost + calculateBrokerFee(transactionCost);
+    }
+
+    std::string unknownOrderMessage(uint64_t orderId)
+    {
+        std::ostringstream oss;
+        oss << "Invalid order ID #" << orderId << " (unknown or already executed).";
+        return oss.str();
+    }
+
+    // Cash a pending buy holds back: at its limit price, or at its stop
+    // trigger for stop-market and trailing buys (a trailing buy's stop only
+    // falls). A fill that gaps past the stop is capped to the cash available.
+    double cashHeld(const User::Order &order)
+    {
+        if (!isBuyOrder(order))
+            return 0.0;
+        if (isStopOrder(order) && !isStopLimitOrder(order))
+            return cashReservation(order.amount, order.stopPrice);
+        return cashReservation(order.amount, order.limitPrice);
+    }
+
+    double sharesHeld(const User::Order &order)
+    {
+        return isBuyOrder(order) ? 0.0 : order.amount;
+    }
+
+    // "Stop_Limit_Sell" -> "stop limit sell"
+    std::string describeType(const std::string &type)
+    {
+        std::string description = type;
+        std::transform(description.begin(), description.end(), description.begin(), [](char c)
+                       { return c == '_' ? ' ' : static_cast<char>(::tolower(c)); });
+        return description;
+    }
+
+    BookCommand addCommandFor(const User::Order &order, AccountId account)
+    {
+        Side side = isBuyOrder(order) ? Side::Buy : Side::Sell;
+        BookCommand command{BookCommand::Add, internSymbol(order.symbol), account, order.id, 0, side, order.amount, order.limitPrice};
+        if (isTrailingOrder(order))
+            command.orderType = BookOrderType::TrailingStop;
+        else if (isStopLimitOrder(order))
+            command.orderType = BookOrderType::StopLimit;
+        else if (isStopOrder(order))
+            command.orderType = BookOrderType::StopMarket;
+        command.stopPrice = order.stopPrice;
+        command.trailAmount = order.trailAmount;
+        command.linkedOrderId = order.linkedId;
+        return command;
+    }
+}
+
+TradingEngine::TradingEngine(User *user, size_t queueCapacity)
+    : user(user), commands(queueCapacity), bookEvents(queueCapacity)
+{
+    publishPortfolio();
+}
+
+TradingEngine::~TradingEngine()
+{
+    stop();
+}
+
+void TradingEngine::setResultListener(ResultListener newListener)
+{
+    listener = std::move(newListener);
+}
+
+void TradingEngine::start()
+{
+    if (running.exchange(true))
+        return;
+
+    // Book events arrive on shard threads and are handed to the engine thread
+    acceptingEvents.store(true, std::memory_order_release);
+    bookAccount = matchingEngine.registerAccount([this](const BookEvent &event)
+                                                 {
+                                                     while (!bookEvents.tryPush(event))
+                                                     {
+                                                         if (!acceptingEvents.load(std::memory_order_acquire))
+                                                             return;
+                                                         std::this_thread::yield();
+                                                     }
+                                                     wakeup.notify(); });
+    engineThread = std::thread(&TradingEngine::run, this);
+}
+
+void TradingEngine::stop()
+{
+    if (!running.exchange(false))
+        return;
+    wakeup.wakeAlways();
+    if (engineThread.joinable())
+        engineThread.join();
+
+    acceptingEvents.store(false, std::memory_order_release);
+    matchingEngine.unregisterAccount(bookAccount);
+    bookAccount = LIQUIDITY_PROVIDER;
+}
+
+bool TradingEngine::trySubmit(const TradeCommand &command)
+{
+    if (!commands.tryPush(command))
+        return false;
+    wakeup.notify();
+    return true;
+}
+
+void TradingEngine::submit(const TradeCommand &command)
+{
+    while (!trySubmit(command))
+    {
+        std::this_thread::yield(); // Queue full: wait for the engine to catch up
+    }
+}
+
+void TradingEngine::publish(std::vector<TradeResult> &results)
+{
+    auto completed = std::chrono::steady_clock::now();
+    for (auto &result : results)
+    {
+        result.completed = completed;
+        if (listener)
+            listener(result);
+    }
+    results.clear();
+}
+
+void TradingEngine::run()
+{
+    resubmitPendingOrders();
+    publishPortfolio();
+
+    auto nextMark = std::chrono::steady_clock::now() + MARK_INTERVAL;
+    std::vector<TradeResult> results;
+    TradeCommand command;
+
+    for (;;)
+    {
+        // Apply every queued command in arrival order
+        bool didWork = false;
+        while (commands.tryPop(command))
+        {
+            {
+                std::lock_guard<std::mutex> accountGuard(accountLock);
+                apply(command, results);
+            }
+            publish(results);
+            didWork = true;
+        }
+
+        if (drainBookEvents(results))
+            didWork = true;
+
+        bool marked = false;
+        if (std::chrono::steady_clock::now() >= nextMark)
+        {
+            markHoldings();
+            nextMark += MARK_INTERVAL;
+            marked = true;
+        }
+
+        // One snapshot per pass, however many commands and fills it applied
+        if (didWork || marked)
+            publishPortfolio();
+
+        if (!running.load(std::memory_order_acquire))
+        {
+            if (commands.size() == 0)
+                break;
+            continue;
+        }
+        if (didWork)
+            continue;
+
+        // Nothing queued: sleep until the next mark or a producer wakes us
+        wakeup.waitUntil(nextMark, [&]
+                         { return commands.size() != 0 || bookEvents.size() != 0 || !running.load(std::memory_order_acquire); });
+    }
+
+    withdrawFromBook();
+    publishPortfolio();
+}
+
+bool TradingEngine::drainBookEvents(std::vector<TradeResult> &results)
+{
+    bool didWork = false;
+    for (;;)
+    {
+        size_t applied = 0;
+        {
+            std::lock_guard<std::mutex> accountGuard(accountLock);
+            BookEvent event;
+            while (applied < EVENT_BATCH)
+            {
+                if (!deferredEvents.empty())
+                {
+                    event = deferredEvents.front();
+                    deferredEvents.pop_front();
+                }
+                else if (!bookEvents.tryPop(event))
+                {
+                    break;
+                }
+                applyBookEvent(event, results);
+                ++applied;
+            }
+        }
+        publish(results);
+        if (applied == 0)
+            return didWork;
+        didWork = true;
+    }
+}
+
+bool TradingEngine::submitToBook(const BookCommand &command)
+{
+    // A full shard queue may be waiting on our own event queue, so keep
+    // draining events (for later) rather than blocking on the shard
+    while (!matchingEngine.trySubmit(command))
+    {
+        if (!matchingEngine.isRunning())
+            return false;
+        BookEvent event;
+        if (bookEvents.tryPop(event))
+            deferredEvents.push_back(event);
+        else
+            std::this_thread::yield();
+    }
+    return true;
+}
+
+void TradingEngine::resubmitPendingOrders()
+{
+    // Orders restored from disk go back into the book in their saved priority order
+    std::lock_guard<std::mutex> accountGuard(accountLock);
+    reservedCash = 0.0;
+    reservedShares.clear();
+    for (const auto &order : user->pendingOrders)
+    {
+        if (carriesReservation(order))
+            reserve(order, 1.0);
+        submitToBook(addCommandFor(order, bookAccount));
+    }
+}
+
+void TradingEngine::withdrawFromBook()
+{
+    // Pull every resting order out of the shared book but keep it in
+    // pendingOrders, so it is saved and re-entered next session. Fills that
+    // race with the withdrawal are still applied before we return.
+    {
+        std::lock_guard<std::mutex> accountGuard(accountLock);
+        for (const auto &order : user->pendingOrders)
+        {
+            BookCommand cancel{BookCommand::Cancel, internSymbol(order.symbol), bookAccount, order.id, nextBookRequest, Side::Buy, 0.0, 0.0};
+            if (!submitToBook(cancel))
+                break;
+            pendingRequests[nextBookRequest++] = PendingRequest{TradeCommand{}, true, 0.0, 0.0};
+            ++withdrawalsOutstanding;
+        }
+    }
+
+    std::vector<TradeResult> results;
+    while (withdrawalsOutstanding > 0 && matchingEngine.isRunning())
+    {
+        if (!drainBookEvents(results))
+        {
+            wakeup.waitUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(10), [&]
+                             { return bookEvents.size() != 0; });
+        }
+    }
+    pendingRequests.clear();
+    withdrawalsOutstanding = 0;
+}
+
+double TradingEngine::latestPrice(SymbolId symbolId)
+{
+    return symbolMarket(symbolId).latest.read().price; // 0 before the first tick
+}
+
+void TradingEngine::reserve(const User::Order &order, double sign)
+{
+    // A one-cancels-other pair can only ever execute one leg, so the pair
+    // holds the larger leg's cash or shares once
+    double cash = cashHeld(order);
+    double shares = sharesHeld(order);
+    const User::Order *sibling = order.linkedId ? user->pendingOrders.find(order.linkedId) : nullptr;
+    if (sibling != nullptr)
+    {
+        cash = std::max(cash, cashHeld(*sibling));
+        shares = std::max(shares, sharesHeld(*sibling));
+    }
+
+    reservedCash += sign * cash;
+    if (shares > 0.0)
+        reservedShares[internSymbol(order.symbol)] += sign * shares;
+}
+
+bool TradingEngine::carriesReservation(const User::Order &order)
+{
+    // The lower ID of a live pair holds the pair's reservation
+    return order.linkedId == 0 || order.id < order.linkedId || user->pendingOrders.find(order.linkedId) == nullptr;
+}
+
+bool TradingEngine::canReserve(const User::Order &order, const User::Order *sibling, std::string &error)
+{
+    double cash = cashHeld(order);
+    double shares = sharesHeld(order);
+    if (sibling != nullptr)
+    {
+        cash = std::max(cash, cashHeld(*sibling));
+        shares = std::max(shares, sharesHeld(*sibling));
+    }
+
+    SymbolId symbolId = internSymbol(order.symbol);
+    if (cash > 0.0 && !hasSufficientFunds(user, cash + reservedCash))
+    {
+        error = "Insufficient funds to place " + describeType(order.type) + " order including broker fee.";
+        return false;
+    }
+    if (shares > 0.0 && !hasSufficientHoldings(user, symbolId, shares + sharesOnOffer(symbolId)))
+    {
+        error = "Insufficient holdings to place " + describeType(order.type) + " order.";
+        return false;
+    }
+    return true;
+}
+
+uint64_t TradingEngine::placeOrder(const User::Order &order, const User::Order *sibling)
+{
+    uint64_t orderId = user->pendingOrders.add(order);
+    if (sibling != nullptr)
+    {
+        uint64_t siblingId = user->pendingOrders.add(*sibling);
+        user->pendingOrders.find(orderId)->linkedId = siblingId;
+        user->pendingOrders.find(siblingId)->linkedId = orderId;
+    }
+
+    const User::Order &placed = *user->pendingOrders.find(orderId);
+    reserve(placed, 1.0);
+    submitToBook(addCommandFor(placed, bookAccount));
+    if (placed.linkedId != 0)
+        submitToBook(addCommandFor(*user->pendingOrders.find(placed.linkedId), bookAccount));
+    return orderId;
+}
+
+void TradingEngine::removeOrder(uint64_t orderId)
+{
+    User::Order *order = user->pendingOrders.find(orderId);
+    if (order == nullptr)
+        return;
+
+    uint64_t siblingId = order->linkedId;
+    reserve(*order, -1.0);
+    user->pendingOrders.cancel(orderId);
+
+    // A surviving sibling now stands alone and holds its own reservation
+    User::Order *sibling = siblingId ? user->pendingOrders.find(siblingId) : nullptr;
+    if (sibling != nullptr)
+    {
+        sibling->linkedId = 0;
+        reserve(*sibling, 1.0);
+    }
+}
+
+void TradingEngine::activateBracket(const User::Order &entry, std::vector<TradeResult> &results)
+{
+    // The filled part of the entry gets a take-profit limit and a stop-loss,
+    // one cancelling the other
+    bool exitBuy = !isBuyOrder(entry);
+    User::Order takeProfit;
+    takeProfit.symbol = entry.symbol;
+    takeProfit.type = exitBuy ? "Limit_Buy" : "Limit_Sell";
+    takeProfit.amount = entry.filled;
+    takeProfit.limitPrice = entry.takeProfit;
+
+    User::Order stopLoss;
+    stopLoss.symbol = entry.symbol;
+    stopLoss.type = exitBuy ? "Stop_Buy" : "Stop_Sell";
+    stopLoss.amount = entry.filled;
+    stopLoss.limitPrice = 0.0;
+    stopLoss.stopPrice = entry.stopPrice;
+
+    TradeResult result{0, exitBuy ? CommandType::OcoBuy : CommandType::OcoSell, false, false, entry.id, "", "", {}, {}};
+    std::ostringstream oss;
+    std::string error;
+    if (!canReserve(takeProfit, &stopLoss, error))
+    {
+        oss << "Bracket order #" << entry.id << ": exit orders not placed. " << error;
+    }
+    else
+    {
+        result.orderId = placeOrder(takeProfit, &stopLoss);
+        result.accepted = true;
+        oss << "Bracket order #" << entry.id << " filled; take-profit #" << result.orderId << " at INR " << entry.takeProfit
+            << " and stop-loss #" << user->pendingOrders.find(result.orderId)->linkedId << " at INR " << entry.stopPrice << " placed";
+    }
+    result.message = oss.str();
+    results.push_back(result);
+}
+
+double TradingEngine::sharesOnOffer(SymbolId symbolId)
+{
+    auto it = reservedShares.find(symbolId);
+    return (it == reservedShares.end()) ? 0.0 : it->second;
+}
+
+void TradingEngine::apply(const TradeCommand &command, std::vector<TradeResult> &results)
+{
+    TradeResult result{command.requestId, command.type, false, false, command.orderId, "", "", command.submitted, {}};
+    const std::string &symbol = symbolName(command.symbolId);
+
+    switch (command.type)
+    {
+    case CommandType::MarketBuy:
+    case CommandType::MarketSell:
+    {
+        // Market orders trade immediately against the synthetic price
+        double currentPrice = latestPrice(command.symbolId);
+        if (currentPrice <= 0.0)
+        {
+            result.message = "No price data available yet. Please wait...";
+            break;
+        }
+
+        double transactionValue = command.amount * currentPrice;
+        double brokerFee = calculateBrokerFee(transactionValue);
+        std::ostringstream detail;
+
+        if (command.type == CommandType::MarketBuy)
+        {
+            double totalCost = transactionValue + brokerFee;
+            // Validate funds for buy orders; cash held by resting limit buys is not available
+            if (!hasSufficientFunds(user, totalCost + reservedCash))
+            {
+                result.message = "Insufficient funds to execute buy order including broker fee.";
+                break;
+            }
+
+            user->demoMoney -= totalCost;
+            user->holdings.buy(command.symbolId, command.amount, currentPrice);
+            user->transactions.push_back({symbol, command.amount, currentPrice, std::string("Buy"), brokerFee});
+
+            result.message = formatOrderMessage("Buy order placed for ", command.amount, symbol, " at INR ", currentPrice);
+            detail << "Broker Fee: INR " << brokerFee << ", Total Cost: INR " << totalCost;
+        }
+        else
+        {
+            // Validate holdings for sell orders; shares offered by resting limit sells are not available
+            if (!hasSufficientHoldings(user, command.symbolId, command.amount + sharesOnOffer(command.symbolId)))
+            {
+                result.message = "Insufficient holdings to execute sell order.";
+                break;
+            }
+
+            double netProceeds = transactionValue - brokerFee;
+            user->demoMoney += netProceeds;
+            user->holdings.sell(command.symbolId, command.amount, currentPrice);
+            user->transactions.push_back({symbol, command.amount, currentPrice, std::string("Sell"), brokerFee});
+
+            result.message = formatOrderMessage("Sell order executed for ", command.amount, symbol, " at INR ", currentPrice);
+            detail << "Broker Fee: INR " << brokerFee << ", Net Proceeds: INR " << netProceeds;
+        }
+
+        lastPrice.store(currentPrice, std::memory_order_relaxed);
+        result.accepted = true;
+        result.filled = true;
+        result.detail = detail.str();
+        break;
+    }
+
+    case CommandType::LimitBuy:
+    case CommandType::LimitSell:
+    case CommandType::StopBuy:
+    case CommandType::StopSell:
+    case CommandType::StopLimitBuy:
+    case CommandType::StopLimitSell:
+    case CommandType::TrailingStopBuy:
+    case CommandType::TrailingStopSell:
+    case CommandType::OcoBuy:
+    case CommandType::OcoSell:
+    case CommandType::BracketBuy:
+    case CommandType::BracketSell:
+    {
+        if (!matchingEngine.isRunning())
+        {
+            result.message = "Limit orders are unavailable: the matching engine is not running.";
+            break;
+        }
+
+        // Build the order (and, for OCO, its stop leg)
+        User::Order newOrder;
+        newOrder.symbol = symbol;
+        newOrder.amount = command.amount;
+        newOrder.limitPrice = command.limitPrice;
+        User::Order stopLeg;
+        bool hasStopLeg = false;
+        std::ostringstream oss;
+
+        switch (command.type)
+        {
+        case CommandType::LimitBuy:
+        case CommandType::LimitSell:
+            newOrder.type = (command.type == CommandType::LimitBuy) ? "Limit_Buy" : "Limit_Sell";
+            break;
+        case CommandType::StopBuy:
+        case CommandType::StopSell:
+            newOrder.type = (command.type == CommandType::StopBuy) ? "Stop_Buy" : "Stop_Sell";
+            newOrder.limitPrice = 0.0;
+            newOrder.stopPrice = command.stopPrice;
+            break;
+        case CommandType::StopLimitBuy:
+        case CommandType::StopLimitSell:
+            newOrder.type = (command.type == CommandType::StopLimitBuy) ? "Stop_Limit_Buy" : "Stop_Limit_Sell";
+            newOrder.stopPrice = command.stopPrice;
+            break;
+        case CommandType::TrailingStopBuy:
+        case CommandType::TrailingStopSell:
+        {
+            // The initial stop sits the trail away from the current price
+            double currentPrice = latestPrice(command.symbolId);
+            if (currentPrice <= 0.0)
+            {
+                result.message = "No price data available yet. Please wait...";
+                break;
+            }
+            bool buy = (command.type == CommandType::TrailingStopBuy);
+            newOrder.type = buy ? "Trailing_Stop_Buy" : "Trailing_Stop_Sell";
+            newOrder.limitPrice = 0.0;
+            newOrder.trailAmount = command.trailAmount;
+            newOrder.stopPrice = buy ? currentPrice + command.trailAmount : std::max(0.0, currentPrice - command.trailAmount);
+            break;
+        }
+        case CommandType::OcoBuy:
+        case CommandType::OcoSell:
+        {
+            bool buy = (command.type == CommandType::OcoBuy);
+            if (buy ? command.limitPrice >= command.stopPrice : command.limitPrice <= command.stopPrice)
+            {
+                result.message = buy ? "For OCO_Buy the limit price must be below the stop price."
+                                     : "For OCO_Sell the limit price must be above the stop price.";
+                break;
+            }
+            newOrder.type = buy ? "Limit_Buy" : "Limit_Sell";
+            stopLeg.symbol = symbol;
+            stopLeg.type = buy ? "Stop_Buy" : "Stop_Sell";
+            stopLeg.amount = command.amount;
+            stopLeg.limitPrice = 0.0;
+            stopLeg.stopPrice = command.stopPrice;
+            hasStopLeg = true;
+            break;
+        }
+        case CommandType::BracketBuy:
+        case CommandType::BracketSell:
+        {
+            bool buy = (command.type == CommandType::BracketBuy);
+            bool ordered = buy ? (command.takeProfit > command.limitPrice && command.limitPrice > command.stopPrice)
+                               : (command.takeProfit < command.limitPrice && command.limitPrice < command.stopPrice);
+            if (!ordered)
+            {
+                result.message = buy ? "For Bracket_Buy use take profit > entry limit > stop loss."
+                                     : "For Bracket_Sell use take profit < entry limit < stop loss.";
+                break;
+            }
+            newOrder.type = buy ? "Bracket_Buy" : "Bracket_Sell";
+            newOrder.stopPrice = command.stopPrice;
+            newOrder.takeProfit = command.takeProfit;
+            break;
+        }
+        default:
+            break;
+        }
+        if (!result.message.empty())
+            break;
+
+        std::string error;
+        if (!canReserve(newOrder, hasStopLeg ? &stopLeg : nullptr, error))
+        {
+            result.message = error;
+            break;
+        }
+
+        // Report the placement before any fills it triggers
+        result.orderId = placeOrder(newOrder, hasStopLeg ? &stopLeg : nullptr);
+        if (hasStopLeg)
+        {
+            oss << "OCO orders #" << result.orderId << " (limit INR " << command.limitPrice << ") and #"
+                << user->pendingOrders.find(result.orderId)->linkedId << " (stop INR " << command.stopPrice
+                << ") placed for " << command.amount << " of " << symbol;
+        }
+        else
+        {
+            oss << newOrder.type << " order #" << result.orderId << " placed for " << command.amount << " of " << symbol;
+            if (isTrailingOrder(newOrder))
+                oss << ", trailing by INR " << newOrder.trailAmount << " (stop now INR " << newOrder.stopPrice << ")";
+            else if (isStopLimitOrder(newOrder))
+                oss << ", stop INR " << newOrder.stopPrice << ", limit INR " << newOrder.limitPrice;
+            else if (isStopOrder(newOrder))
+                oss << " at stop price INR " << newOrder.stopPrice;
+            else
+                oss << " at limit price INR " << command.limitPrice;
+            if (isBracketOrder(newOrder))
+                oss << ", take profit INR " << newOrder.takeProfit << ", stop loss INR " << newOrder.stopPrice;
+        }
+        result.message = oss.str();
+        result.accepted = true;
+        results.push_back(result);
+        return;
+    }
+
+    case CommandType::CancelOrder:
+    {
+        const User::Order *order = user->pendingOrders.find(command.orderId);
+        if (order == nullptr)
+        {
+            result.message = unknownOrderMessage(command.orderId);
+            break;
+        }
+
+        // The book acknowledges the cancel; the result is reported from applyBookEvent()
+        BookCommand cancel{BookCommand::Cancel, internSymbol(order->symbol), bookAccount, command.orderId, nextBookRequest, Side::Buy, 0.0, 0.0};
+        if (!submitToBook(cancel))
+        {
+            result.message = "Limit orders are unavailable: the matching engine is not running.";
+            break;
+        }
+        pendingRequests[nextBookRequest++] = PendingRequest{command, false, 0.0, 0.0};
+        return;
+    }
+
+    case CommandType::AmendOrder:
+    {
+        const User::Order *order = user->pendingOrders.find(command.orderId);
+        if (order == nullptr)
+        {
+            result.message = unknownOrderMessage(command.orderId);
+            break;
+        }
+
+        if (!(command.amount > 0) || !(command.limitPrice > 0))
+        {
+            result.message = "The amended amount and limit price must be positive.";
+            break;
+        }
+
+        if (isStopOrder(*order) || order->linkedId != 0)
+        {
+            result.message = "Only limit and bracket orders can be amended; cancel and re-enter stop and OCO orders.";
+            break;
+        }
+
+        // Re-validate the amended order the same way a new one is validated;
+        // the order's own reservation counts towards it
+        double heldCash = 0.0;
+        double heldShares = 0.0;
+        if (isBuyOrder(*order))
+        {
+            heldCash = std::max(0.0, cashReservation(command.amount, command.limitPrice) - cashReservation(order->amount, order->limitPrice));
+            if (!hasSufficientFunds(user, heldCash + reservedCash))
+            {
+                result.message = "Insufficient funds for the amended order.";
+                break;
+            }
+        }
+        else
+        {
+            heldShares = std::max(0.0, command.amount - order->amount);
+            if (!hasSufficientHoldings(user, order->symbol, heldShares + sharesOnOffer(internSymbol(order->symbol))))
+            {
+                result.message = "Insufficient holdings for the amended order.";
+                break;
+            }
+        }
+
+        Side side = isBuyOrder(*order) ? Side::Buy : Side::Sell;
+        SymbolId symbolId = internSymbol(order->symbol);
+        BookCommand amend{BookCommand::Amend, symbolId, bookAccount, command.orderId, nextBookRequest, side, command.amount, command.limitPrice};
+        if (!submitToBook(amend))
+        {
+            result.message = "Limit orders are unavailable: the matching engine is not running.";
+            break;
+        }
+
+        // Hold any increase until the book acknowledges the amend
+        reservedCash += heldCash;
+        reservedShares[symbolId] += heldShares;
+        pendingRequests[nextBookRequest++] = PendingRequest{command, false, heldCash, heldShares};
+        return;
+    }
+    }
+
+    results.push_back(result);
+}
+
+void TradingEngine::applyBookEvent(const BookEvent &event, std::vector<TradeResult> &results)
+{
+    // Acknowledgements carry the request that asked for them
+    PendingRequest request{TradeCommand{}, false, 0.0, 0.0};
+    if (event.requestId != 0)
+    {
+        auto it = pendingRequests.find(event.requestId);
+        if (it == pendingRequests.end())
+            return;
+        request = it->second;
+        pendingRequests.erase(it);
+        if (request.withdrawal)
+            --withdrawalsOutstanding;
+
+        reservedCash -= request.heldCash;
+        reservedShares[event.symbolId] -= request.heldShares;
+    }
+
+    const TradeCommand &command = request.command;
+    TradeResult result{command.requestId, command.type, false, false, event.orderId, "", "", command.submitted, {}};
+    User::Order *order = user->pendingOrders.find(event.orderId);
+    std::ostringstream oss;
+
+    switch (event.kind)
+    {
+    case BookEvent::Fill:
+    {
+        if (order == nullptr)
+            return;
+
+        double quantity = event.quantity;
+        double transactionValue = quantity * event.price;
+        double brokerFee = calculateBrokerFee(transactionValue);
+        double shortfall = 0.0;
+        if (event.side == Side::Buy && isStopOrder(*order) && !isStopLimitOrder(*order))
+        {
+            // Stop-market and trailing buys fill at the reference price, which can
+            // gap past the stop their cash was reserved at. They may spend their
+            // own reservation and free cash, but never what other orders hold.
+            double budget = user->demoMoney - (reservedCash - cashHeld(*order));
+            if (transactionValue + brokerFee > budget)
+            {
+                // The fee on the whole budget is at least the fee on what it buys
+                quantity = std::max(0.0, (budget - calculateBrokerFee(budget)) / event.price);
+                if (quantity < AMOUNT_EPSILON)
+                    quantity = 0.0;
+                shortfall = event.quantity - quantity;
+                transactionValue = quantity * event.price;
+                brokerFee = (quantity > 0.0) ? calculateBrokerFee(transactionValue) : 0.0;
+            }
+        }
+
+        if (quantity > 0.0)
+        {
+            if (event.side == Side::Buy)
+            {
+                user->demoMoney -= transactionValue + brokerFee;
+                user->holdings.buy(event.symbolId, quantity, event.price);
+            }
+            else
+            {
+                user->demoMoney += transactionValue - brokerFee;
+                user->holdings.sell(event.symbolId, quantity, event.price);
+            }
+            user->transactions.emplace_back(order->symbol, quantity, event.price, order->type, brokerFee);
+            lastPrice.store(event.price, std::memory_order_relaxed);
+        }
+
+        // Release what the filled part had reserved
+        User::Order executed = *order;
+        executed.filled += quantity;
+        if (event.remaining > 0.0)
+        {
+            reserve(*order, -1.0);
+            order->amount = event.remaining;
+            order->filled = executed.filled;
+            reserve(*order, 1.0);
+        }
+        else
+        {
+            removeOrder(event.orderId);
+        }
+        const std::string &type = executed.type;
+        const std::string &symbol = executed.symbol;
+
+        result.type = (event.side == Side::Buy) ? CommandType::LimitBuy : CommandType::LimitSell;
+        if (quantity > 0.0)
+        {
+            result.accepted = true;
+            result.filled = true;
+            result.message = formatOrderMessage(type + " order executed for ", quantity, symbol, " at INR ", event.price);
+        }
+        else
+        {
+            oss << type << " order #" << event.orderId << " canceled: insufficient funds at INR " << event.price;
+            result.message = oss.str();
+            oss.str("");
+        }
+        if (shortfall > 0.0 && quantity > 0.0)
+        {
+            oss << "Order #" << event.orderId << " cut by " << shortfall << ": insufficient funds at the fill price";
+            result.detail = oss.str();
+        }
+        else if (event.remaining > 0.0)
+        {
+            oss << "Order #" << event.orderId << " partially filled, " << event.remaining << " still resting";
+            result.detail = oss.str();
+        }
+        results.push_back(result);
+
+        // A completed bracket entry arms its exits
+        if (event.remaining <= 0.0 && isBracketOrder(executed))
+            activateBracket(executed, results);
+        return;
+    }
+
+    case BookEvent::Triggered:
+    {
+        if (order == nullptr)
+            return;
+
+        oss << order->type << " order #" << event.orderId << " triggered at INR " << event.price;
+        if (isStopLimitOrder(*order))
+        {
+            // It now rests in the book as a plain limit order
+            reserve(*order, -1.0);
+            order->type = isBuyOrder(*order) ? "Limit_Buy" : "Limit_Sell";
+            order->stopPrice = 0.0;
+            reserve(*order, 1.0);
+            oss << "; now a limit order at INR " << order->limitPrice;
+        }
+        result.type = (event.side == Side::Buy) ? CommandType::StopBuy : CommandType::StopSell;
+        result.accepted = true;
+        result.message = oss.str();
+        break;
+    }
+
+    case BookEvent::OcoCanceled:
+    {
+        if (order == nullptr)
+            return;
+
+        oss << order->type << " order #" << event.orderId << " canceled: its one-cancels-other order #" << order->linkedId << " executed.";
+        removeOrder(event.orderId);
+        result.type = (event.side == Side::Buy) ? CommandType::OcoBuy : CommandType::OcoSell;
+        result.message = oss.str();
+        break;
+    }
+
+    case BookEvent::Canceled:
+    {
+        // The order executed or was canceled before the request reached the
+        // book; the request is still answered so no submitter waits on it
+        if (order == nullptr)
+        {
+            if (event.requestId == 0 || request.withdrawal)
+                return;
+            result.message = unknownOrderMessage(event.orderId);
+            break;
+        }
+
+        // Shutting down: the order stays pending so it is saved (reservations
+        // are rebuilt when it is re-entered)
+        if (request.withdrawal)
+            return;
+
+        User::Order canceled = *order;
+        removeOrder(event.orderId);
+        if (event.requestId == 0)
+        {
+            // The book canceled our resting order so we would not trade with ourselves
+            result.type = (event.side == Side::Buy) ? CommandType::LimitBuy : CommandType::LimitSell;
+            oss << "Limit order #" << event.orderId << " canceled to prevent a self-trade.";
+        }
+        else
+        {
+            oss << "Order #" << event.orderId << " has been canceled.";
+            result.accepted = true;
+        }
+        result.message = oss.str();
+        results.push_back(result);
+
+        // Whatever part of a bracket entry did fill still gets its exits
+        if (isBracketOrder(canceled) && canceled.filled > 0.0)
+            activateBracket(canceled, results);
+        return;
+    }
+
+    case BookEvent::Amended:
+    {
+        if (order == nullptr)
+        {
+            result.message = unknownOrderMessage(event.orderId);
+            break;
+        }
+
+        reserve(*order, -1.0);
+        user->pendingOrders.amend(event.orderId, event.quantity, event.price);
+        reserve(*order, 1.0);
+
+        oss << "Limit order #" << event.orderId << " amended to " << event.quantity << " at limit price INR " << event.price;
+        result.message = oss.str();
+        result.accepted = true;
+        break;
+    }
+
+    case BookEvent::StopMoved:
+    {
+        // A trailing stop followed the price; a trailing buy's reservation follows it down
+        if (order == nullptr)
+            return;
+        reserve(*order, -1.0);
+        order->stopPrice = event.price;
+        reserve(*order, 1.0);
+        return;
+    }
+
+    case BookEvent::CancelRejected:
+    case BookEvent::AmendRejected:
+        if (request.withdrawal)
+            return;
+        result.message = unknownOrderMessage(event.orderId);
+        break;
+    }
+
+    results.push_back(result);
+}
+
+void TradingEngine::markHoldings()
+{
+    // Mark holdings to the latest prices so portfolio totals stay current; the
+    // ticks are read without a lock, so no simulation step is held up
+    std::lock_guard<std::mutex> accountGuard(accountLock);
+    for (const Holding &holding : user->holdings)
+    {
+        Tick tick = symbolMarket(holding.symbolId).latest.read();
+        if (tick.sequence != 0)
+            user->holdings.markPrice(holding.symbolId, tick.price);
+    }
+}
+
+void TradingEngine::publishPortfolio()
+{
+    // Only the engine writes the account, so reading it here needs no lock
+    capturePortfolio(*user, reservedCash, lastPrice.load(std::memory_order_relaxed), snapshots.back());
+    snapshots.publish();
+}
@@ -0,0 +1,269 @@
+// src/trigger_index.cpp
+
+#include "trigger_index.h"
+
+TriggerIndex::Entry &TriggerIndex::entry(Handle handle)
+{
+    if (handle >= entries.size())
+        entries.resize(handle + 1);
+    return entries[handle];
+}
+
+void TriggerIndex::arm(Handle handle, Direction direction, int64_t triggerTicks)
+{
+    disarm(handle);
+    uint8_t ladder = (direction == FiresOnFall) ? 0 : 1;
+    armFixed(handle, ladder, toLadder(ladder, triggerTicks));
+    ++armedCount;
+}
+
+void TriggerIndex::armTrailing(Handle handle, Direction direction, int64_t distanceTicks)
+{
+    disarm(handle);
+    uint8_t ladder = (direction == FiresOnFall) ? 0 : 1;
+    if (priceSeen)
+    {
+        armInCohort(handle, ladder, distanceTicks, toLadder(ladder, lastTicks));
+    }
+    else
+    {
+        Entry &waitingEntry = entry(handle);
+        waitingEntry.state = Entry::Waiting;
+        waitingEntry.ladder = ladder;
+        waitingEntry.value = distanceTicks;
+        waiting.push_back(handle);
+    }
+    ++armedCount;
+}
+
+bool TriggerIndex::disarm(Handle handle)
+{
+    if (handle >= entries.size())
+        return false;
+
+    switch (entries[handle].state)
+    {
+    case Entry::Disarmed:
+        return false;
+    case Entry::Fixed:
+        unlinkFixed(handle);
+        break;
+    case Entry::Trailing:
+        removeFromCohort(handle);
+        break;
+    case Entry::Waiting:
+        waiting.erase(std::find(waiting.begin(), waiting.end(), handle));
+        break;
+    }
+    entries[handle].state = Entry::Disarmed;
+    --armedCount;
+    return true;
+}
+
+void TriggerIndex::armFixed(Handle handle, uint8_t ladder, int64_t trigger)
+{
+    Level &level = ladders[ladder].fixedLevels[trigger];
+    Entry &fixed = entry(handle);
+    fixed.state = Entry::Fixed;
+    fixed.ladder = ladder;
+    fixed.value = trigger;
+    fixed.prev = level.tail;
+    fixed.next = NIL;
+    if (level.tail != NIL)
+        entries[level.tail].next = handle;
+    else
+        level.head = handle;
+    level.tail = handle;
+}
+
+void TriggerIndex::unlinkFixed(Handle handle)
+{
+    Entry &fixed = entries[handle];
+    auto &levels = ladders[fixed.ladder].fixedLevels;
+    auto levelIt = levels.find(fixed.value);
+    Level &level = levelIt->second;
+    if (fixed.prev != NIL)
+        entries[fixed.prev].next = fixed.next;
+    else
+        level.head = fixed.next;
+    if (fixed.next != NIL)
+        entries[fixed.next].prev = fixed.prev;
+    else
+        level.tail = fixed.prev;
+    if (level.head == NIL)
+        levels.erase(levelIt);
+}
+
+void TriggerIndex::armInCohort(Handle handle, uint8_t ladder, int64_t distance, int64_t peak)
+{
+    Ladder &side = ladders[ladder];
+    uint32_t cohort;
+    auto peakIt = side.cohortsByPeak.find(peak);
+    if (peakIt != side.cohortsByPeak.end())
+    {
+        cohort = peakIt->second;
+        side.cohortsByTrigger.erase({cohortTrigger(cohort), cohort});
+    }
+    else
+    {
+        if (!freeCohorts.empty())
+        {
+            cohort = freeCohorts.back();
+            freeCohorts.pop_back();
+        }
+        else
+        {
+            cohort = static_cast<uint32_t>(cohorts.size());
+            cohorts.emplace_back();
+        }
+        cohorts[cohort].peak = peak;
+        side.cohortsByPeak.emplace(peak, cohort);
+    }
+
+    Entry &trailing = entry(handle);
+    trailing.state = Entry::Trailing;
+    trailing.ladder = ladder;
+    trailing.value = distance;
+    trailing.cohort = cohort;
+    trailing.position = cohorts[cohort].byDistance.emplace(distance, handle);
+    side.cohortsByTrigger.emplace(cohortTrigger(cohort), cohort);
+}
+
+void TriggerIndex::removeFromCohort(Handle handle)
+{
+    Entry &trailing = entries[handle];
+    Ladder &side = ladders[trailing.ladder];
+    uint32_t cohort = trailing.cohort;
+
+    side.cohortsByTrigger.erase({cohortTrigger(cohort), cohort});
+    cohorts[cohort].byDistance.erase(trailing.position);
+    if (cohorts[cohort].byDistance.empty())
+        releaseCohort(side, cohort);
+    else
+        side.cohortsByTrigger.emplace(cohortTrigger(cohort), cohort);
+}
+
+void TriggerIndex::releaseCohort(Ladder &ladder, uint32_t cohort)
+{
+    ladder.cohortsByPeak.erase(cohorts[cohort].peak);
+    freeCohorts.push_back(cohort);
+}
+
+int64_t TriggerIndex::trigger(Handle handle) const
+{
+    const Entry &armed = entries[handle];
+    if (armed.state == Entry::Trailing)
+        return toLadder(armed.ladder, cohorts[armed.cohort].peak - armed.value);
+    return toLadder(armed.ladder, armed.value);
+}
+
+void TriggerIndex::ratchet(uint8_t ladder, int64_t price, std::vector<Handle> *moved)
+{
+    // Every cohort whose peak the price has reached now shares that peak
+    Ladder &side = ladders[ladder];
+    if (side.cohortsByPeak.empty() || side.cohortsByPeak.begin()->first > price)
+        return;
+
+    std::vector<uint32_t> merging;
+    for (auto peakIt = side.cohortsByPeak.begin(); peakIt != side.cohortsByPeak.end() && peakIt->first <= price;)
+    {
+        merging.push_back(peakIt->second);
+        if (moved != nullptr && peakIt->first < price)
+        {
+            for (const auto &node : cohorts[peakIt->second].byDistance)
+                moved->push_back(node.second);
+        }
+        side.cohortsByTrigger.erase({cohortTrigger(peakIt->second), peakIt->second});
+        peakIt = side.cohortsByPeak.erase(peakIt);
+    }
+
+    // Keep the largest cohort and move the others' nodes into it
+    uint32_t target = merging[0];
+    for (uint32_t cohort : merging)
+    {
+        if (cohorts[cohort].byDistance.size() > cohorts[target].byDistance.size())
+            target = cohort;
+    }
+    DistanceMap &targetMap = cohorts[target].byDistance;
+    for (uint32_t cohort : merging)
+    {
+        if (cohort == target)
+            continue;
+        DistanceMap &source = cohorts[cohort].byDistance;
+        while (!source.empty())
+        {
+            auto node = source.extract(source.begin());
+            Handle handle = node.mapped();
+            entries[handle].position = targetMap.insert(std::move(node));
+            entries[handle].cohort = target;
+        }
+        freeCohorts.push_back(cohort);
+    }
+
+    cohorts[target].peak = price;
+    side.cohortsByPeak.emplace(price, target);
+    side.cohortsByTrigger.emplace(cohortTrigger(target), target);
+}
+
+void TriggerIndex::fire(uint8_t ladder, int64_t price, std::vector<Handle> &fired)
+{
+    Ladder &side = ladders[ladder];
+
+    // Fixed triggers at or above the price fire, oldest first within a level
+    while (!side.fixedLevels.empty() && side.fixedLevels.begin()->first >= price)
+    {
+        for (uint32_t handle = side.fixedLevels.begin()->second.head; handle != NIL; handle = entries[handle].next)
+        {
+            entries[handle].state = Entry::Disarmed;
+            fired.push_back(handle);
+            --armedCount;
+        }
+        side.fixedLevels.erase(side.fixedLevels.begin());
+    }
+
+    // A cohort fires its tightest trailing stops first
+    while (!side.cohortsByTrigger.empty() && side.cohortsByTrigger.begin()->first >= price)
+    {
+        uint32_t cohort = side.cohortsByTrigger.begin()->second;
+        side.cohortsByTrigger.erase(side.cohortsByTrigger.begin());
+
+        DistanceMap &byDistance = cohorts[cohort].byDistance;
+        int64_t peak = cohorts[cohort].peak;
+        while (!byDistance.empty() && peak - byDistance.begin()->first >= price)
+        {
+            Handle handle = byDistance.begin()->second;
+            byDistance.erase(byDistance.begin());
+            entries[handle].state = Entry::Disarmed;
+            fired.push_back(handle);
+            --armedCount;
+        }
+
+        if (byDistance.empty())
+            releaseCohort(side, cohort);
+        else
+            side.cohortsByTrigger.emplace(cohortTrigger(cohort), cohort);
+    }
+}
+
+void TriggerIndex::onPrice(int64_t priceTicks, std::vector<Handle> &fired, std::vector<Handle> *moved)
+{
+    priceSeen = true;
+    lastTicks = priceTicks;
+
+    // Trailing stops placed before any price was known start from this one
+    for (Handle handle : waiting)
+    {
+        uint8_t ladder = entries[handle].ladder;
+        armInCohort(handle, ladder, entries[handle].value, toLadder(ladder, priceTicks));
+        if (moved != nullptr)
+            moved->push_back(handle);
+    }
+    waiting.clear();
+
+    for (uint8_t ladder = 0; ladder < 2; ++ladder)
+    {
+        int64_t price = toLadder(ladder, priceTicks);
+        ratchet(ladder, price, moved);
+        fire(ladder, price, fired);
+    }
+}
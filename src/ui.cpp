@@ -2,194 +2,183 @@
 
 #include "utils.h"
 #include "ui.h"
+#include "screener.h"
+#include "data_persistence.h"
 
-void displayPortfolio(User *user, std::map<std::string, std::vector<double>> &closePricesMap,
-                      double lastOrderPrice, int screenWidth, int screenHeight, int &lastLineUsed,
-                      int &maximumHoldingsCount, int &maximumPendingOrdersCount)
+int portfolioLinesNeeded(int maximumHoldingsCount, int maximumPendingOrdersCount)
 {
-    std::lock_guard<std::mutex> dataLock(dataMutex);
-
-    // Update maximumHoldingsCount
-    int holdingsCount = user->holdings.size();
-    if (holdingsCount > maximumHoldingsCount)
-    {
-        maximumHoldingsCount = holdingsCount;
-    }
-
-    // Update maximumPendingOrdersCount
-    int pendingOrdersCount = user->pendingOrders.size();
-    if (pendingOrdersCount > maximumPendingOrdersCount)
-    {
-        maximumPendingOrdersCount = pendingOrdersCount;
-    }
-
     // Calculate the total number of lines needed
     int totalLinesNeeded = 1;                      // For "Portfolio Summary"
     totalLinesNeeded += maximumHoldingsCount;      // For holdings
-    totalLinesNeeded += 4;                         // For Total Investment, Current Value, Profit/Loss, Wallet Balance
-    totalLinesNeeded += 2;                         // For "Pending Limit Orders:" and spacing
+    totalLinesNeeded += 5;                         // For Total Investment, Current Value, Profit/Loss, Realized P/L, Wallet Balance
+    totalLinesNeeded += 2;                         // For "Pending Orders:" and spacing
     totalLinesNeeded += maximumPendingOrdersCount; // For pending orders
     int learningTipsLines = 10;                    // Number of lines used by learning tips
     totalLinesNeeded += learningTipsLines + 1;     // For learning tips and spacing
+    return totalLinesNeeded;
+}
 
+int portfolioTopLine(int screenHeight, int maximumHoldingsCount, int maximumPendingOrdersCount)
+{
     // Check if totalLinesNeeded exceeds screenHeight
+    int totalLinesNeeded = portfolioLinesNeeded(maximumHoldingsCount, maximumPendingOrdersCount);
     int portfolioStartY = 1;                 // Default starting line
     if (totalLinesNeeded < screenHeight - 2) // Leave two lines for messages
     {
         portfolioStartY = screenHeight - totalLinesNeeded - 2;
     }
+    return portfolioStartY;
+}
 
-    // Save cursor position
-    std::cout << "\033[s";
+void composePortfolio(const PortfolioSnapshot &portfolio, int screenWidth, int screenHeight, int &lastLineUsed,
+                      int &maximumHoldingsCount, int &maximumPendingOrdersCount, ScreenBuffer &screen)
+{
+    // Update maximumHoldingsCount
+    int holdingsCount = portfolio.holdings.size();
+    if (holdingsCount > maximumHoldingsCount)
+    {
+        maximumHoldingsCount = holdingsCount;
+    }
 
-    // Clear the space where the portfolio will be displayed
-    for (int i = 0; i < totalLinesNeeded + 5; ++i)
+    // Update maximumPendingOrdersCount
+    int pendingOrdersCount = portfolio.pendingOrders.size();
+    if (pendingOrdersCount > maximumPendingOrdersCount)
     {
-        moveCursor(1, portfolioStartY + i);
-        std::cout << CLEARLINE;
+        maximumPendingOrdersCount = pendingOrdersCount;
     }
 
-    int currentLine = portfolioStartY;
-    moveCursor(1, currentLine++);
-    std::cout << "Portfolio Summary for " << user->username << ":";
+    int totalLinesNeeded = portfolioLinesNeeded(maximumHoldingsCount, maximumPendingOrdersCount);
+    int portfolioStartY = portfolioTopLine(screenHeight, maximumHoldingsCount, maximumPendingOrdersCount);
+
+    // The panel owns the lines the old full redraw used to clear, down to the bottom of the screen
+    TerminalArea area;
+    area.row = portfolioStartY;
+    area.width = screenWidth;
+    area.height = std::max(0, std::min(totalLinesNeeded + 5, screenHeight - portfolioStartY + 1));
+    screen.setArea(area);
+    screen.clear();
+
+    // Each line is formatted as before, then placed on the next row of the panel
+    int row = 0;
+    std::ostringstream line;
+    auto endLine = [&]()
+    {
+        screen.print(0, row++, line.str());
+        line.str("");
+    };
 
-    double totalInvestment = 0.0;
-    double currentValue = 0.0;
+    line << "Portfolio Summary for " << portfolio.username << ":";
+    endLine();
 
-    // Display holdings
+    // Display holdings, valued at the prices they were last marked at
     for (int i = 0; i < maximumHoldingsCount; ++i)
     {
-        moveCursor(1, currentLine++);
         if (i < holdingsCount)
         {
-            const auto &holding = user->holdings[i];
-            const std::string &holdingSymbol = holding.symbol;
-            double latestPrice = 0.0;
-
-            if (!closePricesMap[holdingSymbol].empty())
-            {
-                latestPrice = closePricesMap[holdingSymbol].back();
-            }
-            else
-            {
-                // No price data available for this symbol
-                continue;
-            }
+            const auto &holding = portfolio.holdings[i];
 
             double investment = holding.amount * holding.averagePrice;
-            double value = holding.amount * latestPrice;
-
-            totalInvestment += investment;
-            currentValue += value;
+            double value = holding.amount * holding.markPrice;
 
             // Display holding details
-            std::cout << CLEARLINE << "Holding: " << holdingSymbol << ", Amount: " << holding.amount
-                      << ", Avg Price: INR " << holding.averagePrice << ", Current Price: INR " << latestPrice
-                      << ", P/L: INR " << (value - investment);
-        }
-        else
-        {
-            // Clear line or output empty line
-            std::cout << CLEARLINE;
+            line << "Holding: " << holding.symbol << ", Amount: " << holding.amount
+                 << ", Avg Price: INR " << holding.averagePrice << ", Current Price: INR " << holding.markPrice
+                 << ", P/L: INR " << (value - investment);
         }
+        endLine(); // Blank once the holding is sold
     }
 
+    // Portfolio totals are maintained incrementally by the holdings map
+    double totalInvestment = portfolio.totalInvestment;
+    double currentValue = portfolio.currentValue;
     double profitLoss = currentValue - totalInvestment;
 
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "Total Investment: INR " << totalInvestment;
-
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "Current Value: INR " << currentValue;
-
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "Profit/Loss: INR " << profitLoss;
-
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "Wallet Balance: INR " << user->demoMoney;
+    line << "Total Investment: INR " << totalInvestment;
+    endLine();
+    line << "Current Value: INR " << currentValue;
+    endLine();
+    line << "Profit/Loss: INR " << profitLoss;
+    endLine();
+    line << "Realized P/L (this session): INR " << portfolio.realizedPnL;
+    endLine();
+    line << "Wallet Balance: INR " << portfolio.demoMoney;
+    if (portfolio.reservedCash > 0)
+        line << " (INR " << portfolio.reservedCash << " held for limit buys)";
+    endLine();
 
     // Show last order price
-    if (lastOrderPrice > 0)
-    {
-        moveCursor(1, currentLine++);
-        std::cout << CLEARLINE << "Last Order Price: INR " << lastOrderPrice;
-    }
-    else
-    {
-        moveCursor(1, currentLine++);
-        std::cout << CLEARLINE; // Clear the line if no last order price
-    }
+    if (portfolio.lastOrderPrice > 0)
+        line << "Last Order Price: INR " << portfolio.lastOrderPrice;
+    endLine();
 
-    // Display Pending Limit Orders with indices
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "Pending Limit Orders:";
+    // Display Pending Orders with their IDs
+    line << "Pending Orders:";
+    endLine();
 
     for (int i = 0; i < maximumPendingOrdersCount; ++i)
     {
-        moveCursor(1, currentLine++);
         if (i < pendingOrdersCount)
         {
-            const auto &order = user->pendingOrders[i];
-            std::cout << CLEARLINE;
-            std::cout << i + 1 << ". " << order.symbol << " - " << order.type << " - Amount: " << order.amount
-                      << ", Limit Price: INR " << order.limitPrice;
-        }
-        else
-        {
-            // Clear line or output empty line
-            std::cout << CLEARLINE;
+            const auto &order = portfolio.pendingOrders[i];
+            line << "#" << order.id << " " << order.symbol << " - " << order.type << " - Amount: " << order.amount;
+            if (isTrailingOrder(order))
+                line << ", Trail: INR " << order.trailAmount;
+            else if (isStopOrder(order))
+                line << ", Stop Price: INR " << order.stopPrice;
+            if (!isStopOrder(order) || isStopLimitOrder(order))
+                line << ", Limit Price: INR " << order.limitPrice;
+            if (isBracketOrder(order))
+                line << ", Take Profit: INR " << order.takeProfit << ", Stop Loss: INR " << order.stopPrice;
+            if (order.linkedId != 0)
+                line << " (OCO with #" << order.linkedId << ")";
         }
+        endLine(); // Blank once the order is gone
     }
 
     if (pendingOrdersCount == 0 && maximumPendingOrdersCount == 0)
     {
-        moveCursor(1, currentLine++);
-        std::cout << CLEARLINE << "No pending limit orders.";
+        line << "No pending orders.";
+        endLine();
     }
 
-    currentLine++;
-
-    // Display Learning Tips
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "LEARNING TIPS:";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "1. Buy low, sell high. Avoid buying high and selling low.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "2. Diversify your portfolio to manage risk.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "3. Use limit orders to set your own buy/sell price.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "4. Stay updated with market news and trends.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "5. Remember, the market can remain irrational longer than you can remain solvent.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "6. Always have an exit strategy for your trades.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "7. If RSI is above 80, the market is overbought. If RSI is below 20, the market is oversold.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "8. If a candle and its next crosses moving average above the price, it's a bullish signal. If they cross below, it's bearish.";
-    moveCursor(1, currentLine++);
-    std::cout << CLEARLINE << "9. A broker fee of 0.05% (max INR 20) applies to each transaction.";
+    row++;
+
+    // Learning tips: unchanged from frame to frame, so only the first frame writes them
+    static const char *const LEARNING_TIPS[] = {
+        "LEARNING TIPS:",
+        "1. Buy low, sell high. Avoid buying high and selling low.",
+        "2. Diversify your portfolio to manage risk.",
+        "3. Use limit orders to set your own buy/sell price.",
+        "4. Stay updated with market news and trends.",
+        "5. Remember, the market can remain irrational longer than you can remain solvent.",
+        "6. Always have an exit strategy for your trades.",
+        "7. If RSI is above 80, the market is overbought. If RSI is below 20, the market is oversold.",
+        "8. If a candle and its next crosses moving average above the price, it's a bullish signal. If they cross below, it's bearish.",
+        "9. A broker fee of 0.05% (max INR 20) applies to each transaction.",
+    };
+    for (const char *tip : LEARNING_TIPS)
+        screen.print(0, row++, tip);
 
     // Set last line used
-    lastLineUsed = currentLine++;
-
-    // Restore cursor position
-    std::cout << "\033[u";
-    std::cout.flush(); // Ensure output is written immediately
+    lastLineUsed = portfolioStartY + row;
 }
 
 // Function to display user transactions
-void displayTransactions(const User &user)
+void displayTransactions(TradingEngine &engine)
 {
+    // Copy the transactions so the engine is not blocked while we wait for a key
+    std::vector<std::tuple<std::string, double, double, std::string, double>> transactions;
+    {
+        std::lock_guard<std::mutex> accountLock(engine.accountMutex());
+        transactions = engine.account()->transactions;
+    }
+
     // Clear the screen and show cursor
     std::cout << CLEAR_SCREEN << RESET_CURSOR << SHOW_CURSOR;
 
-    std::lock_guard<std::mutex> dataLock(dataMutex);
-
     std::cout << "=== Your Transactions ===\n\n";
 
-    if (user.transactions.empty())
+    if (transactions.empty())
     {
         std::cout << "No transactions to display.\n";
     }
@@ -202,7 +191,7 @@ void displayTransactions(const User &user)
                   << std::setw(15) << "Broker Fee" << "\n";
         std::cout << "-------------------------------------------------------------\n";
 
-        for (const auto &transaction : user.transactions)
+        for (const auto &transaction : transactions)
         {
             std::cout << std::left << std::setw(15) << std::get<0>(transaction)
                       << std::setw(10) << std::get<1>(transaction)
@@ -223,12 +212,27 @@ void displayTransactions(const User &user)
     } while (choice != 'm' && choice != 'M');
 }
 
-// Helper function to display the input prompt
-void displayInputPrompt()
+// Function to screen every symbol and show the ranked matches
+void displayScan()
 {
-    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-    moveCursor(2, 7);
-    std::cout << CLEARLINE << "Enter 'Buy', 'Sell', 'Limit_Buy', 'Limit_Sell', 'Cancel_Limit_Order', 'Help', 'Return_Main_Menu', or 'Exit': ";
-    std::cout << SHOW_CURSOR;
+    ScreenCriteria criteria;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ScreenHit> hits = scanSymbols(candlesMap, indicatorsMap, criteria, sharedPool(), TaskPriority::Interactive);
+    size_t symbols = indicatorsMap.size();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << CLEAR_SCREEN << RESET_CURSOR << SHOW_CURSOR;
+    std::cout << "=== Market Scan ===\n\n";
+    std::cout << symbols << " symbols scanned in " << std::fixed << std::setprecision(3) << elapsed * 1000.0 << " ms\n\n";
+    printScanTable(hits, criteria, 0);
+
+    std::cout << "\nPress 'm' to return to the main menu...";
     std::cout.flush();
-}
\ No newline at end of file
+
+    // Wait for user to press 'm' or 'M'
+    char choice;
+    do
+    {
+        choice = std::cin.get();
+    } while (choice != 'm' && choice != 'M');
+}
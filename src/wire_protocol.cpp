@@ -0,0 +1,263 @@
+// src/wire_protocol.cpp
+
+#include "utils.h"
+#include "wire_protocol.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace
+{
+    template <typename T>
+    void put(std::string &out, T value)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    // Start a frame; its length is filled in by endFrame()
+    size_t beginFrame(std::string &out, WireType type)
+    {
+        size_t start = out.size();
+        put<uint32_t>(out, 0);
+        put<uint8_t>(out, static_cast<uint8_t>(type));
+        return start;
+    }
+
+    void endFrame(std::string &out, size_t start)
+    {
+        uint32_t length = static_cast<uint32_t>(out.size() - start - WIRE_LENGTH_BYTES);
+        std::memcpy(&out[start], &length, sizeof(length));
+    }
+}
+
+bool WireReader::readString(size_t length, std::string &value)
+{
+    if (failed || size - offset < length)
+    {
+        failed = true;
+        return false;
+    }
+    value.assign(data + offset, length);
+    offset += length;
+    return true;
+}
+
+char *FrameReader::prepare(size_t bytes)
+{
+    // Move what is left to the front before growing, so the buffer stays the size of a frame or two
+    if (begin != 0 && buffer.size() - end < bytes)
+    {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (buffer.size() - end < bytes)
+        buffer.resize(end + bytes);
+    return buffer.data() + end;
+}
+
+bool FrameReader::next(const char *&body, size_t &size)
+{
+    if (tooLarge || end - begin < WIRE_LENGTH_BYTES)
+        return false;
+    uint32_t length;
+    std::memcpy(&length, buffer.data() + begin, sizeof(length));
+    if (length == 0 || length > WIRE_MAX_BODY)
+    {
+        tooLarge = true;
+        return false;
+    }
+    if (end - begin < WIRE_LENGTH_BYTES + length)
+        return false;
+
+    body = buffer.data() + begin + WIRE_LENGTH_BYTES;
+    size = length;
+    begin += WIRE_LENGTH_BYTES + length;
+    if (begin == end)
+        begin = end = 0;
+    return true;
+}
+
+void appendSubscribe(std::string &out, WireType type, const std::vector<SymbolId> &symbols)
+{
+    size_t start = beginFrame(out, type);
+    put<uint32_t>(out, static_cast<uint32_t>(symbols.size()));
+    for (SymbolId id : symbols)
+        put<uint32_t>(out, id);
+    endFrame(out, start);
+}
+
+void appendOrderBatch(std::string &out, const WireOrder *orders, size_t count)
+{
+    size_t start = beginFrame(out, WireType::OrderBatch);
+    put<uint32_t>(out, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i)
+    {
+        const WireOrder &order = orders[i];
+        put<uint64_t>(out, order.tag);
+        put<uint8_t>(out, static_cast<uint8_t>(order.type));
+        put<uint32_t>(out, order.symbolId);
+        put<double>(out, order.amount);
+        put<double>(out, order.limitPrice);
+        put<double>(out, order.stopPrice);
+        put<double>(out, order.trailAmount);
+        put<double>(out, order.takeProfit);
+        put<uint64_t>(out, order.orderId);
+    }
+    endFrame(out, start);
+}
+
+void appendSymbolTable(std::string &out, const std::vector<std::pair<SymbolId, double>> &symbols)
+{
+    size_t start = beginFrame(out, WireType::SymbolTable);
+    put<uint32_t>(out, static_cast<uint32_t>(symbols.size()));
+    for (const auto &pair : symbols)
+    {
+        const std::string &name = symbolName(pair.first);
+        uint8_t length = static_cast<uint8_t>(std::min<size_t>(name.size(), 255));
+        put<uint32_t>(out, pair.first);
+        put<double>(out, pair.second);
+        put<uint8_t>(out, length);
+        out.append(name, 0, length);
+    }
+    endFrame(out, start);
+}
+
+void appendTick(std::string &out, SymbolId symbolId, uint64_t sequence, int64_t sentNanos, double price)
+{
+    size_t start = beginFrame(out, WireType::Tick);
+    put<uint32_t>(out, symbolId);
+    put<uint64_t>(out, sequence);
+    put<int64_t>(out, sentNanos);
+    put<double>(out, price);
+    endFrame(out, start);
+}
+
+void appendCandle(std::string &out, SymbolId symbolId, uint64_t sequence, int64_t sentNanos, const Candle &candle)
+{
+    size_t start = beginFrame(out, WireType::CandleClose);
+    put<uint32_t>(out, symbolId);
+    put<uint64_t>(out, sequence);
+    put<int64_t>(out, sentNanos);
+    put<double>(out, candle.open);
+    put<double>(out, candle.high);
+    put<double>(out, candle.low);
+    put<double>(out, candle.close);
+    endFrame(out, start);
+}
+
+void appendAck(std::string &out, const WireAck &ack)
+{
+    size_t start = beginFrame(out, WireType::OrderAck);
+    uint16_t length = static_cast<uint16_t>(std::min<size_t>(ack.message.size(), 65535));
+    put<uint64_t>(out, ack.tag);
+    put<uint8_t>(out, static_cast<uint8_t>(ack.type));
+    put<uint8_t>(out, ack.flags);
+    put<uint64_t>(out, ack.orderId);
+    put<uint16_t>(out, length);
+    out.append(ack.message, 0, length);
+    endFrame(out, start);
+}
+
+bool readWireOrder(WireReader &reader, WireOrder &order)
+{
+    uint8_t type = 0;
+    reader.read(order.tag);
+    reader.read(type);
+    reader.read(order.symbolId);
+    reader.read(order.amount);
+    reader.read(order.limitPrice);
+    reader.read(order.stopPrice);
+    reader.read(order.trailAmount);
+    reader.read(order.takeProfit);
+    reader.read(order.orderId);
+    order.type = static_cast<CommandType>(type);
+    return reader.ok() && type <= static_cast<uint8_t>(CommandType::AmendOrder);
+}
+
+bool readWireAck(WireReader &reader, WireAck &ack)
+{
+    uint8_t type = 0;
+    uint16_t length = 0;
+    reader.read(ack.tag);
+    reader.read(type);
+    reader.read(ack.flags);
+    reader.read(ack.orderId);
+    reader.read(length);
+    reader.readString(length, ack.message);
+    ack.type = static_cast<CommandType>(type);
+    return reader.ok();
+}
+
+int64_t wireClockNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifndef _WIN32
+int connectToServer(const std::string &socketPath, uint16_t port)
+{
+    int fd;
+    if (port != 0)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        return fd;
+    }
+
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path))
+        return -1;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+size_t raiseDescriptorLimit()
+{
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return 0;
+    if (limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<size_t>(limit.rlim_cur);
+}
+#else
+int connectToServer(const std::string &, uint16_t)
+{
+    return -1; // The server is POSIX-only
+}
+
+size_t raiseDescriptorLimit()
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,194 @@
+// src/work_stealing_pool.cpp
+
+#include "utils.h"
+#include "work_stealing_pool.h"
+
+namespace
+{
+    // Index of the pool worker running on this thread, if any
+    thread_local const WorkStealingPool *currentPool = nullptr;
+    thread_local unsigned currentWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned workerCount)
+    : started(std::chrono::steady_clock::now())
+{
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (auto &count : queued)
+        count.store(0, std::memory_order_relaxed);
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers[i]->thread = std::thread(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::unique_lock<std::mutex> sleepGuard(sleepLock);
+        groupDone.wait(sleepGuard, [this]
+                       { return unfinished.load() == 0; });
+        stopping.store(true);
+    }
+    workAvailable.notify_all();
+    for (auto &worker : workers)
+    {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+void WorkStealingPool::submit(TaskGroup &group, Task task, TaskPriority priority)
+{
+    unsigned target = (currentPool == this) ? currentWorker : nextWorker.fetch_add(1, std::memory_order_relaxed) % size();
+    size_t level = static_cast<size_t>(priority);
+
+    group.unfinished.fetch_add(1);
+    unfinished.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> dequeGuard(workers[target]->lock);
+        workers[target]->jobs[level].push_back(Job{std::move(task), &group});
+    }
+    queued[level].fetch_add(1);
+
+    // Taking the sleep lock orders this against a worker about to sleep, so the wakeup is not lost
+    {
+        std::lock_guard<std::mutex> sleepGuard(sleepLock);
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait(TaskGroup &group)
+{
+    if (currentPool == this)
+    {
+        // Sleeping here could leave the group's own tasks with no worker to run them
+        Job job;
+        while (group.unfinished.load() != 0)
+        {
+            if (take(currentWorker, job))
+                execute(currentWorker, job);
+            else
+                std::this_thread::yield();
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> sleepGuard(sleepLock);
+    groupDone.wait(sleepGuard, [&group]
+                   { return group.unfinished.load() == 0; });
+}
+
+std::vector<WorkStealingPool::WorkerStats> WorkStealingPool::stats() const
+{
+    double lifetime = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::vector<WorkerStats> result(workers.size());
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        const Worker &worker = *workers[i];
+        WorkerStats &stats = result[i];
+        stats.tasks = worker.tasks.load(std::memory_order_relaxed);
+        stats.stolen = worker.stolen.load(std::memory_order_relaxed);
+        stats.busySeconds = worker.busyNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+        stats.utilisation = lifetime > 0.0 ? std::min(1.0, stats.busySeconds / lifetime) : 0.0;
+    }
+    return result;
+}
+
+bool WorkStealingPool::take(unsigned self, Job &job)
+{
+    for (size_t level = 0; level < PRIORITY_LEVELS; ++level)
+    {
+        if (queued[level].load() == 0)
+            continue;
+        if (popLocal(self, level, job))
+            return true;
+        if (steal(self, level, job))
+        {
+            workers[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::popLocal(unsigned self, size_t level, Job &job)
+{
+    Worker &worker = *workers[self];
+    std::lock_guard<std::mutex> dequeGuard(worker.lock);
+    std::deque<Job> &jobs = worker.jobs[level];
+    if (jobs.empty())
+        return false;
+    job = std::move(jobs.back());
+    jobs.pop_back();
+    queued[level].fetch_sub(1);
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned self, size_t level, Job &job)
+{
+    for (unsigned offset = 1; offset < size(); ++offset)
+    {
+        Worker &victim = *workers[(self + offset) % size()];
+        std::lock_guard<std::mutex> dequeGuard(victim.lock);
+        std::deque<Job> &jobs = victim.jobs[level];
+        if (!jobs.empty())
+        {
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            queued[level].fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::execute(unsigned self, Job &job)
+{
+    Worker &worker = *workers[self];
+    auto start = std::chrono::steady_clock::now();
+    job.task();
+    auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    worker.busyNanoseconds.fetch_add(static_cast<uint64_t>(busy.count()), std::memory_order_relaxed);
+    worker.tasks.fetch_add(1, std::memory_order_relaxed);
+
+    // The group may be gone as soon as its count reaches zero, so only the pool is touched after
+    bool groupFinished = job.group->unfinished.fetch_sub(1) == 1;
+    bool poolFinished = unfinished.fetch_sub(1) == 1;
+    job.task = nullptr;
+    if (groupFinished || poolFinished)
+    {
+        std::lock_guard<std::mutex> sleepGuard(sleepLock);
+        groupDone.notify_all();
+    }
+}
+
+void WorkStealingPool::run(unsigned self)
+{
+    currentPool = this;
+    currentWorker = self;
+
+    while (true)
+    {
+        Job job;
+        if (take(self, job))
+        {
+            execute(self, job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> sleepGuard(sleepLock);
+        workAvailable.wait(sleepGuard, [this]
+                           { return queued[0].load() + queued[1].load() + queued[2].load() != 0 || stopping.load(); });
+        if (stopping.load() && queued[0].load() + queued[1].load() + queued[2].load() == 0)
+            return;
+    }
+}
+
+WorkStealingPool &sharedPool()
+{
+    static WorkStealingPool pool;
+    return pool;
+}